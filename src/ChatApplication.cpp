@@ -0,0 +1,10 @@
+#include "ChatApplication.h"
+#include "utils/EventLoopMonitor.h"
+
+ChatApplication::ChatApplication(int& argc, char** argv) : QApplication(argc, argv) {}
+
+bool ChatApplication::notify(QObject* receiver, QEvent* event)
+{
+    EventLoopMonitor::Dispatch dispatch(receiver, event);
+    return QApplication::notify(receiver, event);
+}
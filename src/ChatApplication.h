@@ -0,0 +1,17 @@
+#ifndef CHATAPPLICATION_H
+#define CHATAPPLICATION_H
+
+#include <QApplication>
+
+// 所有事件都经过 notify, 在这里给界面线程上的每次分发计时, 见 utils/EventLoopMonitor.h
+class ChatApplication : public QApplication
+{
+    Q_OBJECT
+
+   public:
+    ChatApplication(int& argc, char** argv);
+
+    bool notify(QObject* receiver, QEvent* event) override;
+};
+
+#endif  // CHATAPPLICATION_H
@@ -4,6 +4,8 @@
 #include <QFileInfo>
 #include <QMimeDatabase>
 #include <QDebug>
+#include "utils/Logging.h"
+#include "utils/MetricsRegistry.h"
 
 FileTransferManager& FileTransferManager::instance()
 {
@@ -14,6 +16,7 @@ FileTransferManager& FileTransferManager::instance()
 FileTransferManager::FileTransferManager(QObject* parent) : QObject(parent)
 {
     // 初始化网络管理器
+    m_clock.start();
 }
 
 void FileTransferManager::uploadFile(const QString& receiverUsername, const QString& filePath,
@@ -25,7 +28,8 @@ void FileTransferManager::uploadFile(const QString& receiverUsername, const QStr
     {
         m_taskQueue.enqueue(
             {taskId, [=]() { uploadFile(receiverUsername, filePath, uploadUrl, token, taskId); }});
-        qDebug() << "任务" << taskId << "已加入上传队列";
+        qCDebug(lcTransfer) << "任务" << taskId << "已加入上传队列";
+        updateTaskGauges();
         return;
     }
 
@@ -33,7 +37,7 @@ void FileTransferManager::uploadFile(const QString& receiverUsername, const QStr
     QFile* file = new QFile(filePath);
     if (!file->open(QIODevice::ReadOnly))
     {
-        qWarning() << "无法打开文件:" << filePath;
+        qCWarning(lcTransfer) << "无法打开文件:" << filePath;
         delete file;
         emit uploadFinished(false, taskId, filePath, "无法打开文件");
         processNextTask();
@@ -76,8 +80,10 @@ void FileTransferManager::uploadFile(const QString& receiverUsername, const QStr
     reply->setParent(this);
     reply->setProperty("taskId", taskId);
     reply->setProperty("localFilePath", filePath);
+    reply->setProperty("startedMs", m_clock.elapsed());
     m_taskMap.insert(taskId, reply);
     m_currentTasks++;
+    updateTaskGauges();
 
     // 连接信号
     connect(reply, &QNetworkReply::uploadProgress, this, [this, taskId](qint64 sent, qint64 total)
@@ -92,14 +98,15 @@ void FileTransferManager::downloadFile(const QUrl& downloadUrl, const QString& s
     {
         m_taskQueue.enqueue(
             {taskId, [=]() { downloadFile(downloadUrl, savePath, token, taskId); }});
-        qDebug() << "任务" << taskId << "已加入下载队列";
+        qCDebug(lcTransfer) << "任务" << taskId << "已加入下载队列";
+        updateTaskGauges();
         return;
     }
 
     QFile* file = new QFile(savePath);
     if (!file->open(QIODevice::WriteOnly))
     {
-        qWarning() << "无法创建文件:" << savePath;
+        qCWarning(lcTransfer) << "无法创建文件:" << savePath;
         delete file;
         emit downloadFinished(false, taskId, savePath, "无法创建文件");
         processNextTask();
@@ -115,9 +122,11 @@ void FileTransferManager::downloadFile(const QUrl& downloadUrl, const QString& s
 
     QNetworkReply* reply = m_networkManager.get(request);
     reply->setParent(this);
+    reply->setProperty("startedMs", m_clock.elapsed());
     m_activeDownloads.insert(reply, file);
     m_taskMap.insert(taskId, reply);
     m_currentTasks++;
+    updateTaskGauges();
 
     connect(reply, &QNetworkReply::downloadProgress, this,
             [this, taskId](qint64 received, qint64 total)
@@ -147,7 +156,7 @@ void FileTransferManager::cancelTask(const QString& taskId)
         reply->deleteLater();
         m_currentTasks--;
         processNextTask();
-        qDebug() << "任务" << taskId << "已取消";
+        qCDebug(lcTransfer) << "任务" << taskId << "已取消";
     }
 }
 
@@ -160,13 +169,15 @@ void FileTransferManager::onUploadFinished()
     QString localFilePath = reply->property("localFilePath").toString();
     QByteArray response = reply->readAll();
 
+    recordTransfer("upload", reply->error() == QNetworkReply::NoError,
+                   QFileInfo(localFilePath).size(), reply->property("startedMs").toLongLong());
     if (reply->error() == QNetworkReply::NoError)
     {
         emit uploadFinished(true, taskId, localFilePath, response);
     }
     else
     {
-        qWarning() << "上传失败:" << localFilePath << ":" << reply->errorString();
+        qCWarning(lcTransfer) << "上传失败:" << localFilePath << ":" << reply->errorString();
         emit uploadFinished(false, taskId, localFilePath, reply->errorString().toUtf8());
     }
 
@@ -181,8 +192,12 @@ void FileTransferManager::onDownloadReadyRead()
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
     if (reply && m_activeDownloads.contains(reply))
     {
+        static MetricCounter& downloaded =
+            MetricsRegistry::instance().counter("transfer.download.bytes");
         QFile* file = m_activeDownloads.value(reply);
-        file->write(reply->readAll());
+        QByteArray data = reply->readAll();
+        downloaded.add(data.size());
+        file->write(data);
     }
 }
 
@@ -195,8 +210,8 @@ void FileTransferManager::onDownloadFinished(const QString& taskId)  // <--- 槽
     // 如果 reply 为空，或它已经从 m_activeDownloads 中移除 (例如被 cancelTask 处理过)
     if (!reply || !m_activeDownloads.contains(reply))
     {
-        qWarning() << "onDownloadFinished: Reply or active download not found for taskId:" << taskId
-                   << ". Possibly already processed or cancelled.";
+        qCWarning(lcTransfer) << "onDownloadFinished: Reply or active download not found for taskId:" << taskId
+                              << ". Possibly already processed or cancelled.";
         // 即使没有找到，也需要确保任务计数正确减少，以允许下一个任务处理
         // 如果这里没有找到 reply，通常意味着它已经被 `cancelTask` 处理过了
         // 但为了健壮性，确保 m_taskMap 中没有残留
@@ -211,12 +226,14 @@ void FileTransferManager::onDownloadFinished(const QString& taskId)  // <--- 槽
 
     QFile* file = m_activeDownloads.take(reply);  // 从活跃下载映射中移除文件
     QString filePath = file->fileName();
+    recordTransfer("download", reply->error() == QNetworkReply::NoError, file->size(),
+                   reply->property("startedMs").toLongLong());
 
     // 调试信息：检查是否有错误
-    qDebug() << "Download finished for taskId:" << taskId;
+    qCDebug(lcTransfer) << "Download finished for taskId:" << taskId;
     if (reply->error() != QNetworkReply::NoError)
     {
-        qWarning() << "下载失败:" << filePath << ":" << reply->errorString();
+        qCWarning(lcTransfer) << "下载失败:" << filePath << ":" << reply->errorString();
     }
 
     if (reply->error() == QNetworkReply::NoError)
@@ -240,8 +257,32 @@ void FileTransferManager::onDownloadFinished(const QString& taskId)  // <--- 槽
 
 void FileTransferManager::processNextTask()
 {
+    updateTaskGauges();
     if (m_taskQueue.isEmpty() || m_currentTasks >= m_maxConcurrentTasks) return;
 
     auto task = m_taskQueue.dequeue();
     task.second();  // 执行队列中的下一个任务
 }
+
+void FileTransferManager::recordTransfer(const QString& direction, bool success, qint64 bytes,
+                                         qint64 startedMs)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    QString prefix = "transfer." + direction + ".";
+    if (!success)
+    {
+        metrics.counter(prefix + "failed").add();
+        return;
+    }
+    metrics.counter(prefix + "completed").add();
+    if (direction == "upload") metrics.counter(prefix + "bytes").add(bytes);
+    // 下载的字节数在收到数据时已经计入
+    qint64 elapsedMs = qMax<qint64>(1, m_clock.elapsed() - startedMs);
+    metrics.histogram(prefix + "throughput_kbps").record(bytes * 1000 / 1024 / elapsedMs);
+}
+
+void FileTransferManager::updateTaskGauges()
+{
+    MetricsRegistry::instance().gauge("transfer.active").set(m_currentTasks);
+    MetricsRegistry::instance().gauge("transfer.queued").set(m_taskQueue.size());
+}
@@ -2,6 +2,7 @@
 #define FILETRANSFERMANAGER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QFile>
@@ -56,6 +57,9 @@ class FileTransferManager : public QObject
    private:
     explicit FileTransferManager(QObject* parent = nullptr);
     void processNextTask();  // 处理队列中的下一个任务
+    // 传输结束时记录次数和吞吐量, direction 为 upload 或 download
+    void recordTransfer(const QString& direction, bool success, qint64 bytes, qint64 startedMs);
+    void updateTaskGauges();
 
     QNetworkAccessManager m_networkManager;
     QMap<QNetworkReply*, QFile*> m_activeDownloads;
@@ -63,6 +67,7 @@ class FileTransferManager : public QObject
     QQueue<QPair<QString, std::function<void()>>> m_taskQueue;  // 任务队列
     int m_maxConcurrentTasks = 3;                               // 最大并发任务数
     int m_currentTasks = 0;                                     // 当前运行的任务数
+    QElapsedTimer m_clock;                                      // 计算传输耗时
 };
 
 #endif  // FILETRANSFERMANAGER_H
@@ -46,7 +46,7 @@ class GlobalEventBus : public QObject
     // 居然重名了
     void appendGroupMessage(const QString& senderUsername, const QString& senderNickname,
                             long groupId, const QString& content, const QString& timestamp);
-    void taskSubmitted(GroupTask* task);
+    void taskSubmitted(const GroupTask& task);
 
    private:
     // 私有构造函数，防止外部直接创建实例
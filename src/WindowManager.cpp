@@ -4,6 +4,7 @@
 #include "ui/RegisterWindow.h"
 #include "ui/ChatWindow.h"
 #include "utils/ConfigManager.h"
+#include "utils/Logging.h"
 #include "utils/UserInfo.h"
 
 #include <QDebug>
@@ -42,6 +43,10 @@ WindowManager::WindowManager(ChatClient* chatClient, QObject* parent)
             &WindowManager::handleClientConnectionError);
     connect(m_chatClient, &ChatClient::reconnecting, this,
             &WindowManager::handleClientReconnecting);
+    connect(m_chatClient, &ChatClient::sessionResumed, this,
+            &WindowManager::handleSessionResumed);
+    connect(m_chatClient, &ChatClient::sessionResumeFailed, this,
+            &WindowManager::handleSessionResumeFailed);
 
     // 注意：ChatWindow 的信号连接将在 handleLoginSuccessful 中动态进行，
     // 因为 ChatWindow 是动态创建的。
@@ -50,7 +55,7 @@ WindowManager::WindowManager(ChatClient* chatClient, QObject* parent)
 WindowManager::~WindowManager()
 {
     // QScopedPointer 会自动处理其管理对象的删除，无需手动 delete
-    qDebug() << "WindowManager destroyed.";
+    qCDebug(lcApp) << "WindowManager destroyed.";
 }
 
 void WindowManager::startApplication()
@@ -67,7 +72,7 @@ void WindowManager::startApplication()
 
 void WindowManager::handleLoginSuccessful(const QString& username, const QString& nickname)
 {
-    qDebug() << "WindowManager: Handling loginSuccessful for" << username;
+    qCDebug(lcApp) << "WindowManager: Handling loginSuccessful for" << username;
 
     // 如果之前有旧的聊天窗口，先销毁它。
     // QScopedPointer 会自动处理旧对象的销毁。
@@ -95,14 +100,14 @@ void WindowManager::handleLoginSuccessful(const QString& username, const QString
 
 void WindowManager::handleShowRegisterWindow()
 {
-    qDebug() << "WindowManager: Showing RegisterWindow.";
+    qCDebug(lcApp) << "WindowManager: Showing RegisterWindow.";
     hideAllWindows();
     showRegisterScreen();
 }
 
 void WindowManager::handleRegistrationSuccessful()
 {
-    qDebug() << "WindowManager: Registration successful, showing LoginWindow.";
+    qCDebug(lcApp) << "WindowManager: Registration successful, showing LoginWindow.";
     // 注册成功通常回到登录界面
     hideAllWindows();
     showLoginScreen();
@@ -111,7 +116,7 @@ void WindowManager::handleRegistrationSuccessful()
 
 void WindowManager::handleShowLoginWindow()
 {
-    qDebug() << "WindowManager: Showing LoginWindow.";
+    qCDebug(lcApp) << "WindowManager: Showing LoginWindow.";
     hideAllWindows();
     showLoginScreen();
 }
@@ -132,7 +137,7 @@ void WindowManager::handleShowLoginWindow()
 
 void WindowManager::handleLogoutRequested()
 {
-    qDebug() << "WindowManager: Logout requested from ChatWindow.";
+    qCDebug(lcApp) << "WindowManager: Logout requested from ChatWindow.";
     hideAllWindows();
     // 还是改回来了
     m_chatClient->disconnectFromServer(true);  // 主动断开连接，服务器会处理在线状态
@@ -145,7 +150,7 @@ void WindowManager::handleLogoutRequested()
 
 void WindowManager::handleClientConnected()
 {
-    qDebug() << "WindowManager: ChatClient connected.";
+    qCDebug(lcApp) << "WindowManager: ChatClient connected.";
     displayConnectionStatus("连接成功。", false);
     // 如果当前在登录界面，并且是连接成功，可以考虑是否需要刷新界面或按钮状态
     // 如果ChatClient内部有自动登录机制，可以在这里触发
@@ -153,11 +158,11 @@ void WindowManager::handleClientConnected()
 
 void WindowManager::handleClientDisconnected()
 {
-    qDebug() << "WindowManager: ChatClient disconnected.";
+    qCDebug(lcApp) << "WindowManager: ChatClient disconnected.";
     // 如果当前在聊天窗口，则显示断线提示，并尝试重连
     if (m_chatWindow && m_chatWindow->isVisible())
     {
-        qDebug() << "void WindowManager::handleClientDisconnected()";
+        qCDebug(lcApp) << "void WindowManager::handleClientDisconnected()";
         displayConnectionStatus("网络连接已断开，正在尝试重连...", true);
         // 这里不直接跳转到登录界面，而是等待 ChatClient 的重连结果
     }
@@ -171,7 +176,13 @@ void WindowManager::handleClientDisconnected()
 
 void WindowManager::handleClientConnectionError(const QString& errorMessage)
 {
-    qDebug() << "WindowManager: ChatClient connection error:" << errorMessage;
+    qCDebug(lcApp) << "WindowManager: ChatClient connection error:" << errorMessage;
+    // 还持有恢复令牌时, 重连成功后会话可以接着用, 保留聊天窗口, 只提示正在重连
+    if (m_chatClient->canResumeSession())
+    {
+        displayConnectionStatus("网络已断开，正在尝试恢复会话...", true);
+        return;
+    }
     displayConnectionStatus("连接错误: " + errorMessage + " 请检查网络或稍后重试。", true);
     // 强制回到登录界面，因为连接失败了
     hideAllWindows();
@@ -180,7 +191,7 @@ void WindowManager::handleClientConnectionError(const QString& errorMessage)
 
 void WindowManager::handleClientReconnecting(int number)
 {
-    qDebug() << "WindowManager: ChatClient attempting to reconnect...";
+    qCDebug(lcApp) << "WindowManager: ChatClient attempting to reconnect...";
     // 如果当前在聊天窗口，显示重连提示
     if (m_chatWindow && m_chatWindow->isVisible())
     {
@@ -193,6 +204,28 @@ void WindowManager::handleClientReconnecting(int number)
     }
 }
 
+void WindowManager::handleSessionResumed()
+{
+    qCDebug(lcApp) << "WindowManager: Session resumed.";
+    // 断线期间聊天窗口可能被隐藏了, 会话恢复后重新显示
+    if (m_chatWindow && !m_chatWindow->isVisible())
+    {
+        hideAllWindows();
+        m_chatWindow->show();
+    }
+    displayConnectionStatus("连接已恢复。", false);
+}
+
+void WindowManager::handleSessionResumeFailed(const QString& reason)
+{
+    qCDebug(lcApp) << "WindowManager: Session resume failed:" << reason;
+    // 原来的会话已经失效, 聊天窗口里的数据不能继续使用, 需要重新登录
+    hideAllWindows();
+    m_chatWindow.reset();
+    showLoginScreen();
+    displayConnectionStatus("会话已失效，请重新登录。(" + reason + ")", true);
+}
+
 // --- 辅助方法实现 ---
 
 void WindowManager::showLoginScreen()
@@ -246,7 +279,7 @@ void WindowManager::displayConnectionStatus(const QString& message, bool isError
     {
         // 可以在聊天窗口的状态栏、顶部通知条或弹出非模态对话框显示
         // m_chatWindow->showStatusMessage(message, isError); // 假设 ChatWindow 有此方法
-        qDebug() << "Connection Status (ChatWindow):" << message;
+        qCDebug(lcApp) << "Connection Status (ChatWindow):" << message;
     }
     else
     {
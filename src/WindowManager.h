@@ -42,6 +42,8 @@ class WindowManager : public QObject
     void handleClientDisconnected();
     void handleClientConnectionError(const QString& errorMessage);
     void handleClientReconnecting(int number);  // 客户端正在尝试重连
+    void handleSessionResumed();                     // 重连后会话已恢复, 继续使用聊天窗口
+    void handleSessionResumeFailed(const QString& reason);  // 恢复失败, 回到登录界面
 
    private:
     ChatClient* m_chatClient;
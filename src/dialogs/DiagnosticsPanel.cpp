@@ -0,0 +1,144 @@
+// dialogs/DiagnosticsPanel.cpp
+#include "DiagnosticsPanel.h"
+#include "utils/MetricsRegistry.h"
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QJsonObject>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+const int REFRESH_INTERVAL = 1000;  // 刷新周期 1 秒
+
+DiagnosticsPanel::DiagnosticsPanel(QWidget* parent) : QDialog(parent)
+{
+    setWindowTitle(tr("诊断"));
+    setMinimumSize(560, 480);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    summaryLabel = new QLabel(this);
+    mainLayout->addWidget(summaryLabel);
+
+    metricsTree = new QTreeWidget(this);
+    metricsTree->setObjectName("metricsTree");
+    metricsTree->setColumnCount(3);
+    metricsTree->setHeaderLabels({tr("指标"), tr("值"), tr("详情")});
+    metricsTree->setUniformRowHeights(true);
+    metricsTree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    mainLayout->addWidget(metricsTree);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    exportButton = new QPushButton(tr("导出 JSON..."), this);
+    QPushButton* closeButton = new QPushButton(tr("关闭"), this);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(exportButton);
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &DiagnosticsPanel::refresh);
+    connect(exportButton, &QPushButton::clicked, this, &DiagnosticsPanel::exportJson);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::hide);
+}
+
+void DiagnosticsPanel::showEvent(QShowEvent* event)
+{
+    refresh();
+    refreshTimer->start(REFRESH_INTERVAL);
+    QDialog::showEvent(event);
+}
+
+void DiagnosticsPanel::hideEvent(QHideEvent* event)
+{
+    // 面板隐藏时不占用界面线程
+    refreshTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+QTreeWidgetItem* DiagnosticsPanel::groupItem(const QString& name)
+{
+    QTreeWidgetItem*& item = m_items[name];
+    if (!item)
+    {
+        item = new QTreeWidgetItem(metricsTree, {name});
+        item->setFirstColumnSpanned(true);
+        item->setExpanded(true);
+    }
+    return item;
+}
+
+QTreeWidgetItem* DiagnosticsPanel::metricItem(QTreeWidgetItem* group, const QString& name)
+{
+    QTreeWidgetItem*& item = m_items[group->text(0) + "/" + name];
+    if (!item) item = new QTreeWidgetItem(group, {name});
+    return item;
+}
+
+void DiagnosticsPanel::refresh()
+{
+    QJsonObject metrics = MetricsRegistry::instance().toJson();
+    double seconds = m_sinceLastRefresh.isValid() ? m_sinceLastRefresh.restart() / 1000.0 : 0.0;
+    if (!m_sinceLastRefresh.isValid()) m_sinceLastRefresh.start();
+
+    QTreeWidgetItem* counters = groupItem("counters");
+    const QJsonObject counterValues = metrics["counters"].toObject();
+    for (auto it = counterValues.constBegin(); it != counterValues.constEnd(); ++it)
+    {
+        qint64 value = it.value().toInteger();
+        QTreeWidgetItem* item = metricItem(counters, it.key());
+        item->setText(1, QString::number(value));
+        if (seconds > 0 && m_lastCounters.contains(it.key()))
+        {
+            double rate = (value - m_lastCounters.value(it.key())) / seconds;
+            item->setText(2, QString("%1/s").arg(rate, 0, 'f', 1));
+        }
+        m_lastCounters.insert(it.key(), value);
+    }
+
+    QTreeWidgetItem* gauges = groupItem("gauges");
+    const QJsonObject gaugeValues = metrics["gauges"].toObject();
+    for (auto it = gaugeValues.constBegin(); it != gaugeValues.constEnd(); ++it)
+    {
+        QJsonObject gauge = it.value().toObject();
+        QTreeWidgetItem* item = metricItem(gauges, it.key());
+        item->setText(1, QString::number(gauge["value"].toInteger()));
+        item->setText(2, QString("max %1").arg(gauge["max"].toInteger()));
+    }
+
+    QTreeWidgetItem* histograms = groupItem("histograms");
+    const QJsonObject histogramValues = metrics["histograms"].toObject();
+    for (auto it = histogramValues.constBegin(); it != histogramValues.constEnd(); ++it)
+    {
+        QJsonObject histogram = it.value().toObject();
+        QTreeWidgetItem* item = metricItem(histograms, it.key());
+        item->setText(1, QString("p50 %1").arg(histogram["p50"].toInteger()));
+        item->setText(2, QString("p99 %1  p999 %2  max %3  n=%4")
+                             .arg(histogram["p99"].toInteger())
+                             .arg(histogram["p999"].toInteger())
+                             .arg(histogram["max"].toInteger())
+                             .arg(histogram["count"].toInteger()));
+    }
+
+    QTreeWidgetItem* probes = groupItem("probes");
+    const QJsonObject probeValues = metrics["probes"].toObject();
+    for (auto it = probeValues.constBegin(); it != probeValues.constEnd(); ++it)
+    {
+        metricItem(probes, it.key())->setText(1, QString::number(it.value().toInteger()));
+    }
+
+    int total = counterValues.size() + gaugeValues.size() + histogramValues.size() +
+                probeValues.size();
+    summaryLabel->setText(tr("%1 个指标, 每秒刷新").arg(total));
+}
+
+void DiagnosticsPanel::exportJson()
+{
+    QString path = QFileDialog::getSaveFileName(this, tr("导出指标"), "chatter_metrics.json",
+                                                tr("JSON (*.json)"));
+    if (path.isEmpty()) return;
+    QString error;
+    if (!MetricsRegistry::instance().dump().write(path, error))
+    {
+        QMessageBox::warning(this, tr("错误"), tr("导出失败: %1").arg(error));
+    }
+}
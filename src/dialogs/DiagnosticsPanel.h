@@ -0,0 +1,44 @@
+// dialogs/DiagnosticsPanel.h
+#ifndef DIAGNOSTICSPANEL_H
+#define DIAGNOSTICSPANEL_H
+
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+
+// 隐藏的诊断面板 (聊天窗口中按 Ctrl+Shift+D 打开), 显示 MetricsRegistry 中的全部指标.
+// 可见时每秒刷新一次, 计数器同时显示两次刷新之间的速率
+class DiagnosticsPanel : public QDialog
+{
+    Q_OBJECT
+
+   public:
+    explicit DiagnosticsPanel(QWidget* parent = nullptr);
+
+   protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+   private slots:
+    void refresh();
+    void exportJson();
+
+   private:
+    QTreeWidgetItem* groupItem(const QString& name);
+    QTreeWidgetItem* metricItem(QTreeWidgetItem* group, const QString& name);
+
+    QTreeWidget* metricsTree;
+    QLabel* summaryLabel;
+    QPushButton* exportButton;
+    QTimer* refreshTimer;
+
+    QHash<QString, QTreeWidgetItem*> m_items;  // 按 "分组/名字" 复用已有的行, 刷新时不重建
+    QHash<QString, qint64> m_lastCounters;
+    QElapsedTimer m_sinceLastRefresh;
+};
+
+#endif  // DIAGNOSTICSPANEL_H
@@ -4,8 +4,8 @@
 #include <QMessageBox>  // 添加QMessageBox
 
 UserSelectionDialog::UserSelectionDialog(const QMap<long, User*>& availableUsers,
-                                         const QSet<long>& currentGroupMembers, bool addingMembers,
-                                         QWidget* parent)
+                                         const GroupMembership& currentGroupMembers,
+                                         bool addingMembers, QWidget* parent)
     : QDialog(parent), m_selectedUserId(0)
 {
     setWindowTitle(addingMembers ? tr("选择要添加的成员") : tr("选择要移除的成员"));
@@ -20,45 +20,36 @@ UserSelectionDialog::UserSelectionDialog(const QMap<long, User*>& availableUsers
     userListWidget = new QListWidget(this);
     userListWidget->setSelectionMode(QAbstractItemView::SingleSelection);
     userListWidget->setObjectName("userListWidget");
+    userListWidget->setUniformItemSizes(true);  // 大列表下避免逐项计算尺寸
     mainLayout->addWidget(userListWidget);
 
-    // 根据是“添加”还是“移除”成员来填充列表
-    for (User* user : availableUsers.values())
+    // 批量填充时关闭刷新
+    userListWidget->setUpdatesEnabled(false);
+    if (addingMembers)
     {
-        if (!user) continue;                   // 确保用户对象有效
-        if (user->getUserId() == 0) continue;  // 跳过无效的 ID
-
-        bool isMemberOfCurrentGroup = currentGroupMembers.contains(user->getUserId());
-
-        if (addingMembers)
+        // 添加成员模式: 遍历所有用户, 只显示非当前群组成员, 成员判断是 O(1)
+        for (auto it = availableUsers.constBegin(); it != availableUsers.constEnd(); ++it)
         {
-            // 在添加成员模式下，只显示非当前群组成员
-            if (!isMemberOfCurrentGroup)
-            {
-                QListWidgetItem* item = new QListWidgetItem(
-                    QString("%1 (%2)").arg(user->getNickname()).arg(user->getUserId()),
-                    userListWidget);
-                item->setData(
-                    Qt::UserRole,
-                    static_cast<qint64>(user->getUserId()));  // 将用户 ID 存储在 Item 的数据中
-                userListWidget->addItem(item);
-            }
+            User* user = it.value();
+            if (!user) continue;                   // 确保用户对象有效
+            if (user->getUserId() == 0) continue;  // 跳过无效的 ID
+            if (currentGroupMembers.contains(user->getUserId())) continue;
+            addUserItem(user->getUserId(), user->getNickname());
         }
-        else
-        {  // 移除成员模式
-            // 在移除成员模式下，只显示当前群组成员
-            if (isMemberOfCurrentGroup)
-            {
-                QListWidgetItem* item = new QListWidgetItem(
-                    QString("%1 (%2)").arg(user->getNickname()).arg(user->getUserId()),
-                    userListWidget);
-                item->setData(
-                    Qt::UserRole,
-                    static_cast<qint64>(user->getUserId()));  // 将用户 ID 存储在 Item 的数据中
-                userListWidget->addItem(item);
-            }
+    }
+    else
+    {
+        // 移除成员模式: 只需要遍历群组成员本身, 不再扫描全部用户
+        const auto& members = currentGroupMembers.members();
+        for (auto it = members.constBegin(); it != members.constEnd(); ++it)
+        {
+            const GroupMembership::MemberInfo& info = it.value();
+            User* user = availableUsers.value(info.userId, nullptr);
+            // 优先使用 UserManager 中的最新昵称
+            addUserItem(info.userId, user ? user->getNickname() : internedString(info.nickname));
         }
     }
+    userListWidget->setUpdatesEnabled(true);
 
     // 按钮布局
     QHBoxLayout* buttonLayout = new QHBoxLayout();
@@ -90,6 +81,13 @@ UserSelectionDialog::UserSelectionDialog(const QMap<long, User*>& availableUsers
     connect(cancelButton, &QPushButton::clicked, this, &QDialog::reject);  // 拒绝对话框并关闭
 }
 
+void UserSelectionDialog::addUserItem(long userId, const QString& nickname)
+{
+    QListWidgetItem* item = new QListWidgetItem(QString("%1 (%2)").arg(nickname).arg(userId));
+    item->setData(Qt::UserRole, static_cast<qint64>(userId));  // 将用户 ID 存储在 Item 的数据中
+    userListWidget->addItem(item);
+}
+
 long UserSelectionDialog::getSelectedUserId() const
 {
     return m_selectedUserId;
@@ -12,16 +12,17 @@
 #include <QSet>  // 用于高效的成员检查
 
 #include "utils/User.h"  // 假设你的 User 类在这里
+#include "utils/GroupMembership.h"
 
 class UserSelectionDialog : public QDialog
 {
     Q_OBJECT
    public:
     // availableUsers: 所有可用的用户 (QMap<long, User*>)
-    // currentGroupMembers: 当前群组的成员 ID 集合 (QSet<long>)，用于过滤
+    // currentGroupMembers: 当前群组的成员集合，O(1) 判断是否为成员
     // addingMembers: true 表示添加成员模式 (显示非群组成员)，false 表示移除成员模式 (显示群组成员)
     explicit UserSelectionDialog(const QMap<long, User*>& availableUsers,
-                                 const QSet<long>& currentGroupMembers, bool addingMembers,
+                                 const GroupMembership& currentGroupMembers, bool addingMembers,
                                  QWidget* parent = nullptr);
 
     // 获取选中的用户 ID
@@ -32,6 +33,8 @@ class UserSelectionDialog : public QDialog
     void onSelectionChanged();
 
    private:
+    void addUserItem(long userId, const QString& nickname);
+
     QListWidget* userListWidget;
     QPushButton* selectButton;
     QPushButton* cancelButton;
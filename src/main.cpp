@@ -1,8 +1,14 @@
+#include "ChatApplication.h"
 #include "network/ChatClient.h"
+#include "network/TrafficReplayer.h"
 #include "ui/LoginWindow.h"
 #include "ui/RegisterWindow.h"
 #include "ui/ChatWindow.h"  // 仍然需要包含，因为 ChatWindow 在 WindowManager 中使用
 #include "utils/ConfigManager.h"
+#include "utils/EventLoopMonitor.h"
+#include "utils/Logging.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/Trace.h"
 #include "FileTransferManager.h"
 #include "GlobalEventBus.h"
 // #include "utils/UserInfo.h" // 如果不再直接在 main 中使用，可以移除
@@ -17,9 +23,24 @@
 #include <QMessageBox>
 // #include <QTimer> // 如果不再直接在 main 中使用，可以移除
 
+// 退出时把诊断数据写到启动参数指定的路径
+static void writeOnQuit(QCoreApplication& app, JsonDump& dump, const char* failure)
+{
+    QObject::connect(&app, &QCoreApplication::aboutToQuit,
+                     [&dump, failure]()
+                     {
+                         QString path = dump.path();
+                         QString error;
+                         if (!dump.write(path, error))
+                         {
+                             qCWarning(lcApp) << failure << path << error;
+                         }
+                     });
+}
+
 int main(int argc, char* argv[])
 {
-    QApplication app(argc, argv);
+    ChatApplication app(argc, argv);
 
     // 1. 初始化单例
     GlobalEventBus::instance();
@@ -28,7 +49,7 @@ int main(int argc, char* argv[])
     // 2. 加载配置文件。即使失败，ConfigManager 也会设置默认值。
     if (!ConfigManager::instance().loadConfig(":/config.json"))
     {
-        qWarning() << "无法加载配置文件或配置有误，将使用默认配置。";
+        qCWarning(lcApp) << "无法加载配置文件或配置有误，将使用默认配置。";
     }
 
     // 3. 获取ConfigManager中的当前（或默认）配置值作为命令行参数的默认值
@@ -53,15 +74,77 @@ int main(int argc, char* argv[])
                                       defaultHttpPortStr);
     QCommandLineOption apiPrefixOption({"ap", "api-prefix"}, "API prefix", "prefix",
                                        defaultApiPrefix);
+    QCommandLineOption traceOption("trace",
+                                   "Trace message latency, export Chrome trace JSON on exit "
+                                   "or with Ctrl+Shift+T",
+                                   "file");
 
     parser.addOption(tcpHostOption);
     parser.addOption(tcpPortOption);
     parser.addOption(httpHostOption);
     parser.addOption(httpPortOption);
     parser.addOption(apiPrefixOption);
+    parser.addOption(traceOption);
+    QCommandLineOption metricsOption("metrics",
+                                     "Dump runtime metrics as JSON on exit or with Ctrl+Shift+M",
+                                     "file");
+    parser.addOption(metricsOption);
+    QCommandLineOption logRulesOption("log-rules",
+                                      "Logging filter rules, e.g. \"chatter.net.debug=true;"
+                                      "chatter.users.debug=true\"",
+                                      "rules");
+    QCommandLineOption logFileOption("log-file", "Also append log output to file", "file");
+    QCommandLineOption logRateOption("log-rate",
+                                     "Max debug/info log lines per second, 0 = unlimited",
+                                     "count", "2000");
+    parser.addOption(logRulesOption);
+    parser.addOption(logFileOption);
+    parser.addOption(logRateOption);
+    QCommandLineOption captureOption("capture",
+                                     "Record every inbound and outbound frame to a capture file",
+                                     "file");
+    QCommandLineOption replayOption("replay",
+                                    "Replay a capture file through the client and UI instead of "
+                                    "connecting to the server",
+                                    "file");
+    QCommandLineOption replaySpeedOption("replay-speed",
+                                         "Replay speed factor, 1 = original timing, "
+                                         "0 = as fast as possible",
+                                         "factor", "1");
+    QCommandLineOption replayQuitOption("replay-quit", "Quit when the replay has finished");
+    parser.addOption(captureOption);
+    parser.addOption(replayOption);
+    parser.addOption(replaySpeedOption);
+    parser.addOption(replayQuitOption);
+    QCommandLineOption stallThresholdOption("stall-threshold",
+                                            "Record GUI event dispatches slower than this in the "
+                                            "stall log, 0 = disable the event loop monitor",
+                                            "ms", "50");
+    QCommandLineOption stallLogOption("stall-log",
+                                      "Write the GUI stall log as JSON on exit or with "
+                                      "Ctrl+Shift+S",
+                                      "file");
+    parser.addOption(stallThresholdOption);
+    parser.addOption(stallLogOption);
 
     parser.process(app);
 
+    // 日志: chatter.* 的 debug 默认关闭, 输出交给后台线程
+    QString logRules = "qt.widgets.style=true";
+    if (parser.isSet(logRulesOption))
+    {
+        logRules += '\n' + parser.value(logRulesOption).replace(';', '\n');
+    }
+    QLoggingCategory::setFilterRules(logRules);
+    Logging::SinkOptions logOptions;
+    logOptions.filePath = parser.value(logFileOption);
+    logOptions.maxPerSecond = qMax(0, parser.value(logRateOption).toInt());
+    QString logError;
+    if (!Logging::installAsyncSink(logOptions, logError))
+    {
+        qCWarning(lcApp) << "无法打开日志文件:" << logOptions.filePath << logError;
+    }
+
     // 5. 获取命令行参数的值，并将其更新到 ConfigManager 中
     QString finalTcpHost = parser.value(tcpHostOption);
     QString finalTcpPortStr = parser.value(tcpPortOption);
@@ -73,8 +156,8 @@ int main(int argc, char* argv[])
     quint16 finalTcpPort = finalTcpPortStr.toUShort(&tcpPortOk);
     if (!tcpPortOk || finalTcpPort == 0)
     {
-        qWarning() << "命令行指定的 TCP 端口无效或为0 (" << finalTcpPortStr
-                   << ")，将使用默认值 9999。";
+        qCWarning(lcApp) << "命令行指定的 TCP 端口无效或为0 (" << finalTcpPortStr
+                         << ")，将使用默认值 9999。";
         finalTcpPort = 9999;
     }
 
@@ -82,8 +165,8 @@ int main(int argc, char* argv[])
     quint16 finalHttpPort = finalHttpPortStr.toUShort(&httpPortOk);
     if (!httpPortOk || finalHttpPort == 0)
     {
-        qWarning() << "命令行指定的 HTTP 端口无效或为0 (" << finalHttpPortStr
-                   << ")，将使用默认值 8080。";
+        qCWarning(lcApp) << "命令行指定的 HTTP 端口无效或为0 (" << finalHttpPortStr
+                         << ")，将使用默认值 8080。";
         finalHttpPort = 8080;
     }
 
@@ -94,34 +177,108 @@ int main(int argc, char* argv[])
     ConfigManager::instance().setHttpPort(finalHttpPort);
     ConfigManager::instance().setApiPrefix(finalApiPrefix);
 
-    qDebug() << "最终配置：TCP Host=" << ConfigManager::instance().tcpHost()
-             << ", TCP Port=" << ConfigManager::instance().tcpPort()
-             << ", HTTP Host=" << ConfigManager::instance().httpHost()
-             << ", HTTP Port=" << ConfigManager::instance().httpPort()
-             << ", API Prefix=" << ConfigManager::instance().apiPrefix();
+    qCDebug(lcApp) << "最终配置：TCP Host=" << ConfigManager::instance().tcpHost()
+                   << ", TCP Port=" << ConfigManager::instance().tcpPort()
+                   << ", HTTP Host=" << ConfigManager::instance().httpHost()
+                   << ", HTTP Port=" << ConfigManager::instance().httpPort()
+                   << ", API Prefix=" << ConfigManager::instance().apiPrefix();
+
+    // 消息链路追踪, 默认关闭
+    if (parser.isSet(traceOption))
+    {
+        Trace::dump().setPath(parser.value(traceOption));
+        Trace::setEnabled(true);
+        writeOnQuit(app, Trace::dump(), "无法写入追踪文件:");
+    }
+
+    // 运行时指标, 控件数量只能在界面线程读取
+    MetricsRegistry::instance().registerProbe(
+        "ui.widgets", []() { return qint64(QApplication::allWidgets().size()); });
+    if (parser.isSet(metricsOption))
+    {
+        MetricsRegistry::instance().dump().setPath(parser.value(metricsOption));
+        writeOnQuit(app, MetricsRegistry::instance().dump(), "无法写入指标文件:");
+    }
+
+    // 界面线程的卡顿监控, 默认开启, 每次事件分发只多两次读时钟
+    EventLoopMonitor::Options monitorOptions;
+    monitorOptions.stallThresholdMs = parser.value(stallThresholdOption).toInt();
+    if (monitorOptions.stallThresholdMs > 0)
+    {
+        EventLoopMonitor::start(monitorOptions);
+    }
+    if (parser.isSet(stallLogOption))
+    {
+        EventLoopMonitor::dump().setPath(parser.value(stallLogOption));
+        writeOnQuit(app, EventLoopMonitor::dump(), "无法写入卡顿日志:");
+    }
+
+    // 回放抓包时不连接服务器, 先确认文件可用
+    TrafficReplayer* replayer = nullptr;
+    if (parser.isSet(replayOption))
+    {
+        replayer = new TrafficReplayer(&app);
+        QString error;
+        if (!replayer->load(parser.value(replayOption), error))
+        {
+            qCCritical(lcApp) << "无法读取抓包文件:" << parser.value(replayOption) << error;
+            EventLoopMonitor::stop();
+            Logging::shutdownAsyncSink();
+            return 1;
+        }
+        replayer->setSpeed(parser.value(replaySpeedOption).toDouble());
+    }
 
     // 7. 创建 ChatClient 实例
     ChatClient* chatClient = new ChatClient(&app);  // 将 app 作为父对象，确保其生命周期受控
+    if (parser.isSet(captureOption))
+    {
+        QString error;
+        if (!chatClient->startCapture(parser.value(captureOption), error))
+        {
+            qCWarning(lcApp) << "无法创建抓包文件:" << parser.value(captureOption) << error;
+        }
+    }
 
     // 8. 创建并启动 WindowManager
     WindowManager windowManager(chatClient);
     windowManager.startApplication();  // 由 WindowManager 管理初始窗口显示和连接尝试
 
+    // 抓包中的登录响应会像真实登录一样切换到聊天窗口
+    if (replayer)
+    {
+        chatClient->beginReplay();
+        QObject::connect(replayer, &TrafficReplayer::frameReady, chatClient,
+                         &ChatClient::replayFrame);
+        const bool quitWhenDone = parser.isSet(replayQuitOption);
+        QObject::connect(replayer, &TrafficReplayer::finished, &app,
+                         [replayer, quitWhenDone](qint64 elapsedMs)
+                         {
+                             qCInfo(lcApp) << "Replay finished:" << replayer->frameCount()
+                                           << "frames in" << elapsedMs << "ms, captured over"
+                                           << replayer->capturedDurationMs() << "ms";
+                             if (quitWhenDone) QCoreApplication::quit();
+                         });
+        replayer->start();
+    }
+
     // 9. 加载样式表
-    QLoggingCategory::setFilterRules("qt.widgets.style=true");
     QFile styleFile(":/styles/styles.qss");
 
     if (styleFile.open(QFile::ReadOnly))
     {
         QString styleSheet = styleFile.readAll();
         app.setStyleSheet(styleSheet);
-        qDebug() << "Successfully loaded styles.qss";
+        qCDebug(lcApp) << "Successfully loaded styles.qss";
     }
     else
     {
-        qWarning() << "Could not open styles.qss: " << styleFile.errorString();
+        qCWarning(lcApp) << "Could not open styles.qss: " << styleFile.errorString();
     }
 
     // 10. 进入事件循环
-    return app.exec();
+    int result = app.exec();
+    EventLoopMonitor::stop();
+    Logging::shutdownAsyncSink();
+    return result;
 }
\ No newline at end of file
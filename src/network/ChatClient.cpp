@@ -1,26 +1,58 @@
 #include "ChatClient.h"
 #include "utils/JsonConverter.h"
+#include "utils/Logging.h"
 #include "utils/MessageHandler.h"
 #include "utils/UserInfo.h"
+#include "utils/ConfigManager.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/Trace.h"
 #include <QDebug>
 #include "GlobalEventBus.h"
 #include <QDateTime>         // 用于随机抖动
 #include <QRandomGenerator>  // 用于随机抖动
 #include <QMetaEnum>
+#include <iterator>
 // 常量定义
 const int HEARTBEAT_INTERVAL = 15000;        // 15 秒
 const int SERVER_HEARTBEAT_TIMEOUT = 45000;  // 服务器3个心跳周期未响应，45秒
+const int HEARTBEAT_CHECK_INTERVAL = 1000;   // 心跳定时器的检查周期, 超时判断的精度为 1 秒
+const int MIN_DEAD_PEER_TIMEOUT = 3000;      // 心跳无响应的最短判定时间
+const int DEAD_PEER_RTO_MULTIPLIER = 4;      // 心跳超过 4 个 RTO 没有响应判定为失联
+const int MAX_OUTSTANDING_PROBES = 8;        // 最多记录的未响应心跳数
+const int RESUME_TIMEOUT = 5000;             // 等待 RESUME 响应的时间
 const int INITIAL_RECONNECT_DELAY = 1000;    // 首次重连延迟 1 秒
+const int FAILOVER_RECONNECT_DELAY = 100;    // 有备用地址时首次重连几乎立即进行
 const int MAX_RECONNECT_DELAY = 60000;       // 最大重连延迟 60 秒
 const int MAX_RECONNECT_ATTEMPTS = 10;       // 最大重连尝试次数
 const int CONNECTION_ATTEMPT_TIMEOUT = 10000; // 10秒连接超时
 
-ChatClient::ChatClient(QObject* parent) : QObject(parent),
-    socket(new QTcpSocket(this)),
+// 正在发送的消息在本地分配的追踪 id, 放进出站帧由服务器转发给接收方; 没有时返回 0
+static quint64 outboundTraceId()
+{
+    quint64 id = Trace::currentId();
+    return Trace::isLocalId(id) ? id : 0;
+}
+
+static QJsonObject withTraceId(QJsonObject message)
+{
+    // 64 位的 id 超出 JSON 数字的精度, 写成字符串
+    if (quint64 id = outboundTraceId()) message["traceId"] = QString::number(id);
+    return message;
+}
+
+ChatClient::ChatClient(QObject* parent) : ChatClient(UserInfo::instance(), parent)
+{
+}
+
+ChatClient::ChatClient(UserInfo& userInfo, QObject* parent) : QObject(parent),
+    m_userInfo(userInfo),
+    socket(nullptr),
+    endpointRacer(new EndpointRacer(this)),
+    pacer(new SendPacer(this)),
+    outbound(new OutboundQueue(this)),
     heartbeatTimer(new QTimer(this)),
     reconnectTimer(new QTimer(this)),
-    messageProcessor(new MessageProcessor(this)),
-    serverHeartbeatTimeoutTimer(new QTimer(this)),
+    messageProcessor(new MessageProcessor(userInfo, this)),
     reconnectAttempts(0),
     currentReconnectDelay(INITIAL_RECONNECT_DELAY),
     m_connectionState(ConnectionState::Disconnected), // 确保初始状态正确
@@ -44,6 +76,8 @@ ChatClient::ChatClient(QObject* parent) : QObject(parent),
         [this](const QString& username, const QString& nickname, const QString& token)
         {
             this->currentToken = token;
+            this->resumeToken.clear();
+            MetricsRegistry::instance().counter("connection.logins").add();
 
             startHeartbeats();                               // 启动心跳和服务器心跳超时检测
             setConnectionState(ConnectionState::Connected);  // 登录成功才认为是真正“连接”并可交互
@@ -64,13 +98,66 @@ ChatClient::ChatClient(QObject* parent) : QObject(parent),
     connect(messageProcessor, &MessageProcessor::someoneLogin, this, &ChatClient::someoneLogin);
     connect(messageProcessor, &MessageProcessor::someoneLogout, this, &ChatClient::someoneLogout);
     connect(messageProcessor, &MessageProcessor::errorOccurred, this, &ChatClient::errorOccurred); // 业务层错误
+    connect(messageProcessor, &MessageProcessor::heartbeatAcknowledged, this,
+            &ChatClient::handleHeartbeatAck);
+    connect(messageProcessor, &MessageProcessor::capabilitiesAccepted, this,
+            [this](const QJsonObject& capabilities)
+            {
+                frameCodec.applyCapabilities(capabilities);
+                // 服务器公布的发送限制: {"rateLimit": {"messagesPerSecond": 10, "burst": 20}}
+                QJsonObject rateLimit = capabilities["rateLimit"].toObject();
+                if (!rateLimit.isEmpty())
+                {
+                    pacer->setRate(rateLimit["messagesPerSecond"].toDouble(pacer->rate()),
+                                   rateLimit["burst"].toInt(pacer->burst()));
+                }
+                qCDebug(lcNet) << "Transport capabilities accepted:" << capabilities;
+            });
 
-    // QTcpSocket 信号连接
-    connect(socket, &QTcpSocket::connected, this, &ChatClient::handleSocketConnected);
-    connect(socket, &QTcpSocket::disconnected, this, &ChatClient::handleSocketDisconnected);
-    connect(socket, &QTcpSocket::readyRead, this, &ChatClient::handleSocketRead);
-    connect(socket, &QAbstractSocket::errorOccurred, this, &ChatClient::handleSocketError);
-    connect(socket, &QTcpSocket::stateChanged, this, &ChatClient::onSocketStateChanged);
+    // 会话恢复
+    connect(messageProcessor, &MessageProcessor::resumeSucceeded, this,
+            [this]()
+            {
+                currentToken = resumeToken;
+                resumeToken.clear();
+                MetricsRegistry::instance().counter("connection.resumes").add();
+                m_userInfo.setOnline(true);
+                startHeartbeats();
+                setConnectionState(ConnectionState::Connected);
+                emit sessionResumed();
+            });
+    connect(messageProcessor, &MessageProcessor::resumeFailed, this,
+            [this](const QString& reason)
+            {
+                qCWarning(lcNet) << "Session resume failed:" << reason;
+                MetricsRegistry::instance().counter("connection.resume_failures").add();
+                clearResumeState();
+                m_userInfo.clear();
+                emit sessionResumeFailed(reason);
+            });
+
+    // QTcpSocket 信号连接, 未连接时也保留一个空闲的 socket, 状态查询不需要判空
+    attachSocket(new QTcpSocket(this));
+    connect(endpointRacer, &EndpointRacer::connected, this, &ChatClient::handleEndpointConnected);
+    connect(endpointRacer, &EndpointRacer::failed, this, &ChatClient::handleEndpointRaceFailed);
+    connect(pacer, &SendPacer::frameReady, this,
+            [this](const QByteArray& frame)
+            {
+                if (socket->state() == QAbstractSocket::ConnectedState)
+                    writeFrame(frame, OutboundQueue::priorityFor(QString(), frame.size()));
+                else
+                    reportNotConnected("paced");
+            });
+    connect(outbound, &OutboundQueue::frameWritten, this,
+            [this](qint64 bytes)
+            {
+                static MetricCounter& bytesOut =
+                    MetricsRegistry::instance().counter("socket.bytes_out");
+                bytesOut.add(bytes);
+                lastSentMs = activityClock.elapsed();
+            });
+    connect(outbound, &OutboundQueue::writeFailed, this,
+            [this](const QString& error) { emit errorOccurred("发送数据失败：" + error); });
 
     // 事件总线信号连接
     connect(GlobalEventBus::instance(), &GlobalEventBus::sendGroupMessage, this,
@@ -79,10 +166,10 @@ ChatClient::ChatClient(QObject* parent) : QObject(parent),
             &ChatClient::sendGroupTask);
 
     // 定时器信号连接
-    connect(heartbeatTimer, &QTimer::timeout, this, &ChatClient::sendHeartbeat);
+    heartbeatTimer->setTimerType(Qt::CoarseTimer);
+    connect(heartbeatTimer, &QTimer::timeout, this, &ChatClient::onHeartbeatTick);
     connect(reconnectTimer, &QTimer::timeout, this, &ChatClient::tryReconnect);
-    connect(serverHeartbeatTimeoutTimer, &QTimer::timeout, this,
-            &ChatClient::handleServerHeartbeatTimeout);
+    activityClock.start();
 
     // 新增连接超时处理槽函数
     connect(connectionAttemptTimer, &QTimer::timeout, this, &ChatClient::handleConnectionAttemptTimeout);
@@ -92,8 +179,9 @@ ChatClient::ChatClient(QObject* parent) : QObject(parent),
 ChatClient::~ChatClient()
 {
     stopAllNetworkActivity(); // 停止所有定时器和 socket 活动
+    stopCapture();
     // QObject 的父子关系会处理子对象的释放，但显式停止定时器是良好实践
-    qDebug() << "ChatClient destroyed.";
+    qCDebug(lcNet) << "ChatClient destroyed.";
 }
 
 // 修改 setConnectionState，添加 message 参数以提供更详细的日志和信号信息
@@ -106,7 +194,7 @@ void ChatClient::setConnectionState(ConnectionState newState) // 接口不变，
     if (m_connectionState == newState) return;
 
     m_connectionState = newState;
-    qDebug() << "ChatClient State Changed: " << msg;
+    qCDebug(lcNet) << "ChatClient State Changed: " << msg;
     emit connectionStateChanged(m_connectionState);
 
     // 兼容旧的信号，可以逐步移除这些兼容性信号
@@ -132,6 +220,11 @@ void ChatClient::setConnectionState(ConnectionState newState) // 接口不变，
 
 void ChatClient::connectToServer(const QString& host, quint16 port)
 {
+    if (m_replaying)
+    {
+        qCDebug(lcNet) << "Replay mode, not connecting to" << host << port;
+        return;
+    }
     this->host = host;
     this->port = port;
 
@@ -143,13 +236,13 @@ void ChatClient::connectToServer(const QString& host, quint16 port)
     if (socket->state() == QAbstractSocket::UnconnectedState)
     {
         setConnectionState(ConnectionState::Connecting);
-        socket->connectToHost(host, port);
+        startEndpointRace();
         connectionAttemptTimer->start(CONNECTION_ATTEMPT_TIMEOUT);
     }
     else
     {
-        qDebug() << "connectToServer: Socket is not in UnconnectedState. Current state:"
-                 << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
+        qCDebug(lcNet) << "connectToServer: Socket is not in UnconnectedState. Current state:"
+                       << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
         // 如果 socket 已经处于其他状态（如 ConnectingState），则不重复调用 connectToHost()
         // 确保 m_connectionState 正确反映了 socket 的意图状态
         if (socket->state() == QAbstractSocket::ConnectingState) {
@@ -168,10 +261,12 @@ void ChatClient::disconnectFromServer(bool disconnect)
 
         // 清理业务相关数据
         currentToken.clear();
-        UserInfo::instance().clear();
+        frameTemplates.clear();
+        clearResumeState();
+        m_userInfo.clear();
         // 即使 socket 已经 Unconnected，也确保设置状态
         setConnectionState(ConnectionState::Disconnected);
-        qDebug() << "ChatClient: Explicit disconnect triggered.";
+        qCDebug(lcNet) << "ChatClient: Explicit disconnect triggered.";
     }
     else
     {
@@ -179,8 +274,9 @@ void ChatClient::disconnectFromServer(bool disconnect)
         // 这种情况下，socket 保持连接，心跳和重连机制也保持活跃
         // 仅仅清空 Token 和 UserInfo
         currentToken.clear();
-        UserInfo::instance().clear();
-        qDebug() << "ChatClient: Persistent content cleared, connection not actively severed.";
+        clearResumeState();
+        m_userInfo.clear();
+        qCDebug(lcNet) << "ChatClient: Persistent content cleared, connection not actively severed.";
     }
 }
 
@@ -188,15 +284,15 @@ void ChatClient::disconnectFromServer(bool disconnect)
 void ChatClient::stopAllNetworkActivity()
 {
     heartbeatTimer->stop();
-    serverHeartbeatTimeoutTimer->stop();
     reconnectTimer->stop();
     connectionAttemptTimer->stop();
     reconnectAttempts = 0; // 重置重连尝试次数
     currentReconnectDelay = INITIAL_RECONNECT_DELAY; // 重置延迟
+    endpointRacer->abort();
 
     if (socket->state() != QAbstractSocket::UnconnectedState) {
         socket->abort(); // 强制中断任何挂起的连接或发送操作，立即让 socket 进入 UnconnectedState
-        qDebug() << "ChatClient: Socket aborted to stop all activity.";
+        qCDebug(lcNet) << "ChatClient: Socket aborted to stop all activity.";
     }
     // 不在这里设置 Disconnected 状态，让 socket 的 disconnected 信号处理或外部调用来设置最终状态
 }
@@ -206,10 +302,11 @@ void ChatClient::login(const QString& username, const QString& password)
 {
     // 只有当 TCP 连接已建立（socket 处于 ConnectedState）时才发送登录请求
     if (socket->state() == QAbstractSocket::ConnectedState) {
-        sendJsonMessage(MessageHandler::createLoginMessage(username, password));
+        sendJsonMessage(MessageHandler::createLoginMessage(username, password,
+                                                           frameCodec.capabilityOffer()));
     } else {
-        qWarning() << "Login failed: Socket not connected. Current state:"
-                   << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
+        qCWarning(lcNet) << "Login failed: Socket not connected. Current state:"
+                         << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
         emit errorOccurred("无法登录，请先连接服务器。");
     }
 }
@@ -221,8 +318,8 @@ void ChatClient::registerUser(const QString& username, const QString& password,
     if (socket->state() == QAbstractSocket::ConnectedState) {
         sendJsonMessage(MessageHandler::createRegisterMessage(username, password, nickname));
     } else {
-        qWarning() << "Register failed: Socket not connected. Current state:"
-                   << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
+        qCWarning(lcNet) << "Register failed: Socket not connected. Current state:"
+                         << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
         emit errorOccurred("无法注册，请先连接服务器。");
     }
 }
@@ -232,12 +329,16 @@ void ChatClient::sendMessage(const QString& content)
     // 只有当业务层状态为 Connected（已登录）且 Token 有效时才发送消息
     if (m_connectionState == ConnectionState::Connected && !currentToken.isEmpty())
     {
-        sendJsonMessage(MessageHandler::createChatMessage(content, currentToken));
+        Trace::Span traceSpan(Trace::Stage::Send, Trace::currentId());
+        sendPaced("chat",
+                  frameCodec.encode(
+                      withTraceId(MessageHandler::createChatMessage(content, frameToken()))),
+                  "CHAT");
     }
     else
     {
-        qWarning() << "Message not sent: Not connected or not logged in. Current state:"
-                   << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
+        qCWarning(lcNet) << "Message not sent: Not connected or not logged in. Current state:"
+                         << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
         emit errorOccurred("消息发送失败：您可能已断开连接或未登录。");
     }
 }
@@ -247,12 +348,26 @@ void ChatClient::sendPrivateMessage(const QString& receiver, const QString& cont
     // 只有当业务层状态为 Connected（已登录）且 Token 有效时才发送消息
     if (m_connectionState == ConnectionState::Connected && !currentToken.isEmpty())
     {
-        sendJsonMessage(MessageHandler::createPrivateChatMessage(receiver, content, currentToken));
+        Trace::Span traceSpan(Trace::Stage::Send, Trace::currentId());
+        if (frameCodec.encoding() == FrameCodec::Encoding::Json && frameCodec.connectionAuth())
+        {
+            // 文本编码时直接拼出整帧, 不经过 QJsonObject, 模板里没有 token 字段
+            QByteArray json;
+            FrameTemplates::appendPrivateChat(json, receiver, content, outboundTraceId());
+            sendPaced("private:" + receiver, frameCodec.encodeJsonText(json), "PRIVATE_CHAT");
+        }
+        else
+        {
+            sendPaced("private:" + receiver,
+                      frameCodec.encode(withTraceId(MessageHandler::createPrivateChatMessage(
+                          receiver, content, frameToken()))),
+                      "PRIVATE_CHAT");
+        }
     }
     else
     {
-        qWarning() << "Private message not sent: Not connected or not logged in. Current state:"
-                   << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
+        qCWarning(lcNet) << "Private message not sent: Not connected or not logged in. Current state:"
+                         << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
         emit errorOccurred("私聊消息发送失败：您可能已断开连接或未登录。");
     }
 }
@@ -262,30 +377,52 @@ void ChatClient::sendGroupMessage(long groupId, const QString& content)
     // 只有当业务层状态为 Connected（已登录）且 Token 有效时才发送消息
     if (m_connectionState == ConnectionState::Connected && !currentToken.isEmpty())
     {
-        sendJsonMessage(MessageHandler::createGroupChatMessage(
-            UserInfo::instance().userId(), UserInfo::instance().username(),
-            UserInfo::instance().nickname(), groupId, content, currentToken));
+        Trace::Span traceSpan(Trace::Stage::Send, Trace::currentId());
+        const UserInfo& user = m_userInfo;
+        if (frameCodec.encoding() == FrameCodec::Encoding::Json && frameCodec.connectionAuth())
+        {
+            // 身份字段已经预先编码在模板里, 只需要追加 groupId 和 content
+            QByteArray json;
+            frameTemplates.appendGroupChat(json, user.userId(), user.usernameId(),
+                                           user.nicknameId(), groupId, content,
+                                           outboundTraceId());
+            sendPaced(QString("group:%1").arg(groupId), frameCodec.encodeJsonText(json),
+                      "GROUP_CHAT");
+        }
+        else
+        {
+            sendPaced(QString("group:%1").arg(groupId),
+                      frameCodec.encode(withTraceId(
+                          MessageHandler::createGroupChatMessage(user.userId(), user.username(),
+                                                                 user.nickname(), groupId,
+                                                                 content, frameToken()))),
+                      "GROUP_CHAT");
+        }
     }
     else
     {
-        qWarning() << "Group message not sent: Not connected or not logged in. Current state:"
-                   << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
+        qCWarning(lcNet) << "Group message not sent: Not connected or not logged in. Current state:"
+                         << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
         emit errorOccurred("群聊消息发送失败：您可能已断开连接或未登录。");
     }
 }
 
-void ChatClient::sendGroupTask(GroupTask* task)
+void ChatClient::sendGroupTask(const GroupTask& task)
 {
     // 只有当业务层状态为 Connected（已登录）且 Token 有效时才发送任务
     if (m_connectionState == ConnectionState::Connected && !currentToken.isEmpty())
     {
-        messageProcessor->insert(task->getOperationId(), task);
-        sendJsonMessage(MessageHandler::createGroupTask(task));
+        if (!messageProcessor->trackGroupTask(task))
+        {
+            emit errorOccurred("任务发送失败：等待响应的操作过多，请稍后再试。");
+            return;
+        }
+        sendJsonMessage(MessageHandler::createGroupTask(task, frameToken()));
     }
     else
     {
-        qWarning() << "Group task not sent: Not connected or not logged in. Current state:"
-                   << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
+        qCWarning(lcNet) << "Group task not sent: Not connected or not logged in. Current state:"
+                         << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
         emit errorOccurred("任务发送失败：您可能已断开连接或未登录。");
     }
 }
@@ -293,29 +430,53 @@ void ChatClient::sendGroupTask(GroupTask* task)
 void ChatClient::handleSocketConnected()
 {
     connectionAttemptTimer->stop(); // 停止连接超时检测
-    qDebug() << "Connected to server.";
+    qCDebug(lcNet) << "Connected to server.";
     
     // 重置重连参数
     resetReconnectLogic();
+
+    // 之前是异常断开的, 先尝试用原来的 token 恢复会话
+    if (!resumeToken.isEmpty())
+    {
+        beginSessionResume();
+    }
     
     // 如果之前是重连状态，现在连接成功，更新状态为已连接
     if (m_connectionState == ConnectionState::Reconnecting) {
         // 注意：这里不直接设置为 Connected，因为需要等待登录成功
         // 实际连接状态将在登录成功后由 loginSuccess 槽函数更新
-        qDebug() << "Reconnected to server, waiting for login...";
+        qCDebug(lcNet) << "Reconnected to server, waiting for login...";
     }
 }
 
 void ChatClient::handleSocketDisconnected()
 {
-    qDebug() << "Socket disconnected.";
+    qCDebug(lcNet) << "Socket disconnected.";
+    MetricsRegistry::instance().counter("connection.disconnects").add();
     stopHeartbeats(); // 连接断开，停止心跳
+    frameCodec.reset();
+    // 排队的消息是按这个连接的编码生成的, 不能在新连接上发送
+    int dropped = pacer->clear() + outbound->clear();
+    if (dropped > 0 && !m_isUserLoggingOut) {
+        emit errorOccurred(QString("连接断开，%1 条排队中的消息未能发送。").arg(dropped));
+    }
+    // 已经发出、等待响应的群组操作也不会在新连接上得到响应
+    if (m_isUserLoggingOut)
+        messageProcessor->pendingRequests()->clear();
+    else
+        messageProcessor->failPendingRequests("连接已断开");
     connectionAttemptTimer->stop(); // 断开连接，停止连接尝试超时定时器
     // 如果是用户主动登出，不触发重连，并重置标志位
     if (m_isUserLoggingOut) {
         setConnectionState(ConnectionState::Disconnected);
         m_isUserLoggingOut = false; // 重置标志
-        qDebug() << "Disconnected due to user logout, no reconnect initiated.";
+        qCDebug(lcNet) << "Disconnected due to user logout, no reconnect initiated.";
+        return;
+    }
+    // 回放时 beginReplay 已经关闭了 socket, 回放的是抓包里的连接, 不需要重连
+    if (m_replaying) {
+        setConnectionState(ConnectionState::Disconnected);
+        qCDebug(lcNet) << "Disconnected in replay mode, no reconnect initiated.";
         return;
     }
 
@@ -334,9 +495,22 @@ void ChatClient::handleSocketDisconnected()
         setConnectionState(ConnectionState::Disconnected);
     }
 
-    // 清理 Token 和 UserInfo，无论是否重连，这些都应该被清除
+    // 异常断开时保留 token 和用户身份, 重连后尝试恢复会话, 只标记为离线
+    // 恢复中途再次断开时 resumeToken 已经保存过了
+    messageProcessor->cancelResume();
+    if (!currentToken.isEmpty())
+    {
+        resumeToken = currentToken;
+    }
     currentToken.clear();
-    UserInfo::instance().clear();
+    if (!resumeToken.isEmpty())
+    {
+        m_userInfo.setOnline(false);
+    }
+    else
+    {
+        m_userInfo.clear();
+    }
 }
 
 void ChatClient::handleSocketError(QAbstractSocket::SocketError socketError)
@@ -344,11 +518,11 @@ void ChatClient::handleSocketError(QAbstractSocket::SocketError socketError)
 
     connectionAttemptTimer->stop(); // 断开连接，停止连接尝试超时定时器
     QString errorMessage = socket->errorString();
-    qWarning() << "Socket Error: " << errorMessage << " (" << socketError << ")";
+    qCWarning(lcNet) << "Socket Error: " << errorMessage << " (" << socketError << ")";
 
     // 如果是用户主动登出导致，不触发重连和错误状态，因为断开是预期行为
     if (m_isUserLoggingOut) {
-        qDebug() << "Socket error during user logout, ignoring automatic reconnect.";
+        qCDebug(lcNet) << "Socket error during user logout, ignoring automatic reconnect.";
         return;
     }
 
@@ -369,6 +543,7 @@ void ChatClient::handleSocketError(QAbstractSocket::SocketError socketError)
     else
     {
         // 其他类型的错误，可能需要用户干预，不触发重连
+        clearResumeState();  // 不会再重连, 之后只能重新登录
         setConnectionState(ConnectionState::Error);
         emit errorOccurred("连接错误：" + errorMessage); // 报告给UI业务层错误
         emit connectionError("网络连接出现非预期错误：" + errorMessage); // 报告给UI连接层错误
@@ -404,7 +579,7 @@ void ChatClient::onSocketStateChanged(QAbstractSocket::SocketState socketState)
             if (m_connectionState == ConnectionState::Connecting || m_connectionState == ConnectionState::Reconnecting) {
                 setConnectionState(ConnectionState::Connected); // 设置为已连接状态
                 resetReconnectLogic(); // 重置重连逻辑，停止重连定时器，重置尝试次数和延迟
-                qDebug() << "Socket connected, resetting reconnect logic.";
+                qCDebug(lcNet) << "Socket connected, resetting reconnect logic.";
             }
         break;
         case QAbstractSocket::BoundState:
@@ -418,44 +593,141 @@ void ChatClient::onSocketStateChanged(QAbstractSocket::SocketState socketState)
         case QAbstractSocket::ListeningState:
             break;
     }
-    qDebug() << "Socket State Changed: " << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socketState);
+    qCDebug(lcNet) << "Socket State Changed: "
+                   << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socketState);
 }
 
 void ChatClient::handleSocketRead()
 {
-    while (socket->canReadLine())
-    {
-        QByteArray data = socket->readLine().trimmed();
-        QJsonDocument doc = QJsonDocument::fromJson(data);
+    // 收到任何数据都表示服务器活跃, 只记录时间戳, 由心跳定时器统一检查
+    lastReceivedMs = activityClock.elapsed();
+
+    static MetricCounter& bytesIn = MetricsRegistry::instance().counter("socket.bytes_in");
 
-        if (doc.isNull() || !doc.isObject())
+    // 追踪: 这一批数据的读取时间记到其中每条消息上, 消息的 id 要解析之后才知道
+    const bool tracing = Trace::isEnabled();
+    qint64 readStart = tracing ? Trace::now() : 0;
+    QByteArray data = socket->readAll();
+    bytesIn.add(data.size());
+    frameCodec.append(data);
+    qint64 readEnd = tracing ? Trace::now() : 0;
+    processInbound(readStart, readEnd);
+}
+
+void ChatClient::processInbound(qint64 readStart, qint64 readEnd)
+{
+    static MetricHistogram& parseTime = MetricsRegistry::instance().histogram("frame.parse_ns");
+
+    const bool tracing = Trace::isEnabled();
+    QJsonObject message;
+    QString error;
+    while (true)
+    {
+        qint64 parseStart = Trace::now();
+        FrameCodec::DecodeResult result = frameCodec.decodeNext(message, error);
+        qint64 parseEnd = Trace::now();
+        if (result == FrameCodec::DecodeResult::NeedMore)
+        {
+            break;
+        }
+        if (result == FrameCodec::DecodeResult::Corrupt)
+        {
+            // 之后的数据都无法解析, 断开后由重连逻辑建立新的连接
+            qCWarning(lcNet) << "Inbound stream corrupted:" << error;
+            if (m_replaying)
+                frameCodec.reset();
+            else
+                socket->abort();
+            break;
+        }
+        if (capture.isOpen())
+        {
+            capture.record(TrafficCapture::Direction::Inbound, frameCodec.lastFrame());
+        }
+        if (result == FrameCodec::DecodeResult::Error)
         {
-            emit errorOccurred("无效的 JSON 格式或非对象消息");
+            emit errorOccurred(error);
             continue;
         }
-
-        // 收到任何消息都表示服务器活跃，重置服务器心跳超时定时器
-        // serverHeartbeatTimeoutTimer->start(SERVER_HEARTBEAT_TIMEOUT);
-        startHeartbeats(); // 包含了上面那条
-        messageProcessor->processMessage(doc.object());
+        parseTime.record(parseEnd - parseStart);
+        quint64 traceId = 0;
+        if (tracing)
+        {
+            traceId = message["messageId"].toVariant().toULongLong();
+            // 发送方带来的追踪 id, 之后的记录都用它, 两端的追踪文件可以连起来
+            quint64 senderTraceId = message["traceId"].toString().toULongLong();
+            if (Trace::isLocalId(senderTraceId))
+            {
+                Trace::link(senderTraceId, traceId);
+                traceId = senderTraceId;
+            }
+            Trace::record(Trace::Stage::SocketRead, traceId, readStart, readEnd);
+            Trace::record(Trace::Stage::Parse, traceId, parseStart, parseEnd);
+        }
+        Trace::Scope traceScope(traceId);
+        Trace::Span dispatchSpan(Trace::Stage::Dispatch, traceId);
+        // 处理过程中连接可能被重置, 此时缓冲区已清空, 下一次循环返回 NeedMore
+        messageProcessor->processMessage(message);
     }
 }
-// todo 这里的设计需要深思熟虑... 如果非登录状态也要保持连接, 可能不需要发送token?
-// 如果取消登录也取消了连接, 需要在登录/注册按钮中加入socket连接的逻辑...
-// 还是不要token好了...
+
+bool ChatClient::startCapture(const QString& path, QString& error)
+{
+    if (!capture.open(path, error)) return false;
+    qCInfo(lcNet) << "Capturing traffic to" << path;
+    return true;
+}
+
+void ChatClient::stopCapture()
+{
+    if (!capture.isOpen()) return;
+    qCInfo(lcNet) << "Traffic capture closed," << capture.frameCount() << "frames in"
+                  << capture.path();
+    capture.close();
+}
+
+void ChatClient::beginReplay()
+{
+    // 先设置标志, socket 断开时不会再安排重连
+    m_replaying = true;
+    stopAllNetworkActivity();
+    frameCodec.reset();
+}
+
+void ChatClient::replayFrame(const QByteArray& frame)
+{
+    if (!m_replaying) return;
+    static MetricCounter& bytesIn = MetricsRegistry::instance().counter("replay.bytes_in");
+    lastReceivedMs = activityClock.elapsed();
+    bytesIn.add(frame.size());
+
+    const bool tracing = Trace::isEnabled();
+    qint64 readStart = tracing ? Trace::now() : 0;
+    frameCodec.append(frame);
+    processInbound(readStart, readStart);
+}
+// 心跳和其他消息一样, 服务器确认了 connectionAuth 之后不再携带 token
 void ChatClient::sendHeartbeat()
 {
     // 只有当业务层状态为 Connected 时才发送心跳
     // ! change 修改为只有在登陆状态的时候才发送心跳
-    if (m_connectionState == ConnectionState::Connected && UserInfo::instance().online())
+    if (m_connectionState == ConnectionState::Connected && m_userInfo.online())
     {
-        sendJsonMessage(MessageHandler::createHeartbeatMessage(currentToken));
-        qDebug() << "Sent Heartbeat.";
+        qint64 now = activityClock.elapsed();
+        quint32 seq = nextHeartbeatSeq++;
+        outstandingProbes.insert(seq, now);
+        if (firstUnansweredProbeMs < 0) firstUnansweredProbeMs = now;
+        // 服务器不回应的心跳不会一直留在表里, 最早的发送时间单独保存在 firstUnansweredProbeMs
+        while (outstandingProbes.size() > MAX_OUTSTANDING_PROBES)
+        {
+            outstandingProbes.erase(outstandingProbes.begin());
+        }
+        sendJsonMessage(MessageHandler::createHeartbeatMessage(seq, now, frameToken()));
     }
     else
     {
-        qDebug() << "Heartbeat not sent: not in Connected state. Current state:"
-                 << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
+        qCDebug(lcNet) << "Heartbeat not sent: not in Connected state. Current state:"
+                       << QMetaEnum::fromType<ConnectionState>().valueToKey(static_cast<int>(m_connectionState));
         // 如果状态不符合，并且心跳定时器还在运行，停止它. 因为断开连接也要停止心跳
         if (heartbeatTimer->isActive()) {
             stopHeartbeats();
@@ -463,9 +735,94 @@ void ChatClient::sendHeartbeat()
     }
 }
 
+void ChatClient::onHeartbeatTick()
+{
+    if (m_connectionState != ConnectionState::Connected || !m_userInfo.online())
+    {
+        sendHeartbeat();  // 状态不符合时会停止心跳
+        return;
+    }
+
+    publishCodecStats();
+
+    qint64 now = activityClock.elapsed();
+    if (now - lastReceivedMs >= SERVER_HEARTBEAT_TIMEOUT)
+    {
+        handleServerHeartbeatTimeout();
+        return;
+    }
+
+    // 发出心跳之后什么都没有收到, 并且已经超过了由 RTT 推导出的时间
+    // 期间收到过其他数据说明服务器还活着, 只是没有回应心跳
+    if (firstUnansweredProbeMs >= 0)
+    {
+        if (lastReceivedMs < firstUnansweredProbeMs &&
+            now - firstUnansweredProbeMs >= deadPeerTimeoutMs())
+        {
+            handleServerHeartbeatTimeout();
+            return;
+        }
+    }
+
+    // 双向都有流量时不需要心跳: 收到数据说明服务器存活, 发出数据说明自己存活.
+    // 只是接收方向安静时, 已经有心跳在等待响应就不再重复探测, 由上面的失联判定处理;
+    // 发送方向安静时每个间隔仍然发一次, 让服务器知道自己存活
+    bool sendQuiet = now - lastSentMs >= HEARTBEAT_INTERVAL;
+    bool receiveQuiet = now - lastReceivedMs >= HEARTBEAT_INTERVAL;
+    if (sendQuiet || (receiveQuiet && outstandingProbes.isEmpty()))
+    {
+        sendHeartbeat();
+    }
+}
+
+void ChatClient::handleHeartbeatAck(qint64 seq)
+{
+    if (outstandingProbes.isEmpty()) return;
+
+    // 优先按 seq 匹配, 服务器没有带回 seq 时按最早的未响应心跳匹配
+    auto it = outstandingProbes.end();
+    if (seq >= 0) it = outstandingProbes.find(static_cast<quint32>(seq));
+    if (it == outstandingProbes.end()) it = outstandingProbes.begin();
+
+    qint64 sample = activityClock.elapsed() - it.value();
+    // 比它更早的心跳已经不可能得到有意义的响应了
+    outstandingProbes.erase(outstandingProbes.begin(), std::next(it));
+    firstUnansweredProbeMs = outstandingProbes.isEmpty() ? -1 : outstandingProbes.first();
+
+    rtt.addSample(sample);
+    MetricsRegistry::instance().histogram("heartbeat.rtt_ms").record(sample);
+    emit rttUpdated(sample, rtt.srttMs(), rtt.rttvarMs());
+}
+
+qint64 ChatClient::deadPeerTimeoutMs() const
+{
+    // 没有样本时 rtoMs 返回上限, 即原来固定的 45 秒
+    qint64 rto = rtt.rtoMs(MIN_DEAD_PEER_TIMEOUT / DEAD_PEER_RTO_MULTIPLIER,
+                           SERVER_HEARTBEAT_TIMEOUT / DEAD_PEER_RTO_MULTIPLIER);
+    return qBound<qint64>(MIN_DEAD_PEER_TIMEOUT, rto * DEAD_PEER_RTO_MULTIPLIER,
+                          SERVER_HEARTBEAT_TIMEOUT);
+}
+
+void ChatClient::beginSessionResume()
+{
+    qCDebug(lcNet) << "Resuming session, lastMessageId:" << messageProcessor->lastMessageId()
+                   << "lastEventSeq:" << messageProcessor->lastEventSeq();
+    messageProcessor->beginResume(RESUME_TIMEOUT);
+    sendJsonMessage(MessageHandler::createResumeMessage(
+        resumeToken, messageProcessor->lastMessageId(), messageProcessor->lastEventSeq(),
+        frameCodec.capabilityOffer()));
+}
+
+void ChatClient::clearResumeState()
+{
+    resumeToken.clear();
+    messageProcessor->resetResumeState();
+}
+
 void ChatClient::handleServerHeartbeatTimeout()
 {
-    qWarning() << "Server heartbeat timed out. Forcing disconnect to trigger reconnect.";
+    qCWarning(lcNet) << "Server heartbeat timed out. Forcing disconnect to trigger reconnect.";
+    endpointRacer->reportFailure(currentEndpoint);  // 下次重连优先尝试其他地址
     // 服务器长时间无响应，主动断开连接，这将触发 handleSocketDisconnected，进而启动重连
     setConnectionState(ConnectionState::Reconnecting);
     socket->abort(); // 使用 abort() 强制关闭，立即触发 disconnected 信号
@@ -476,7 +833,7 @@ void ChatClient::tryReconnect()
 {
     // 如果用户正在主动登出，停止重连
     if (m_isUserLoggingOut) {
-        qDebug() << "tryReconnect: User is logging out, stopping reconnect attempts.";
+        qCDebug(lcNet) << "tryReconnect: User is logging out, stopping reconnect attempts.";
         resetReconnectLogic();
         return;
     }
@@ -484,23 +841,29 @@ void ChatClient::tryReconnect()
     if (reconnectAttempts < MAX_RECONNECT_ATTEMPTS)
     {
         reconnectAttempts++;
+        MetricsRegistry::instance().counter("connection.reconnect_attempts").add();
         int delay = currentReconnectDelay;
         // 添加随机抖动，避免惊群效应
         delay += QRandomGenerator::global()->bounded(delay / 2); // 随机增加 0 到 delay/2 的时间
 
-        qDebug() << QString("Attempting to reconnect... Attempt %1, next delay %2ms")
-                        .arg(reconnectAttempts)
-                        .arg(delay);
+        qCDebug(lcNet) << QString("Attempting to reconnect... Attempt %1, next delay %2ms")
+                              .arg(reconnectAttempts)
+                              .arg(delay);
 
         currentReconnectDelay = qMin(currentReconnectDelay * 2, MAX_RECONNECT_DELAY); // 指数退避
 
         // 确保 socket 处于 UnconnectedState 才进行连接尝试
         QAbstractSocket::SocketState currentSocketState = socket->state();
-        if (currentSocketState == QAbstractSocket::UnconnectedState)
+        if (endpointRacer->isRunning())
+        {
+            // 上一轮连接还在进行, 等它的结果
+            qCDebug(lcNet) << "tryReconnect: Endpoint race still in progress, waiting for next retry.";
+        }
+        else if (currentSocketState == QAbstractSocket::UnconnectedState)
         {
             setConnectionState(ConnectionState::Reconnecting); // 设置为重连状态
-            qDebug()<<"debug: ChatClient::tryReconnect() " << host << "" <<port;
-            socket->connectToHost(host, port);
+            qCDebug(lcNet) << "debug: ChatClient::tryReconnect() " << host << "" <<port;
+            startEndpointRace();
             // 启动连接超时检测
             connectionAttemptTimer->start(CONNECTION_ATTEMPT_TIMEOUT);
         }
@@ -508,14 +871,16 @@ void ChatClient::tryReconnect()
                  currentSocketState == QAbstractSocket::ConnectingState)
         {
             // 如果 socket 正在关闭或连接中，等待其状态变化，不立即尝试连接
-            qDebug() << "tryReconnect: Socket is in" << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(currentSocketState) << "state, waiting for next retry.";
+            qCDebug(lcNet) << "tryReconnect: Socket is in"
+                           << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(currentSocketState) << "state, waiting for next retry.";
             // 在这种情况下，定时器会继续运行，并在下一个超时周期再次调用 tryReconnect
         }
         else
         {
             // 对于 ConnectedState, BoundState, ListeningState（不应在重连时出现）
             // 强制 abort() 以清理状态，使其回到 UnconnectedState
-            qDebug() << "tryReconnect: Socket in unexpected state (" << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(currentSocketState) << "), aborting to clear.";
+            qCDebug(lcNet) << "tryReconnect: Socket in unexpected state ("
+                           << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(currentSocketState) << "), aborting to clear.";
             socket->abort(); // 强制清理，希望下次 tryReconnect 时能变为 UnconnectedState
             // 此时不设置状态，等待 onSocketStateChanged 或 handleSocketDisconnected 来更新
         }
@@ -525,8 +890,9 @@ void ChatClient::tryReconnect()
     }
     else
     {
-        qWarning() << "Max reconnect attempts reached. Unable to reconnect.";
+        qCWarning(lcNet) << "Max reconnect attempts reached. Unable to reconnect.";
         reconnectTimer->stop();
+        clearResumeState();  // 之后只能重新登录
         setConnectionState(ConnectionState::Error); // 最终状态：错误，无法重连
         emit errorOccurred("无法重新连接到服务器，请检查网络或稍后重试。"); // 业务层错误
         emit connectionError("无法重新连接到服务器，请检查网络或稍后重试。"); // 连接层错误
@@ -536,21 +902,24 @@ void ChatClient::tryReconnect()
 void ChatClient::scheduleReconnect()
 {
     // 只有当重连定时器未激活，并且不是用户正在主动登出时才调度重连
+    if (m_replaying) return;
     if (!reconnectTimer->isActive() && !m_isUserLoggingOut)
     {
         // 确保 socket 状态适合调度重连，例如，不是处于 Connected 状态
         if (socket->state() != QAbstractSocket::ConnectedState) {
             resetReconnectLogic(); // 首次重连时重置参数
             // tryReconnect();        // 立即尝试第一次重连
-            reconnectTimer->start(INITIAL_RECONNECT_DELAY);
+            // 有备用地址时失联的地址健康分已经降低, 其他地址会先被尝试, 不需要等待
+            bool hasAlternates = ConfigManager::instance().tcpEndpoints().size() > 1;
+            reconnectTimer->start(hasAlternates ? FAILOVER_RECONNECT_DELAY : INITIAL_RECONNECT_DELAY);
         } else {
-            qDebug() << "scheduleReconnect: Socket is already Connected, not scheduling reconnect.";
+            qCDebug(lcNet) << "scheduleReconnect: Socket is already Connected, not scheduling reconnect.";
         }
     }
     else if (reconnectTimer->isActive()) {
-        qDebug() << "scheduleReconnect: Reconnect already scheduled/active.";
+        qCDebug(lcNet) << "scheduleReconnect: Reconnect already scheduled/active.";
     } else if (m_isUserLoggingOut) {
-        qDebug() << "scheduleReconnect: User is logging out, not scheduling reconnect.";
+        qCDebug(lcNet) << "scheduleReconnect: User is logging out, not scheduling reconnect.";
     }
 }
 
@@ -559,65 +928,181 @@ void ChatClient::resetReconnectLogic()
     reconnectAttempts = 0;
     currentReconnectDelay = INITIAL_RECONNECT_DELAY;
     reconnectTimer->stop(); // 确保停止定时器
-    qDebug() << "Reconnect logic reset and timer stopped.";
+    qCDebug(lcNet) << "Reconnect logic reset and timer stopped.";
 }
 
 void ChatClient::startHeartbeats()
 {
+    // 回放时没有真正的连接, 心跳超时会触发重连
+    if (m_replaying) return;
+    // 登录成功时调用, 此时刚收到登录响应, 超时从现在开始计算
+    lastReceivedMs = activityClock.elapsed();
+    outstandingProbes.clear();
+    firstUnansweredProbeMs = -1;
     if (!heartbeatTimer->isActive())
     {
-        heartbeatTimer->start(HEARTBEAT_INTERVAL);
-        qDebug() << "Heartbeat timer started.";
+        heartbeatTimer->start(HEARTBEAT_CHECK_INTERVAL);
+        qCDebug(lcNet) << "Heartbeat timer started.";
     }
-    // 每次启动心跳或收到消息时，重置服务器心跳超时计时
-    serverHeartbeatTimeoutTimer->stop(); // 先停止确保重置
-    serverHeartbeatTimeoutTimer->start(SERVER_HEARTBEAT_TIMEOUT);
-    qDebug() << "Server heartbeat timeout timer reset.";
 }
 
 void ChatClient::stopHeartbeats()
 {
     heartbeatTimer->stop();
-    serverHeartbeatTimeoutTimer->stop();
-    qDebug() << "Heartbeats stopped.";
+    outstandingProbes.clear();
+    firstUnansweredProbeMs = -1;
+    qCDebug(lcNet) << "Heartbeats stopped.";
 }
 
 void ChatClient::sendJsonMessage(const QJsonObject& message)
 {
     // 在发送消息前，再次检查 socket 状态。
     // 这里判断 ConnectedState 更为准确，因为只有建立了 TCP 连接才能发送。
+    QString type = message["type"].toString();
     if (socket->state() == QAbstractSocket::ConnectedState) {
-        QJsonDocument doc(message);
-        QByteArray data = doc.toJson(QJsonDocument::Compact) + "\n";
-        qint64 bytesWritten = socket->write(data);
-        if (bytesWritten == -1) {
-            qWarning() << "Failed to write to socket:" << socket->errorString();
-            emit errorOccurred("发送数据失败：" + socket->errorString());
-        }
-        // socket->flush(); // QTcpSocket通常会自动刷新
+        countOutboundFrame(type);
+        QByteArray frame = frameCodec.encode(message);
+        writeFrame(frame, OutboundQueue::priorityFor(type, frame.size()));
     } else {
-        qWarning() << "Attempted to send message while socket is not connected. Message type:"
-                   << message["type"].toString() << ", Current socket state:"
-                   << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
-        // 发送一个连接层错误信号
-        emit connectionError("无法发送消息：网络未连接或状态异常。");
+        reportNotConnected(type);
+    }
+}
+
+void ChatClient::sendPaced(const QString& conversation, const QByteArray& frame,
+                           const QString& type)
+{
+    if (socket->state() == QAbstractSocket::ConnectedState) {
+        countOutboundFrame(type);
+        pacer->enqueue(conversation, frame);
+    } else {
+        reportNotConnected(type);
+    }
+}
+
+void ChatClient::writeFrame(const QByteArray& frame, OutboundQueue::Priority priority)
+{
+    if (capture.isOpen()) capture.record(TrafficCapture::Direction::Outbound, frame);
+    // 写缓冲区没有积压时直接写入 socket, 否则按优先级排队, 写入成功后更新 lastSentMs
+    outbound->enqueue(priority, frame);
+}
+
+void ChatClient::countOutboundFrame(const QString& type)
+{
+    MetricCounter*& counter = outboundFrameCounters[type];
+    if (!counter) counter = &MetricsRegistry::instance().counter("frames.out." + type);
+    counter->add();
+}
+
+void ChatClient::publishCodecStats()
+{
+    // 指标只有整数, 压缩率按百分比 (350 表示压缩到 1/3.5), 耗时按每 MB 微秒记录
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    static MetricGauge& ratioOut = metrics.gauge("codec.compression_ratio_out_pct");
+    static MetricGauge& ratioIn = metrics.gauge("codec.compression_ratio_in_pct");
+    static MetricGauge& encodeCost = metrics.gauge("codec.encode_us_per_mb");
+    static MetricGauge& decodeCost = metrics.gauge("codec.decode_us_per_mb");
+    const FrameCodec::Stats& stats = frameCodec.stats();
+    ratioOut.set(qRound64(stats.compressionRatioOut() * 100));
+    ratioIn.set(qRound64(stats.compressionRatioIn() * 100));
+    encodeCost.set(qRound64(stats.encodeMsPerMB() * 1000));
+    decodeCost.set(qRound64(stats.decodeMsPerMB() * 1000));
+}
+
+QString ChatClient::frameToken() const
+{
+    return frameCodec.connectionAuth() ? QString() : currentToken;
+}
+
+void ChatClient::reportNotConnected(const QString& type)
+{
+    if (m_replaying)
+    {
+        // 回放时没有连接, 界面上的操作产生的出站帧直接丢弃
+        qCDebug(lcNet) << "Replay mode, outbound frame dropped:" << type;
+        return;
     }
+    qCWarning(lcNet) << "Attempted to send message while socket is not connected. Message type:"
+                     << type << ", Current socket state:"
+                     << QMetaEnum::fromType<QAbstractSocket::SocketState>().valueToKey(socket->state());
+    // 发送一个连接层错误信号
+    emit connectionError("无法发送消息：网络未连接或状态异常。");
 }
 
 
 // private slots:
 void ChatClient::handleConnectionAttemptTimeout()
 {
-    qWarning() << "连接服务器超时。";
+    qCWarning(lcNet) << "连接服务器超时。";
     connectionAttemptTimer->stop(); // 停止定时器
 
-    // 强制断开socket，这会触发 handleSocketDisconnected 和 handleSocketError
-    // 从而进入重连逻辑（如果不是用户主动断开）或错误状态
-    if (socket->state() == QAbstractSocket::ConnectingState) {
-        socket->abort(); // 立即中止连接尝试
+    // 中止所有地址的连接尝试, 不会触发 handleSocketDisconnected 和 handleSocketError
+    if (endpointRacer->isRunning()) {
+        endpointRacer->abort(); // 立即中止连接尝试
+        clearResumeState();  // 不会再重连, 之后只能重新登录
         setConnectionState(ConnectionState::Error); // 设置为错误状态
         emit connectionError("连接服务器超时，请检查网络或重试。"); // 发出更具体的错误信号
         emit errorOccurred("连接服务器超时，请手动重连。"); // 报告给UI业务层错误
         resetReconnectLogic(); // 停止重连尝试，因为是单次手动重连的超时
     }
-}
\ No newline at end of file
+}
+
+void ChatClient::handleEndpointConnected(QTcpSocket* newSocket, const ServerEndpoint& endpoint)
+{
+    currentEndpoint = endpoint;
+    attachSocket(newSocket);
+
+    // 胜出的 socket 在交给我们之前就已经连上了, 按原来的信号顺序补一次状态处理
+    onSocketStateChanged(QAbstractSocket::ConnectedState);
+    handleSocketConnected();
+    if (socket->bytesAvailable() > 0)
+    {
+        handleSocketRead();
+    }
+}
+
+void ChatClient::handleEndpointRaceFailed(const QString& error)
+{
+    connectionAttemptTimer->stop();
+    qCWarning(lcNet) << "All endpoints failed:" << error;
+    if (m_isUserLoggingOut) {
+        return;
+    }
+    // 与单个 socket 连接被拒绝时的处理相同
+    setConnectionState(ConnectionState::Error);
+    scheduleReconnect();
+}
+
+void ChatClient::attachSocket(QTcpSocket* newSocket)
+{
+    if (socket && socket != newSocket)
+    {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    socket = newSocket;
+    socket->setParent(this);
+    frameCodec.reset();  // 新的连接从不压缩的 JSON 开始, 登录时重新协商
+    outbound->setSocket(socket);
+
+    connect(socket, &QTcpSocket::connected, this, &ChatClient::handleSocketConnected);
+    connect(socket, &QTcpSocket::disconnected, this, &ChatClient::handleSocketDisconnected);
+    connect(socket, &QTcpSocket::readyRead, this, &ChatClient::handleSocketRead);
+    connect(socket, &QAbstractSocket::errorOccurred, this, &ChatClient::handleSocketError);
+    connect(socket, &QTcpSocket::stateChanged, this, &ChatClient::onSocketStateChanged);
+}
+
+void ChatClient::startEndpointRace()
+{
+    // 调用方指定的地址排在最前, 健康分相同时优先尝试
+    QList<ServerEndpoint> endpoints;
+    endpoints.append({host, port});
+    for (const ServerEndpoint& endpoint : ConfigManager::instance().tcpEndpoints())
+    {
+        if (!endpoints.contains(endpoint))
+        {
+            endpoints.append(endpoint);
+        }
+    }
+    endpointRacer->start(endpoints);
+}
@@ -1,13 +1,27 @@
 #ifndef CHATCLIENT_H
 #define CHATCLIENT_H
 
+#include "EndpointRacer.h"
+#include "FrameCodec.h"
+#include "FrameTemplates.h"
 #include "MessageProcessor.h"
+#include "OutboundQueue.h"
+#include "RttEstimator.h"
+#include "SendPacer.h"
+#include "TrafficCapture.h"
+#include <QHash>
+#include <QMap>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QString>
 #include <QObject>
+#include <QElapsedTimer>
 #include <QTcpSocket>
 #include <QTimer>
+
+class MetricCounter;
+class UserInfo;
+
 class ChatClient : public QObject
 {
     Q_OBJECT
@@ -23,6 +37,8 @@ class ChatClient : public QObject
     };
     Q_ENUM(ConnectionState)  // 关键宏
     explicit ChatClient(QObject* parent = nullptr);
+    // 登录状态保存在 userInfo 中, 一个进程里的多个客户端各用一份; 默认使用 UserInfo::instance()
+    explicit ChatClient(UserInfo& userInfo, QObject* parent = nullptr);
     ~ChatClient();
 
     void connectToServer(const QString& host, quint16 port);
@@ -35,14 +51,39 @@ class ChatClient : public QObject
     // void logout(); 直接删除好了, 没用
 
     QString getToken() const { return currentToken; }
+    // 异常断开后保留了 token, 重新连上时会先发 RESUME 而不是等待登录
+    bool canResumeSession() const { return !resumeToken.isEmpty(); }
 
     ConnectionState connectionState() const { return m_connectionState; }
+    // 心跳测得的往返时延, 用于监控
+    const RttEstimator& rttEstimator() const { return rtt; }
+    // 由 RTT 推导出的判定服务器失联的时间
+    qint64 deadPeerTimeoutMs() const;
+    // 不等心跳间隔立即发一次心跳探测, 压测工具用它测量控制帧在拥塞的发送队列中的排队时间
+    void probeNow() { sendHeartbeat(); }
+    // 收发字节数、压缩率和编解码耗时
+    const FrameCodec::Stats& frameStats() const { return frameCodec.stats(); }
+    // 聊天消息的发送速率控制, 可以读取排队深度和排队延迟
+    SendPacer* sendPacer() const { return pacer; }
+    // 按优先级排队的出站帧, 可以读取每个优先级的排队时间
+    const OutboundQueue* outboundQueue() const { return outbound; }
     bool isConnected() const { return m_connectionState == ConnectionState::Connected; }
 
+    // 把之后收发的每一帧写入抓包文件, 见 TrafficCapture
+    bool startCapture(const QString& path, QString& error);
+    void stopCapture();
+    bool isCapturing() const { return capture.isOpen(); }
+
+    // 回放模式: 不连接服务器, 不发心跳, 出站帧直接丢弃;
+    // 入站帧经过与 socket 数据相同的解码、分发路径, 界面的反应和真实连接时一致
+    void beginReplay();
+    bool isReplaying() const { return m_replaying; }
+    void replayFrame(const QByteArray& frame);
+
    public slots:
     // 需要改为公共槽函数
     void sendGroupMessage(long groupId, const QString& content);
-    void sendGroupTask(GroupTask* task);
+    void sendGroupTask(const GroupTask& task);
 
    signals:
     void connected();
@@ -68,29 +109,77 @@ class ChatClient : public QObject
 
     void connectionError(const QString& message);
 
+    // 断线重连后用原来的 token 恢复了会话, 不需要重新登录
+    void sessionResumed();
+    // 恢复失败, 需要回到登录界面
+    void sessionResumeFailed(const QString& reason);
+
+    // 每收到一个心跳响应发出一次
+    void rttUpdated(qint64 sampleMs, double srttMs, double rttvarMs);
+
    private slots:
     void handleSocketConnected();
     void handleSocketDisconnected();
     void handleSocketError(QAbstractSocket::SocketError error);
     void handleSocketRead();
     void sendHeartbeat();
+    void onHeartbeatTick();  // 心跳定时器: 检查服务器是否存活, 需要时发送心跳
+    void handleHeartbeatAck(qint64 seq);
     void tryReconnect();
     void onSocketStateChanged(QAbstractSocket::SocketState socketState);
     void handleConnectionAttemptTimeout();
+    void handleEndpointConnected(QTcpSocket* newSocket, const ServerEndpoint& endpoint);
+    void handleEndpointRaceFailed(const QString& error);
    private:
     void sendJsonMessage(const QJsonObject& message);
-
+    // 聊天消息经过 SendPacer, conversation 用于会话之间的公平轮转
+    void sendPaced(const QString& conversation, const QByteArray& frame, const QString& type);
+    void writeFrame(const QByteArray& frame, OutboundQueue::Priority priority);
+    void reportNotConnected(const QString& type);
+    // 服务器没有确认 connectionAuth 时每条业务消息都要带上的 token, 已确认时为空
+    QString frameToken() const;
+    // 出站帧按类型计数, 计数器缓存起来, 发送时不按名字查找
+    void countOutboundFrame(const QString& type);
+    // 把 frameCodec 的压缩率和编解码耗时写入指标, 随心跳检查每秒一次
+    void publishCodecStats();
+    // 解码 frameCodec 中所有完整的帧并分发, readStart/readEnd 是这批数据的读取时间, 用于追踪
+    void processInbound(qint64 readStart, qint64 readEnd);
+
+    UserInfo& m_userInfo;
     QTcpSocket* socket;
-    QTimer* heartbeatTimer;
+    // 连接时并行尝试所有服务器地址, 胜出的 socket 替换 socket
+    EndpointRacer* endpointRacer;
+    ServerEndpoint currentEndpoint;  // 当前连接使用的地址
+    FrameCodec frameCodec;           // 分帧和压缩, 每个连接重新协商
+    FrameTemplates frameTemplates;   // 文本编码下聊天消息的快速构造
+    TrafficCapture capture;          // 打开时记录收发的每一帧
+    bool m_replaying = false;
+    SendPacer* pacer;
+    OutboundQueue* outbound;         // 控制帧优先于排队中的聊天数据
+    QTimer* heartbeatTimer;  // 唯一的心跳定时器, 粗粒度地检查收发时间戳
     QTimer* reconnectTimer;
 
-    QTimer* serverHeartbeatTimeoutTimer;
+    // 连接活跃度: 收到/发出数据时只更新时间戳, 由 heartbeatTimer 延迟检查
+    QElapsedTimer activityClock;
+    qint64 lastReceivedMs = 0;
+    qint64 lastSentMs = 0;
+
+    // 心跳探测: seq -> 发送时间, 响应到达时得到一个 RTT 样本
+    RttEstimator rtt;
+    quint32 nextHeartbeatSeq = 1;
+    QMap<quint32, qint64> outstandingProbes;
+    QHash<QString, MetricCounter*> outboundFrameCounters;  // frames.out.<type>
+    // 最早一个还没有响应的心跳的发送时间, -1 表示没有; 不随 outstandingProbes 的淘汰丢失,
+    // 失联判定从这里开始计时
+    qint64 firstUnansweredProbeMs = -1;
 
     // 新增, 发起连接超时
     QTimer* connectionAttemptTimer;
 
     MessageProcessor* messageProcessor;
     QString currentToken;
+    // 异常断开时保留的 token, 重连后用于恢复会话
+    QString resumeToken;
     QString host;
     quint16 port;
     int reconnectAttempts = 0;
@@ -102,12 +191,16 @@ class ChatClient : public QObject
     bool m_isUserLoggingOut = false; // Add this private member
 
     // 辅助方法
+    void attachSocket(QTcpSocket* newSocket);  // 接管 socket 并连接它的信号
+    void startEndpointRace();                  // 向 host:port 和备用地址发起连接
     void handleServerHeartbeatTimeout();
+    void beginSessionResume();   // TCP 重连成功后发送 RESUME
+    void clearResumeState();     // 放弃恢复, 之后只能完整登录
     void setConnectionState(ConnectionState newState);
     void scheduleReconnect();    // 封装重连逻辑
     void resetReconnectLogic();  // 重置重连尝试次数和延迟
-    void startHeartbeats();      // 启动心跳定时器和服务器心跳检测定时器
-    void stopHeartbeats();       // 停止所有心跳相关定时器
+    void startHeartbeats();      // 启动心跳定时器, 并把服务器视为刚刚活跃
+    void stopHeartbeats();       // 停止心跳定时器
 };
 
 #endif  // CHATCLIENT_H
\ No newline at end of file
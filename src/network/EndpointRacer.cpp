@@ -0,0 +1,251 @@
+#include "EndpointRacer.h"
+#include "utils/Logging.h"
+#include <QDebug>
+#include <algorithm>
+
+// RFC 8305 建议的连接尝试间隔: 前一个地址 250ms 内没有连上就同时尝试下一个
+const int ATTEMPT_STAGGER = 250;
+// 健康分的平滑系数, 每次结果把分数向 1 或 -1 拉近 30%
+const double HEALTH_SMOOTHING = 0.3;
+
+EndpointRacer::EndpointRacer(QObject* parent) : QObject(parent)
+{
+    m_clock.start();
+    m_staggerTimer.setSingleShot(true);
+    connect(&m_staggerTimer, &QTimer::timeout, this, &EndpointRacer::launchNext);
+}
+
+EndpointRacer::~EndpointRacer()
+{
+    abort();
+}
+
+void EndpointRacer::start(const QList<ServerEndpoint>& endpoints)
+{
+    abort();
+    if (endpoints.isEmpty())
+    {
+        emit failed("没有可用的服务器地址");
+        return;
+    }
+
+    m_running = true;
+    m_lastError.clear();
+    const quint64 round = m_round;
+
+    // IP 地址不需要解析, 可以立即尝试; 域名交给 QHostInfo 异步解析
+    for (const ServerEndpoint& endpoint : orderedByHealth(endpoints))
+    {
+        Target target;
+        target.endpoint = endpoint;
+        QHostAddress literal;
+        if (literal.setAddress(endpoint.host))
+        {
+            target.addresses.append(literal);
+            target.resolved = true;
+        }
+        m_targets.append(target);
+    }
+    for (int i = 0; i < m_targets.size(); ++i)
+    {
+        if (m_targets[i].resolved) continue;
+        ++m_pendingLookups;
+        int lookupId = QHostInfo::lookupHost(m_targets[i].endpoint.host, this,
+                                             [this, round, i](const QHostInfo& info)
+                                             { handleLookup(round, i, info); });
+        if (round == m_round && i < m_targets.size() && !m_targets[i].resolved)
+        {
+            m_targets[i].lookupId = lookupId;
+        }
+    }
+
+    launchNext();
+}
+
+void EndpointRacer::abort()
+{
+    ++m_round;
+    m_staggerTimer.stop();
+    for (const Target& target : m_targets)
+    {
+        if (!target.resolved && target.lookupId >= 0) QHostInfo::abortHostLookup(target.lookupId);
+    }
+    const QList<QTcpSocket*> sockets = m_attempts.keys();
+    m_attempts.clear();
+    for (QTcpSocket* socket : sockets) discardSocket(socket);
+
+    m_targets.clear();
+    m_pendingLookups = 0;
+    m_running = false;
+    m_launchDue = false;
+}
+
+void EndpointRacer::reportFailure(const ServerEndpoint& endpoint)
+{
+    recordFailure(endpoint);
+}
+
+QList<ServerEndpoint> EndpointRacer::orderedByHealth(const QList<ServerEndpoint>& endpoints) const
+{
+    QList<ServerEndpoint> ordered = endpoints;
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [this](const ServerEndpoint& lhs, const ServerEndpoint& rhs)
+                     {
+                         EndpointHealth a = m_health.value(lhs.key());
+                         EndpointHealth b = m_health.value(rhs.key());
+                         if (a.score != b.score) return a.score > b.score;
+                         return a.connectMs < b.connectMs;
+                     });
+    return ordered;
+}
+
+void EndpointRacer::launchNext()
+{
+    if (!m_running) return;
+    m_launchDue = false;
+
+    // targets 已经按健康分排好序, 取第一个还有未尝试地址的
+    for (int i = 0; i < m_targets.size(); ++i)
+    {
+        Target& target = m_targets[i];
+        if (!target.resolved || target.nextAddress >= target.addresses.size()) continue;
+
+        QHostAddress address = target.addresses.at(target.nextAddress++);
+        QTcpSocket* socket = new QTcpSocket(this);
+        connect(socket, &QTcpSocket::connected, this,
+                [this, socket]() { handleAttemptConnected(socket); });
+        connect(socket, &QAbstractSocket::errorOccurred, this,
+                [this, socket](QAbstractSocket::SocketError) { handleAttemptFailed(socket); });
+        m_attempts.insert(socket, {i, address, m_clock.elapsed()});
+
+        qCDebug(lcNet) << "EndpointRacer: connecting to" << target.endpoint.key() << "via"
+                       << address.toString();
+        // 先启动间隔定时器再连接: connectToHost 可能同步报错, 并在里面立即发起下一个
+        m_staggerTimer.start(ATTEMPT_STAGGER);
+        socket->connectToHost(address, target.endpoint.port);
+        return;
+    }
+
+    // 没有可以尝试的地址了, 还有域名在解析时等解析结果
+    if (m_pendingLookups > 0)
+    {
+        m_launchDue = true;
+        return;
+    }
+    finishIfExhausted();
+}
+
+void EndpointRacer::handleLookup(quint64 round, int targetIndex, const QHostInfo& info)
+{
+    if (round != m_round || !m_running || targetIndex >= m_targets.size()) return;
+    Target& target = m_targets[targetIndex];
+    if (target.resolved) return;
+    target.resolved = true;
+    target.lookupId = -1;
+    --m_pendingLookups;
+
+    if (info.error() != QHostInfo::NoError || info.addresses().isEmpty())
+    {
+        m_lastError = QString("%1: %2").arg(target.endpoint.key(), info.errorString());
+        qCWarning(lcNet) << "EndpointRacer: lookup failed for" << target.endpoint.key()
+                         << info.errorString();
+        recordFailure(target.endpoint);
+    }
+    else
+    {
+        // IPv6 与 IPv4 交替, 其中一种协议整体不可用时不会拖慢另一种
+        QList<QHostAddress> ipv6;
+        QList<QHostAddress> ipv4;
+        for (const QHostAddress& address : info.addresses())
+        {
+            if (address.protocol() == QAbstractSocket::IPv6Protocol)
+                ipv6.append(address);
+            else
+                ipv4.append(address);
+        }
+        for (int i = 0; i < qMax(ipv6.size(), ipv4.size()); ++i)
+        {
+            if (i < ipv6.size()) target.addresses.append(ipv6.at(i));
+            if (i < ipv4.size()) target.addresses.append(ipv4.at(i));
+        }
+    }
+
+    // 没有连接在进行, 或者间隔已经到了, 立即尝试; 否则等间隔定时器
+    if (m_launchDue || m_attempts.isEmpty()) launchNext();
+}
+
+void EndpointRacer::handleAttemptConnected(QTcpSocket* socket)
+{
+    auto it = m_attempts.find(socket);
+    if (it == m_attempts.end()) return;
+    Attempt attempt = it.value();
+    m_attempts.erase(it);
+
+    ServerEndpoint endpoint = m_targets.at(attempt.targetIndex).endpoint;
+    qint64 connectMs = m_clock.elapsed() - attempt.startedMs;
+    recordSuccess(endpoint, connectMs);
+    qCDebug(lcNet) << "EndpointRacer:" << endpoint.key() << "via" << attempt.address.toString()
+                   << "connected in" << connectMs << "ms";
+
+    // 交出 socket, 然后中止其余的连接
+    socket->disconnect(this);
+    socket->setParent(nullptr);
+    abort();
+    emit connected(socket, endpoint);
+}
+
+void EndpointRacer::handleAttemptFailed(QTcpSocket* socket)
+{
+    auto it = m_attempts.find(socket);
+    if (it == m_attempts.end()) return;
+    Attempt attempt = it.value();
+    m_attempts.erase(it);
+
+    const ServerEndpoint& endpoint = m_targets.at(attempt.targetIndex).endpoint;
+    m_lastError = QString("%1 (%2): %3")
+                      .arg(endpoint.key(), attempt.address.toString(), socket->errorString());
+    qCWarning(lcNet) << "EndpointRacer: attempt failed," << m_lastError;
+    recordFailure(endpoint);
+    discardSocket(socket);
+
+    // 失败的连接不必等满间隔, 立即尝试下一个地址
+    m_staggerTimer.stop();
+    launchNext();
+}
+
+void EndpointRacer::finishIfExhausted()
+{
+    if (!m_running || !m_attempts.isEmpty() || m_pendingLookups > 0) return;
+    for (const Target& target : m_targets)
+    {
+        if (!target.resolved || target.nextAddress < target.addresses.size()) return;
+    }
+
+    QString error = m_lastError.isEmpty() ? QString("无法连接到任何服务器地址") : m_lastError;
+    abort();
+    emit failed(error);
+}
+
+void EndpointRacer::recordSuccess(const ServerEndpoint& endpoint, qint64 connectMs)
+{
+    EndpointHealth& health = m_health[endpoint.key()];
+    health.score += HEALTH_SMOOTHING * (1.0 - health.score);
+    health.connectMs = health.successes == 0
+                           ? connectMs
+                           : health.connectMs + HEALTH_SMOOTHING * (connectMs - health.connectMs);
+    health.successes++;
+}
+
+void EndpointRacer::recordFailure(const ServerEndpoint& endpoint)
+{
+    EndpointHealth& health = m_health[endpoint.key()];
+    health.score += HEALTH_SMOOTHING * (-1.0 - health.score);
+    health.failures++;
+}
+
+void EndpointRacer::discardSocket(QTcpSocket* socket)
+{
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+}
@@ -0,0 +1,99 @@
+#ifndef ENDPOINTRACER_H
+#define ENDPOINTRACER_H
+
+#include "utils/ConfigManager.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QList>
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QVector>
+
+// 同时向多个服务器地址发起连接 (Happy Eyeballs, RFC 8305)
+// 地址按健康分排序, 依次发起连接, 相邻两次间隔 ATTEMPT_STAGGER;
+// 一个连接失败时立即发起下一个. 第一个连上的 socket 胜出, 其余的全部中止.
+// 域名异步解析, 解析结果中 IPv6 与 IPv4 地址交替排列, 先解析完的地址先尝试.
+class EndpointRacer : public QObject
+{
+    Q_OBJECT
+
+   public:
+    // 每个地址的健康记录, 跨多次连接保留, 决定下一次尝试的顺序
+    struct EndpointHealth
+    {
+        double score = 0.0;      // [-1, 1], 成功趋向 1, 失败趋向 -1
+        double connectMs = 0.0;  // 平滑后的建连耗时
+        quint64 successes = 0;
+        quint64 failures = 0;
+    };
+
+    explicit EndpointRacer(QObject* parent = nullptr);
+    ~EndpointRacer();
+
+    // 开始一轮连接, 正在进行的一轮会先被中止
+    void start(const QList<ServerEndpoint>& endpoints);
+    // 中止当前一轮, 不发出任何信号
+    void abort();
+    bool isRunning() const { return m_running; }
+
+    // 已经建立的连接因为服务器失联而断开时调用, 同样计入健康分
+    void reportFailure(const ServerEndpoint& endpoint);
+    EndpointHealth health(const ServerEndpoint& endpoint) const
+    {
+        return m_health.value(endpoint.key());
+    }
+    // 按健康分从高到低排序, 分数相同时建连更快的在前, 都没有记录时保持配置顺序
+    QList<ServerEndpoint> orderedByHealth(const QList<ServerEndpoint>& endpoints) const;
+
+   signals:
+    // socket 已经处于 ConnectedState, 并且已经脱离 EndpointRacer, 由接收方接管
+    void connected(QTcpSocket* socket, const ServerEndpoint& endpoint);
+    // 所有地址都失败了
+    void failed(const QString& error);
+
+   private slots:
+    void launchNext();
+
+   private:
+    // 一个服务器地址的解析结果
+    struct Target
+    {
+        ServerEndpoint endpoint;
+        QList<QHostAddress> addresses;  // IPv6/IPv4 交替排列
+        int nextAddress = 0;
+        bool resolved = false;
+        int lookupId = -1;
+    };
+
+    struct Attempt
+    {
+        int targetIndex;
+        QHostAddress address;
+        qint64 startedMs;
+    };
+
+    void handleLookup(quint64 round, int targetIndex, const QHostInfo& info);
+    void handleAttemptConnected(QTcpSocket* socket);
+    void handleAttemptFailed(QTcpSocket* socket);
+    void finishIfExhausted();
+    void recordSuccess(const ServerEndpoint& endpoint, qint64 connectMs);
+    void recordFailure(const ServerEndpoint& endpoint);
+    void discardSocket(QTcpSocket* socket);
+
+    QVector<Target> m_targets;
+    QHash<QTcpSocket*, Attempt> m_attempts;
+    QHash<QString, EndpointHealth> m_health;  // key 为 ServerEndpoint::key()
+
+    QTimer m_staggerTimer;
+    QElapsedTimer m_clock;
+    quint64 m_round = 0;  // 丢弃上一轮迟到的解析结果
+    int m_pendingLookups = 0;
+    bool m_running = false;
+    bool m_launchDue = false;  // 间隔已到但没有可用地址, 等解析完成后立即发起
+    QString m_lastError;
+};
+
+#endif  // ENDPOINTRACER_H
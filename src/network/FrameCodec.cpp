@@ -0,0 +1,532 @@
+#include "FrameCodec.h"
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QtEndian>
+#include <iterator>
+
+// 小于阈值的帧 (聊天消息、心跳) 压缩收益很小, 直接发送
+const int DEFAULT_COMPRESSION_THRESHOLD = 1024;
+// zlib 最快的级别: 历史消息、群组信息这类重复度高的数据已经能压缩到几分之一
+const int COMPRESSION_LEVEL = 1;
+// 单帧 (解压后) 的上限, 防止异常数据或解压炸弹占满内存
+const int MAX_FRAME_SIZE = 16 * 1024 * 1024;
+const char COMPRESSED_PREFIX[] = "Z:";
+const char CAPABILITY_DEFLATE[] = "deflate";
+const char CAPABILITY_CBOR[] = "cbor";
+
+// 二进制帧头: 1 字节 flags + 4 字节大端长度
+// flags 只使用低 3 位, 不会与文本帧的第一个字节 ('{' 或 'Z') 和帧之间的空白字符冲突
+const int BINARY_HEADER_SIZE = 5;
+const quint8 BINARY_FLAG_MASK = 0x07;
+const quint8 FLAG_DEFLATE = 0x01;
+const int MAX_CBOR_DEPTH = 32;
+
+// CBOR 中字段名的整数编码, 下标就是线上的值
+// 服务器使用同一张表, 只能在末尾追加, 不能删除或调整顺序
+const char* const WIRE_KEYS[] = {
+    "type",         "content",     "token",        "username",      "nickname",
+    "userId",       "groupId",     "receiver",     "sender",        "status",
+    "errorMessage", "messageId",   "eventSeq",     "seq",           "sentAt",
+    "timestamp",    "password",    "capabilities", "operationId",   "operatorId",
+    "groupName",    "creatorId",   "members",      "history",       "fileUrl",
+    "fileName",     "fileSize",    "taskId",       "replayed",      "lastMessageId",
+    "lastEventSeq", "onlineUsers", "onlineCount",  "avatarUrl",     "role",
+};
+const int TYPE_KEY = 0;
+
+// 顶层 type 字段的整数编码, 规则同上
+const char* const WIRE_TYPES[] = {
+    "LOGIN", "REGISTER", "LOGOUT", "HEARTBEAT", "RESUME", "CHAT", "PRIVATE_CHAT", "GROUP_CHAT",
+    "FILE", "SYSTEM", "ERROR", "ONLINE_USERS", "OFFLINE_USERS", "HISTORY_MESSAGES",
+    "USER_LOGIN", "USER_LOGOUT", "GROUP_INFO", "GROUP_RESPONSE", "GROUP_BROADCAST",
+    "GROUP_CREATE", "GROUP_DELETE", "GROUP_ADD", "GROUP_REMOVE",
+};
+
+static QHash<QString, int> buildWireTable(const char* const* names, int count)
+{
+    QHash<QString, int> table;
+    for (int i = 0; i < count; ++i) table.insert(QString::fromLatin1(names[i]), i);
+    return table;
+}
+
+static const QHash<QString, int>& wireKeyIds()
+{
+    static const QHash<QString, int> ids =
+        buildWireTable(WIRE_KEYS, static_cast<int>(std::size(WIRE_KEYS)));
+    return ids;
+}
+
+static const QHash<QString, int>& wireTypeIds()
+{
+    static const QHash<QString, int> ids =
+        buildWireTable(WIRE_TYPES, static_cast<int>(std::size(WIRE_TYPES)));
+    return ids;
+}
+
+static QString wireName(const char* const* names, qint64 count, qint64 id)
+{
+    // 对方的表比我们新时可能出现不认识的值, 保留为数字字符串而不是丢弃整帧
+    return id >= 0 && id < count ? QString::fromLatin1(names[id]) : QString::number(id);
+}
+
+static void writeCborValue(QCborStreamWriter& writer, const QJsonValue& value);
+
+static void writeCborObject(QCborStreamWriter& writer, const QJsonObject& object, bool topLevel)
+{
+    writer.startMap(object.size());
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it)
+    {
+        int keyId = wireKeyIds().value(it.key(), -1);
+        if (keyId >= 0)
+            writer.append(static_cast<qint64>(keyId));
+        else
+            writer.append(it.key());
+
+        if (topLevel && keyId == TYPE_KEY && it.value().isString())
+        {
+            int typeId = wireTypeIds().value(it.value().toString(), -1);
+            if (typeId >= 0)
+            {
+                writer.append(static_cast<qint64>(typeId));
+                continue;
+            }
+        }
+        writeCborValue(writer, it.value());
+    }
+    writer.endMap();
+}
+
+static void writeCborValue(QCborStreamWriter& writer, const QJsonValue& value)
+{
+    if (value.isObject())
+    {
+        writeCborObject(writer, value.toObject(), false);
+    }
+    else if (value.isArray())
+    {
+        const QJsonArray array = value.toArray();
+        writer.startArray(array.size());
+        for (const QJsonValue& element : array) writeCborValue(writer, element);
+        writer.endArray();
+    }
+    else
+    {
+        // 整数按 CBOR 变长整数写出, 通常只占 1~5 字节
+        QCborValue::fromJsonValue(value).toCbor(writer);
+    }
+}
+
+static QString readCborString(QCborStreamReader& reader, bool& ok)
+{
+    QString result;
+    auto chunk = reader.readString();
+    while (chunk.status == QCborStreamReader::Ok)
+    {
+        result += chunk.data;
+        chunk = reader.readString();
+    }
+    if (chunk.status == QCborStreamReader::Error) ok = false;
+    return result;
+}
+
+static QJsonValue readCborValue(QCborStreamReader& reader, int depth, bool& ok);
+
+static QJsonObject readCborMap(QCborStreamReader& reader, int depth, bool topLevel, bool& ok)
+{
+    QJsonObject object;
+    if (!reader.isMap() || depth > MAX_CBOR_DEPTH || !reader.enterContainer())
+    {
+        ok = false;
+        return object;
+    }
+    while (ok && reader.lastError() == QCborError::NoError && reader.hasNext())
+    {
+        QString key;
+        bool isTypeKey = false;
+        if (reader.isInteger())
+        {
+            qint64 keyId = reader.toInteger();
+            reader.next();
+            key = wireName(WIRE_KEYS, std::size(WIRE_KEYS), keyId);
+            isTypeKey = keyId == TYPE_KEY;
+        }
+        else if (reader.isString())
+        {
+            key = readCborString(reader, ok);
+        }
+        else
+        {
+            ok = false;
+            break;
+        }
+
+        if (topLevel && isTypeKey && reader.isInteger())
+        {
+            qint64 typeId = reader.toInteger();
+            reader.next();
+            object.insert(key, wireName(WIRE_TYPES, std::size(WIRE_TYPES), typeId));
+            continue;
+        }
+        object.insert(key, readCborValue(reader, depth + 1, ok));
+    }
+    if (ok) reader.leaveContainer();
+    return object;
+}
+
+static QJsonValue readCborValue(QCborStreamReader& reader, int depth, bool& ok)
+{
+    switch (reader.type())
+    {
+        case QCborStreamReader::UnsignedInteger:
+        case QCborStreamReader::NegativeInteger:
+        {
+            qint64 value = reader.toInteger();
+            reader.next();
+            return value;
+        }
+        case QCborStreamReader::TextString:
+            return readCborString(reader, ok);
+        case QCborStreamReader::ByteArray:
+        {
+            // 与 QCborValue::toJsonValue 一致, 字节串转为 base64url 字符串
+            QByteArray bytes;
+            auto chunk = reader.readByteArray();
+            while (chunk.status == QCborStreamReader::Ok)
+            {
+                bytes += chunk.data;
+                chunk = reader.readByteArray();
+            }
+            if (chunk.status == QCborStreamReader::Error) ok = false;
+            return QString::fromLatin1(bytes.toBase64(QByteArray::Base64UrlEncoding |
+                                                      QByteArray::OmitTrailingEquals));
+        }
+        case QCborStreamReader::Array:
+        {
+            QJsonArray array;
+            if (depth > MAX_CBOR_DEPTH || !reader.enterContainer())
+            {
+                ok = false;
+                return array;
+            }
+            while (ok && reader.lastError() == QCborError::NoError && reader.hasNext())
+            {
+                array.append(readCborValue(reader, depth + 1, ok));
+            }
+            if (ok) reader.leaveContainer();
+            return array;
+        }
+        case QCborStreamReader::Map:
+            return readCborMap(reader, depth, false, ok);
+        case QCborStreamReader::Tag:
+            reader.next();
+            return readCborValue(reader, depth, ok);
+        case QCborStreamReader::SimpleType:
+        {
+            QCborSimpleType simple = reader.toSimpleType();
+            reader.next();
+            if (simple == QCborSimpleType::False) return false;
+            if (simple == QCborSimpleType::True) return true;
+            return QJsonValue(QJsonValue::Null);
+        }
+        case QCborStreamReader::Float16:
+        {
+            double value = reader.toFloat16();
+            reader.next();
+            return value;
+        }
+        case QCborStreamReader::Float:
+        {
+            double value = reader.toFloat();
+            reader.next();
+            return value;
+        }
+        case QCborStreamReader::Double:
+        {
+            double value = reader.toDouble();
+            reader.next();
+            return value;
+        }
+        default:
+            ok = false;
+            return QJsonValue();
+    }
+}
+
+FrameCodec::FrameCodec() : m_compressionThreshold(DEFAULT_COMPRESSION_THRESHOLD) {}
+
+QJsonObject FrameCodec::capabilityOffer() const
+{
+    QJsonObject offer;
+    offer["compression"] = QJsonArray{CAPABILITY_DEFLATE};
+    offer["compressionThreshold"] = m_compressionThreshold;
+    offer["encodings"] = QJsonArray{CAPABILITY_CBOR};
+    offer["connectionAuth"] = true;
+    return offer;
+}
+
+void FrameCodec::applyCapabilities(const QJsonObject& accepted)
+{
+    m_compression = accepted["compression"].toString() == CAPABILITY_DEFLATE
+                        ? Compression::Deflate
+                        : Compression::None;
+    // 只影响发送方向, 接收方向按每一帧的第一个字节判断格式
+    m_encoding = accepted["encoding"].toString() == CAPABILITY_CBOR ? Encoding::Cbor
+                                                                     : Encoding::Json;
+    m_connectionAuth = accepted["connectionAuth"].toBool();
+}
+
+void FrameCodec::reset()
+{
+    m_buffer.clear();
+    m_readPos = 0;
+    m_scanPos = 0;
+    m_frameStart = 0;
+    m_encoding = Encoding::Json;
+    m_compression = Compression::None;
+    m_connectionAuth = false;
+}
+
+QByteArray FrameCodec::encode(const QJsonObject& message)
+{
+    if (m_encoding == Encoding::Json)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+        m_stats.encodeNs += timer.nsecsElapsed();
+        return encodeJsonText(json);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray payload = toCbor(message);
+    qsizetype payloadSize = payload.size();
+    quint8 flags = 0;
+    if (m_compression == Compression::Deflate && payload.size() >= m_compressionThreshold)
+    {
+        QByteArray packed = qCompress(payload, COMPRESSION_LEVEL);
+        if (packed.size() < payload.size())
+        {
+            payload = packed;
+            flags |= FLAG_DEFLATE;
+        }
+    }
+    QByteArray frame(BINARY_HEADER_SIZE, Qt::Uninitialized);
+    frame[0] = static_cast<char>(flags);
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()), frame.data() + 1);
+    frame.append(payload);
+
+    m_stats.framesOut++;
+    if (flags & FLAG_DEFLATE) m_stats.compressedFramesOut++;
+    m_stats.payloadBytesOut += payloadSize;
+    m_stats.wireBytesOut += frame.size();
+    m_stats.encodeNs += timer.nsecsElapsed();
+    return frame;
+}
+
+QByteArray FrameCodec::encodeJsonText(const QByteArray& json)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray frame;
+    bool compressed = false;
+    if (m_compression == Compression::Deflate && json.size() >= m_compressionThreshold)
+    {
+        QByteArray packed = qCompress(json, COMPRESSION_LEVEL).toBase64();
+        // 压缩后反而更大 (例如内容本身就是 base64 的文件) 时仍然发送原文
+        if (packed.size() + 2 < json.size())
+        {
+            frame.reserve(packed.size() + 3);
+            frame.append(COMPRESSED_PREFIX).append(packed);
+            compressed = true;
+        }
+    }
+    if (!compressed)
+    {
+        frame = json;
+    }
+    frame.append('\n');
+
+    m_stats.framesOut++;
+    if (compressed) m_stats.compressedFramesOut++;
+    m_stats.payloadBytesOut += json.size() + 1;
+    m_stats.wireBytesOut += frame.size();
+    m_stats.encodeNs += timer.nsecsElapsed();
+    return frame;
+}
+
+void FrameCodec::append(const QByteArray& data)
+{
+    // 已经取出的帧在追加新数据时才一次性移除
+    if (m_readPos > 0)
+    {
+        m_buffer.remove(0, m_readPos);
+        m_scanPos = qMax(0, m_scanPos - m_readPos);
+        m_readPos = 0;
+        m_frameStart = 0;
+    }
+    m_buffer.append(data);
+    m_stats.wireBytesIn += data.size();
+}
+
+FrameCodec::DecodeResult FrameCodec::decodeNext(QJsonObject& message, QString& error)
+{
+    // 跳过帧之间的空行
+    while (m_readPos < m_buffer.size())
+    {
+        char c = m_buffer.at(m_readPos);
+        if (c != '\n' && c != '\r' && c != ' ' && c != '\t') break;
+        ++m_readPos;
+    }
+    if (m_readPos >= m_buffer.size()) return DecodeResult::NeedMore;
+    m_frameStart = m_readPos;
+
+    // 协商编码期间对方可能还在发送旧格式的帧, 所以每一帧单独判断
+    quint8 lead = static_cast<quint8>(m_buffer.at(m_readPos));
+    if ((lead & ~BINARY_FLAG_MASK) == 0)
+    {
+        return decodeBinary(message, error);
+    }
+    return decodeLine(message, error);
+}
+
+FrameCodec::DecodeResult FrameCodec::decodeLine(QJsonObject& message, QString& error)
+{
+    int end = m_buffer.indexOf('\n', qMax(m_readPos, m_scanPos));
+    if (end < 0)
+    {
+        m_scanPos = m_buffer.size();
+        if (m_buffer.size() - m_readPos > MAX_FRAME_SIZE)
+        {
+            // 一直没有换行, 说明数据已经错乱
+            error = "帧长度超过上限";
+            return DecodeResult::Corrupt;
+        }
+        return DecodeResult::NeedMore;
+    }
+
+    QByteArray line = m_buffer.mid(m_readPos, end - m_readPos).trimmed();
+    m_readPos = end + 1;
+    m_scanPos = m_readPos;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool compressed = line.startsWith(COMPRESSED_PREFIX);
+    if (compressed)
+    {
+        QByteArray packed = QByteArray::fromBase64(line.mid(2));
+        // qCompress 的前 4 字节是大端的原始长度, 解压前先检查
+        if (packed.size() < 4 || qFromBigEndian<quint32>(packed.constData()) > MAX_FRAME_SIZE)
+        {
+            error = "压缩帧长度无效";
+            return DecodeResult::Error;
+        }
+        line = qUncompress(packed);
+        if (line.isEmpty())
+        {
+            error = "压缩帧解压失败";
+            return DecodeResult::Error;
+        }
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+    m_stats.decodeNs += timer.nsecsElapsed();
+    if (doc.isNull() || !doc.isObject())
+    {
+        error = "无效的 JSON 格式或非对象消息";
+        return DecodeResult::Error;
+    }
+
+    m_stats.framesIn++;
+    if (compressed) m_stats.compressedFramesIn++;
+    m_stats.payloadBytesIn += line.size() + 1;
+    message = doc.object();
+    return DecodeResult::Frame;
+}
+
+FrameCodec::DecodeResult FrameCodec::decodeBinary(QJsonObject& message, QString& error)
+{
+    if (m_buffer.size() - m_readPos < BINARY_HEADER_SIZE) return DecodeResult::NeedMore;
+
+    const char* header = m_buffer.constData() + m_readPos;
+    quint8 flags = static_cast<quint8>(header[0]);
+    quint32 length = qFromBigEndian<quint32>(header + 1);
+    if (length > MAX_FRAME_SIZE)
+    {
+        // 长度错了之后无法再找到下一帧的边界
+        error = "帧长度超过上限";
+        return DecodeResult::Corrupt;
+    }
+    if (m_buffer.size() - m_readPos < BINARY_HEADER_SIZE + qsizetype(length))
+    {
+        return DecodeResult::NeedMore;
+    }
+
+    QByteArray payload = m_buffer.mid(m_readPos + BINARY_HEADER_SIZE, length);
+    m_readPos += BINARY_HEADER_SIZE + length;
+    m_scanPos = m_readPos;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool compressed = flags & FLAG_DEFLATE;
+    if (compressed)
+    {
+        if (payload.size() < 4 || qFromBigEndian<quint32>(payload.constData()) > MAX_FRAME_SIZE)
+        {
+            error = "压缩帧长度无效";
+            return DecodeResult::Error;
+        }
+        payload = qUncompress(payload);
+        if (payload.isEmpty())
+        {
+            error = "压缩帧解压失败";
+            return DecodeResult::Error;
+        }
+    }
+
+    bool ok = fromCbor(payload, message, error);
+    m_stats.decodeNs += timer.nsecsElapsed();
+    if (!ok) return DecodeResult::Error;
+
+    m_stats.framesIn++;
+    if (compressed) m_stats.compressedFramesIn++;
+    m_stats.payloadBytesIn += payload.size();
+    return DecodeResult::Frame;
+}
+
+QByteArray FrameCodec::toCbor(const QJsonObject& message)
+{
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+    writeCborObject(writer, message, true);
+    return data;
+}
+
+bool FrameCodec::fromCbor(const QByteArray& data, QJsonObject& message, QString& error)
+{
+    QCborStreamReader reader(data);
+    bool ok = true;
+    message = readCborMap(reader, 0, true, ok);
+    if (reader.lastError() != QCborError::NoError)
+    {
+        error = QString("CBOR 解码失败: %1").arg(reader.lastError().toString());
+        return false;
+    }
+    if (!ok)
+    {
+        error = "CBOR 帧格式无效";
+        return false;
+    }
+    return true;
+}
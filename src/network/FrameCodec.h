@@ -0,0 +1,130 @@
+#ifndef FRAMECODEC_H
+#define FRAMECODEC_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QJsonObject>
+#include <QString>
+
+// TCP 通道的分帧与编解码
+// 连接建立时使用文本格式, 一帧一行:
+//   {...}\n          普通的 compact JSON
+//   Z:<base64>\n     qCompress (deflate) 压缩后的 JSON, 只有协商过压缩并且超过阈值的帧才会这样发送
+// 服务器在 LOGIN / RESUME 响应中接受 cbor 编码后, 双方从下一帧开始改用二进制格式:
+//   [flags: 1 字节][长度: 4 字节大端][CBOR 或 qCompress(CBOR)]
+// CBOR 中已知的字段名和消息类型编码为小整数, 未知的保持字符串, 解码后与 JSON 格式得到相同的对象
+// 服务器接受 connectionAuth 后, token 绑定在连接上, 之后的业务消息不再携带 token;
+// 没有接受 (旧版本的服务器) 时每条消息仍然带上 token
+class FrameCodec
+{
+   public:
+    enum class Compression
+    {
+        None,
+        Deflate
+    };
+
+    // 收发统计, 用于计算压缩率和每 MB 的编解码耗时
+    struct Stats
+    {
+        quint64 framesOut = 0;
+        quint64 compressedFramesOut = 0;
+        quint64 payloadBytesOut = 0;  // 压缩前的 JSON / CBOR 字节数
+        quint64 wireBytesOut = 0;     // 实际写入 socket 的字节数
+        qint64 encodeNs = 0;          // 序列化与压缩的总耗时
+
+        quint64 framesIn = 0;
+        quint64 compressedFramesIn = 0;
+        quint64 payloadBytesIn = 0;
+        quint64 wireBytesIn = 0;
+        qint64 decodeNs = 0;
+
+        double compressionRatioOut() const
+        {
+            return wireBytesOut ? double(payloadBytesOut) / wireBytesOut : 1.0;
+        }
+        double compressionRatioIn() const
+        {
+            return wireBytesIn ? double(payloadBytesIn) / wireBytesIn : 1.0;
+        }
+        // 每处理 1MB 原始 JSON 花费的 CPU 时间 (毫秒)
+        double encodeMsPerMB() const
+        {
+            return payloadBytesOut ? encodeNs / 1e6 / (payloadBytesOut / 1048576.0) : 0.0;
+        }
+        double decodeMsPerMB() const
+        {
+            return payloadBytesIn ? decodeNs / 1e6 / (payloadBytesIn / 1048576.0) : 0.0;
+        }
+    };
+
+    enum class Encoding
+    {
+        Json,
+        Cbor
+    };
+
+    enum class DecodeResult
+    {
+        Frame,     // message 中是一个完整的帧
+        NeedMore,  // 缓冲区中没有完整的帧了
+        Error,     // 当前帧无效, 已经跳过, error 中是原因
+        Corrupt    // 找不到帧边界, 数据流已经错乱, 只能断开连接
+    };
+
+    FrameCodec();
+
+    // 放进 LOGIN / RESUME 请求的 capabilities 字段
+    QJsonObject capabilityOffer() const;
+    // 服务器在 LOGIN / RESUME 响应中返回的 capabilities
+    void applyCapabilities(const QJsonObject& accepted);
+
+    // 新的连接: 清空接收缓冲区, 回到不压缩的 JSON, 统计保留
+    void reset();
+
+    void setEncoding(Encoding encoding) { m_encoding = encoding; }
+    Encoding encoding() const { return m_encoding; }
+    void setCompression(Compression compression) { m_compression = compression; }
+    Compression compression() const { return m_compression; }
+    bool connectionAuth() const { return m_connectionAuth; }
+    void setCompressionThreshold(int bytes) { m_compressionThreshold = bytes; }
+    int compressionThreshold() const { return m_compressionThreshold; }
+
+    // 编码一个完整的帧, 文本格式包括结尾的换行
+    QByteArray encode(const QJsonObject& message);
+    // 已经序列化好的 compact JSON (不含换行), 按需压缩后成帧
+    // 只能在 encoding() 为 Json 时使用, 例如 FrameTemplates 直接拼出的帧
+    QByteArray encodeJsonText(const QByteArray& json);
+
+    // 追加从 socket 读到的数据, 然后循环调用 decodeNext 直到返回 NeedMore
+    void append(const QByteArray& data);
+    DecodeResult decodeNext(QJsonObject& message, QString& error);
+    // decodeNext 返回 Frame 或 Error 之后, 刚取出的那一帧在线路上的原始字节, 下一次 append 之前有效
+    QByteArrayView lastFrame() const
+    {
+        return QByteArrayView(m_buffer).sliced(m_frameStart, m_readPos - m_frameStart);
+    }
+
+    const Stats& stats() const { return m_stats; }
+
+    // 单个消息与 CBOR 之间的转换, 不包括帧头
+    static QByteArray toCbor(const QJsonObject& message);
+    static bool fromCbor(const QByteArray& data, QJsonObject& message, QString& error);
+
+   private:
+    DecodeResult decodeLine(QJsonObject& message, QString& error);
+    DecodeResult decodeBinary(QJsonObject& message, QString& error);
+
+    QByteArray m_buffer;
+    int m_readPos = 0;  // 已经取出的帧之后的位置
+    int m_scanPos = 0;  // 这之前没有换行符, 数据分多次到达时不重复查找
+    int m_frameStart = 0;  // 最近一次取出的帧的起始位置
+
+    Encoding m_encoding = Encoding::Json;
+    Compression m_compression = Compression::None;
+    bool m_connectionAuth = false;
+    int m_compressionThreshold;
+    Stats m_stats;
+};
+
+#endif  // FRAMECODEC_H
@@ -0,0 +1,112 @@
+#include "FrameTemplates.h"
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+void FrameTemplates::appendGroupChat(QByteArray& out, long userId, StringId username,
+                                     StringId nickname, long groupId, const QString& content,
+                                     quint64 traceId)
+{
+    if (m_groupChatPrefix.isEmpty() || userId != m_userId || username != m_username ||
+        nickname != m_nickname)
+    {
+        m_userId = userId;
+        m_username = username;
+        m_nickname = nickname;
+        m_groupChatPrefix = "{\"type\":\"GROUP_CHAT\",\"userId\":";
+        m_groupChatPrefix.append(QByteArray::number(static_cast<qint64>(userId)));
+        m_groupChatPrefix.append(",\"username\":");
+        appendJsonString(m_groupChatPrefix, internedString(username));
+        m_groupChatPrefix.append(",\"nickname\":");
+        appendJsonString(m_groupChatPrefix, internedString(nickname));
+        m_groupChatPrefix.append(",\"groupId\":");
+    }
+
+    // content 转义后最多是 UTF-8 长度的几倍, 这里按常见情况预留, 不够时 QByteArray 自己扩容
+    out.reserve(out.size() + m_groupChatPrefix.size() + content.size() * 3 + 40);
+    out.append(m_groupChatPrefix);
+    out.append(QByteArray::number(static_cast<qint64>(groupId)));
+    out.append(",\"content\":");
+    appendJsonString(out, content);
+    appendTraceId(out, traceId);
+    out.append('}');
+}
+
+void FrameTemplates::appendPrivateChat(QByteArray& out, const QString& receiver,
+                                       const QString& content, quint64 traceId)
+{
+    out.reserve(out.size() + receiver.size() + content.size() * 3 + 48);
+    out.append("{\"type\":\"PRIVATE_CHAT\",\"receiver\":");
+    appendJsonString(out, receiver);
+    out.append(",\"content\":");
+    appendJsonString(out, content);
+    appendTraceId(out, traceId);
+    out.append('}');
+}
+
+// 64 位的 id 超出 JSON 数字的精度, 写成字符串
+void FrameTemplates::appendTraceId(QByteArray& out, quint64 traceId)
+{
+    if (traceId == 0) return;
+    out.append(",\"traceId\":\"");
+    out.append(QByteArray::number(traceId));
+    out.append('"');
+}
+
+void FrameTemplates::appendJsonString(QByteArray& out, const QString& value)
+{
+    // toUtf8 本身是向量化的, 之后一次扫描完成转义; 没有需要转义的字符时整段追加
+    const QByteArray utf8 = value.toUtf8();
+    const char* data = utf8.constData();
+    const qsizetype size = utf8.size();
+
+    out.append('"');
+    qsizetype runStart = 0;
+    for (qsizetype i = 0; i < size; ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(data + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c)
+        {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\b':
+                out.append("\\b");
+                break;
+            case '\f':
+                out.append("\\f");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default:
+            {
+                const char escape[] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+                out.append(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    out.append(data + runStart, size - runStart);
+    out.append('"');
+}
+
+void FrameTemplates::clear()
+{
+    m_groupChatPrefix.clear();
+    m_userId = -1;
+    m_username = StringPool::InvalidId;
+    m_nickname = StringPool::InvalidId;
+}
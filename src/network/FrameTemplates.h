@@ -0,0 +1,37 @@
+#ifndef FRAMETEMPLATES_H
+#define FRAMETEMPLATES_H
+
+#include <QByteArray>
+#include <QString>
+#include "utils/StringPool.h"
+
+// 高频消息 (GROUP_CHAT, PRIVATE_CHAT) 的 JSON 帧构造器
+// 不变的部分 (type 和当前用户的身份字段) 预先编码好, 每次只追加 groupId / receiver 和转义后的 content,
+// 不经过 QJsonObject, 也不做第二次序列化. 输出与 MessageHandler 构造的消息等价 (字段顺序不同)
+class FrameTemplates
+{
+   public:
+    // {"type":"GROUP_CHAT","userId":..,"username":..,"nickname":..,"groupId":..,"content":..}
+    // 身份与上一次不同时 (重新登录) 才重建前缀, 比较的是 StringId, 不比较字符串
+    // traceId 不为 0 时追加 "traceId" 字段, 见 Trace.h
+    void appendGroupChat(QByteArray& out, long userId, StringId username, StringId nickname,
+                         long groupId, const QString& content, quint64 traceId = 0);
+    // {"type":"PRIVATE_CHAT","receiver":..,"content":..}
+    static void appendPrivateChat(QByteArray& out, const QString& receiver, const QString& content,
+                                  quint64 traceId = 0);
+
+    // 追加带引号的 JSON 字符串, 转义与 QJsonDocument 相同, 非 ASCII 字符直接输出 UTF-8
+    static void appendJsonString(QByteArray& out, const QString& value);
+
+    void clear();
+
+   private:
+    static void appendTraceId(QByteArray& out, quint64 traceId);
+
+    QByteArray m_groupChatPrefix;  // 到 "groupId": 为止
+    long m_userId = -1;
+    StringId m_username = StringPool::InvalidId;
+    StringId m_nickname = StringPool::InvalidId;
+};
+
+#endif  // FRAMETEMPLATES_H
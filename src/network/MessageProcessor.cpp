@@ -1,8 +1,25 @@
 #include "MessageProcessor.h"
 #include <QDebug>
+#include "utils/Logging.h"
 #include "utils/UserInfo.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/Trace.h"
 #include "GlobalEventBus.h"
-MessageProcessor::MessageProcessor(QObject* parent) : QObject(parent) {}
+
+// 会话恢复请求在等待表中的 id, 同一时间只会有一个
+const QString RESUME_REQUEST_ID = "resume";
+
+MessageProcessor::MessageProcessor(QObject* parent)
+    : MessageProcessor(UserInfo::instance(), parent)
+{
+}
+
+MessageProcessor::MessageProcessor(UserInfo& userInfo, QObject* parent)
+    : QObject(parent), m_userInfo(userInfo), m_pendingRequests(new PendingRequestTracker(this))
+{
+    connect(m_pendingRequests, &PendingRequestTracker::requestTimedOut, this,
+            &MessageProcessor::handlePendingRequestTimeout);
+}
 
 bool MessageProcessor::processMessage(const QJsonObject& message)
 {
@@ -13,6 +30,20 @@ bool MessageProcessor::processMessage(const QJsonObject& message)
     }
 
     QString type = message["type"].toString();
+    MetricCounter*& frameCounter = m_frameCounters[type];
+    if (!frameCounter) frameCounter = &MetricsRegistry::instance().counter("frames.in." + type);
+    frameCounter->add();
+
+    // 记录已经收到的位置, 断线重连后服务器只需要补发之后的内容
+    if (message.contains("messageId"))
+    {
+        m_lastMessageId = qMax(m_lastMessageId, message["messageId"].toVariant().toLongLong());
+    }
+    if (message.contains("eventSeq"))
+    {
+        m_lastEventSeq = qMax(m_lastEventSeq, message["eventSeq"].toVariant().toLongLong());
+    }
+
     // cpp限制,switchcase很有限, 不能直接对于string使用,只能对于常量或者枚举使用
     // 这里转换为枚举就还要写一遍, 无语了
     if (type == "REGISTER")
@@ -83,6 +114,10 @@ bool MessageProcessor::processMessage(const QJsonObject& message)
     {
         handleHeartbeatResponse(message);
     }
+    else if (type == "RESUME")
+    {
+        handleResumeMessage(message);
+    }
     else
     {
         emit errorOccurred(QString("未知消息类型: %1").arg(type));
@@ -136,21 +171,23 @@ void MessageProcessor::handleLoginMessage(const QJsonObject& message)
         QString nickname = message["nickname"].toString();
         QString cur_username = message["username"].toString();
 
-        UserInfo& userInfo = UserInfo::instance();
-        userInfo.setUserId(userId);
-        userInfo.setUsername(cur_username);
-        userInfo.setNickname(nickname);
-        userInfo.setToken(currentToken);
-        userInfo.setOnline(true);
-
-        qDebug()
-            << QString(
-                   "MessageProcessor: Login success, id: %1, username: %2, nickname: %3, token: %4")
-                   .arg(userId)
-                   .arg(cur_username)
-                   .arg(nickname)
-                   .arg(currentToken);
-        // 需要百分号 + .arg 填充参数
+        m_userInfo.setUserId(userId);
+        m_userInfo.setUsername(cur_username);
+        m_userInfo.setNickname(nickname);
+        m_userInfo.setToken(currentToken);
+        m_userInfo.setOnline(true);
+
+        // 新的登录从服务器快照重新开始: 之前的上下线事件已经体现在在线列表里,
+        // 之后到达的历史记录再推进 messageId
+        m_lastMessageId = 0;
+        m_lastEventSeq = message["eventSeq"].toVariant().toLongLong();
+
+        // token 是登录凭据, 不写进日志
+        qCInfo(lcProtocol) << "Login success, id:" << userId << "username:" << cur_username;
+        if (message.contains("capabilities"))
+        {
+            emit capabilitiesAccepted(message["capabilities"].toObject());
+        }
         emit loginSuccess(cur_username, nickname, currentToken);
     }
     else
@@ -184,7 +221,7 @@ void MessageProcessor::handleOnlineUser(const QJsonObject& message)
 
     QJsonArray users = message["content"].toArray();
     // qDebug() << "receive online list: " << users;
-    qDebug() << "Online users init, count: " << users.count();
+    qCDebug(lcProtocol) << "Online users init, count: " << users.count();
     emit onlineUsersInit(users);
 }
 // 注意自己也算是在线用户的, 理论上这里应该添加的
@@ -200,7 +237,7 @@ void MessageProcessor::handleOfflineUser(const QJsonObject& message)
     QJsonArray users = message["content"].toArray();
     int count = users.size();
     // qDebug() << "receive offline list: " << users;
-    qDebug() << "Offline users init. count: " << users.count();
+    qCDebug(lcProtocol) << "Offline users init. count: " << users.count();
     emit offlineUsersInit(users);
 }
 
@@ -212,7 +249,7 @@ void MessageProcessor::handleUserLoginMessage(const QJsonObject& message)
         return;
     }
     QJsonObject LoginUser = message["content"].toObject();
-    qDebug() << "user log in: " << LoginUser;
+    qCDebug(lcProtocol) << "user log in: " << LoginUser;
     emit someoneLogin(LoginUser);
 }
 
@@ -224,7 +261,7 @@ void MessageProcessor::handleUserLogoutMessage(const QJsonObject& message)
         return;
     }
     QJsonObject LogoutUser = message["content"].toObject();
-    qDebug() << "user logout: " << LogoutUser;
+    qCDebug(lcProtocol) << "user logout: " << LogoutUser;
     emit someoneLogout(LogoutUser);
 }
 
@@ -236,7 +273,8 @@ void MessageProcessor::handleHistoryMessages(const QJsonObject& message)
         return;
     }
     QJsonArray messages = message["content"].toArray();
-    qDebug() << "History received successfully, number = " << messages.size();
+    noteHistoryPosition(messages);
+    qCDebug(lcProtocol) << "History received successfully, number = " << messages.size();
     // qDebug() << "history content: " << messages;
     emit historyMessagesReceived(messages);
 }
@@ -293,6 +331,7 @@ void MessageProcessor::handleGroupChatMessage(const QJsonObject& message)
                                   .toString("hh:mm:ss")
                             : QDateTime::currentDateTime().toString("hh:mm:ss");
 
+    Trace::Span traceSpan(Trace::Stage::EventBus, Trace::currentId());
     GlobalEventBus::instance()->appendGroupMessage(senderUsername, senderNickname, groupId, content,
                                                    timestamp);
 }
@@ -360,13 +399,21 @@ void MessageProcessor::handleGroupResponse(const QJsonObject& message)  // 没
     QString status = message["status"].toString();
     QJsonObject content = message["content"].toObject();
     QString operationId = content["operationId"].toString();
-    qDebug() << "receive group reponse: " << message["content"] << " status: " << status;
+    qCDebug(lcProtocol) << "receive group reponse: " << message["content"] << " status: " << status;
+    // 无论成功与否都把任务从等待表中移除
+    PendingRequest request;
+    if (!m_pendingRequests->complete(operationId, request))
+    {
+        qCWarning(lcProtocol) << "Group response for unknown or expired operation:" << operationId;
+        return;
+    }
+    GroupTask task = request.payload.value<GroupTask>();
+
     if (status == "success")
     {
-        GroupTask* task = groupTaskMap.value(operationId);
-        QString taskType = task->getType();
+        QString taskType = task.getType();
         // 这里是从map中获取类型的
-        qDebug() << "type: " << taskType;
+        qCDebug(lcProtocol) << "type: " << taskType;
         if (taskType == "GROUP_CREATE")
         {
             long groupId = content["groupId"].toVariant().toLongLong();
@@ -394,22 +441,129 @@ void MessageProcessor::handleGroupResponse(const QJsonObject& message)  // 没
     }
     else
     {
-        qDebug() << "Group task reponse error, content: " << content;
+        qCDebug(lcProtocol) << "Group task reponse error, content: " << content;
+    }
+}
+
+bool MessageProcessor::trackGroupTask(const GroupTask& task)
+{
+    return m_pendingRequests->track(task.getOperationId(), task.getType(),
+                                    QVariant::fromValue(task));
+}
+
+void MessageProcessor::handlePendingRequestTimeout(const PendingRequest& request)
+{
+    qCWarning(lcProtocol) << "Request timed out:" << request.type << request.requestId;
+    if (request.requestId == RESUME_REQUEST_ID)
+    {
+        // 旧版本的服务器不认识 RESUME, 只能回到完整登录
+        emit resumeFailed("会话恢复超时");
+    }
+    else if (request.payload.canConvert<GroupTask>())
+    {
+        GroupTask task = request.payload.value<GroupTask>();
+        emit errorOccurred(QString("群组操作超时, 请稍后重试 (%1)").arg(task.getType()));
+    }
+    else
+    {
+        emit errorOccurred(QString("请求超时 (%1)").arg(request.type));
     }
 }
 
-void MessageProcessor::insert(const QString& operationId, GroupTask* task)
+void MessageProcessor::failPendingRequests(const QString& reason)
 {
-    groupTaskMap.insert(operationId, task);
+    const QVector<PendingRequest> abandoned = m_pendingRequests->takeAll();
+    for (const PendingRequest& request : abandoned)
+    {
+        // 会话恢复由 ChatClient 的重连逻辑重新发起
+        if (request.requestId == RESUME_REQUEST_ID) continue;
+        qCWarning(lcProtocol) << "Request failed:" << request.type << request.requestId << reason;
+        if (request.payload.canConvert<GroupTask>())
+        {
+            GroupTask task = request.payload.value<GroupTask>();
+            emit errorOccurred(QString("群组操作失败: %1 (%2)").arg(reason, task.getType()));
+        }
+        else
+        {
+            emit errorOccurred(QString("请求失败: %1 (%2)").arg(reason, request.type));
+        }
+    }
 }
 
 void MessageProcessor::handleHeartbeatResponse(const QJsonObject& message)
 {
-    QString timestamp = message["timestamp"].toString();
-    qInfo()<<"heartbeat at: " << timestamp;
+    // 旧版本的服务器不会带回 seq, 由 ChatClient 按最早的未响应心跳匹配
+    qint64 seq = message.contains("seq") ? message["seq"].toVariant().toLongLong() : -1;
+    emit heartbeatAcknowledged(seq);
 }
 
 
+void MessageProcessor::noteHistoryPosition(const QJsonArray& messages)
+{
+    // 历史记录里的消息不会再实时推送一遍, 恢复时从其中最大的 messageId 之后补发
+    for (const QJsonValue& value : messages)
+    {
+        m_lastMessageId =
+            qMax(m_lastMessageId, value.toObject()["messageId"].toVariant().toLongLong());
+    }
+}
+
+void MessageProcessor::resetResumeState()
+{
+    cancelResume();
+    m_lastMessageId = 0;
+    m_lastEventSeq = 0;
+}
+
+void MessageProcessor::beginResume(int timeoutMs)
+{
+    cancelResume();
+    m_pendingRequests->track(RESUME_REQUEST_ID, "RESUME", QVariant(), timeoutMs);
+}
+
+void MessageProcessor::cancelResume()
+{
+    m_pendingRequests->cancel(RESUME_REQUEST_ID);
+}
+
+/*
+{
+    "type": "RESUME",
+    "status": "success" | "error",
+    "errorMessage": "...",
+    "content": { "replayed": 12 },
+    "capabilities": { "compression": "deflate" }
+}
+成功之后服务器按正常格式补发错过的消息和事件
+*/
+void MessageProcessor::handleResumeMessage(const QJsonObject& message)
+{
+    PendingRequest request;
+    if (!m_pendingRequests->complete(RESUME_REQUEST_ID, request))
+    {
+        qCWarning(lcProtocol) << "Unexpected RESUME response, ignored.";
+        return;
+    }
+
+    if (message["status"].toString() == "success")
+    {
+        qCDebug(lcProtocol) << "Session resumed, replayed events:"
+                            << message["content"].toObject()["replayed"].toInt();
+        if (message.contains("capabilities"))
+        {
+            emit capabilitiesAccepted(message["capabilities"].toObject());
+        }
+        emit resumeSucceeded();
+    }
+    else
+    {
+        QString error = message.contains("errorMessage") && !message["errorMessage"].isNull()
+                            ? message["errorMessage"].toString()
+                            : "会话已失效";
+        emit resumeFailed(error);
+    }
+}
+
 void MessageProcessor::handleGroupBroadcast(const QJsonObject& message)
 {
     QJsonObject content = message["content"].toObject();
@@ -422,6 +576,7 @@ void MessageProcessor::handleGroupBroadcast(const QJsonObject& message)
         long creatorId = content["creatorId"].toVariant().toLongLong();
         QJsonArray members = content["members"].toArray();
         QJsonArray history = content["history"].toArray();
+        noteHistoryPosition(history);
         GlobalEventBus::instance()->sendGroupBroadcastAdd(groupId, groupName, creatorId, members, history);
     }
     else if(type == "remove")
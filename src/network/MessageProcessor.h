@@ -6,18 +6,37 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QString>
+#include <QHash>
 #include <QMap>
 #include "utils/GroupTask.h"
+#include "PendingRequestTracker.h"
+
+class MetricCounter;
+class UserInfo;
 class MessageProcessor : public QObject
 {
     Q_OBJECT
 
    public:
     explicit MessageProcessor(QObject* parent = nullptr);
+    // 登录结果写入 userInfo, 默认构造使用全局的 UserInfo::instance()
+    explicit MessageProcessor(UserInfo& userInfo, QObject* parent = nullptr);
 
     // 处理消息，返回是否成功，更新 token 和心跳状态
     bool processMessage(const QJsonObject& message);
-    void insert(const QString& operationId, GroupTask* task);
+    // 登记一个等待 GROUP_RESPONSE 的群组任务, 等待的请求过多时返回 false
+    bool trackGroupTask(const GroupTask& task);
+    PendingRequestTracker* pendingRequests() const { return m_pendingRequests; }
+
+    // 会话恢复: 记录已经收到的最大 messageId 和服务器事件序号
+    qint64 lastMessageId() const { return m_lastMessageId; }
+    qint64 lastEventSeq() const { return m_lastEventSeq; }
+    void resetResumeState();
+    // 发出 RESUME 之后调用, 响应超时视为恢复失败
+    void beginResume(int timeoutMs);
+    void cancelResume();
+    // 连接断开后等待中的请求不会再有响应, 立即以 reason 报告失败, 不等到超时
+    void failPendingRequests(const QString& reason);
     void handleHeartbeatResponse(const QJsonObject& message);
     void handleGroupBroadcast(const QJsonObject& message);
    signals:
@@ -40,6 +59,15 @@ class MessageProcessor : public QObject
     void someoneLogin(const QJsonObject& loginUsername);
     void someoneLogout(const QJsonObject& logoutUsername);
 
+    // 心跳响应, 服务器没有带回 seq 时为 -1
+    void heartbeatAcknowledged(qint64 seq);
+
+    // 服务器在 LOGIN / RESUME 响应中接受的传输特性, 在 loginSuccess / resumeSucceeded 之前发出
+    void capabilitiesAccepted(const QJsonObject& capabilities);
+
+    void resumeSucceeded();
+    void resumeFailed(const QString& reason);
+
    private:
     void handleRegisterMessage(const QJsonObject& message);
     void handleLoginMessage(const QJsonObject& message);
@@ -56,8 +84,16 @@ class MessageProcessor : public QObject
     void handleUserLogoutMessage(const QJsonObject& message);
     void handleGroupInfo(const QJsonObject& message);
     void handleGroupResponse(const QJsonObject& message);
+    void handleResumeMessage(const QJsonObject& message);
+
+    void handlePendingRequestTimeout(const PendingRequest& request);
+    void noteHistoryPosition(const QJsonArray& messages);
 
-    QMap<QString, GroupTask*> groupTaskMap;
+    UserInfo& m_userInfo;
+    QHash<QString, MetricCounter*> m_frameCounters;  // 每种消息的接收计数, 避免每次按名字查找
+    PendingRequestTracker* m_pendingRequests;  // 按 operationId 等待响应的请求
+    qint64 m_lastMessageId = 0;
+    qint64 m_lastEventSeq = 0;
 };
 
 #endif  // MESSAGEPROCESSOR_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "OutboundQueue.h"
+#include "utils/Logging.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/Trace.h"
+#include <QDebug>
+
+// socket 写缓冲区的水位线: 低于它才继续写入, 控制帧最多排在这么多数据后面
+const qint64 WRITE_BUFFER_WATERMARK = 32 * 1024;
+// 超过这个大小的聊天消息 (例如粘贴的大段文本) 按大块数据处理, 不挡住普通消息
+const qsizetype BULK_FRAME_SIZE = 16 * 1024;
+
+OutboundQueue::OutboundQueue(QObject* parent) : QObject(parent)
+{
+    m_clock.start();
+}
+
+OutboundQueue::Priority OutboundQueue::priorityFor(const QString& type, qsizetype frameSize)
+{
+    if (type == "HEARTBEAT" || type == "LOGIN" || type == "REGISTER" || type == "RESUME" ||
+        type == "LOGOUT" || (type.startsWith("GROUP_") && type != "GROUP_CHAT"))
+    {
+        return Priority::Control;
+    }
+    if (type == "FILE" || frameSize > BULK_FRAME_SIZE)
+    {
+        return Priority::Bulk;
+    }
+    return Priority::Interactive;
+}
+
+void OutboundQueue::setSocket(QTcpSocket* socket)
+{
+    if (m_socket == socket) return;
+    if (m_socket) m_socket->disconnect(this);
+    clear();
+    m_socket = socket;
+    if (m_socket)
+    {
+        connect(m_socket, &QTcpSocket::bytesWritten, this, &OutboundQueue::pump);
+    }
+}
+
+void OutboundQueue::enqueue(Priority priority, const QByteArray& frame)
+{
+    int index = static_cast<int>(priority);
+    ClassStats& stats = m_stats[index];
+
+    // 没有排队的帧并且缓冲区有空间时直接写入, 不改变原来的延迟
+    if (pendingFrames() == 0 && hasRoom())
+    {
+        if (writeToSocket(frame, Trace::currentId())) stats.frames++;
+        return;
+    }
+
+    m_queues[index].enqueue({frame, m_clock.elapsed(), Trace::currentId()});
+    m_pendingBytes += frame.size();
+    stats.pending++;
+    pump();
+}
+
+int OutboundQueue::clear()
+{
+    int dropped = 0;
+    for (int i = 0; i < PriorityCount; ++i)
+    {
+        dropped += m_queues[i].size();
+        m_queues[i].clear();
+        m_stats[i].pending = 0;
+    }
+    m_pendingBytes = 0;
+    updateGauges();
+    return dropped;
+}
+
+void OutboundQueue::updateGauges()
+{
+    static MetricGauge& frames = MetricsRegistry::instance().gauge("outbound.pending_frames");
+    static MetricGauge& bytes = MetricsRegistry::instance().gauge("outbound.pending_bytes");
+    frames.set(pendingFrames());
+    bytes.set(m_pendingBytes);
+}
+
+int OutboundQueue::pendingFrames() const
+{
+    int total = 0;
+    for (const QQueue<QueuedFrame>& queue : m_queues) total += queue.size();
+    return total;
+}
+
+OutboundQueue::ClassStats OutboundQueue::stats(Priority priority) const
+{
+    return m_stats[static_cast<int>(priority)];
+}
+
+void OutboundQueue::pump()
+{
+    while (hasRoom())
+    {
+        int index = 0;
+        while (index < PriorityCount && m_queues[index].isEmpty()) ++index;
+        if (index == PriorityCount) break;
+
+        QueuedFrame queued = m_queues[index].dequeue();
+        m_pendingBytes -= queued.frame.size();
+
+        ClassStats& stats = m_stats[index];
+        qint64 waited = m_clock.elapsed() - queued.enqueuedMs;
+        stats.pending--;
+        stats.queued++;
+        stats.totalQueueMs += waited;
+        stats.maxQueueMs = qMax(stats.maxQueueMs, waited);
+
+        // 写入失败时连接会被断开, clear() 之后循环自然结束
+        if (writeToSocket(queued.frame, queued.traceId)) stats.frames++;
+    }
+    updateGauges();
+}
+
+bool OutboundQueue::hasRoom() const
+{
+    return m_socket && m_socket->state() == QAbstractSocket::ConnectedState &&
+           m_socket->bytesToWrite() < WRITE_BUFFER_WATERMARK;
+}
+
+bool OutboundQueue::writeToSocket(const QByteArray& frame, quint64 traceId)
+{
+    Trace::Span traceSpan(Trace::Stage::SocketWrite, traceId);
+    if (m_socket->write(frame) == -1)
+    {
+        qCWarning(lcNet) << "Failed to write to socket:" << m_socket->errorString();
+        emit writeFailed(m_socket->errorString());
+        return false;
+    }
+    emit frameWritten(frame.size());
+    return true;
+}
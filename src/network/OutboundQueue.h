@@ -0,0 +1,83 @@
+#ifndef OUTBOUNDQUEUE_H
+#define OUTBOUNDQUEUE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include <QTcpSocket>
+
+// 按优先级发送的出站队列
+// QTcpSocket 自己的写缓冲区是先进先出的, 排在大量聊天数据后面的心跳可能要等很久.
+// 这里只让 socket 的写缓冲区保持在水位线以下, 其余的帧按优先级留在队列里,
+// 缓冲区腾出空间时 (bytesWritten) 先写控制帧, 再写交互帧, 最后写大块数据
+class OutboundQueue : public QObject
+{
+    Q_OBJECT
+
+   public:
+    enum class Priority
+    {
+        Control = 0,      // 心跳、登录、RESUME、群组操作
+        Interactive = 1,  // 普通聊天消息
+        Bulk = 2          // 文件和超大的消息
+    };
+    static const int PriorityCount = 3;
+
+    // 每个优先级的排队统计, 排队时间是从入队到交给 socket 的时间
+    struct ClassStats
+    {
+        quint64 frames = 0;
+        quint64 queued = 0;  // 没能直接写入、排过队的帧数
+        qint64 totalQueueMs = 0;
+        qint64 maxQueueMs = 0;
+        int pending = 0;
+
+        double averageQueueMs() const { return frames ? double(totalQueueMs) / frames : 0.0; }
+    };
+
+    explicit OutboundQueue(QObject* parent = nullptr);
+
+    // 根据消息类型和帧大小决定优先级, type 为空表示普通聊天消息
+    static Priority priorityFor(const QString& type, qsizetype frameSize);
+
+    // 切换到新的连接, 旧连接上排队的帧全部丢弃
+    void setSocket(QTcpSocket* socket);
+    void enqueue(Priority priority, const QByteArray& frame);
+    // 丢弃所有排队的帧, 返回丢弃的帧数
+    int clear();
+
+    int pendingFrames() const;
+    qint64 pendingBytes() const { return m_pendingBytes; }
+    ClassStats stats(Priority priority) const;
+
+   signals:
+    // 一帧交给了 socket, 用于更新最后发送时间
+    void frameWritten(qint64 bytes);
+    void writeFailed(const QString& error);
+
+   private slots:
+    void pump();
+
+   private:
+    struct QueuedFrame
+    {
+        QByteArray frame;
+        qint64 enqueuedMs;
+        quint64 traceId;  // 入队时的 Trace::currentId()
+    };
+
+    bool hasRoom() const;
+    void updateGauges();  // 排队的帧数和字节数写入 MetricsRegistry
+    bool writeToSocket(const QByteArray& frame, quint64 traceId);
+
+    QPointer<QTcpSocket> m_socket;
+    QQueue<QueuedFrame> m_queues[PriorityCount];
+    ClassStats m_stats[PriorityCount];
+    qint64 m_pendingBytes = 0;
+    QElapsedTimer m_clock;
+};
+
+#endif  // OUTBOUNDQUEUE_H
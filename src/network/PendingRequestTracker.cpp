@@ -0,0 +1,154 @@
+#include "PendingRequestTracker.h"
+#include "utils/Logging.h"
+#include <QDebug>
+#include <algorithm>
+
+// 时间轮参数: 250ms 一格, 64 格一圈 (16 秒)
+// 超过一圈的截止时间会先放在最远的格子里, 轮到时再重新放置
+const int TICK_INTERVAL = 250;
+const int WHEEL_SLOTS = 64;
+
+PendingRequestTracker::PendingRequestTracker(QObject* parent, int maxPending, int defaultTimeoutMs)
+    : QObject(parent),
+      m_wheel(WHEEL_SLOTS),
+      m_maxPending(maxPending),
+      m_defaultTimeoutMs(defaultTimeoutMs)
+{
+    m_clock.start();
+    m_tickTimer.setInterval(TICK_INTERVAL);
+    m_tickTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_tickTimer, &QTimer::timeout, this, &PendingRequestTracker::onTick);
+}
+
+bool PendingRequestTracker::track(const QString& requestId, const QString& type,
+                                  const QVariant& payload, int timeoutMs)
+{
+    if (requestId.isEmpty() || m_pending.contains(requestId)) return false;
+    if (m_pending.size() >= m_maxPending)
+    {
+        qCWarning(lcNet) << "PendingRequestTracker: too many pending requests, rejecting" << type;
+        return false;
+    }
+
+    qint64 now = m_clock.elapsed();
+    if (m_pending.isEmpty() && !m_tickTimer.isActive())
+    {
+        // 空闲后重新开始计时, 时间轮从当前时间算起
+        m_cursorMs = now;
+        m_tickTimer.start();
+    }
+
+    PendingRequest request;
+    request.requestId = requestId;
+    request.type = type;
+    request.payload = payload;
+    request.startedMs = now;
+    request.deadlineMs = now + (timeoutMs > 0 ? timeoutMs : m_defaultTimeoutMs);
+    request.serial = m_nextSerial++;
+
+    m_pending.insert(requestId, request);
+    schedule(request);
+    return true;
+}
+
+bool PendingRequestTracker::complete(const QString& requestId, PendingRequest& out)
+{
+    auto it = m_pending.find(requestId);
+    if (it == m_pending.end()) return false;
+
+    out = it.value();
+    m_pending.erase(it);  // 时间轮里的记录留到轮到时再丢弃
+
+    qint64 latency = m_clock.elapsed() - out.startedMs;
+    LatencyStats& stats = m_stats[out.type];
+    stats.minMs = stats.completed == 0 ? latency : qMin(stats.minMs, latency);
+    stats.maxMs = qMax(stats.maxMs, latency);
+    stats.totalMs += latency;
+    stats.lastMs = latency;
+    stats.completed++;
+    return true;
+}
+
+bool PendingRequestTracker::cancel(const QString& requestId)
+{
+    return m_pending.remove(requestId) > 0;
+}
+
+void PendingRequestTracker::clear()
+{
+    m_pending.clear();
+    for (QVector<WheelSlot>& slot : m_wheel) slot.clear();
+    m_tickTimer.stop();
+}
+
+QVector<PendingRequest> PendingRequestTracker::takeAll()
+{
+    QVector<PendingRequest> requests;
+    requests.reserve(m_pending.size());
+    for (const PendingRequest& request : std::as_const(m_pending)) requests.append(request);
+    std::sort(requests.begin(), requests.end(),
+              [](const PendingRequest& a, const PendingRequest& b) { return a.serial < b.serial; });
+    clear();
+    return requests;
+}
+
+int PendingRequestTracker::slotFor(qint64 deadlineMs) const
+{
+    qint64 ticksAhead = (deadlineMs - m_cursorMs + TICK_INTERVAL - 1) / TICK_INTERVAL;
+    ticksAhead = qBound<qint64>(1, ticksAhead, WHEEL_SLOTS - 1);
+    return static_cast<int>((m_cursor + ticksAhead) % WHEEL_SLOTS);
+}
+
+void PendingRequestTracker::schedule(const PendingRequest& request)
+{
+    m_wheel[slotFor(request.deadlineMs)].append({request.requestId, request.serial});
+}
+
+void PendingRequestTracker::onTick()
+{
+    qint64 now = m_clock.elapsed();
+    QVector<PendingRequest> expired;
+
+    // 定时器可能被事件循环延迟, 把落后的格子都补上, 最多转一圈
+    int steps = 0;
+    while (m_cursorMs + TICK_INTERVAL <= now && steps < WHEEL_SLOTS)
+    {
+        m_cursor = (m_cursor + 1) % WHEEL_SLOTS;
+        m_cursorMs += TICK_INTERVAL;
+        ++steps;
+
+        QVector<WheelSlot> slot;
+        slot.swap(m_wheel[m_cursor]);
+        for (const WheelSlot& entry : slot)
+        {
+            auto it = m_pending.find(entry.requestId);
+            // 已经完成, 或者 id 被新的请求复用了
+            if (it == m_pending.end() || it->serial != entry.serial) continue;
+
+            if (it->deadlineMs <= now)
+            {
+                expired.append(it.value());
+                m_pending.erase(it);
+            }
+            else
+            {
+                schedule(it.value());
+            }
+        }
+    }
+    // 落后超过一圈 (例如系统休眠), 所有格子都已经检查过了, 直接对齐到当前时间
+    if (m_cursorMs + TICK_INTERVAL <= now) m_cursorMs = now;
+
+    if (m_pending.isEmpty())
+    {
+        for (QVector<WheelSlot>& slot : m_wheel) slot.clear();
+        m_tickTimer.stop();
+    }
+
+    // 统一在最后发信号, 槽函数里可以安全地发起新的请求
+    for (const PendingRequest& request : expired)
+    {
+        m_stats[request.type].timedOut++;
+        emit requestTimedOut(request);
+    }
+}
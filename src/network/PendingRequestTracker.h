@@ -0,0 +1,101 @@
+#ifndef PENDINGREQUESTTRACKER_H
+#define PENDINGREQUESTTRACKER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+#include <QVector>
+
+// 一个等待响应的请求, payload 保存请求本身 (例如 GroupTask), 响应到达时原样取回
+struct PendingRequest
+{
+    QString requestId;  // 请求和响应共用的 id, 例如 GroupTask 的 operationId
+    QString type;       // 请求类型, 用于统计延迟和超时
+    QVariant payload;
+    qint64 startedMs = 0;   // 单调时钟, 只用于计算延迟
+    qint64 deadlineMs = 0;  // 单调时钟
+    quint64 serial = 0;     // 区分复用同一个 id 的请求
+};
+Q_DECLARE_METATYPE(PendingRequest)
+
+// 等待响应的请求表, 以 requestId 为 key
+// 所有请求的超时共用一个时间轮, 只有一个定时器, 并且只在有请求等待时运行
+// 响应到达或者超时都会把请求从表中移除, 表的大小有上限, 不会无限增长
+class PendingRequestTracker : public QObject
+{
+    Q_OBJECT
+
+   public:
+    // 每种请求类型的延迟统计, 单位毫秒
+    struct LatencyStats
+    {
+        quint64 completed = 0;
+        quint64 timedOut = 0;
+        qint64 totalMs = 0;
+        qint64 minMs = 0;
+        qint64 maxMs = 0;
+        qint64 lastMs = 0;
+
+        double averageMs() const { return completed ? double(totalMs) / completed : 0.0; }
+    };
+
+    explicit PendingRequestTracker(QObject* parent = nullptr, int maxPending = 256,
+                                   int defaultTimeoutMs = 10000);
+
+    // 开始跟踪一个请求, 表已满或者 id 已经在等待时返回 false
+    // timeoutMs <= 0 时使用默认超时
+    bool track(const QString& requestId, const QString& type, const QVariant& payload,
+               int timeoutMs = 0);
+    // 响应到达时调用, 请求存在时移除并写入 out, 同时记录延迟
+    bool complete(const QString& requestId, PendingRequest& out);
+    // 不记录统计, 直接放弃一个请求
+    bool cancel(const QString& requestId);
+    // 放弃所有请求, 例如连接被主动关闭时
+    void clear();
+    // 放弃所有请求并按发起的先后返回, 由调用方报告失败, 例如连接异常断开时
+    QVector<PendingRequest> takeAll();
+
+    bool contains(const QString& requestId) const { return m_pending.contains(requestId); }
+    int pendingCount() const { return m_pending.size(); }
+    int maxPending() const { return m_maxPending; }
+
+    QHash<QString, LatencyStats> stats() const { return m_stats; }
+    LatencyStats stats(const QString& type) const { return m_stats.value(type); }
+
+   signals:
+    void requestTimedOut(const PendingRequest& request);
+
+   private slots:
+    void onTick();
+
+   private:
+    struct WheelSlot
+    {
+        QString requestId;
+        quint64 serial;
+    };
+
+    void schedule(const PendingRequest& request);
+    int slotFor(qint64 deadlineMs) const;
+
+    QHash<QString, PendingRequest> m_pending;
+    QHash<QString, LatencyStats> m_stats;
+
+    // 时间轮: 每个槽保存截止时间落在这一格的请求, 完成的请求不从槽中删除,
+    // 轮到这一格时根据 serial 判断是否还有效
+    QVector<QVector<WheelSlot>> m_wheel;
+    int m_cursor = 0;
+    qint64 m_cursorMs = 0;  // 当前格子对应的时间
+
+    QTimer m_tickTimer;
+    QElapsedTimer m_clock;
+    quint64 m_nextSerial = 1;
+    int m_maxPending;
+    int m_defaultTimeoutMs;
+};
+
+#endif  // PENDINGREQUESTTRACKER_H
@@ -0,0 +1,37 @@
+#include "RttEstimator.h"
+#include <QtMath>
+
+void RttEstimator::addSample(qint64 sampleMs)
+{
+    if (sampleMs < 0) return;
+    double sample = static_cast<double>(sampleMs);
+    if (m_samples == 0)
+    {
+        m_srtt = sample;
+        m_rttvar = sample / 2.0;
+        m_min = sampleMs;
+        m_max = sampleMs;
+    }
+    else
+    {
+        // 先用旧的 srtt 更新 rttvar
+        m_rttvar = 0.75 * m_rttvar + 0.25 * qAbs(m_srtt - sample);
+        m_srtt = 0.875 * m_srtt + 0.125 * sample;
+        m_min = qMin(m_min, sampleMs);
+        m_max = qMax(m_max, sampleMs);
+    }
+    m_last = sampleMs;
+    m_samples++;
+}
+
+void RttEstimator::reset()
+{
+    *this = RttEstimator();
+}
+
+qint64 RttEstimator::rtoMs(qint64 minMs, qint64 maxMs) const
+{
+    if (m_samples == 0) return maxMs;  // 没有样本时保守处理
+    qint64 rto = qCeil(m_srtt + 4.0 * m_rttvar);
+    return qBound(minMs, rto, maxMs);
+}
@@ -0,0 +1,34 @@
+#ifndef RTTESTIMATOR_H
+#define RTTESTIMATOR_H
+
+#include <QtGlobal>
+
+// 往返时延估计 (Jacobson/Karels, 与 TCP 的 RTO 计算相同)
+// srtt = 7/8 srtt + 1/8 sample, rttvar = 3/4 rttvar + 1/4 |srtt - sample|
+class RttEstimator
+{
+   public:
+    void addSample(qint64 sampleMs);
+    void reset();
+
+    bool hasSamples() const { return m_samples > 0; }
+    quint64 sampleCount() const { return m_samples; }
+    double srttMs() const { return m_srtt; }
+    double rttvarMs() const { return m_rttvar; }  // 抖动
+    qint64 lastMs() const { return m_last; }
+    qint64 minMs() const { return m_min; }
+    qint64 maxMs() const { return m_max; }
+
+    // 重传超时 srtt + 4 * rttvar, 限制在 [minMs, maxMs] 之间
+    qint64 rtoMs(qint64 minMs, qint64 maxMs) const;
+
+   private:
+    double m_srtt = 0.0;
+    double m_rttvar = 0.0;
+    qint64 m_last = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+    quint64 m_samples = 0;
+};
+
+#endif  // RTTESTIMATOR_H
@@ -0,0 +1,140 @@
+#include "SendPacer.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/Trace.h"
+#include <QtMath>
+
+// 服务器没有公布限制时的默认速率: 正常聊天不会碰到, 只限制脚本或粘贴造成的突发
+const double DEFAULT_RATE = 20.0;  // 条/秒
+const int DEFAULT_BURST = 40;
+
+SendPacer::SendPacer(QObject* parent)
+    : QObject(parent), m_rate(DEFAULT_RATE), m_burst(DEFAULT_BURST), m_tokens(DEFAULT_BURST)
+{
+    m_clock.start();
+    m_drainTimer.setSingleShot(true);
+    m_drainTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_drainTimer, &QTimer::timeout, this, &SendPacer::drain);
+}
+
+void SendPacer::setRate(double messagesPerSecond, int burst)
+{
+    if (messagesPerSecond <= 0.0 || burst < 1) return;
+    refill();
+    m_rate = messagesPerSecond;
+    m_burst = burst;
+    m_tokens = qMin(m_tokens, static_cast<double>(m_burst));
+    if (!m_activeOrder.isEmpty())
+    {
+        m_drainTimer.stop();
+        scheduleDrain();
+    }
+}
+
+void SendPacer::enqueue(const QString& conversation, const QByteArray& frame)
+{
+    refill();
+    if (m_activeOrder.isEmpty() && m_tokens >= 1.0)
+    {
+        m_tokens -= 1.0;
+        m_stats.sent++;
+        emit frameReady(frame);
+        return;
+    }
+
+    QQueue<PendingFrame>& queue = m_queues[conversation];
+    if (queue.isEmpty()) m_activeOrder.append(conversation);
+    queue.enqueue({frame, m_clock.elapsed(), Trace::currentId()});
+    m_queueDepth++;
+    m_queuedBytes += frame.size();
+    m_stats.maxQueueDepth = qMax(m_stats.maxQueueDepth, m_queueDepth);
+    updateGauges();
+    emit queueDepthChanged(m_queueDepth);
+
+    if (!m_drainTimer.isActive()) scheduleDrain();
+}
+
+int SendPacer::clear()
+{
+    int dropped = m_queueDepth;
+    m_queues.clear();
+    m_activeOrder.clear();
+    m_drainTimer.stop();
+    m_queueDepth = 0;
+    m_queuedBytes = 0;
+    m_stats.dropped += dropped;
+    updateGauges();
+    if (dropped > 0) emit queueDepthChanged(0);
+    return dropped;
+}
+
+qint64 SendPacer::oldestWaitMs() const
+{
+    qint64 oldest = -1;
+    for (const QString& conversation : m_activeOrder)
+    {
+        qint64 enqueuedMs = m_queues.value(conversation).head().enqueuedMs;
+        if (oldest < 0 || enqueuedMs < oldest) oldest = enqueuedMs;
+    }
+    return oldest < 0 ? 0 : m_clock.elapsed() - oldest;
+}
+
+void SendPacer::drain()
+{
+    static MetricHistogram& delayMs = MetricsRegistry::instance().histogram("pacer.delay_ms");
+    refill();
+    int depthBefore = m_queueDepth;
+    while (!m_activeOrder.isEmpty() && m_tokens >= 1.0)
+    {
+        // 轮转: 取出队首会话的一条消息, 还有剩余时排到队尾
+        QString conversation = m_activeOrder.takeFirst();
+        auto it = m_queues.find(conversation);
+        if (it == m_queues.end() || it->isEmpty()) continue;
+
+        PendingFrame pending = it->dequeue();
+        if (it->isEmpty())
+            m_queues.erase(it);
+        else
+            m_activeOrder.append(conversation);
+
+        m_tokens -= 1.0;
+        m_queueDepth--;
+        m_queuedBytes -= pending.frame.size();
+        qint64 delay = m_clock.elapsed() - pending.enqueuedMs;
+        m_stats.sent++;
+        m_stats.delayed++;
+        m_stats.totalDelayMs += delay;
+        m_stats.maxDelayMs = qMax(m_stats.maxDelayMs, delay);
+        delayMs.record(delay);
+
+        // 槽函数里可能断开连接并调用 clear(), 循环条件会重新检查
+        Trace::Scope traceScope(pending.traceId);
+        emit frameReady(pending.frame);
+    }
+
+    updateGauges();
+    if (m_queueDepth != depthBefore) emit queueDepthChanged(m_queueDepth);
+    if (!m_activeOrder.isEmpty()) scheduleDrain();
+}
+
+void SendPacer::updateGauges()
+{
+    // 排队最久的等待时间在每次放行后更新, 放行间隔不超过一个令牌的时间
+    static MetricGauge& depth = MetricsRegistry::instance().gauge("pacer.queue_depth");
+    static MetricGauge& oldestWait = MetricsRegistry::instance().gauge("pacer.oldest_wait_ms");
+    depth.set(m_queueDepth);
+    oldestWait.set(oldestWaitMs());
+}
+
+void SendPacer::refill()
+{
+    qint64 now = m_clock.elapsed();
+    m_tokens = qMin(static_cast<double>(m_burst), m_tokens + (now - m_lastRefillMs) * m_rate / 1000.0);
+    m_lastRefillMs = now;
+}
+
+void SendPacer::scheduleDrain()
+{
+    // 等到桶里攒够一个令牌
+    double missing = qMax(0.0, 1.0 - m_tokens);
+    m_drainTimer.start(qCeil(missing * 1000.0 / m_rate));
+}
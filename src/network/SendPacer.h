@@ -0,0 +1,88 @@
+#ifndef SENDPACER_H
+#define SENDPACER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+// 聊天消息的发送节奏控制
+// 令牌桶限制整体速率 (条/秒, 允许一定的突发), 桶里有令牌并且没有排队时直接发送, 不增加延迟.
+// 超出速率的消息按会话排队, 会话之间轮转, 每轮每个会话发送一条,
+// 一个刷屏的群聊不会让私聊一直等待
+class SendPacer : public QObject
+{
+    Q_OBJECT
+
+   public:
+    struct Stats
+    {
+        quint64 sent = 0;
+        quint64 delayed = 0;  // 排过队的消息数
+        quint64 dropped = 0;  // 连接断开时丢弃的消息数
+        qint64 totalDelayMs = 0;
+        qint64 maxDelayMs = 0;
+        int maxQueueDepth = 0;
+
+        double averageDelayMs() const { return delayed ? double(totalDelayMs) / delayed : 0.0; }
+    };
+
+    explicit SendPacer(QObject* parent = nullptr);
+
+    // 服务器在 capabilities 中公布的限制, 以及没有公布时的默认值
+    void setRate(double messagesPerSecond, int burst);
+    double rate() const { return m_rate; }
+    int burst() const { return m_burst; }
+
+    // 可以立即发送时在这里同步发出 frameReady
+    void enqueue(const QString& conversation, const QByteArray& frame);
+    // 丢弃所有排队的消息, 返回丢弃的条数
+    int clear();
+
+    int queueDepth() const { return m_queueDepth; }
+    qint64 queuedBytes() const { return m_queuedBytes; }
+    int activeConversations() const { return m_activeOrder.size(); }
+    // 排队最久的消息已经等了多久
+    qint64 oldestWaitMs() const;
+    const Stats& stats() const { return m_stats; }
+
+   signals:
+    void frameReady(const QByteArray& frame);
+    void queueDepthChanged(int depth);
+
+   private slots:
+    void drain();
+
+   private:
+    struct PendingFrame
+    {
+        QByteArray frame;
+        qint64 enqueuedMs;
+        quint64 traceId;  // 入队时的 Trace::currentId(), 发出时恢复
+    };
+
+    void refill();
+    void scheduleDrain();
+    void updateGauges();
+
+    QHash<QString, QQueue<PendingFrame>> m_queues;
+    QStringList m_activeOrder;  // 有消息排队的会话, 轮转顺序
+
+    double m_rate;
+    int m_burst;
+    double m_tokens;
+    qint64 m_lastRefillMs = 0;
+
+    int m_queueDepth = 0;
+    qint64 m_queuedBytes = 0;
+    Stats m_stats;
+
+    QTimer m_drainTimer;
+    QElapsedTimer m_clock;
+};
+
+#endif  // SENDPACER_H
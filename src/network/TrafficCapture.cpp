@@ -0,0 +1,168 @@
+#include "TrafficCapture.h"
+#include "FrameCodec.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QtEndian>
+#include <cstring>
+
+namespace
+{
+const char MAGIC[] = "CHCAP";
+const int MAGIC_SIZE = 5;
+const quint8 VERSION = 1;
+const int FILE_HEADER_SIZE = 16;
+const int FRAME_HEADER_SIZE = 13;
+const quint32 MAX_FRAME_SIZE = 64 * 1024 * 1024;  // 超过说明文件已损坏
+const char* const CREDENTIAL_KEYS[] = {"password", "token"};
+const char* const CREDENTIAL_PATTERNS[] = {"\"password\"", "\"token\""};
+const char REDACTED[] = "***";
+
+// 不压缩的 JSON 文本帧里没有出现这些字段名时不需要解码;
+// 压缩帧和 CBOR 帧 (字段名编码成了整数) 只能解码后判断
+bool mayCarryCredentials(QByteArrayView frame)
+{
+    if (frame.front() != '{') return true;
+    for (const char* pattern : CREDENTIAL_PATTERNS)
+    {
+        if (frame.contains(QByteArrayView(pattern))) return true;
+    }
+    return false;
+}
+
+// 含有凭据时返回去掉凭据后的 JSON 文本帧, 否则返回空
+QByteArray redactCredentials(QByteArrayView frame)
+{
+    FrameCodec codec;
+    codec.append(frame.toByteArray());
+    QJsonObject message;
+    QString error;
+    if (codec.decodeNext(message, error) != FrameCodec::DecodeResult::Frame) return QByteArray();
+
+    bool redacted = false;
+    for (const char* key : CREDENTIAL_KEYS)
+    {
+        if (message.contains(QLatin1String(key)))
+        {
+            message[QLatin1String(key)] = REDACTED;
+            redacted = true;
+        }
+    }
+    if (!redacted) return QByteArray();
+    return QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+}
+}  // namespace
+
+bool TrafficCapture::open(const QString& path, QString& error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        error = m_file.errorString();
+        return false;
+    }
+
+    char header[FILE_HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, MAGIC_SIZE);
+    header[MAGIC_SIZE] = static_cast<char>(VERSION);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 8);
+    if (m_file.write(header, FILE_HEADER_SIZE) != FILE_HEADER_SIZE)
+    {
+        error = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_clock.start();
+    m_frames = 0;
+    return true;
+}
+
+void TrafficCapture::close()
+{
+    if (m_file.isOpen()) m_file.close();
+}
+
+void TrafficCapture::record(Direction direction, QByteArrayView frame)
+{
+    if (!m_file.isOpen() || frame.isEmpty()) return;
+
+    if (mayCarryCredentials(frame))
+    {
+        QByteArray redacted = redactCredentials(frame);
+        if (!redacted.isEmpty())
+        {
+            writeFrame(direction, redacted);
+            return;
+        }
+    }
+    writeFrame(direction, frame);
+}
+
+void TrafficCapture::writeFrame(Direction direction, QByteArrayView frame)
+{
+    // QFile 自带缓冲, 每帧只是两次内存拷贝, 缓冲区满时才真正写盘
+    char header[FRAME_HEADER_SIZE];
+    header[0] = static_cast<char>(direction);
+    qToLittleEndian<quint64>(quint64(m_clock.nsecsElapsed() / 1000), header + 1);
+    qToLittleEndian<quint32>(quint32(frame.size()), header + 9);
+    m_file.write(header, FRAME_HEADER_SIZE);
+    m_file.write(frame.data(), frame.size());
+    m_frames++;
+}
+
+bool TrafficCapture::load(const QString& path, QList<Frame>& frames, qint64& startedAtMs,
+                          QString& error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        error = file.errorString();
+        return false;
+    }
+    QByteArray data = file.readAll();
+    if (data.size() < FILE_HEADER_SIZE || !data.startsWith(MAGIC))
+    {
+        error = "不是抓包文件";
+        return false;
+    }
+    if (quint8(data.at(MAGIC_SIZE)) != VERSION)
+    {
+        error = QString("不支持的抓包文件版本 %1").arg(int(quint8(data.at(MAGIC_SIZE))));
+        return false;
+    }
+    startedAtMs = qFromLittleEndian<qint64>(data.constData() + 8);
+
+    qsizetype pos = FILE_HEADER_SIZE;
+    while (pos < data.size())
+    {
+        if (data.size() - pos < FRAME_HEADER_SIZE)
+        {
+            // 抓包过程中进程退出, 最后一帧不完整, 之前的帧仍然可用
+            break;
+        }
+        const char* header = data.constData() + pos;
+        quint8 direction = quint8(header[0]);
+        quint32 length = qFromLittleEndian<quint32>(header + 9);
+        if (direction > quint8(Direction::Outbound) || length > MAX_FRAME_SIZE)
+        {
+            error = QString("抓包文件在偏移 %1 处损坏").arg(pos);
+            return false;
+        }
+        if (data.size() - pos - FRAME_HEADER_SIZE < qsizetype(length)) break;
+
+        Frame frame;
+        frame.direction = static_cast<Direction>(direction);
+        frame.offsetUs = qint64(qFromLittleEndian<quint64>(header + 1));
+        frame.bytes = data.mid(pos + FRAME_HEADER_SIZE, length);
+        frames.append(frame);
+        pos += FRAME_HEADER_SIZE + length;
+    }
+    return true;
+}
+
+bool TrafficCapture::isCaptureFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    return file.read(MAGIC_SIZE) == MAGIC;
+}
@@ -0,0 +1,61 @@
+#ifndef TRAFFICCAPTURE_H
+#define TRAFFICCAPTURE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+// 抓包: 按时间顺序记录连接上收发的每一帧 (线路上的原始字节, 压缩和 CBOR 帧保持原样), 用于离线回放.
+// 帧的格式可以从字节本身判断, 所以回放时不需要重现编码协商的过程.
+// 抓包文件不保存凭据: 含有 password 或 token 字段的帧 (LOGIN / REGISTER / RESUME 请求,
+// 带令牌的 LOGIN 响应, 以及服务器不支持连接级认证时的普通消息) 在记录前把这些字段的值换成 "***",
+// 重新编码为不压缩的 JSON 文本帧. 其余的帧保持线路上的原始字节.
+// 文件格式, 整数都是小端:
+//   文件头 16 字节: "CHCAP" + 版本 (u8) + 保留 (u16) + 开始抓包的 UTC 时间 (i64, 毫秒)
+//   每一帧 13 字节头 + 帧字节: 方向 (u8) + 距开始的时间 (u64, 微秒) + 长度 (u32)
+class TrafficCapture
+{
+   public:
+    enum class Direction : quint8
+    {
+        Inbound = 0,
+        Outbound = 1
+    };
+
+    struct Frame
+    {
+        Direction direction = Direction::Inbound;
+        qint64 offsetUs = 0;
+        QByteArray bytes;
+    };
+
+    ~TrafficCapture() { close(); }
+
+    // 覆盖已有的文件
+    bool open(const QString& path, QString& error);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+    qint64 frameCount() const { return m_frames; }
+
+    // 需要去掉凭据的帧会先解码一次, 其余的帧直接写入
+    void record(Direction direction, QByteArrayView frame);
+
+    // 读取整个抓包文件
+    static bool load(const QString& path, QList<Frame>& frames, qint64& startedAtMs,
+                     QString& error);
+    // 按文件头判断, 用于和其他格式的帧文件区分
+    static bool isCaptureFile(const QString& path);
+
+   private:
+    void writeFrame(Direction direction, QByteArrayView frame);
+
+    QFile m_file;
+    QElapsedTimer m_clock;
+    qint64 m_frames = 0;
+};
+
+#endif  // TRAFFICCAPTURE_H
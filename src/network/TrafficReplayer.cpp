@@ -0,0 +1,81 @@
+#include "TrafficReplayer.h"
+
+namespace
+{
+const int MAX_BATCH_MS = 8;  // 每批最多占用事件循环的时间, 之后让出给绘制和其他事件
+}  // namespace
+
+TrafficReplayer::TrafficReplayer(QObject* parent) : QObject(parent), m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &TrafficReplayer::feed);
+}
+
+bool TrafficReplayer::load(const QString& path, QString& error)
+{
+    QList<TrafficCapture::Frame> frames;
+    qint64 startedAtMs = 0;
+    if (!TrafficCapture::load(path, frames, startedAtMs, error)) return false;
+
+    m_frames.clear();
+    m_bytes = 0;
+    m_next = 0;
+    for (TrafficCapture::Frame& frame : frames)
+    {
+        if (frame.direction != TrafficCapture::Direction::Inbound) continue;
+        m_bytes += frame.bytes.size();
+        m_frames.append(std::move(frame));
+    }
+    if (m_frames.isEmpty())
+    {
+        error = "抓包中没有入站帧";
+        return false;
+    }
+    return true;
+}
+
+qint64 TrafficReplayer::capturedDurationMs() const
+{
+    if (m_frames.isEmpty()) return 0;
+    return (m_frames.last().offsetUs - m_frames.first().offsetUs) / 1000;
+}
+
+void TrafficReplayer::start()
+{
+    m_next = 0;
+    m_running = true;
+    m_clock.start();
+    m_timer->start(0);
+}
+
+void TrafficReplayer::feed()
+{
+    // 时间从第一个入站帧算起, 跳过抓包开始到连接建立之间的空白
+    const qint64 baseUs = m_frames.isEmpty() ? 0 : m_frames.first().offsetUs;
+    QElapsedTimer batch;
+    batch.start();
+    while (m_next < m_frames.size())
+    {
+        const TrafficCapture::Frame& frame = m_frames.at(m_next);
+        if (m_speed > 0)
+        {
+            qint64 dueUs = qint64((frame.offsetUs - baseUs) / m_speed);
+            qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+            if (dueUs > nowUs)
+            {
+                m_timer->start(int((dueUs - nowUs + 999) / 1000));
+                return;
+            }
+        }
+        if (batch.elapsed() >= MAX_BATCH_MS)
+        {
+            m_timer->start(0);
+            return;
+        }
+        m_next++;
+        emit frameReady(frame.bytes);
+    }
+    m_running = false;
+    emit finished(m_clock.elapsed());
+}
@@ -0,0 +1,51 @@
+#ifndef TRAFFICREPLAYER_H
+#define TRAFFICREPLAYER_H
+
+#include "TrafficCapture.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+// 按抓包中的时间把入站帧依次交给 ChatClient::replayFrame, 出站帧只用于分析, 不回放.
+// speed 为 1 时按原始节奏, 2 为两倍速, 0 为尽快回放: 每处理一批帧回到事件循环一次,
+// 界面仍然会绘制, 测到的是消息处理加上界面更新的真实开销
+class TrafficReplayer : public QObject
+{
+    Q_OBJECT
+
+   public:
+    explicit TrafficReplayer(QObject* parent = nullptr);
+
+    bool load(const QString& path, QString& error);
+    void setSpeed(double speed) { m_speed = qMax(0.0, speed); }
+    double speed() const { return m_speed; }
+
+    void start();
+    bool isRunning() const { return m_running; }
+
+    int frameCount() const { return m_frames.size(); }
+    qint64 byteCount() const { return m_bytes; }
+    int replayedCount() const { return m_next; }
+    // 抓包本身覆盖的时长
+    qint64 capturedDurationMs() const;
+
+   signals:
+    void frameReady(const QByteArray& frame);
+    void finished(qint64 elapsedMs);
+
+   private slots:
+    void feed();
+
+   private:
+    QList<TrafficCapture::Frame> m_frames;  // 只有入站帧
+    qint64 m_bytes = 0;
+    int m_next = 0;
+    double m_speed = 1.0;
+    bool m_running = false;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+};
+
+#endif  // TRAFFICREPLAYER_H
@@ -0,0 +1,75 @@
+// ui/ChatSessionData.cpp
+#include "ChatSessionData.h"
+
+GroupChatData::GroupChatData(long groupId_, const QString& groupName_, long creatorId_,
+                             const QJsonArray& members_)
+    : groupId(groupId_),
+      groupName(internString(groupName_)),
+      creatorId(creatorId_),
+      members(GroupMembership::fromJson(members_, creatorId_))
+{
+}
+
+void GroupChatData::appendMessage(StringId senderUsername, StringId senderNickname,
+                                  const QJsonValue& content, const QString& timestamp,
+                                  const QString& senderNicknameText)
+{
+    ChatMessageRecord record;
+    record.senderUsername = senderUsername;
+    record.senderNickname = senderNickname;
+    if (senderNickname == StringPool::InvalidId) record.senderNicknameText = senderNicknameText;
+    record.content = content;
+    record.timestamp = timestamp;
+    messages.append(record);
+}
+
+PrivateChatData::PrivateChatData(StringId targetUsername_, StringId targetNickname_)
+    : targetUsername(targetUsername_), targetNickname(targetNickname_)
+{
+}
+
+int PrivateChatData::appendMessage(StringId senderUsername, const QJsonValue& content,
+                                   const QString& timestamp, bool isFile)
+{
+    ChatMessageRecord record;
+    record.senderUsername = senderUsername;
+    record.content = content;
+    record.timestamp = timestamp;
+    record.isFile = isFile;
+    messages.append(record);
+
+    int index = messages.size() - 1;
+    if (isFile && content.isObject())
+    {
+        QString taskId = content.toObject()["taskId"].toString();
+        if (!taskId.isEmpty()) fileRecordIndex.insert(taskId, index);
+    }
+    return index;
+}
+
+void PrivateChatData::updateFileRecord(const QString& taskId, const QJsonObject& fileInfo)
+{
+    auto it = fileRecordIndex.constFind(taskId);
+    if (it == fileRecordIndex.constEnd()) return;
+    int index = it.value();
+    fileRecordIndex.erase(it);
+    if (index < 0 || index >= messages.size()) return;
+
+    // 服务器的响应格式是 {content: {fileUrl, fileSize, ...}}
+    QJsonObject record = messages[index].content.toObject();
+    QJsonObject serverInfo = fileInfo["content"].toObject();
+    for (auto field = serverInfo.constBegin(); field != serverInfo.constEnd(); ++field)
+    {
+        record[field.key()] = field.value();
+    }
+    messages[index].content = record;
+}
+
+void PrivateChatData::markFileDownloaded(int index, const QString& localFilePath)
+{
+    if (index < 0 || index >= messages.size() || !messages[index].isFile) return;
+    QJsonObject record = messages[index].content.toObject();
+    record["downloaded"] = true;
+    record["localFilePath"] = localFilePath;
+    messages[index].content = record;
+}
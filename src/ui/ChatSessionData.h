@@ -0,0 +1,74 @@
+// ui/ChatSessionData.h
+#ifndef CHATSESSIONDATA_H
+#define CHATSESSIONDATA_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <QVector>
+#include "utils/GroupMembership.h"
+#include "utils/StringPool.h"
+
+// 会话中的一条消息, 会话控件被释放后仍然保存在这里, 重新打开时据此重建气泡
+struct ChatMessageRecord
+{
+    // 不在池中的发送者为 InvalidId, 昵称改为保存原文, 网络上的任意字符串不进入池子
+    StringId senderUsername = StringPool::InvalidId;
+    StringId senderNickname = StringPool::InvalidId;
+    QString senderNicknameText;
+    QJsonValue content;
+    QString timestamp;
+    bool isFile = false;
+
+    QString nickname() const
+    {
+        return senderNickname != StringPool::InvalidId ? internedString(senderNickname)
+                                                       : senderNicknameText;
+    }
+};
+
+// 群聊会话的数据部分, 不包含任何控件
+// 登录时每个群组只创建这个对象, GroupChatSession 控件在第一次打开时才构造
+class GroupChatData
+{
+   public:
+    GroupChatData(long groupId_, const QString& groupName_, long creatorId_,
+                  const QJsonArray& members_);
+
+    // senderNickname 为 InvalidId 时使用 senderNicknameText
+    void appendMessage(StringId senderUsername, StringId senderNickname,
+                       const QJsonValue& content, const QString& timestamp,
+                       const QString& senderNicknameText = QString());
+
+    long groupId;
+    StringId groupName;
+    long creatorId;
+    GroupMembership members;
+    QVector<ChatMessageRecord> messages;
+};
+
+// 私聊会话的数据部分
+class PrivateChatData
+{
+   public:
+    PrivateChatData(StringId targetUsername_, StringId targetNickname_);
+
+    // 返回新消息的下标, 文件消息可以据此在上传完成后回写服务器返回的信息
+    int appendMessage(StringId senderUsername, const QJsonValue& content,
+                      const QString& timestamp, bool isFile);
+    // 上传完成后把 fileUrl 等信息合并进对应的文件消息, 重建气泡时才能下载
+    void updateFileRecord(const QString& taskId, const QJsonObject& fileInfo);
+    // 下载完成后记下本地路径, 重建气泡时显示为已下载
+    void markFileDownloaded(int index, const QString& localFilePath);
+
+    StringId targetUsername;
+    StringId targetNickname;
+    QVector<ChatMessageRecord> messages;
+
+   private:
+    QHash<QString, int> fileRecordIndex;  // 上传任务 id -> 消息下标
+};
+
+#endif  // CHATSESSIONDATA_H
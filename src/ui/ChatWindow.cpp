@@ -11,7 +11,14 @@
 #include <QVBoxLayout>
 #include "GlobalEventBus.h"
 #include <QJsonDocument>
+#include "utils/Logging.h"
 #include "utils/UserInfo.h"
+#include "dialogs/DiagnosticsPanel.h"
+#include "utils/EventLoopMonitor.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/Trace.h"
+#include <QDir>
+#include <QShortcut>
 ChatWindow::ChatWindow(ChatClient* client, QWidget* parent)
     : QMainWindow(parent),
       chatClient(client),
@@ -23,35 +30,35 @@ ChatWindow::ChatWindow(ChatClient* client, QWidget* parent)
 {
     if (!chatClient || nickname.isEmpty())
     {
-        qDebug() << "ChatWindow: Invalid client or nickname";
+        qCDebug(lcUi) << "ChatWindow: Invalid client or nickname";
         throw std::runtime_error("无效的客户端或昵称");
     }
     try
     {
-        qDebug() << "ChatWindow: Starting setupUi";
+        qCDebug(lcUi) << "ChatWindow: Starting setupUi";
         setupUi();
-        qDebug() << "ChatWindow: Starting connectSignals";
+        qCDebug(lcUi) << "ChatWindow: Starting connectSignals";
         connectSignals();
-        qDebug() << "ChatWindow: Setting window title";
+        qCDebug(lcUi) << "ChatWindow: Setting window title";
         setWindowTitle("聊天客户端 - " + nickname);
-        qDebug() << "ChatWindow: Initialization completed";
+        qCDebug(lcUi) << "ChatWindow: Initialization completed";
         isInitialized = true;
     }
     catch (const QException& e)
     {
-        qDebug() << "ChatWindow: Qt exception during initialization:" << e.what();
+        qCDebug(lcUi) << "ChatWindow: Qt exception during initialization:" << e.what();
         QMessageBox::critical(this, "错误", QString("初始化失败: %1").arg(e.what()));
         throw;
     }
     catch (const std::exception& e)
     {
-        qDebug() << "ChatWindow: Exception during initialization:" << e.what();
+        qCDebug(lcUi) << "ChatWindow: Exception during initialization:" << e.what();
         QMessageBox::critical(this, "错误", QString("初始化失败: %1").arg(e.what()));
         throw;
     }
     catch (...)
     {
-        qDebug() << "ChatWindow: Unknown exception during initialization";
+        qCDebug(lcUi) << "ChatWindow: Unknown exception during initialization";
         QMessageBox::critical(this, "错误", "初始化时发生未知错误");
         throw;
     }
@@ -59,31 +66,31 @@ ChatWindow::ChatWindow(ChatClient* client, QWidget* parent)
 
 ChatWindow::~ChatWindow()
 {
-    qDebug() << "ChatWindow: Destructor called";
+    qCDebug(lcUi) << "ChatWindow: Destructor called";
 }
 
 void ChatWindow::setupUi()
 {
     try
     {
-        qDebug() << "ChatWindow: Creating central widget";
+        qCDebug(lcUi) << "ChatWindow: Creating central widget";
         centralWidget = new QWidget(this);
         setCentralWidget(centralWidget);
 
-        qDebug() << "ChatWindow: Creating main layout";
+        qCDebug(lcUi) << "ChatWindow: Creating main layout";
         QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
         mainLayout->setContentsMargins(15, 15, 15, 15);
         mainLayout->setSpacing(12);
 
-        qDebug() << "ChatWindow: Creating tab widget";
+        qCDebug(lcUi) << "ChatWindow: Creating tab widget";
         chatTabs = new QTabWidget(this);
         chatTabs->setObjectName("chatTabs");
         mainLayout->addWidget(chatTabs);
 
-        qDebug() << "ChatWindow: Init user manager";
+        qCDebug(lcUi) << "ChatWindow: Init user manager";
         userManager = new UserManager(this);
 
-        qDebug() << "ChatWindow: Setting up tabs";
+        qCDebug(lcUi) << "ChatWindow: Setting up tabs";
         publicChatTab = new PublicChatTab(chatClient, nickname, this);
         privateChatTab = new PrivateChatTab(chatClient, curUsername, nickname, userManager, this);
         groupChatTab = new GroupChatTab(chatClient, nickname, userManager, this);
@@ -92,7 +99,7 @@ void ChatWindow::setupUi()
         chatTabs->addTab(privateChatTab, "私聊");
         chatTabs->addTab(groupChatTab, "群聊");
 
-        qDebug() << "ChatWindow: Setting up status bar";
+        qCDebug(lcUi) << "ChatWindow: Setting up status bar";
         QStatusBar* statusBar = new QStatusBar(this);
         statusBar->setObjectName("statusBar");
         statusLabel = new QLabel("已连接");
@@ -106,11 +113,11 @@ void ChatWindow::setupUi()
         statusBar->addPermanentWidget(logoutButton);
         setStatusBar(statusBar);
 
-        qDebug() << "ChatWindow: Setting window size and style";
+        qCDebug(lcUi) << "ChatWindow: Setting window size and style";
         resize(1000, 750);
         setObjectName("ChatWindow");
 
-        qDebug() << "ChatWindow: Centering window";
+        qCDebug(lcUi) << "ChatWindow: Centering window";
         QScreen* screen = QGuiApplication::primaryScreen();
         if (screen)
         {
@@ -126,28 +133,28 @@ void ChatWindow::setupUi()
         if (styleFile.open(QFile::ReadOnly))
         {
             setStyleSheet(styleFile.readAll());
-            qDebug() << "ChatWindow: Applied stylesheet";
+            qCDebug(lcUi) << "ChatWindow: Applied stylesheet";
         }
         else
         {
-            qWarning() << "ChatWindow: Could not open styles.qss: " << styleFile.errorString();
+            qCWarning(lcUi) << "ChatWindow: Could not open styles.qss: " << styleFile.errorString();
         }
 
-        qDebug() << "ChatWindow: setupUi completed";
+        qCDebug(lcUi) << "ChatWindow: setupUi completed";
     }
     catch (const QException& e)
     {
-        qDebug() << "ChatWindow: Qt exception in setupUi:" << e.what();
+        qCDebug(lcUi) << "ChatWindow: Qt exception in setupUi:" << e.what();
         throw;
     }
     catch (const std::exception& e)
     {
-        qDebug() << "ChatWindow: Exception in setupUi:" << e.what();
+        qCDebug(lcUi) << "ChatWindow: Exception in setupUi:" << e.what();
         throw;
     }
     catch (...)
     {
-        qDebug() << "ChatWindow: Unknown exception in setupUi";
+        qCDebug(lcUi) << "ChatWindow: Unknown exception in setupUi";
         throw std::runtime_error("Unknown error in setupUi");
     }
 }
@@ -156,7 +163,7 @@ void ChatWindow::connectSignals()
 {
     try
     {
-        qDebug() << "ChatWindow: Connecting signals";
+        qCDebug(lcUi) << "ChatWindow: Connecting signals";
         connect(chatClient, &ChatClient::messageReceived, this, &ChatWindow::handleMessageReceived);
         connect(chatClient, &ChatClient::privateMessageReceived, this,
                 &ChatWindow::handlePrivateMessageReceived);
@@ -174,6 +181,31 @@ void ChatWindow::connectSignals()
         connect(statusBar()->findChild<QPushButton*>(), &QPushButton::clicked, this,
                 &ChatWindow::handleLogout);
 
+        // 隐藏的诊断面板和指标导出
+        QShortcut* diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+        connect(diagnosticsShortcut, &QShortcut::activated, this,
+                &ChatWindow::toggleDiagnosticsPanel);
+        QShortcut* metricsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+M"), this);
+        connect(metricsShortcut, &QShortcut::activated, this, &ChatWindow::dumpMetrics);
+        QShortcut* stallShortcut = new QShortcut(QKeySequence("Ctrl+Shift+S"), this);
+        connect(stallShortcut, &QShortcut::activated, this, &ChatWindow::dumpStallLog);
+
+        // 以 --trace 启动时, 随时导出当前的追踪记录
+        if (!Trace::dump().path().isEmpty())
+        {
+            QShortcut* traceShortcut = new QShortcut(QKeySequence("Ctrl+Shift+T"), this);
+            connect(traceShortcut, &QShortcut::activated, this,
+                    [this]()
+                    {
+                        QString path = Trace::dump().path();
+                        QString error;
+                        if (Trace::dump().write(path, error))
+                            statusBar()->showMessage("追踪记录已导出到 " + path, 5000);
+                        else
+                            statusBar()->showMessage("导出追踪记录失败: " + error, 5000);
+                    });
+        }
+
         // 连接UserManager的信号到ChatWindow的UI更新槽
         connect(userManager, &UserManager::usersInitialized, this,
                 &ChatWindow::updateUserCountsDisplay);
@@ -182,21 +214,21 @@ void ChatWindow::connectSignals()
         connect(userManager, &UserManager::userAdded, this, &ChatWindow::updateUserCountsDisplay);
         connect(userManager, &UserManager::userRemoved, this, &ChatWindow::updateUserCountsDisplay);
         isInitialized = true;  // 假设UI和Manager都已准备好
-        qDebug() << "ChatWindow: Signals connected";
+        qCDebug(lcUi) << "ChatWindow: Signals connected";
     }
     catch (const QException& e)
     {
-        qDebug() << "ChatWindow: Qt exception in connectSignals:" << e.what();
+        qCDebug(lcUi) << "ChatWindow: Qt exception in connectSignals:" << e.what();
         throw;
     }
     catch (const std::exception& e)
     {
-        qDebug() << "ChatWindow: Exception in connectSignals:" << e.what();
+        qCDebug(lcUi) << "ChatWindow: Exception in connectSignals:" << e.what();
         throw;
     }
     catch (...)
     {
-        qDebug() << "ChatWindow: Unknown exception in connectSignals";
+        qCDebug(lcUi) << "ChatWindow: Unknown exception in connectSignals";
         throw std::runtime_error("Unknown error in connectSignals");
     }
 }
@@ -207,7 +239,7 @@ void ChatWindow::handleMessageReceived(const QString& sender, const QString& con
 {
     if (!isInitialized)
     {
-        qDebug() << "ChatWindow: Ignoring messageReceived before initialization";
+        qCDebug(lcUi) << "ChatWindow: Ignoring messageReceived before initialization";
         return;
     }
     if (messageId > 0 && displayedMessages.contains(messageId)) return;
@@ -222,7 +254,7 @@ void ChatWindow::handlePrivateMessageReceived(const QString& sender, const QStri
 {
     if (!isInitialized)
     {
-        qDebug() << "ChatWindow: Ignoring privateMessageReceived before initialization";
+        qCDebug(lcUi) << "ChatWindow: Ignoring privateMessageReceived before initialization";
         return;
     }
     if (messageId > 0 && displayedMessages.contains(messageId)) return;
@@ -236,7 +268,7 @@ void ChatWindow::handleHistoryMessagesReceived(const QJsonArray& messages)
 {
     if (!isInitialized)
     {
-        qDebug() << "ChatWindow: Ignoring historyMessagesReceived before initialization";
+        qCDebug(lcUi) << "ChatWindow: Ignoring historyMessagesReceived before initialization";
         return;
     }
 
@@ -334,7 +366,7 @@ void ChatWindow::appendMessageBubble(QWidget* container, const QString& sender,
     QVBoxLayout* layout = qobject_cast<QVBoxLayout*>(container->layout());
     if (!layout)
     {
-        qDebug() << "ChatWindow: Invalid container layout";
+        qCDebug(lcUi) << "ChatWindow: Invalid container layout";
         return;
     }
 
@@ -361,7 +393,7 @@ void ChatWindow::handleOnlineUsersInit(const QJsonArray& users)
 {
     if (!isInitialized)
     {
-        qDebug() << "ChatWindow: Ignoring onlineUsersInit before initialization";
+        qCDebug(lcUi) << "ChatWindow: Ignoring onlineUsersInit before initialization";
         return;
     }
     userManager->initOnlineUsers(users);  // 传递给 UserManager 处理
@@ -375,7 +407,7 @@ void ChatWindow::handleOnlineUsersInit(const QJsonArray& users)
         // m_initialOnlineLoaded = false;
         // m_initialOfflineLoaded = false;
     }
-    qDebug() << "ChatWindow: 初始在线用户列表已处理。";
+    qCDebug(lcUi) << "ChatWindow: 初始在线用户列表已处理。";
 }
 
 // 处理初始离线用户列表
@@ -383,7 +415,7 @@ void ChatWindow::handleOfflineUsersInit(const QJsonArray& users)
 {
     if (!isInitialized)
     {
-        qDebug() << "ChatWindow: Ignoring offlineUsersInit before initialization";
+        qCDebug(lcUi) << "ChatWindow: Ignoring offlineUsersInit before initialization";
         return;
     }
     userManager->initOfflineUsers(users);  // 传递给 UserManager 处理
@@ -397,7 +429,7 @@ void ChatWindow::handleOfflineUsersInit(const QJsonArray& users)
         // m_initialOnlineLoaded = false;
         // m_initialOfflineLoaded = false;
     }
-    qDebug() << "ChatWindow: 初始离线用户列表已处理。";
+    qCDebug(lcUi) << "ChatWindow: 初始离线用户列表已处理。";
 }
 
 // 处理用户登录事件 (连接到 ChatClient 发出的信号)
@@ -406,7 +438,7 @@ void ChatWindow::handleSomeoneLogin(const QJsonObject& loginUser)
     // 传递给 UserManager 处理，UserManager 会更新内部数据并发射信号
     userManager->handleUserStatusChange(loginUser, User::Online);  // 登录状态对应 User::Online (1)
     // ChatWindow 的 UI 统计会通过连接 userManager 信号的 updateUserCountsDisplay 槽自动更新
-    qDebug() << "ChatWindow: 收到用户登录通知，已转发给 UserManager。";
+    qCDebug(lcUi) << "ChatWindow: 收到用户登录通知，已转发给 UserManager。";
 }
 
 // 处理用户登出事件 (连接到 ChatClient 发出的信号)
@@ -416,7 +448,41 @@ void ChatWindow::handleSomeoneLogout(const QJsonObject& logoutUser)
     userManager->handleUserStatusChange(logoutUser,
                                         User::Offline);  // 登出状态对应 User::Offline (0)
     // ChatWindow 的 UI 统计会通过连接 userManager 信号的 updateUserCountsDisplay 槽自动更新
-    qDebug() << "ChatWindow: 收到用户登出通知，已转发给 UserManager。";
+    qCDebug(lcUi) << "ChatWindow: 收到用户登出通知，已转发给 UserManager。";
+}
+
+// 诊断面板只在第一次打开时创建
+void ChatWindow::toggleDiagnosticsPanel()
+{
+    if (!diagnosticsPanel) diagnosticsPanel = new DiagnosticsPanel(this);
+    diagnosticsPanel->setVisible(!diagnosticsPanel->isVisible());
+}
+
+// 导出到 --metrics 指定的文件, 没有指定时写到当前目录
+void ChatWindow::dumpMetrics()
+{
+    QString path = MetricsRegistry::instance().dump().path();
+    if (path.isEmpty()) path = QDir::current().filePath("chatter_metrics.json");
+    QString error;
+    if (MetricsRegistry::instance().dump().write(path, error))
+        statusBar()->showMessage("指标已导出到 " + path, 5000);
+    else
+        statusBar()->showMessage("导出指标失败: " + error, 5000);
+}
+
+// 导出到 --stall-log 指定的文件, 没有指定时写到当前目录
+void ChatWindow::dumpStallLog()
+{
+    QString path = EventLoopMonitor::dump().path();
+    if (path.isEmpty()) path = QDir::current().filePath("chatter_stalls.json");
+    QString error;
+    if (EventLoopMonitor::dump().write(path, error))
+        statusBar()->showMessage(QString("卡顿日志 (%1 次) 已导出到 %2")
+                                     .arg(EventLoopMonitor::stallCount())
+                                     .arg(path),
+                                 5000);
+    else
+        statusBar()->showMessage("导出卡顿日志失败: " + error, 5000);
 }
 
 // 更新在线/离线人数显示 (连接到UserManager的信号)
@@ -426,7 +492,9 @@ void ChatWindow::updateUserCountsDisplay()
     offlineNumbers = userManager->getOfflineNumber();
     // busyNumbers = userManager->getBusyNumber(); // 如果有忙碌人数标签
     onlineCountLabel->setText(QString("在线人数: %1").arg(onlineNumbers));
+    MetricsRegistry::instance().gauge("users.online").set(onlineNumbers);
+    MetricsRegistry::instance().gauge("users.offline").set(offlineNumbers);
     // 如果有 offlineCountLabel 或 busyCountLabel，也在这里更新
-    qDebug() << "ChatWindow: 人数统计更新 -> 在线: " << onlineNumbers
-             << ", 离线: " << offlineNumbers << ", 忙碌: " << userManager->getBusyNumber();
+    qCDebug(lcUi) << "ChatWindow: 人数统计更新 -> 在线: " << onlineNumbers
+                  << ", 离线: " << offlineNumbers << ", 忙碌: " << userManager->getBusyNumber();
 }
\ No newline at end of file
@@ -15,6 +15,8 @@
 #include <QTabWidget>
 #include "utils/UserManager.h"
 
+class DiagnosticsPanel;
+
 class ChatWindow : public QMainWindow
 {
     Q_OBJECT
@@ -38,6 +40,9 @@ class ChatWindow : public QMainWindow
    private slots:
     void handleLogout();
     void handleError(const QString& error);  // 新增声明
+    void toggleDiagnosticsPanel();           // Ctrl+Shift+D
+    void dumpMetrics();                      // Ctrl+Shift+M
+    void dumpStallLog();                     // Ctrl+Shift+S
 
    private:
     void setupUi();
@@ -69,6 +74,7 @@ class ChatWindow : public QMainWindow
     bool m_initialOfflineLoaded = false;  // 新增：是否已加载初始离线列表
 
     UserManager* userManager;
+    DiagnosticsPanel* diagnosticsPanel = nullptr;  // 第一次打开时创建
    signals:
     void logoutRequested();
     // void windowClosed();
@@ -8,28 +8,37 @@
 #include <QTimer>
 #include <QJsonParseError>
 #include "MessageBubble.h"
+#include "utils/Logging.h"
 #include "utils/UserInfo.h"
 #include "utils/ConfigManager.h"
+#include "utils/Trace.h"
 #include "FileTransferManager.h"
 #include "GlobalEventBus.h"
 #include <QUuid>
 #include "GroupChatSession.h"
 #include "GlobalEventBus.h"
-GroupChatSession::GroupChatSession(long groupId_, const QString& groupName_, long creatorId_,
-                                   const QJsonArray& members_, QWidget* parent)
-    : QWidget(parent),
-      groupId(groupId_),
-      groupName(groupName_),
-      creatorId(creatorId_),
-      members(members_)
+GroupChatSession::GroupChatSession(QSharedPointer<GroupChatData> data_, QWidget* parent)
+    : QWidget(parent), data(std::move(data_))
 {
-    setObjectName("GroupChatSession" + groupId_);
+    setObjectName("GroupChatSession" + QString::number(data->groupId));
     setupUi();
     connectSignals();
+
+    // 重建之前收到的消息, 最后只加一次拉伸
+    for (const ChatMessageRecord& record : data->messages)
+    {
+        addBubble(record);
+    }
+    if (QVBoxLayout* layout = qobject_cast<QVBoxLayout*>(groupChatContainer->layout()))
+    {
+        layout->addStretch();
+    }
 }
 
 void GroupChatSession::setupUi()
 {
+    const QString name = internedString(data->groupName);
+
     // 初始化主布局
     QVBoxLayout* layout = new QVBoxLayout(this);
     layout->setContentsMargins(8, 8, 8, 8);
@@ -37,11 +46,11 @@ void GroupChatSession::setupUi()
 
     // 设置消息显示区域
     groupChatDisplay = new QScrollArea();
-    groupChatDisplay->setObjectName("groupChatDisplay_" + groupName);
+    groupChatDisplay->setObjectName("groupChatDisplay_" + name);
     groupChatDisplay->setMinimumHeight(400);
     groupChatDisplay->setMinimumWidth(600);
     groupChatContainer = new QWidget();
-    groupChatContainer->setObjectName("groupChatContainer_" + groupName);
+    groupChatContainer->setObjectName("groupChatContainer_" + name);
     QVBoxLayout* messagesLayout = new QVBoxLayout(groupChatContainer);
     messagesLayout->setAlignment(Qt::AlignTop);
     messagesLayout->setContentsMargins(0, 0, 0, 0);
@@ -51,11 +60,11 @@ void GroupChatSession::setupUi()
     // 设置输入区域
     QHBoxLayout* inputLayout = new QHBoxLayout();
     groupMessageInput = new QLineEdit();
-    groupMessageInput->setObjectName("groupMessageInput_" + groupName);
+    groupMessageInput->setObjectName("groupMessageInput_" + name);
     groupMessageInput->setPlaceholderText("输入群聊消息...");
 
     groupSendButton = new QPushButton("发送");
-    groupSendButton->setObjectName("groupSendButton_" + groupName);
+    groupSendButton->setObjectName("groupSendButton_" + name);
 
     inputLayout->addWidget(groupMessageInput);
     inputLayout->addWidget(groupSendButton);
@@ -92,24 +101,34 @@ void GroupChatSession::sendGroupMessage()
         return;
     }
 
-    GlobalEventBus::instance()->sendGroupMessage(groupId, content);
+    // 追踪: 同步调用链 (编码、发送、自己的气泡) 都记到这个本地 id 上
+    quint64 traceId = Trace::newLocalId();
+    Trace::Scope traceScope(traceId);
+    Trace::Span traceSpan(Trace::Stage::Input, traceId);
+
+    GlobalEventBus::instance()->sendGroupMessage(data->groupId, content);
 
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
     // 这里传入的是username
-    appendMessage(UserInfo::instance().username(),UserInfo::instance().nickname(), content, timestamp);
+    appendMessage(UserInfo::instance().usernameId(), UserInfo::instance().nicknameId(), content,
+                  timestamp);
+    emit messageSent(data->groupId);
 
     groupMessageInput->clear();
 }
 
 // 注意content需要包含状态
 // 这里删除了taskId, 包含在content中
-void GroupChatSession::appendMessage(const QString& senderUsername,const QString& senderNickname, const QJsonValue& content,
-                                     const QString& timestamp)
+void GroupChatSession::appendMessage(StringId senderUsername, StringId senderNickname,
+                                     const QJsonValue& content, const QString& timestamp,
+                                     const QString& senderNicknameText)
 {
+    data->appendMessage(senderUsername, senderNickname, content, timestamp, senderNicknameText);
+
     QVBoxLayout* layout = qobject_cast<QVBoxLayout*>(groupChatContainer->layout());
     if (!layout)
     {
-        qWarning() << "无效的容器布局:" << groupId;
+        qCWarning(lcUi) << "无效的容器布局:" << data->groupId;
         return;
     }
 
@@ -123,12 +142,7 @@ void GroupChatSession::appendMessage(const QString& senderUsername,const QString
         }
     }
 
-    // isOwn由是否和当前用户相同决定
-    MessageBubble* bubble =
-        new MessageBubble("", senderNickname, content, timestamp, senderUsername == UserInfo::instance().username(),
-                          false, groupChatContainer);
-
-    layout->addWidget(bubble);
+    addBubble(data->messages.constLast());
 
     layout->addStretch();
 
@@ -144,6 +158,16 @@ void GroupChatSession::appendMessage(const QString& senderUsername,const QString
                        });
 }
 
+void GroupChatSession::addBubble(const ChatMessageRecord& record)
+{
+    // isOwn由是否和当前用户相同决定
+    MessageBubble* bubble = new MessageBubble(
+        "", record.nickname(), record.content, record.timestamp,
+        record.senderUsername == UserInfo::instance().usernameId(), false, groupChatContainer);
+
+    groupChatContainer->layout()->addWidget(bubble);
+}
+
 void GroupChatSession::scrollToBottom()
 {
     groupChatDisplay->viewport()->update();
@@ -157,49 +181,15 @@ void GroupChatSession::scrollToBottom()
 
 long GroupChatSession::getGroupId()
 {
-    return this->groupId;
+    return data->groupId;
 }
 
 QString GroupChatSession::getGroupName()
 {
-    return this->groupName;
+    return internedString(data->groupName);
 }
 
 long GroupChatSession::getCreatorId()
 {
-    return this->creatorId;
-}
-
-QJsonArray GroupChatSession::getMembers()
-{
-    return this->members;
-}
-
-void GroupChatSession::addMemberToList(User* user)
-{
-    QJsonObject obj;
-    obj["userId"] = static_cast<qint64>(user->getUserId());
-    obj["username"] = user->getUsername();
-    obj["nickname"] = user->getNickname();
-    obj["avatarUrl"] = user->getAvatarUrl();
-    obj["status"] = user->getStatus();
-    members.append(obj);
+    return data->creatorId;
 }
-
-void GroupChatSession::removeMemberFromList(long userId)
-{
-    // 需要注意members的类型, 就是user的数组
-    for (int i = 0; i < members.count(); i++)
-    {
-        QJsonObject user = members.at(i).toObject();
-        long curId = user["userId"].toVariant().toLongLong();
-        if (curId == userId)
-        {
-            members.removeAt(i);
-            qDebug()<<"从session中移除用户 " << userId<<" 成功";
-            break;
-        }
-    }
-
-    qDebug()<<"移除之后, 群组成员有: "<<members;
-}
\ No newline at end of file
@@ -12,9 +12,14 @@
 #include <QMap>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QSharedPointer>
 #include "utils/User.h"
+#include "utils/StringPool.h"
+#include "utils/GroupMembership.h"
+#include "ChatSessionData.h"
 
-// 群组会话类
+// 群组会话类, 只是 GroupChatData 的视图
+// 控件在第一次打开群组时构造, 空闲时可以被释放, 数据仍然保留在 GroupChatData 中
 class GroupChatSession : public QWidget
 {
     Q_OBJECT
@@ -23,11 +28,10 @@ class GroupChatSession : public QWidget
     void connectSignals();
     QString formatFileSize(qint64 fileSize);
     QString generateTaskId(const QString& groupId, bool isUpload);
+    // 只创建气泡, 不处理末尾的拉伸和滚动, 重建历史时批量调用
+    void addBubble(const ChatMessageRecord& record);
 
-    long groupId;
-    QString groupName;
-    long creatorId;
-    QJsonArray members;
+    QSharedPointer<GroupChatData> data;  // 群组信息, 成员和消息都在这里
 
     QScrollArea* groupChatDisplay;
     QWidget* groupChatContainer;
@@ -39,10 +43,13 @@ class GroupChatSession : public QWidget
     void sendGroupMessage();
 
    public:
-    GroupChatSession(long groupId_, const QString& groupName_, long creatorId_,
-                     const QJsonArray& member, QWidget* parent = nullptr);
+    // 构造时会根据 data 中已有的消息重建气泡
+    explicit GroupChatSession(QSharedPointer<GroupChatData> data_, QWidget* parent = nullptr);
 
-    void appendMessage(const QString& senderUsername, const QString& senderNickname,const QJsonValue& content, const QString& timestamp);
+    // 发送者使用驻留 id, isOwn 的判断是整数比较, 不在池中的昵称通过 senderNicknameText 传入
+    // 消息同时写入 GroupChatData
+    void appendMessage(StringId senderUsername, StringId senderNickname, const QJsonValue& content,
+                       const QString& timestamp, const QString& senderNicknameText = QString());
 
     long getGroupId();
 
@@ -50,13 +57,15 @@ class GroupChatSession : public QWidget
 
     long getCreatorId();
 
-    QJsonArray getMembers();
-
-    void addMemberToList(User* user);
-    void removeMemberFromList(long userId);
+    // 输入框里还有没发出去的内容, 这时不应该释放控件
+    bool hasDraft() const { return !groupMessageInput->text().isEmpty(); }
 
    public slots:
     void scrollToBottom();
+
+   signals:
+    // 自己发出了一条消息, 群组列表据此更新活跃时间
+    void messageSent(long groupId);
 };
 
 #endif
\ No newline at end of file
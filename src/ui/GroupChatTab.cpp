@@ -7,19 +7,27 @@
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QUuid>
-#include <QMap>
+#include "utils/Logging.h"
 #include "utils/User.h"
 #include "utils/UserInfo.h"
 #include "GlobalEventBus.h"
 #include "utils/GroupTask.h"
 #include "dialogs/UserSelectionDialog.h"
 
+const int IDLE_SWEEP_INTERVAL = 60000;        // 每分钟检查一次空闲的会话控件
+const qint64 IDLE_SESSION_TIMEOUT = 300000;   // 5 分钟没有显示过的会话释放回纯数据
+
 GroupChatTab::GroupChatTab(ChatClient* client, const QString& nickname, UserManager* userManager_,
                            QWidget* parent)
     : QWidget(parent), chatClient(client), nickname(nickname), userManager(userManager_)
 {
     setupUi();
     connectSignals();
+
+    idleSweepTimer = new QTimer(this);
+    idleSweepTimer->setInterval(IDLE_SWEEP_INTERVAL);
+    connect(idleSweepTimer, &QTimer::timeout, this, &GroupChatTab::releaseIdleSessions);
+    idleSweepTimer->start();
 }
 
 void GroupChatTab::setupUi()
@@ -42,6 +50,9 @@ void GroupChatTab::setupUi()
     groupList->setMaximumWidth(200);  // 限制宽度
     groupList->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     groupList->setSelectionMode(QAbstractItemView::SingleSelection);
+    // 按最后活跃时间倒序排列, 某一行数据变化时列表只移动这一行
+    groupList->setSortingEnabled(true);
+    groupList->sortItems(Qt::DescendingOrder);
     contentLayout->addWidget(groupList);  // 将群组列表添加到内容布局
 
     // --- 右侧：聊天内容区 + 操作按钮区 ---
@@ -140,65 +151,113 @@ void GroupChatTab::on_groupList_itemClicked(QListWidgetItem* item)
 {
     if (!item) return;
 
-    long groupId = item->data(Qt::UserRole).toLongLong();  // todo 不知道是否有问题
+    long groupId = item->data(GroupListItem::GroupIdRole).toLongLong();
 
-    GroupChatSession* session = sessionsMap.value(groupId, nullptr);
+    GroupRegistry::GroupEntry* entry = groups.find(groupId);
+    if (entry) showGroup(*entry);
+}
 
-    if (session)
-    {
-        groupContentStack->setCurrentWidget(session);
-        curGroupId = session->getGroupId();
-        curGroupName = session->getGroupName();
-        curGroupCreatorId = session->getCreatorId();
+void GroupChatTab::showGroup(GroupRegistry::GroupEntry& entry)
+{
+    // 第一次打开 (或者被释放之后再次打开) 时才构造控件
+    GroupChatSession* session = sessionFor(entry);
+    groupContentStack->setCurrentWidget(session);
+    curGroupId = entry.groupId;
+    curGroupName = internedString(entry.data->groupName);
+    curGroupCreatorId = entry.data->creatorId;
 
-        session->scrollToBottom();
-    }
+    entry.lastViewedMs = QDateTime::currentMSecsSinceEpoch();
+    groups.clearUnread(entry.groupId);
+    session->scrollToBottom();
 }
 
-// 只有初始化历史消息, 或者用户创建或者被加入了新的群组, 才会用这个.
-// 只有这一个方法会创建并插入新的会话..
-GroupChatSession* GroupChatTab::getOrCreateSession(long groupId, const QString& groupName,
-                                                   long creatorId, const QJsonArray& members)
+GroupChatSession* GroupChatTab::sessionFor(GroupRegistry::GroupEntry& entry)
 {
-    // 其实get的时候直接从map中获取即可
-    if (sessionsMap.contains(groupId))  // getSession
+    if (!entry.session)
     {
-        return sessionsMap[groupId];
+        entry.session = new GroupChatSession(entry.data, this);
+        groupContentStack->addWidget(entry.session);
+        connect(entry.session, &GroupChatSession::messageSent, this,
+                [this](long groupId)
+                { groups.recordActivity(groupId, QDateTime::currentMSecsSinceEpoch(), false); });
     }
-    // 群组信息直接存储在session的字段中即可
-    // groupId groupName creatorId
-
-    GroupChatSession* session = new GroupChatSession(groupId, groupName, creatorId, members, this);
-
-    // fuck
-    sessionsMap.insert(groupId, session);
-
-    groupContentStack->addWidget(session);
-
-    QString displayText = groupName;
+    return entry.session;
+}
 
-    QListWidgetItem* item = new QListWidgetItem(displayText);
+// 只创建群组数据和列表项, 不创建控件
+GroupRegistry::GroupEntry& GroupChatTab::ensureGroup(long groupId, const QString& groupName,
+                                                     long creatorId, const QJsonArray& members)
+{
+    if (GroupRegistry::GroupEntry* existing = groups.find(groupId))
+    {
+        return *existing;
+    }
 
-    item->setData(Qt::UserRole, static_cast<qint64>(groupId));
-    groupList->addItem(item);
-    groupList->setCurrentItem(item);
+    GroupRegistry::GroupEntry entry;
+    entry.groupId = groupId;
+    entry.data = QSharedPointer<GroupChatData>::create(groupId, groupName, creatorId, members);
+    entry.item = new GroupListItem(groupId, groupName);
+    // GROUP_INFO 不带最后一条消息的时间, 还没有消息的群组排在后面,
+    // 之后收到的历史记录和新消息通过 recordActivity 把群组往前移
+    entry.lastActivityMs = 0;
+    // 先写好活跃时间再插入, 这样排序插入时直接落在正确的位置
+    GroupRegistry::GroupEntry& inserted = groups.insert(entry);
+    groupList->addItem(inserted.item);
+    return inserted;
+}
 
-    groupContentStack->setCurrentWidget(session);
+// 用户创建或者被加入了新的群组时使用, 会直接打开这个群组
+GroupChatSession* GroupChatTab::getOrCreateSession(long groupId, const QString& groupName,
+                                                   long creatorId, const QJsonArray& members)
+{
+    GroupRegistry::GroupEntry& entry = ensureGroup(groupId, groupName, creatorId, members);
+    groupList->setCurrentItem(entry.item);
     // 直接在显示session的时候设置当前的变量
-    curGroupId = session->getGroupId();
-    curGroupName = session->getGroupName();
-    curGroupCreatorId = session->getCreatorId();
-    session->scrollToBottom();
-    return session;
+    showGroup(entry);
+    return entry.session;
+}
+
+void GroupChatTab::releaseIdleSessions()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QWidget* current = groupContentStack->currentWidget();
+    for (GroupRegistry::GroupEntry& entry : groups.entries())
+    {
+        GroupChatSession* session = entry.session;
+        if (!session || session == current || session->hasDraft()) continue;
+        if (now - entry.lastViewedMs < IDLE_SESSION_TIMEOUT) continue;
+
+        // 消息都保存在 GroupChatData 中, 下次打开时重建
+        groupContentStack->removeWidget(session);
+        session->deleteLater();
+        entry.session = nullptr;
+    }
 }
 
 void GroupChatTab::appendMessage(const QString& senderUsername, const QString& senderNickname,
                                  long groupId, const QString& content, const QString& timestamp)
 {
-    // 这里直接获取群组
-    auto session = getOrCreateSession(groupId, "", -1, QJsonArray());
-    // 这里修改了签名
-    session->appendMessage(senderUsername, senderNickname, content, timestamp);
+    if (senderUsername.isEmpty())
+    {
+        qCWarning(lcUi) << "群聊消息缺少发送者, 已忽略, groupId:" << groupId;
+        return;
+    }
+    // 这里直接从注册表获取群组, 未知的群组只创建数据
+    GroupRegistry::GroupEntry* entry = groups.find(groupId);
+    if (!entry) entry = &ensureGroup(groupId, "", -1, QJsonArray());
+    // 只查找不驻留: 已知用户的用户名和昵称已经在池子里, 未知的发送者只保存昵称原文
+    StringPool& pool = StringPool::instance();
+    StringId senderId = pool.find(senderUsername);
+    StringId nicknameId = pool.find(senderNickname);
+    if (entry->session)
+        entry->session->appendMessage(senderId, nicknameId, content, timestamp, senderNickname);
+    else
+        entry->data->appendMessage(senderId, nicknameId, content, timestamp, senderNickname);
+
+    // 自己发的消息和正在查看的群组不计入未读
+    bool viewing = isVisible() && groupId == curGroupId;
+    bool isOwn = senderId != StringPool::InvalidId && senderId == UserInfo::instance().usernameId();
+    groups.recordActivity(groupId, QDateTime::currentMSecsSinceEpoch(), !viewing && !isOwn);
 }
 
 /*
@@ -237,8 +296,8 @@ void GroupChatTab::receiveGroupInfo(const QJsonValue& content)
         long creatorId = obj["creatorId"].toInt();
         QJsonArray members = obj["members"].toArray();
 
-        // 只是创建会话, 将数据放入会话类中
-        getOrCreateSession(groupId, groupName, creatorId, members);
+        // 只创建群组数据, 控件等到第一次打开时再构造
+        ensureGroup(groupId, groupName, creatorId, members);
     }
 }
 
@@ -249,25 +308,20 @@ QString GroupChatTab::generateTaskId()
 }
 
 /**
- * @brief 创建并初始化一个 GroupTask 对象
+ * @brief 创建并初始化一个 GroupTask
  * @param type 任务类型，例如 "CREATE_GROUP", "DELETE_GROUP", "ADD_MEMBER", "REMOVE_MEMBER"
  * @param groupId 相关联的群组ID
  * @param operatorId 执行此操作的用户ID (谁发起的)
  * @param groupName 相关联的群组名称 (用于创建群组时，或显示给用户)
  * @param userId 目标用户ID (当任务与单个用户有关时，例如添加/删除成员)
- * @return 指向新创建的 GroupTask 对象的指针。
- * 注意：此对象在堆上创建，其生命周期由接收者（如 NetworkRequestManager）管理。
+ * @return GroupTask 值对象, 由 ChatClient 登记到等待响应的请求表中
  */
-GroupTask* GroupChatTab::getGroupTask(const QString& type, long groupId, long operatorId,
-                                      const QString& groupName, long userId)
+GroupTask GroupChatTab::getGroupTask(const QString& type, long groupId, long operatorId,
+                                     const QString& groupName, long userId)
 {
     QString operationId = generateTaskId();  // 生成唯一任务 ID
-    // 在堆上创建 GroupTask 对象，并将其父对象设置为 GroupChatTab，
-    // 这样当 GroupChatTab 析构时，如果 GroupTask 还没有被处理，Qt 会自动删除它。
-    // 但通常，这些任务会被 NetworkRequestManager 取走并处理其生命周期。
-    GroupTask* task =
-        new GroupTask(operationId, type, groupId, operatorId, groupName, userId, this);
-    qDebug() << "Created GroupTask: " << task->toString();
+    GroupTask task(operationId, type, groupId, operatorId, groupName, userId);
+    qCDebug(lcUi) << "Created GroupTask: " << task.toString();
     return task;
 }
 
@@ -288,15 +342,11 @@ void GroupChatTab::on_createGroupButton_clicked()
         // - operatorId: m_currentUserId (当前操作的用户 ID)
         // - groupName: newGroupName (用户输入的群组名称)
         // - userId: 0 (创建群组通常不涉及特定的目标用户 ID，设为默认值)
-        GroupTask* task =
+        GroupTask task =
             getGroupTask("GROUP_CREATE", 0, UserInfo::instance().userId(), newGroupName, 0);
 
-        // 如果任务成功创建
-        if (task)
-        {
-            GlobalEventBus::instance()->taskSubmitted(task);
-            qDebug() << "已提交创建群组任务: " << task->toString();
-        }
+        GlobalEventBus::instance()->taskSubmitted(task);
+        qCDebug(lcUi) << "已提交创建群组任务: " << task.toString();
     }
     else if (ok)
     {
@@ -322,12 +372,17 @@ void GroupChatTab::on_deleteGroupButton_clicked()
     // long groupIdToDelete = currentItem->data(Qt::UserRole).toLongLong();
     long groupIdToDelete = curGroupId;
 
-    GroupChatSession* session = sessionsMap.value(groupIdToDelete);
+    const GroupRegistry::GroupEntry* entry = groups.find(groupIdToDelete);
+    if (!entry)
+    {
+        QMessageBox::warning(this, tr("警告"), tr("请选择群组。"));
+        return;
+    }
 
     // 获取选中项显示的群组名称
-    QString groupNameToDelete = session->getGroupName();
+    QString groupNameToDelete = internedString(entry->data->groupName);
 
-    long creatorId = session->getCreatorId();
+    long creatorId = entry->data->creatorId;
 
     long curUserId = UserInfo::instance().userId();
 
@@ -351,15 +406,12 @@ void GroupChatTab::on_deleteGroupButton_clicked()
         // - groupName: groupNameToDelete (仅用于日志或用户提示)
         // - userId: 0 (删除群组不涉及特定的目标用户 ID)
         // todo 后端修改此处逻辑
-        GroupTask* task =
+        GroupTask task =
             getGroupTask("GROUP_DELETE", groupIdToDelete, curUserId, groupNameToDelete, 0);
 
-        if (task)
-        {
-            // 通过 GlobalEventBus 提交任务
-            GlobalEventBus::instance()->taskSubmitted(task);
-            qDebug() << "已提交删除群组任务: " << task->toString();
-        }
+        // 通过 GlobalEventBus 提交任务
+        GlobalEventBus::instance()->taskSubmitted(task);
+        qCDebug(lcUi) << "已提交删除群组任务: " << task.toString();
     }
 }
 
@@ -385,35 +437,18 @@ void GroupChatTab::on_addMemberButton_clicked()
     // 获取所有用户
     QMap<long, User*> allUsers = userManager->getAllUsers();
 
-    // 获取当前选中群组的成员 ID 列表
-    GroupChatSession* session = sessionsMap.value(targetGroupId);
-    QSet<long> currentGroupMemberIds;
-    if (session)
+    // 直接使用会话中维护的成员集合, 不再每次重新构造
+    const GroupRegistry::GroupEntry* entry = groups.find(targetGroupId);
+    if (!entry)
     {
-        QJsonArray members = session->getMembers();  //getMembers() 返回 QJsonArray
-        for (const QJsonValue& memberValue : members)
-        {
-            if (memberValue.isObject())
-            {
-                QJsonObject memberObj = memberValue.toObject();
-                long memberId = memberObj["userId"].toVariant().toLongLong();
-                if (memberId != 0)
-                {
-                    currentGroupMemberIds.insert(memberId);
-                }
-            }
-        }
-    }
-    else
-    {
-        qWarning() << "无法找到群组会话：" << targetGroupId << "来获取成员列表。";
+        qCWarning(lcUi) << "无法找到群组会话：" << targetGroupId << "来获取成员列表。";
         // 这里可以考虑给用户一个提示，或者从其他地方获取成员列表
         QMessageBox::warning(this, tr("错误"), tr("无法获取群组成员信息。"));
         return;
     }
 
     // 创建并显示用户选择对话框，用于添加成员（显示非群组成员）
-    UserSelectionDialog dialog(allUsers, currentGroupMemberIds, true, this);  // true 表示添加模式
+    UserSelectionDialog dialog(allUsers, entry->data->members, true, this);  // true 表示添加模式
     if (dialog.exec() == QDialog::Accepted)  // 如果用户点击了“选择”
     {
         long memberIdToAdd = dialog.getSelectedUserId();
@@ -428,23 +463,20 @@ void GroupChatTab::on_addMemberButton_clicked()
                 return;
             }
             // 检查要添加的成员是否已经是群组成员
-            if (currentGroupMemberIds.contains(memberIdToAdd))
+            if (entry->data->members.contains(memberIdToAdd))
             {
                 QMessageBox::information(this, tr("提示"), tr("该用户已是群组成员。"));
                 return;
             }
 
             // 调用 getGroupTask 创建一个“添加成员”类型的任务
-            GroupTask* task =
+            GroupTask task =
                 getGroupTask("GROUP_ADD", targetGroupId, UserInfo::instance().userId(),
                              targetGroupName, memberIdToAdd);
 
-            if (task)
-            {
-                // 通过 GlobalEventBus 提交任务
-                GlobalEventBus::instance()->taskSubmitted(task);
-                qDebug() << "已提交添加成员任务: " << task->toString();
-            }
+            // 通过 GlobalEventBus 提交任务
+            GlobalEventBus::instance()->taskSubmitted(task);
+            qCDebug(lcUi) << "已提交添加成员任务: " << task.toString();
         }
         else
         {
@@ -477,35 +509,18 @@ void GroupChatTab::on_removeMemberButton_clicked()
     // 获取所有用户 (用于获取昵称等信息，虽然移除时只关心 ID)
     QMap<long, User*> allUsers = userManager->getAllUsers();
 
-    // 获取当前选中群组的成员 ID 列表
-    GroupChatSession* session = sessionsMap.value(targetGroupId);
-    QSet<long> currentGroupMemberIds;
-    if (session)
+    // 直接使用会话中维护的成员集合, 不再每次重新构造
+    const GroupRegistry::GroupEntry* entry = groups.find(targetGroupId);
+    if (!entry)
     {
-        QJsonArray members = session->getMembers();  // 假设 getMembers() 返回 QJsonArray
-        for (const QJsonValue& memberValue : members)
-        {
-            if (memberValue.isObject())
-            {
-                QJsonObject memberObj = memberValue.toObject();
-
-                long memberId = memberObj["userId"].toVariant().toLongLong();
-                if (memberId != 0)
-                {
-                    currentGroupMemberIds.insert(memberId);
-                }
-            }
-        }
-    }
-    else
-    {
-        qWarning() << "无法找到群组会话：" << targetGroupId << "来获取成员列表。";
+        qCWarning(lcUi) << "无法找到群组会话：" << targetGroupId << "来获取成员列表。";
         QMessageBox::warning(this, tr("错误"), tr("无法获取群组成员信息。"));
         return;
     }
 
     // 创建并显示用户选择对话框，用于移除成员（显示当前群组成员）
-    UserSelectionDialog dialog(allUsers, currentGroupMemberIds, false, this);  // false 表示移除模式
+    UserSelectionDialog dialog(allUsers, entry->data->members, false,
+                               this);  // false 表示移除模式
     if (dialog.exec() == QDialog::Accepted)  // 如果用户点击了“选择”
     {
         long memberIdToRemove = dialog.getSelectedUserId();
@@ -520,23 +535,20 @@ void GroupChatTab::on_removeMemberButton_clicked()
                 return;
             }
             // 检查该用户是否确实是群组成员 (尽管对话框已经过滤了)
-            if (!currentGroupMemberIds.contains(memberIdToRemove))
+            if (!entry->data->members.contains(memberIdToRemove))
             {
                 QMessageBox::information(this, tr("提示"), tr("该用户不是群组成员。"));
                 return;
             }
 
             // 调用 getGroupTask 创建一个“移除成员”类型的任务
-            GroupTask* task =
+            GroupTask task =
                 getGroupTask("GROUP_REMOVE", targetGroupId, UserInfo::instance().userId(),
                              targetGroupName, memberIdToRemove);
 
-            if (task)
-            {
-                // 通过 GlobalEventBus 提交任务
-                GlobalEventBus::instance()->taskSubmitted(task);
-                qDebug() << "已提交移除成员任务: " << task->toString();
-            }
+            // 通过 GlobalEventBus 提交任务
+            GlobalEventBus::instance()->taskSubmitted(task);
+            qCDebug(lcUi) << "已提交移除成员任务: " << task.toString();
         }
         else
         {
@@ -551,81 +563,93 @@ void GroupChatTab::on_receiveGroupCreateResponse(long groupId, const QString& gr
                                                  long creatorId)
 {
     getOrCreateSession(groupId, groupName, creatorId, QJsonArray());
+    // 自己新建的群组排到最前面
+    groups.recordActivity(groupId, QDateTime::currentMSecsSinceEpoch(), false);
 }
 
 void GroupChatTab::on_receiveGroupDeleteResponse(long groupId)
 {
-    // Check if the group exists in the sessions map
-    if (!sessionsMap.contains(groupId))
+    // Check if the group exists in the registry
+    if (!groups.contains(groupId))
     {
-        qWarning() << "Received delete response for non-existent group ID:" << groupId;
+        qCWarning(lcUi) << "Received delete response for non-existent group ID:" << groupId;
         return;
     }
 
-    // Get the session to access group details
-    GroupChatSession* session = sessionsMap.value(groupId);
-    QString groupName = session->getGroupName();
+    QString groupName = removeGroup(groupId);
+
+    // Notify the user
+    QMessageBox::information(
+        this, tr("群组删除"),
+        tr("群组 '%1' (ID: %2) 已删除或您已退出。").arg(groupName).arg(groupId));
+
+    qCDebug(lcUi) << "Group deleted: ID =" << groupId << ", Name =" << groupName;
+}
+
+QString GroupChatTab::removeGroup(long groupId)
+{
+    GroupRegistry::GroupEntry entry = groups.take(groupId);
+    GroupChatSession* session = entry.session;
+    QString groupName = internedString(entry.data->groupName);
+    // 必须在移除之前判断, removeWidget 之后堆栈会自动切到别的页面
+    bool wasCurrent = groupId == curGroupId;
 
-    // Remove the session from the sessions map
-    sessionsMap.remove(groupId);
+    // 列表项析构时会自动从 QListWidget 中移除, 不需要再按行查找
+    delete entry.item;
 
-    // Remove the group from the group list (UI)
-    for (int i = 0; i < groupList->count(); ++i)
+    // 控件可能从来没有构造过
+    if (session)
     {
-        QListWidgetItem* item = groupList->item(i);
-        if (item->data(Qt::UserRole).toLongLong() == groupId)
-        {
-            delete groupList->takeItem(i);
-            break;
-        }
+        // Remove the session widget from the stacked widget
+        groupContentStack->removeWidget(session);
+        session->deleteLater();  // Schedule the session for deletion
     }
 
-    // Remove the session widget from the stacked widget
-    groupContentStack->removeWidget(session);
-    session->deleteLater();  // Schedule the session for deletion
-
-    // If the deleted group was currently displayed, switch to another group or clear the view
-    if (groupContentStack->currentWidget() == session)
+    // If the deleted group was currently displayed, switch to the most active group
+    if (wasCurrent)
     {
-        if (groupContentStack->count() > 0)
+        QListWidgetItem* next = groupList->item(0);
+        GroupRegistry::GroupEntry* nextEntry =
+            next ? groups.find(next->data(GroupListItem::GroupIdRole).toLongLong()) : nullptr;
+        if (nextEntry)
         {
-            groupContentStack->setCurrentIndex(0);
-            if (groupList->count() > 0)
-            {
-                groupList->setCurrentRow(0);
-            }
+            groupList->setCurrentItem(next);
+            showGroup(*nextEntry);
         }
         else
         {
             // No groups left, clear the selection
             groupList->clearSelection();
+            curGroupId = -1;
+            curGroupName.clear();
+            curGroupCreatorId = -1;
         }
     }
-
-    // Notify the user
-    QMessageBox::information(
-        this, tr("群组删除"),
-        tr("群组 '%1' (ID: %2) 已删除或您已退出。").arg(groupName).arg(groupId));
-
-    qDebug() << "Group deleted: ID =" << groupId << ", Name =" << groupName;
+    return groupName;
 }
 
 void GroupChatTab::on_receiveGroupAddResponse(long userId, long groupId)
 {
     // Check if the group exists
-    if (!sessionsMap.contains(groupId))
+    const GroupRegistry::GroupEntry* entry = groups.find(groupId);
+    if (!entry)
     {
-        qWarning() << "Received add member response for non-existent group ID:" << groupId;
+        qCWarning(lcUi) << "Received add member response for non-existent group ID:" << groupId;
         return;
     }
 
-    // Get the group session and user details
-    GroupChatSession* session = sessionsMap.value(groupId);
-    QString groupName = session->getGroupName();
+    // Get the group data and user details
+    QString groupName = internedString(entry->data->groupName);
     User* user = userManager->getUserById(userId);
+    if (!user)
+    {
+        qCWarning(lcUi) << "Received add member response for unknown user ID:" << userId;
+        return;
+    }
     QString username = user->getUsername();
 
-    session->addMemberToList(user);
+    // 增量更新成员集合
+    entry->data->members.add(user);
 
     // Notify the user
     QMessageBox::information(this, tr("成员添加"),
@@ -635,26 +659,26 @@ void GroupChatTab::on_receiveGroupAddResponse(long userId, long groupId)
                                  .arg(groupName)
                                  .arg(groupId));
 
-    qDebug() << "Member added: User ID =" << userId << "to Group ID =" << groupId;
+    qCDebug(lcUi) << "Member added: User ID =" << userId << "to Group ID =" << groupId;
 }
 
 void GroupChatTab::on_receiveGroupRemoveResponse(long userId, long groupId)
 {
     // Check if the group exists
-    if (!sessionsMap.contains(groupId))
+    const GroupRegistry::GroupEntry* entry = groups.find(groupId);
+    if (!entry)
     {
-        qWarning() << "Received remove member response for non-existent group ID:" << groupId;
+        qCWarning(lcUi) << "Received remove member response for non-existent group ID:" << groupId;
         return;
     }
 
-    // Get the group session and user details
-    GroupChatSession* session = sessionsMap.value(groupId);
-    QString groupName = session->getGroupName();
+    // Get the group data and user details
+    QString groupName = internedString(entry->data->groupName);
     User* user = userManager->getUserById(userId);
+    QString username = user ? user->getUsername() : QString::number(userId);
 
-    QString username = user->getUsername();
-
-    session->removeMemberFromList(user->getUserId());
+    // 增量更新成员集合, 即使本地没有该用户的信息也要移除
+    entry->data->members.remove(userId);
 
     // Notify the user
     QMessageBox::information(this, tr("成员移除"),
@@ -664,7 +688,7 @@ void GroupChatTab::on_receiveGroupRemoveResponse(long userId, long groupId)
                                  .arg(groupName)
                                  .arg(groupId));
 
-    qDebug() << "Member removed: User ID =" << userId << "from Group ID =" << groupId;
+    qCDebug(lcUi) << "Member removed: User ID =" << userId << "from Group ID =" << groupId;
 }
 
 // 这个用户被添加到这个群聊中
@@ -674,81 +698,47 @@ void GroupChatTab::on_receiveBroadcastAdd(long groupId, const QString& groupName
     auto session = getOrCreateSession(groupId, groupName, creatorId, members);
     // 把自己添加进去即可
     long curUserId = UserInfo::instance().userId();
-    session->addMemberToList(userManager->getUserById(curUserId));
+    groups.find(groupId)->data->members.add(userManager->getUserById(curUserId));
 
     for(const auto& info : history)
     {
         // 现在这是一个后端的MessageDTO
         QJsonObject message = info.toObject();
-        qDebug()<<"message: "<<message;
+        qCDebug(lcUi) << "message: "<<message;
 
         long senderId = message["userId"].toVariant().toLongLong();
         User* user = userManager->getUserById(senderId);
 
-        QString senderUsername = user->getUsername();
-        QString senderNickname = user->getNickname();
         QString content = message["content"].toString();
         // 注意这里的名称是createdAt
 
         QString timestamp = message["timestamp"].toString();
-        qDebug()<<senderNickname << " " << content << " time is: "<<timestamp;
-        session->appendMessage(senderUsername, senderNickname, content, timestamp);
+        if (!user)
+        {
+            qCWarning(lcUi) << "History message from unknown user ID:" << senderId;
+            continue;
+        }
+        session->appendMessage(user->getUsernameId(), user->getNicknameId(), content, timestamp);
     }
+    // 新加入的群组排到最前面
+    groups.recordActivity(groupId, QDateTime::currentMSecsSinceEpoch(), false);
 }
 
 void GroupChatTab::on_receiveBroadcastRemove(long groupId, const QString& groupName)
 {
-    // Check if the group exists in the sessions map
-    if (!sessionsMap.contains(groupId))
+    // Check if the group exists in the registry
+    if (!groups.contains(groupId))
     {
-        qWarning() << "Received delete response for non-existent group ID:" << groupId;
+        qCWarning(lcUi) << "Received delete response for non-existent group ID:" << groupId;
         return;
     }
 
-    // Get the session to access group details
-    GroupChatSession* session = sessionsMap.value(groupId);
-
-    // Remove the session from the sessions map
-    sessionsMap.remove(groupId);
-
-    // Remove the group from the group list (UI)
-    for (int i = 0; i < groupList->count(); ++i)
-    {
-        QListWidgetItem* item = groupList->item(i);
-        if (item->data(Qt::UserRole).toLongLong() == groupId)
-        {
-            delete groupList->takeItem(i);
-            break;
-        }
-    }
-
-    // Remove the session widget from the stacked widget
-    groupContentStack->removeWidget(session);
-    session->deleteLater();  // Schedule the session for deletion
-
-    // If the deleted group was currently displayed, switch to another group or clear the view
-    if (groupContentStack->currentWidget() == session)
-    {
-        if (groupContentStack->count() > 0)
-        {
-            groupContentStack->setCurrentIndex(0);
-            if (groupList->count() > 0)
-            {
-                groupList->setCurrentRow(0);
-            }
-        }
-        else
-        {
-            // No groups left, clear the selection
-            groupList->clearSelection();
-        }
-    }
+    removeGroup(groupId);
 
     // Notify the user
     QMessageBox::information(
         this, tr("群组删除"),
         tr("群组 '%1' (ID: %2) 已删除或您已退出。").arg(groupName).arg(groupId));
 
-    qDebug() << "Group deleted: ID =" << groupId << ", Name =" << groupName;
-
+    qCDebug(lcUi) << "Group deleted: ID =" << groupId << ", Name =" << groupName;
 }
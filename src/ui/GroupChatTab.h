@@ -15,12 +15,14 @@
 #include <QHBoxLayout>
 #include <QListWidget>
 #include <QStackedWidget>
+#include <QTimer>
 
 #include <QMap>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QString>
 #include "GroupChatSession.h"
+#include "GroupRegistry.h"
 #include "utils/GroupTask.h"
 #include "utils/UserManager.h"
 
@@ -58,15 +60,26 @@ class GroupChatTab : public QWidget
     void on_removeMemberButton_clicked();
     // 会话列表选中
     void on_groupList_itemClicked(QListWidgetItem* item);
+    // 把长时间没有显示的会话控件释放回纯数据的形式
+    void releaseIdleSessions();
 
    private:
     void setupUi();
     void connectSignals();
     GroupChatSession* getOrCreateSession(long groupId, const QString& groupName, long creatorId,
-                                         const QJsonArray& userArray);  // qmap也是用groupId标识
+                                         const QJsonArray& userArray);  // 注册表也是用groupId标识
+    // 只创建群组数据和列表项, 不构造控件
+    GroupRegistry::GroupEntry& ensureGroup(long groupId, const QString& groupName, long creatorId,
+                                           const QJsonArray& members);
+    // 返回群组的会话控件, 不存在时才构造
+    GroupChatSession* sessionFor(GroupRegistry::GroupEntry& entry);
+    // 切换到某个群组, 同时清空它的未读数
+    void showGroup(GroupRegistry::GroupEntry& entry);
+    // 从注册表, 列表和堆栈中移除群组, 返回被移除的群组名称
+    QString removeGroup(long groupId);
     QString generateTaskId();
-    GroupTask* getGroupTask(const QString& type, long groupId, long operatorId,
-                            const QString& m_groupName, long userId);
+    GroupTask getGroupTask(const QString& type, long groupId, long operatorId,
+                           const QString& m_groupName, long userId);
 
     ChatClient* chatClient;
     QString nickname;  // 这里表示当前用户的nickname, 虽然可以通过UserInfo获取, 但还是保留
@@ -85,15 +98,16 @@ class GroupChatTab : public QWidget
     QPushButton* addMemberButton;
     QPushButton* removeMemberButton;
 
-    QMap<long, GroupChatSession*> sessionsMap;  // 用groupId标识
+    QTimer* idleSweepTimer;
+    GroupRegistry groups;  // 用groupId标识, 同时保存列表行, 未读数和活跃时间
 
     UserManager* userManager;
 
-    long curGroupId;
+    long curGroupId = -1;
 
     QString curGroupName;
 
-    long curGroupCreatorId;
+    long curGroupCreatorId = -1;
 
    signals:
     void createGroupRequested(long creatorId, const QString& groupName, const QString& operationId);
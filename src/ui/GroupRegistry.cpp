@@ -0,0 +1,82 @@
+// ui/GroupRegistry.cpp
+#include "GroupRegistry.h"
+#include <QFont>
+
+GroupListItem::GroupListItem(long groupId, const QString& text) : QListWidgetItem(text)
+{
+    setData(GroupIdRole, static_cast<qint64>(groupId));
+    setData(LastActivityRole, static_cast<qint64>(0));
+    setData(UnreadRole, 0);
+}
+
+bool GroupListItem::operator<(const QListWidgetItem& other) const
+{
+    qint64 lhs = data(LastActivityRole).toLongLong();
+    qint64 rhs = other.data(LastActivityRole).toLongLong();
+    if (lhs != rhs) return lhs < rhs;
+    // 活跃时间相同 (例如都还没有消息) 时按 id 排, 保证顺序稳定
+    return data(GroupIdRole).toLongLong() < other.data(GroupIdRole).toLongLong();
+}
+
+GroupRegistry::GroupEntry* GroupRegistry::find(long groupId)
+{
+    auto it = m_groups.find(groupId);
+    return it == m_groups.end() ? nullptr : &it.value();
+}
+
+const GroupRegistry::GroupEntry* GroupRegistry::find(long groupId) const
+{
+    auto it = m_groups.constFind(groupId);
+    return it == m_groups.constEnd() ? nullptr : &it.value();
+}
+
+GroupRegistry::GroupEntry& GroupRegistry::insert(const GroupEntry& entry)
+{
+    auto it = m_groups.insert(entry.groupId, entry);
+    refreshItem(it.value());
+    return it.value();
+}
+
+GroupRegistry::GroupEntry GroupRegistry::take(long groupId)
+{
+    return m_groups.take(groupId);
+}
+
+void GroupRegistry::recordActivity(long groupId, qint64 timestampMs, bool countUnread)
+{
+    GroupEntry* entry = find(groupId);
+    if (!entry) return;
+    entry->lastActivityMs = qMax(entry->lastActivityMs, timestampMs);
+    if (countUnread) entry->unreadCount++;
+    refreshItem(*entry);
+}
+
+void GroupRegistry::clearUnread(long groupId)
+{
+    GroupEntry* entry = find(groupId);
+    if (!entry || entry->unreadCount == 0) return;
+    entry->unreadCount = 0;
+    refreshItem(*entry);
+}
+
+void GroupRegistry::refreshItem(GroupEntry& entry)
+{
+    if (!entry.item || !entry.data) return;
+    QString name = internedString(entry.data->groupName);
+    QString text =
+        entry.unreadCount > 0 ? QString("%1 (%2)").arg(name).arg(entry.unreadCount) : name;
+
+    // 只有真正变化时才写入, 每次 setData 都会触发列表的重新排序和重绘
+    if (entry.item->text() != text) entry.item->setText(text);
+    if (entry.item->data(GroupListItem::UnreadRole).toInt() != entry.unreadCount)
+    {
+        entry.item->setData(GroupListItem::UnreadRole, entry.unreadCount);
+        QFont font = entry.item->font();
+        font.setBold(entry.unreadCount > 0);
+        entry.item->setFont(font);
+    }
+    if (entry.item->data(GroupListItem::LastActivityRole).toLongLong() != entry.lastActivityMs)
+    {
+        entry.item->setData(GroupListItem::LastActivityRole, entry.lastActivityMs);
+    }
+}
@@ -0,0 +1,69 @@
+// ui/GroupRegistry.h
+#ifndef GROUPREGISTRY_H
+#define GROUPREGISTRY_H
+
+#include <QHash>
+#include <QListWidgetItem>
+#include <QSharedPointer>
+#include <QString>
+#include "ChatSessionData.h"
+
+class GroupChatSession;
+
+// 群组列表项, 按最后活跃时间排序 (配合 QListWidget::setSortingEnabled 使用)
+// 数据变化时 QListWidget 只会把这一行移动到正确位置, 不会重新扫描整个列表
+class GroupListItem : public QListWidgetItem
+{
+   public:
+    enum DataRole
+    {
+        GroupIdRole = Qt::UserRole,           // 群组 id (qint64), 与之前的 Qt::UserRole 保持一致
+        LastActivityRole = Qt::UserRole + 1,  // 最后活跃时间 (毫秒时间戳)
+        UnreadRole = Qt::UserRole + 2         // 未读消息数
+    };
+
+    explicit GroupListItem(long groupId, const QString& text);
+
+    bool operator<(const QListWidgetItem& other) const override;
+};
+
+// 群组注册表: groupId -> 群组数据, 会话控件, 列表行以及元数据
+// 消息路由, 删除群组, 未读计数都是常数时间操作
+// session 只在群组被打开过之后才存在, 空闲一段时间后会被释放回纯数据的形式
+class GroupRegistry
+{
+   public:
+    struct GroupEntry
+    {
+        long groupId = 0;
+        QSharedPointer<GroupChatData> data;  // 名称, 群主, 成员和消息
+        GroupChatSession* session = nullptr;  // 懒加载的控件, 可能为空
+        GroupListItem* item = nullptr;  // 列表中的行, 排序后行号会变, 所以保存指针
+        int unreadCount = 0;
+        qint64 lastActivityMs = 0;
+        qint64 lastViewedMs = 0;  // 最后一次显示的时间, 用于释放空闲的控件
+    };
+
+    GroupEntry* find(long groupId);
+    const GroupEntry* find(long groupId) const;
+    bool contains(long groupId) const { return m_groups.contains(groupId); }
+    int size() const { return m_groups.size(); }
+
+    GroupEntry& insert(const GroupEntry& entry);
+    // 返回被移除的条目, 由调用者负责释放会话和列表项
+    GroupEntry take(long groupId);
+
+    // 记录一条新消息, countUnread 为 true 时增加未读数
+    void recordActivity(long groupId, qint64 timestampMs, bool countUnread);
+    void clearUnread(long groupId);
+
+    const QHash<long, GroupEntry>& entries() const { return m_groups; }
+    QHash<long, GroupEntry>& entries() { return m_groups; }
+
+   private:
+    void refreshItem(GroupEntry& entry);
+
+    QHash<long, GroupEntry> m_groups;
+};
+
+#endif  // GROUPREGISTRY_H
@@ -1,6 +1,7 @@
 #include "LoginWindow.h"
 
 #include "utils/ConfigManager.h"
+#include "utils/Logging.h"
 
 #include <QApplication>
 #include <QFormLayout>
@@ -170,7 +171,7 @@ void LoginWindow::handleLogin()
 
     // 如果已经有登录尝试正在进行，则直接返回，避免重复操作
     if (m_isLoginAttemptActive) {
-        qDebug() << "LoginWindow: 登录尝试已在进行中，忽略重复点击。";
+        qCDebug(lcUi) << "LoginWindow: 登录尝试已在进行中，忽略重复点击。";
         return;
     }
 
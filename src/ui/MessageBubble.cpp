@@ -15,13 +15,18 @@
 #include <QDir>
 #include <QMessageBox>
 #include <QProcess>
+#include "utils/Logging.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/Trace.h"
 
 // 构造函数，初始化消息气泡
 MessageBubble::MessageBubble(const QString& avatar, const QString& nickname,
                              const QJsonValue& content, const QString& timestamp, bool isOwn,
                              bool isFile, QWidget* parent)
-    : QWidget(parent), isOwnMessage(isOwn), isFileMessage(false)  // isFileMessage 初始为 false
+    : QWidget(parent), isOwnMessage(isOwn), isFileMessage(false),  // isFileMessage 初始为 false
+      traceId(Trace::currentId())
 {
+    MetricsRegistry::instance().gauge("ui.message_bubbles").add(1);
     // --- 统一初始化所有成员变量，确保它们不是野指针 ---
     // 这是关键改动，将QLabel和QProgressBar的new操作提到最前面
     avatarLabel = new QLabel(this);  // 传递this作为父对象，Qt会自动管理内存
@@ -183,7 +188,10 @@ MessageBubble::MessageBubble(const QString& avatar, const QString& nickname,
     adjustSize();
 }
 
-MessageBubble::~MessageBubble() {}
+MessageBubble::~MessageBubble()
+{
+    MetricsRegistry::instance().gauge("ui.message_bubbles").add(-1);
+}
 
 void MessageBubble::mousePressEvent(QMouseEvent* event)
 {
@@ -194,7 +202,7 @@ void MessageBubble::mousePressEvent(QMouseEvent* event)
     {
         if (!haveTransmitted)  // 只要没有传输, 就应该点击下载
         {
-            qDebug() << "Emitting fileMessageClicked with URL:" << fileUrl;
+            qCDebug(lcUi) << "Emitting fileMessageClicked with URL:" << fileUrl;
             emit fileMessageClicked(fileUrl, fileName, taskId);  // 下载接口
             progressBar->setVisible(true);
             this->setEnabled(false);
@@ -207,11 +215,21 @@ void MessageBubble::mousePressEvent(QMouseEvent* event)
     }
     else
     {
-        qDebug() << "Click not on content label or not a file message";
+        qCDebug(lcUi) << "Click not on content label or not a file message";
     }
     QWidget::mousePressEvent(event);
 }
 
+void MessageBubble::paintEvent(QPaintEvent* event)
+{
+    if (traceId != 0)
+    {
+        Trace::mark(Trace::Stage::Paint, traceId);
+        traceId = 0;
+    }
+    QWidget::paintEvent(event);
+}
+
 void MessageBubble::updateProgress(qint64 bytesProcessed, qint64 bytesTotal)
 {
     if (bytesTotal > 0)
@@ -272,7 +290,7 @@ void MessageBubble::updateFileInfo(const QJsonObject& fileInfo)
     contentLabel->style()->polish(contentLabel);
     contentLabel->update();
 
-    qDebug() << "File info updated, URL:" << fileUrl;
+    qCDebug(lcUi) << "File info updated, URL:" << fileUrl;
 }
 
 QString MessageBubble::formatFileSize(qint64 bytes)
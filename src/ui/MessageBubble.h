@@ -34,6 +34,7 @@ class MessageBubble : public QWidget
 
    protected:
     void mousePressEvent(QMouseEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
 
    signals:
     void fileMessageClicked(const QString& fileUrl, const QString& fileName, const QString& taskId);
@@ -57,6 +58,7 @@ class MessageBubble : public QWidget
     QString localFilePath;
     void openFileInExplorer(const QString& filePath);
     QString taskId;
+    quint64 traceId;  // 创建时正在处理的消息, 第一次绘制时记录一次 Trace::Stage::Paint
 };
 
 #endif  // MESSAGEBUBBLE_H
\ No newline at end of file
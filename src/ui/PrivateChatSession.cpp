@@ -8,31 +8,45 @@
 #include <QTimer>
 #include <QJsonParseError>
 #include "MessageBubble.h"
+#include "utils/Logging.h"
 #include "utils/UserInfo.h"
 #include "utils/ConfigManager.h"
 #include "FileTransferManager.h"
 #include "GlobalEventBus.h"
 #include <QUuid>
 
-PrivateChatSession::PrivateChatSession(ChatClient* client, const QString& curUsername_,
-                                       const QString& curNickname_, const QString& targetUsername_,
-                                       const QString& targetNickname_, QWidget* parent)
+PrivateChatSession::PrivateChatSession(ChatClient* client, QSharedPointer<PrivateChatData> data_,
+                                       const QString& curUsername_, const QString& curNickname_,
+                                       QWidget* parent)
     : QWidget(parent),
       chatClient(client),
-      curUsername(curUsername_),
-      curNickname(curNickname_),
-      targetUsername(targetUsername_),
-      targetNickname(targetNickname_),
+      data(std::move(data_)),
+      curUsernameId(internString(curUsername_)),
+      curNicknameId(internString(curNickname_)),
+      targetUsernameId(data->targetUsername),
+      targetNicknameId(data->targetNickname),
       httpHost(ConfigManager::instance().httpHost()),
       httpPort(ConfigManager::instance().httpPort())
 {
-    setObjectName("PrivateChatSession_" + targetUsername);
+    setObjectName("PrivateChatSession_" + internedString(targetUsernameId));
     setupUi();
     connectSignals();
+
+    // 重建之前收到的消息, 最后只加一次拉伸
+    for (int index = 0; index < data->messages.size(); ++index)
+    {
+        addBubble(index);
+    }
+    if (QVBoxLayout* layout = qobject_cast<QVBoxLayout*>(privateChatContainer->layout()))
+    {
+        layout->addStretch();
+    }
 }
 
 void PrivateChatSession::setupUi()
 {
+    const QString targetUsername = internedString(targetUsernameId);
+
     // 初始化主布局
     QVBoxLayout* layout = new QVBoxLayout(this);
     layout->setContentsMargins(8, 8, 8, 8);
@@ -102,9 +116,9 @@ void PrivateChatSession::sendPrivateMessage()
         QMessageBox::warning(this, "错误", "消息内容不能超过1000字节");
         return;
     }
-    emit sendMessageRequested(targetUsername, content);
+    emit sendMessageRequested(internedString(targetUsernameId), content);
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
-    appendMessage(curUsername, targetUsername, content, timestamp, false);
+    appendMessage(curUsernameId, content, timestamp, false);
     privateMessageInput->clear();
 }
 
@@ -134,7 +148,8 @@ void PrivateChatSession::sendFile()
 
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
 
-    appendMessage(curUsername, targetUsername, fileInfoObj, timestamp, true);
+    appendMessage(curUsernameId, fileInfoObj, timestamp, true);
+    activeTransfers.insert(taskId);
 
     // 准备上传URL
     QUrl uploadUrl;
@@ -144,8 +159,8 @@ void PrivateChatSession::sendFile()
     uploadUrl.setPath("/api/files/upload");
 
     // 发起上传
-    FileTransferManager::instance().uploadFile(targetUsername, filePath, uploadUrl,
-                                               UserInfo::instance().token(), taskId);
+    FileTransferManager::instance().uploadFile(internedString(targetUsernameId), filePath,
+                                               uploadUrl, UserInfo::instance().token(), taskId);
 }
 
 void PrivateChatSession::onFileMessageClicked(const QString& fileUrl,
@@ -164,6 +179,7 @@ void PrivateChatSession::onFileMessageClicked(const QString& fileUrl,
     MessageBubble* bubble = fileMessageMap.value(taskId);
     bubble->setLocalFilePath(savePath);
     bubble->setEnabled(false);
+    activeTransfers.insert(taskId);
     // 下载过程中不可以修改外观
     // 发起下载
     FileTransferManager::instance().downloadFile(QUrl(fileUrl), savePath,
@@ -174,6 +190,8 @@ void PrivateChatSession::onFileMessageClicked(const QString& fileUrl,
 void PrivateChatSession::onUploadFinished(bool success, const QString& taskId,
                                           const QString& localFilePath, const QByteArray& response)
 {
+    // 先结束任务再检查气泡, 否则没有气泡的任务会一直留着, 控件永远不能释放
+    activeTransfers.remove(taskId);
     MessageBubble* bubble = fileMessageMap.value(taskId);
     if (!bubble) return;
 
@@ -202,6 +220,8 @@ void PrivateChatSession::onUploadFinished(bool success, const QString& taskId,
     bubble->setTranmittingStatus(true);
     bubble->updateStatus("已发送");
     bubble->updateFileInfo(fileInfoObj);
+    // 回写到数据中, 控件重建后仍然可以下载
+    data->updateFileRecord(taskId, fileInfoObj);
 
     fileMessageMap.remove(taskId);
 }
@@ -210,11 +230,15 @@ void PrivateChatSession::onDownloadTaskFinished(bool success, const QString& tas
                                                 const QString& savedFilePath,
                                                 const QString& errorString)
 {
+    activeTransfers.remove(taskId);
+    int recordIndex = fileRecordIndex.value(taskId, -1);
     // 可能是因为没有这个taskId?
     MessageBubble* bubble = fileMessageMap.value(taskId);
     if (!bubble) return;
     if (success)
     {
+        // 回写到数据中, 控件重建后仍然显示为已下载
+        if (recordIndex >= 0) data->markFileDownloaded(recordIndex, savedFilePath);
         bubble->updateStatus("已下载");
         bubble->setEnabled(true);
         // 这里启用bubble的交互
@@ -253,6 +277,7 @@ void PrivateChatSession::onDownloadProgressUpdated(const QString& taskId, qint64
 void PrivateChatSession::cancelFileTransfer(const QString& taskId)
 {
     FileTransferManager::instance().cancelTask(taskId);
+    activeTransfers.remove(taskId);
     MessageBubble* bubble = fileMessageMap.value(taskId);
     if (bubble)
     {
@@ -269,8 +294,10 @@ void PrivateChatSession::handleFileReceived(const QString& sender, const QString
     // 问题是当前是const, 不可以修改, 需要创建可修改的副本
     QJsonObject modifiedFileInfo = fileInfo;  // 创建副本
     QString fileUrl = modifiedFileInfo["fileUrl"].toString();
+    // 会话里的消息只可能来自自己或对方, 两者都已经驻留, 只需要查找
+    const bool isOwn = StringPool::instance().find(sender) == curUsernameId;
 
-    if (sender == curUsername)
+    if (isOwn)
     {  // 当前用户是发送者, 判定为已经上传, 来自服务器存储的历史记录
         modifiedFileInfo["isSender"] = true;
         modifiedFileInfo["haveTransmitted"] = true;
@@ -283,19 +310,20 @@ void PrivateChatSession::handleFileReceived(const QString& sender, const QString
 
     modifiedFileInfo["taskId"] = generateTaskId(fileUrl, false);  // 这里使用的taskId将会在后续使用
 
-    appendMessage(sender, receiver, modifiedFileInfo, timestamp, true);
+    appendMessage(isOwn ? curUsernameId : targetUsernameId, modifiedFileInfo, timestamp, true);
 }
 
 // 注意content需要包含状态
 // 这里删除了taskId, 包含在content中
-void PrivateChatSession::appendMessage(const QString& sender, const QString& receiver,
-                                       const QJsonValue& content, const QString& timestamp,
-                                       bool isFile)
+void PrivateChatSession::appendMessage(StringId senderId, const QJsonValue& content,
+                                       const QString& timestamp, bool isFile)
 {
+    data->appendMessage(senderId, content, timestamp, isFile);
+
     QVBoxLayout* layout = qobject_cast<QVBoxLayout*>(privateChatContainer->layout());
     if (!layout)
     {
-        qWarning() << "无效的容器布局:" << targetUsername;
+        qCWarning(lcUi) << "无效的容器布局:" << getTargetUser();
         return;
     }
 
@@ -308,31 +336,54 @@ void PrivateChatSession::appendMessage(const QString& sender, const QString& rec
             delete item;
         }
     }
-    QString displaySender = (sender == curUsername) ? curNickname : targetNickname;
 
-    QJsonObject modifiedFileInfo;
+    addBubble(data->messages.size() - 1);
+
+    layout->addStretch();
+
+    privateChatDisplay->viewport()->update();
+    // 使用 QTimer::singleShot 延迟执行，确保布局已经计算出新的 maximum() 值
+    QTimer::singleShot(0, privateChatDisplay,  // 延迟设为0，表示尽快执行
+                       [=]()
+                       {
+                           privateChatDisplay->verticalScrollBar()->setValue(
+                               privateChatDisplay->verticalScrollBar()->maximum());
+                       });
+
+    // QTimer::singleShot(10, ...) 这里的10ms延迟是为了确保布局计算完成，
+    // 如果设置为0，Qt会尽可能快地执行，通常也足够了。
+    // 如果偶尔出现滚动不到底的情况，再适当增加延迟。
+}
 
-    QString taskId = "";
+void PrivateChatSession::addBubble(int index)
+{
+    const ChatMessageRecord& record = data->messages.at(index);
+    const QJsonValue& content = record.content;
+    const QString& timestamp = record.timestamp;
+    const bool isFile = record.isFile;
+    const bool isOwn = (record.senderUsername == curUsernameId);
+    QString displaySender = internedString(isOwn ? curNicknameId : targetNicknameId);
 
     MessageBubble* bubble;
 
     // handleFileReceived的逻辑迁移到这里了
     if (isFile && content.isObject())
     {
-        modifiedFileInfo = content.toObject();
-        // qDebug() << modifiedFileInfo;
+        QJsonObject modifiedFileInfo = content.toObject();
         QString fileUrl = modifiedFileInfo["fileUrl"].toString();
 
-        if (sender == curUsername)
+        // 在这个客户端上下载过的文件保持已下载, 可以直接打开本地文件
+        bool downloaded = modifiedFileInfo["downloaded"].toBool();
+        if (isOwn)
         {  // ! change
             // 修改为从历史消息中加载, 重新下载一遍
             modifiedFileInfo["isSender"] = true;
-            modifiedFileInfo["haveTransmitted"] = false;
+            modifiedFileInfo["haveTransmitted"] = downloaded;
         }
         else
         {  // 当前是接收者, 认为没有下载
             modifiedFileInfo["isSender"] = false;
-            modifiedFileInfo["haveTransmitted"] = false;
+            modifiedFileInfo["haveTransmitted"] = downloaded;
         }
 
         // 有两种可能, 可能在sendFile中设置了
@@ -344,8 +395,8 @@ void PrivateChatSession::appendMessage(const QString& sender, const QString& rec
         QString taskId = modifiedFileInfo["taskId"].toString();
 
         modifiedFileInfo["type"] = "file";
-        bubble = new MessageBubble("", displaySender, modifiedFileInfo, timestamp,
-                                   sender == curUsername, isFile, privateChatContainer);
+        bubble = new MessageBubble("", displaySender, modifiedFileInfo, timestamp, isOwn, isFile,
+                                   privateChatContainer);
         connect(bubble, &MessageBubble::fileMessageClicked, this,
                 &PrivateChatSession::onFileMessageClicked);
 
@@ -353,44 +404,17 @@ void PrivateChatSession::appendMessage(const QString& sender, const QString& rec
         {
             // 这里直接加入即可
             fileMessageMap.insert(taskId, bubble);
+            fileRecordIndex.insert(taskId, index);
         }
     }
     else
     {
-        bubble = new MessageBubble("", displaySender, content, timestamp, sender == curUsername,
-                                   isFile, privateChatContainer);
+        // 这里把content的类型判断交给MessageBubble处理了
+        bubble = new MessageBubble("", displaySender, content, timestamp, isOwn, isFile,
+                                   privateChatContainer);
     }
-    // 最傻的是这个bubble出错了
-    // 这里把content的类型判断交给MessageBubble处理了
-    // 这个content需要包含状态
-
-    // bool isSender = obj["isSender"].toBool();
-    // bool haveTransmitted = obj["haveTransmitted"].toBool();
-
-    // if(isSender && !haveTransmitted){
-    //     bubble->setEnabled(false); // 上传, 暂时关闭点击的选项
-    // }
-
-    layout->addWidget(bubble);
 
-    layout->addStretch();
-
-    // 滚动条逻辑并不智能
-    bool isAtBottom = privateChatDisplay->verticalScrollBar()->value() >=
-                      privateChatDisplay->verticalScrollBar()->maximum() - 20;
-
-    privateChatDisplay->viewport()->update();
-    // 使用 QTimer::singleShot 延迟执行，确保布局已经计算出新的 maximum() 值
-    QTimer::singleShot(0, privateChatDisplay,  // 延迟设为0，表示尽快执行
-                       [=]()
-                       {
-                           privateChatDisplay->verticalScrollBar()->setValue(
-                               privateChatDisplay->verticalScrollBar()->maximum());
-                       });
-
-    // QTimer::singleShot(10, ...) 这里的10ms延迟是为了确保布局计算完成，
-    // 如果设置为0，Qt会尽可能快地执行，通常也足够了。
-    // 如果偶尔出现滚动不到底的情况，再适当增加延迟。
+    privateChatContainer->layout()->addWidget(bubble);
 }
 
 QString PrivateChatSession::formatFileSize(qint64 fileSize)
@@ -11,20 +11,33 @@
 #include <QWidget>
 #include <QJsonObject>
 #include <QMap>
+#include <QSet>
+#include <QSharedPointer>
+#include "utils/StringPool.h"
+#include "ChatSessionData.h"
 
 // 私聊会话类，管理聊天UI和文件传输
+// 消息保存在 PrivateChatData 中, 控件在第一次打开时构造, 空闲时可以被释放
 class PrivateChatSession : public QWidget
 {
     Q_OBJECT
 
    public:
-    explicit PrivateChatSession(ChatClient* client, const QString& curUsername_,
-                                const QString& curNickname_, const QString& targetUsername_,
-                                const QString& targetNickname_, QWidget* parent = nullptr);
-    void appendMessage(const QString& sender, const QString& receiver, const QJsonValue& content,
-                       const QString& timestamp, bool isFile);
+    // 构造时会根据 data 中已有的消息重建气泡
+    explicit PrivateChatSession(ChatClient* client, QSharedPointer<PrivateChatData> data_,
+                                const QString& curUsername_, const QString& curNickname_,
+                                QWidget* parent = nullptr);
+    // sender 使用驻留 id, 判断是否是自己发的消息只需要整数比较
+    // 消息同时写入 PrivateChatData
+    void appendMessage(StringId senderId, const QJsonValue& content, const QString& timestamp,
+                       bool isFile);
 
-    QString getTargetUser() const { return targetUsername; }
+    QString getTargetUser() const { return internedString(targetUsernameId); }
+    StringId getTargetUserId() const { return targetUsernameId; }
+
+    // 有未发送的输入或者正在进行的文件传输时, 不能释放控件
+    bool hasDraft() const { return !privateMessageInput->text().isEmpty(); }
+    bool hasActiveTransfers() const { return !activeTransfers.isEmpty(); }
 
    public slots:
     void scrollToBottom();  // 新增的公共槽
@@ -52,12 +65,15 @@ class PrivateChatSession : public QWidget
     void connectSignals();
     QString formatFileSize(qint64 fileSize);
     QString generateTaskId(const QString& filePath, bool isUpload);
+    // 为 data->messages[index] 创建气泡, 不处理末尾的拉伸和滚动, 重建历史时批量调用
+    void addBubble(int index);
 
     ChatClient* chatClient;
-    QString curUsername;
-    QString curNickname;
-    QString targetUsername;
-    QString targetNickname;
+    QSharedPointer<PrivateChatData> data;
+    StringId curUsernameId;
+    StringId curNicknameId;
+    StringId targetUsernameId;
+    StringId targetNicknameId;
 
     // 组件
     QScrollArea* privateChatDisplay;
@@ -68,6 +84,8 @@ class PrivateChatSession : public QWidget
     QString httpHost;
     quint16 httpPort;
     QMap<QString, MessageBubble*> fileMessageMap;
+    QSet<QString> activeTransfers;  // 已经发起, 还没有结束的上传/下载任务
+    QHash<QString, int> fileRecordIndex;  // 文件气泡的任务 id -> 消息下标, 下载完成时回写
 };
 
 #endif  // PRIVATECHATSESSION_H
\ No newline at end of file
@@ -1,5 +1,6 @@
 // ui/PrivateChatTab.cpp
 #include "PrivateChatTab.h"
+#include "utils/Logging.h"
 #include <QDateTime>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -13,10 +14,13 @@
 #include "GlobalEventBus.h"
 #include "network/ChatClient.h"
 
+const int IDLE_SWEEP_INTERVAL = 60000;        // 每分钟检查一次空闲的会话控件
+const qint64 IDLE_SESSION_TIMEOUT = 300000;   // 5 分钟没有显示过的会话释放回纯数据
+
 // 定义列表项数据角色
 enum UserListItemDataRole
 {
-    UsernameRole = Qt::UserRole,       // 存储用户的username (QString)
+    UsernameRole = Qt::UserRole,       // 存储用户username的驻留id (StringId)
     UserIdRole = Qt::UserRole + 1,     // 存储用户的user_id (long)
     UserStatusRole = Qt::UserRole + 2  // 存储用户的状态 (int, 对应User::UserStatus)
 };
@@ -25,13 +29,18 @@ PrivateChatTab::PrivateChatTab(ChatClient* client, const QString& username, cons
                                UserManager* userManager_, QWidget* parent)
     : QWidget(parent),
       chatClient(client),
-      curUsername(username),
+      curUsernameId(internString(username)),
       curNickname(nickname),
       userManager(userManager_)  // 初始化userManager成员
 {
     setupUi();
     connectSignals();
 
+    idleSweepTimer = new QTimer(this);
+    idleSweepTimer->setInterval(IDLE_SWEEP_INTERVAL);
+    connect(idleSweepTimer, &QTimer::timeout, this, &PrivateChatTab::releaseIdleSessions);
+    idleSweepTimer->start();
+
     // 初始时不需要调用 refreshUserLists(); 等待 usersInitialized 信号
 }
 
@@ -112,102 +121,141 @@ void PrivateChatTab::connectSignals()
 void PrivateChatTab::handleUserSelected(QListWidgetItem* item)
 {
     if (!item) return;
-    QString targetUsername = item->data(UsernameRole).toString();
+    StringId targetUsernameId = item->data(UsernameRole).value<StringId>();
 
     QListWidgetItem* currentSessionItem = sessionList->currentItem();
-    if (currentSessionItem && currentSessionItem->data(UsernameRole).toString() == targetUsername)
+    if (currentSessionItem &&
+        currentSessionItem->data(UsernameRole).value<StringId>() == targetUsernameId)
     {
         return;
     }
-    PrivateChatSession* session = getOrCreateSession(targetUsername);
+    SessionEntry* entry = ensureSession(targetUsernameId);
 
-    if (session)
+    if (entry)
     {
-        session->scrollToBottom();
-        for (int i = 0; i < sessionList->count(); ++i)
-        {
-            if (sessionList->item(i)->data(UsernameRole).toString() == targetUsername)
-            {
-                sessionList->setCurrentItem(sessionList->item(i));
-                break;
-            }
-        }
+        sessionList->setCurrentItem(entry->item);
+        showSession(*entry);
     }
 }
 
 void PrivateChatTab::handleSessionSelected(QListWidgetItem* item)
 {
     if (!item) return;
-    QString targetUsername = item->data(UsernameRole).toString();
-
-    PrivateChatSession* session = sessions.value(targetUsername, nullptr);
+    StringId targetUsernameId = item->data(UsernameRole).value<StringId>();
 
-    if (session)
+    auto it = sessions.find(targetUsernameId);
+    if (it != sessions.end())
     {
-        sessionStack->setCurrentWidget(session);
-        session->scrollToBottom();
+        showSession(it.value());
     }
 }
 
-PrivateChatSession* PrivateChatTab::getOrCreateSession(const QString& targetUsername)
+void PrivateChatTab::showSession(SessionEntry& entry)
+{
+    PrivateChatSession* session = sessionFor(entry);
+    sessionStack->setCurrentWidget(session);
+    entry.lastViewedMs = QDateTime::currentMSecsSinceEpoch();
+    session->scrollToBottom();
+}
+
+PrivateChatSession* PrivateChatTab::sessionFor(SessionEntry& entry)
+{
+    if (entry.session) return entry.session;
+
+    // 第一次打开 (或者被释放之后再次打开) 时才构造控件
+    PrivateChatSession* session = new PrivateChatSession(
+        chatClient, entry.data, internedString(curUsernameId), curNickname, this);
+    sessionStack->addWidget(session);
+    connect(session, &PrivateChatSession::sendMessageRequested, this,
+            [=](const QString& target, const QString& content)
+            { chatClient->sendPrivateMessage(target, content); });
+    entry.session = session;
+    return session;
+}
+
+PrivateChatTab::SessionEntry* PrivateChatTab::ensureSession(StringId targetUsernameId)
 {
-    if (targetUsername == curUsername)
+    if (targetUsernameId == curUsernameId)
     {
-        qDebug() << "不能与自己创建会话: " << targetUsername;
+        qCDebug(lcUi) << "不能与自己创建会话: " << internedString(targetUsernameId);
         return nullptr;
     }
-    if (sessions.contains(targetUsername))
+    auto it = sessions.find(targetUsernameId);
+    if (it != sessions.end())
     {
-        return sessions[targetUsername];
+        return &it.value();
     }
     // 从UserManager获取用户信息
-    User* targetUser = userManager->getUserByUsername(targetUsername);
+    User* targetUser = userManager->getUserByUsernameId(targetUsernameId);
     if (!targetUser)
     {
-        qWarning() << "无法找到用户: " << targetUsername << "来创建会话。";
+        qCWarning(lcUi) << "无法找到用户: " << internedString(targetUsernameId) << "来创建会话。";
         return nullptr;
     }
+    QString targetUsername = targetUser->getUsername();
     QString targetNickname = targetUser->getNickname();
 
-    PrivateChatSession* session = new PrivateChatSession(chatClient, curUsername, curNickname,
-                                                         targetUsername, targetNickname, this);
-    sessions[targetUsername] = session;
-
-    sessionStack->addWidget(session);
+    SessionEntry entry;
+    entry.data = QSharedPointer<PrivateChatData>::create(targetUsernameId,
+                                                         targetUser->getNicknameId());
 
     QString displayText = targetNickname.isEmpty() ? targetUsername : targetNickname;
-    QListWidgetItem* item = new QListWidgetItem(displayText);
-    item->setData(UsernameRole, targetUsername);  // 存储username
-    sessionList->addItem(item);
-    sessionList->setCurrentItem(item);
+    entry.item = new QListWidgetItem(displayText);
+    entry.item->setData(UsernameRole, targetUsernameId);  // 存储username的驻留id
+    sessionList->addItem(entry.item);
 
-    sessionStack->setCurrentWidget(session);
-    session->scrollToBottom();
-
-    connect(session, &PrivateChatSession::sendMessageRequested, this,
-            [=](const QString& target, const QString& content)
-            { chatClient->sendPrivateMessage(target, content); });
-    return session;
+    return &sessions.insert(targetUsernameId, entry).value();
 }
 
-PrivateChatSession* PrivateChatTab::getOrCreateSessionTwo(const QString& sender,
-                                                          const QString& receiver)
+PrivateChatTab::SessionEntry* PrivateChatTab::ensureSessionTwo(StringId senderId,
+                                                               StringId receiverId)
 {
-    QString targetUsername;
-    if (sender == curUsername)
-        targetUsername = receiver;
+    StringId targetUsernameId;
+    if (senderId == curUsernameId)
+        targetUsernameId = receiverId;
     else
-        targetUsername = sender;
-    return getOrCreateSession(targetUsername);
+        targetUsernameId = senderId;
+    return ensureSession(targetUsernameId);
 }
 
 void PrivateChatTab::appendMessage(const QString& sender, const QString& receiver,
                                    const QJsonValue& content, const QString& timestamp, bool isFile)
 {
-    PrivateChatSession* session = getOrCreateSessionTwo(sender, receiver);
-    if (session)
+    // 只查找不驻留: 会话只为 UserManager 中已知的用户建立, 他们的用户名已经在池子里,
+    // 查不到说明消息来自未知用户, 网络上的任意字符串不会进入只增不减的池子
+    StringPool& pool = StringPool::instance();
+    StringId senderId = pool.find(sender);
+    StringId receiverId = pool.find(receiver);
+    if (senderId == StringPool::InvalidId || receiverId == StringPool::InvalidId)
+    {
+        qCWarning(lcUi) << "私聊消息涉及未知用户, 已忽略:" << sender << "->" << receiver;
+        return;
+    }
+    SessionEntry* entry = ensureSessionTwo(senderId, receiverId);
+    if (!entry) return;
+
+    // 还没有打开过的会话只记录数据
+    if (entry->session)
+        entry->session->appendMessage(senderId, content, timestamp, isFile);
+    else
+        entry->data->appendMessage(senderId, content, timestamp, isFile);
+}
+
+void PrivateChatTab::releaseIdleSessions()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QWidget* current = sessionStack->currentWidget();
+    for (SessionEntry& entry : sessions)
     {
-        session->appendMessage(sender, receiver, content, timestamp, isFile);
+        PrivateChatSession* session = entry.session;
+        if (!session || session == current) continue;
+        // 文件传输的进度要更新到气泡上, 传输结束之前保留控件
+        if (session->hasDraft() || session->hasActiveTransfers()) continue;
+        if (now - entry.lastViewedMs < IDLE_SESSION_TIMEOUT) continue;
+
+        sessionStack->removeWidget(session);
+        session->deleteLater();
+        entry.session = nullptr;
     }
 }
 
@@ -227,7 +275,7 @@ void PrivateChatTab::addUserToListUI(User* user)
             break;
         case User::Busy:
             targetList = onlineUsersList;  // 假设忙碌用户也显示在在线列表，可以根据需求调整
-            qDebug() << "User " << user->getUsername() << " is busy.";
+            qCDebug(lcUi) << "User " << user->getUsername() << " is busy.";
             break;
         default:
             return;  // 未知状态不处理
@@ -246,7 +294,7 @@ void PrivateChatTab::addUserToListUI(User* user)
 
     QString displayText = QString("%1 (%2)").arg(user->getNickname()).arg(user->getUsername());
     QListWidgetItem* item = new QListWidgetItem(displayText, targetList);
-    item->setData(UsernameRole, user->getUsername());                    // 存储username
+    item->setData(UsernameRole, user->getUsernameId());                  // 存储username的驻留id
     item->setData(UserIdRole, static_cast<qint64>(user->getUserId()));   // 存储user_id
     item->setData(UserStatusRole, static_cast<int>(user->getStatus()));  // 存储状态
 
@@ -292,7 +340,7 @@ void PrivateChatTab::removeUserFromListUI(long userId, QListWidget* targetList)
 void PrivateChatTab::onUsersInitialized()
 {
     refreshUserLists();  // 收到初始化信号后，刷新整个列表
-    qDebug() << "PrivateChatTab: Received usersInitialized signal. Refreshing UI.";
+    qCDebug(lcUi) << "PrivateChatTab: Received usersInitialized signal. Refreshing UI.";
 }
 
 // **响应 UserManager::userStatusChanged 信号**
@@ -4,13 +4,17 @@
 
 #include <QWidget>
 #include <QMap>
+#include <QHash>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QListWidget>
 #include <QStackedWidget>
 #include <QSplitter>
+#include <QSharedPointer>
+#include <QTimer>
 
 #include "utils/UserManager.h"  // 包含UserManager和User类
+#include "ChatSessionData.h"
 
 class ChatClient;
 class PrivateChatSession;
@@ -28,11 +32,23 @@ class PrivateChatTab : public QWidget
                        const QString& timestamp, bool isFile);
 
    private:
+    // 一个私聊会话: 数据常驻, 控件只在打开过之后才存在
+    struct SessionEntry
+    {
+        QSharedPointer<PrivateChatData> data;
+        PrivateChatSession* session = nullptr;  // 懒加载的控件, 可能为空
+        QListWidgetItem* item = nullptr;        // 会话列表中的行
+        qint64 lastViewedMs = 0;                // 最后一次显示的时间, 用于释放空闲的控件
+    };
+
     void setupUi();
     void connectSignals();
-    PrivateChatSession* getOrCreateSession(
-        const QString& targetUsername);  // 保持targetUsername为字符串
-    PrivateChatSession* getOrCreateSessionTwo(const QString& sender, const QString& receiver);
+    // 只创建会话数据和列表项, 不构造控件. 对自己或者未知用户返回 nullptr
+    SessionEntry* ensureSession(StringId targetUsernameId);  // 使用驻留的username id
+    SessionEntry* ensureSessionTwo(StringId senderId, StringId receiverId);
+    // 返回会话控件, 不存在时才构造
+    PrivateChatSession* sessionFor(SessionEntry& entry);
+    void showSession(SessionEntry& entry);
 
     // 辅助函数，用于根据UserManager的信号更新UI列表
     void refreshUserLists();  // 初始或大幅度变更时刷新
@@ -50,11 +66,15 @@ class PrivateChatTab : public QWidget
     void onUserStatusChanged(User* user);  // 某个用户状态发生变化
     void onUserAdded(User* user);          // 新用户被添加
 
+    // 把长时间没有显示的会话控件释放回纯数据的形式
+    void releaseIdleSessions();
+
    private:
     ChatClient* chatClient;
-    QString curUsername;
+    StringId curUsernameId;
     QString curNickname;
-    QMap<QString, PrivateChatSession*> sessions;  // 键是用户名
+    QHash<StringId, SessionEntry> sessions;  // 键是驻留的用户名 id
+    QTimer* idleSweepTimer;
 
     UserManager* userManager;  // 存储 UserManager 指针
     QListWidget* onlineUsersList;
@@ -1,4 +1,5 @@
 #include "PublicChatTab.h"
+#include "utils/Logging.h"
 #include <QDateTime>
 #include <QHBoxLayout>
 #include <QMessageBox>
@@ -80,7 +81,7 @@ void PublicChatTab::appendMessage(const QString& sender, const QString& content,
     QVBoxLayout* layout = qobject_cast<QVBoxLayout*>(publicChatContainer->layout());
     if (!layout)
     {
-        qDebug() << "PublicChatTab: Invalid container layout";
+        qCDebug(lcUi) << "PublicChatTab: Invalid container layout";
         return;
     }
 
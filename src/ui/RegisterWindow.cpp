@@ -1,6 +1,7 @@
 #include "RegisterWindow.h"
 
 #include "utils/ConfigManager.h"
+#include "utils/Logging.h"
 
 #include <QApplication>
 #include <QFormLayout>
@@ -182,7 +183,7 @@ void RegisterWindow::handleRegister()
 
     // --- 核心修改：注册尝试状态管理 ---
     if (m_isRegisterAttemptActive) {
-        qDebug() << "RegisterWindow: 注册尝试已在进行中，忽略重复点击。";
+        qCDebug(lcUi) << "RegisterWindow: 注册尝试已在进行中，忽略重复点击。";
         return;
     }
 
@@ -1,5 +1,7 @@
 #include "ConfigManager.h"
+#include "Logging.h"
 #include <QFile>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QDebug>
@@ -15,7 +17,7 @@ bool ConfigManager::loadConfig(const QString& filePath)
 {
     QFile configFile(filePath);
     if (!configFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "无法打开配置文件:" << filePath;
+        qCWarning(lcConfig) << "无法打开配置文件:" << filePath;
         // 如果无法加载，设置默认值，这样应用仍可启动
         m_tcpHost = "127.0.0.1";
         m_tcpPort = 9999;
@@ -32,7 +34,7 @@ bool ConfigManager::loadConfig(const QString& filePath)
     QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
 
     if (parseError.error != QJsonParseError::NoError) {
-        qWarning() << "配置文件解析错误:" << parseError.errorString();
+        qCWarning(lcConfig) << "配置文件解析错误:" << parseError.errorString();
         // 解析失败也设置默认值
         m_tcpHost = "127.0.0.1";
         m_tcpPort = 9999;
@@ -55,10 +57,27 @@ bool ConfigManager::loadConfig(const QString& filePath)
     if (tcpPortDouble >= 0 && tcpPortDouble <= 65535 && (qAbs(tcpPortDouble - qRound(tcpPortDouble)) < 0.0001)) { // 检查是否是整数且在有效范围
         m_tcpPort = static_cast<quint16>(qRound(tcpPortDouble));
     } else {
-        qWarning() << "TCP 端口配置无效 (" << tcpPortDouble << ")，使用默认值 9999";
+        qCWarning(lcConfig) << "TCP 端口配置无效 (" << tcpPortDouble << ")，使用默认值 9999";
         m_tcpPort = 9999;
     }
 
+    // 备用地址: "endpoints": [{"host": "::1", "port": 9999}, {"host": "gw2.example.com"}]
+    // 省略 port 时使用主地址的端口
+    m_extraTcpEndpoints.clear();
+    const QJsonArray endpointArray = tcpConfig.value("endpoints").toArray();
+    for (const QJsonValue& value : endpointArray) {
+        QJsonObject endpointConfig = value.toObject();
+        ServerEndpoint endpoint;
+        endpoint.host = endpointConfig.value("host").toString().trimmed();
+        int endpointPort = endpointConfig.value("port").toInt(m_tcpPort);
+        if (endpoint.host.isEmpty() || endpointPort <= 0 || endpointPort > 65535) {
+            qCWarning(lcConfig) << "忽略无效的 TCP 备用地址配置:" << value;
+            continue;
+        }
+        endpoint.port = static_cast<quint16>(endpointPort);
+        m_extraTcpEndpoints.append(endpoint);
+    }
+
 
     // 解析HTTP配置
     QJsonObject httpConfig = config.value("http").toObject();
@@ -69,15 +88,28 @@ bool ConfigManager::loadConfig(const QString& filePath)
     if (httpPortDouble >= 0 && httpPortDouble <= 65535 && (qAbs(httpPortDouble - qRound(httpPortDouble)) < 0.0001)) { // 检查是否是整数且在有效范围
         m_httpPort = static_cast<quint16>(qRound(httpPortDouble));
     } else {
-        qWarning() << "HTTP 端口配置无效 (" << httpPortDouble << ")，使用默认值 8080";
+        qCWarning(lcConfig) << "HTTP 端口配置无效 (" << httpPortDouble << ")，使用默认值 8080";
         m_httpPort = 8080;
     }
 
     m_apiPrefix = config.value("apiPrefix").toString("/api"); // 假设 apiPrefix 是顶层字段
 
-    qDebug() << "Config loaded: TCP Host=" << m_tcpHost << ", TCP Port=" << m_tcpPort
-             << ", HTTP Host=" << m_httpHost << ", HTTP Port=" << m_httpPort
-             << ", API Prefix=" << m_apiPrefix;
+    qCDebug(lcConfig) << "Config loaded: TCP Host=" << m_tcpHost << ", TCP Port=" << m_tcpPort
+                      << ", HTTP Host=" << m_httpHost << ", HTTP Port=" << m_httpPort
+                      << ", API Prefix=" << m_apiPrefix
+                      << ", Extra TCP Endpoints=" << m_extraTcpEndpoints.size();
 
     return true;
+}
+
+QList<ServerEndpoint> ConfigManager::tcpEndpoints() const
+{
+    QList<ServerEndpoint> endpoints;
+    endpoints.append({m_tcpHost, m_tcpPort});
+    for (const ServerEndpoint& endpoint : m_extraTcpEndpoints) {
+        if (!endpoints.contains(endpoint)) {
+            endpoints.append(endpoint);
+        }
+    }
+    return endpoints;
 }
\ No newline at end of file
@@ -1,8 +1,22 @@
 #pragma once
 #include <QString>
 #include <QJsonObject>
+#include <QList>
 #include <QtGlobal> // 引入 quint16 类型
 
+// 一个 TCP 服务器地址, host 可以是域名、IPv4 或 IPv6 地址
+struct ServerEndpoint
+{
+    QString host;
+    quint16 port = 0;
+
+    QString key() const { return host + ':' + QString::number(port); }
+    bool operator==(const ServerEndpoint& other) const
+    {
+        return port == other.port && host.compare(other.host, Qt::CaseInsensitive) == 0;
+    }
+};
+
 class ConfigManager
 {
 public:
@@ -16,6 +30,8 @@ public:
     QString httpHost() const { return m_httpHost; }
     quint16 httpPort() const { return m_httpPort; } // 返回 quint16
     QString apiPrefix() const { return m_apiPrefix; }
+    // 所有 TCP 服务器地址, 第一个总是 tcpHost:tcpPort, 之后是 tcp.endpoints 中配置的备用地址
+    QList<ServerEndpoint> tcpEndpoints() const;
 
     // Setters - 新增，用于从命令行参数更新配置
     void setTcpHost(const QString& host) { m_tcpHost = host; }
@@ -23,6 +39,7 @@ public:
     void setHttpHost(const QString& host) { m_httpHost = host; }
     void setHttpPort(quint16 port) { m_httpPort = port; }
     void setApiPrefix(const QString& prefix) { m_apiPrefix = prefix; }
+    void setExtraTcpEndpoints(const QList<ServerEndpoint>& endpoints) { m_extraTcpEndpoints = endpoints; }
 
 private:
     ConfigManager() = default; // 私有构造函数，实现单例
@@ -33,4 +50,5 @@ private:
     QString m_httpHost;
     quint16 m_httpPort;
     QString m_apiPrefix;
+    QList<ServerEndpoint> m_extraTcpEndpoints; // 备用地址, 与主地址并行连接
 };
\ No newline at end of file
@@ -0,0 +1,362 @@
+// utils/EventLoopMonitor.cpp
+#include "EventLoopMonitor.h"
+#include "Logging.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QEvent>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMetaEnum>
+#include <QMutex>
+#include <QSysInfo>
+#include <QThread>
+#include <QVector>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+const qint64 NS_PER_MS = 1000000;
+const int MAX_WATCHDOG_INTERVAL_MS = 250;
+
+struct StallEntry
+{
+    qint64 wallTimeMs = 0;  // 分发开始时的 UTC 时间
+    qint64 durationNs = 0;
+    int type = 0;
+    const char* className = nullptr;  // 元对象里的类名是字符串常量, 直接保存指针
+    qint64 nestedNs = 0;              // 其中最慢的一次嵌套分发, 没有时为 0
+    int nestedType = 0;
+    const char* nestedClassName = nullptr;
+    quint64 traceId = 0;
+};
+
+// 只在界面线程上读写
+struct DispatchState
+{
+    int depth = 0;
+    int loopBase = 0;  // 正在运行的事件循环所在的深度, 它直接分发的事件在 loopBase + 1 层
+    qint64 nestedNs = 0;
+    int nestedType = 0;
+    const char* nestedClassName = nullptr;
+};
+
+EventLoopMonitor::Options options;
+qint64 stallThresholdNs = 0;
+Qt::HANDLE guiThread = nullptr;
+DispatchState state;
+QMetaObject::Connection blockConnection;
+
+MetricHistogram* eventHistogram = nullptr;
+MetricHistogram* paintHistogram = nullptr;
+MetricHistogram* frameHistogram = nullptr;
+MetricCounter* stallCounter = nullptr;
+
+// 卡顿日志是环形的, logNext 指向下一个写入的位置
+QMutex logMutex;
+QVector<StallEntry> stallLog;
+int logNext = 0;
+qint64 totalStalls = 0;
+
+// 界面线程在最外层分发开始时写入, 后台线程读取. start 为 0 表示界面线程空闲,
+// seq 每次分发加一, 读取前后 seq 不变时其他几个字段才属于同一次分发
+std::atomic<qint64> currentStart{0};
+std::atomic<int> currentType{0};
+std::atomic<const char*> currentClassName{nullptr};
+std::atomic<quint64> currentSeq{0};
+
+QString eventTypeName(int type)
+{
+    const char* key = QMetaEnum::fromType<QEvent::Type>().valueToKey(type);
+    if (key) return QString::fromLatin1(key);
+    if (type >= QEvent::User) return QString("User+%1").arg(type - QEvent::User);
+    return QString::number(type);
+}
+
+QString receiverName(const char* name)
+{
+    return name ? QString::fromLatin1(name) : QString("?");
+}
+
+double toMs(qint64 ns)
+{
+    return qRound64(double(ns) / NS_PER_MS * 100) / 100.0;
+}
+
+// 定期检查界面线程是否停在一次分发里
+class Watchdog
+{
+   public:
+    explicit Watchdog(int hangThresholdMs)
+        : m_hangThresholdNs(qint64(hangThresholdMs) * NS_PER_MS),
+          m_intervalMs(qBound(10, hangThresholdMs / 4, MAX_WATCHDOG_INTERVAL_MS)),
+          m_hangs(MetricsRegistry::instance().counter("gui.hangs"))
+    {
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+   private:
+    void run()
+    {
+        quint64 reportedSeq = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_wake.wait_for(lock, std::chrono::milliseconds(m_intervalMs),
+                                [this]() { return m_stopping; }))
+        {
+            quint64 seq = currentSeq.load(std::memory_order_acquire);
+            qint64 start = currentStart.load(std::memory_order_acquire);
+            int type = currentType.load(std::memory_order_relaxed);
+            const char* name = currentClassName.load(std::memory_order_relaxed);
+            if (start == 0 || seq == reportedSeq) continue;
+            if (currentSeq.load(std::memory_order_acquire) != seq) continue;
+
+            qint64 blockedNs = Trace::now() - start;
+            if (blockedNs < m_hangThresholdNs) continue;
+            // 同一次分发只报告一次, 分发结束后卡顿日志里会有完整的耗时
+            reportedSeq = seq;
+            m_hangs.add();
+            qCWarning(lcUi).noquote() << "GUI thread blocked for" << blockedNs / NS_PER_MS
+                                      << "ms in" << eventTypeName(type) << "->"
+                                      << receiverName(name);
+        }
+    }
+
+    const qint64 m_hangThresholdNs;
+    const int m_intervalMs;
+    MetricCounter& m_hangs;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+Watchdog* watchdog = nullptr;
+
+// 事件循环准备等待新事件. 深度大于 loopBase 说明这是某次分发里启动的嵌套事件循环
+// (模态对话框、QEventLoop::exec), 外层的分发从这里开始包含空闲时间
+void onAboutToBlock()
+{
+    if (state.depth > state.loopBase) state.loopBase = state.depth;
+    currentStart.store(0, std::memory_order_relaxed);
+}
+
+void recordStall(qint64 startNs, qint64 durationNs, int type, const char* name)
+{
+    StallEntry entry;
+    entry.wallTimeMs = QDateTime::currentMSecsSinceEpoch() - durationNs / NS_PER_MS;
+    entry.durationNs = durationNs;
+    entry.type = type;
+    entry.className = name;
+    entry.nestedNs = state.nestedNs;
+    entry.nestedType = state.nestedType;
+    entry.nestedClassName = state.nestedClassName;
+    entry.traceId = Trace::lastId();
+
+    stallCounter->add();
+    if (Trace::isEnabled())
+    {
+        Trace::record(Trace::Stage::Stall, entry.traceId, startNs, startNs + durationNs);
+    }
+    qCDebug(lcUi).noquote() << "GUI stall:" << toMs(durationNs) << "ms in"
+                            << eventTypeName(type) << "->" << receiverName(name);
+
+    QMutexLocker locker(&logMutex);
+    if (stallLog.size() < options.logCapacity)
+        stallLog.append(entry);
+    else
+        stallLog[logNext] = entry;
+    logNext = (logNext + 1) % options.logCapacity;
+    totalStalls++;
+}
+
+QJsonObject stallToJson(const StallEntry& entry)
+{
+    QJsonObject json;
+    json["time"] = QDateTime::fromMSecsSinceEpoch(entry.wallTimeMs).toString(Qt::ISODateWithMs);
+    json["durationMs"] = toMs(entry.durationNs);
+    json["event"] = eventTypeName(entry.type);
+    json["receiver"] = receiverName(entry.className);
+    if (entry.nestedNs > 0)
+    {
+        json["slowestNested"] = QJsonObject{{"event", eventTypeName(entry.nestedType)},
+                                            {"receiver", receiverName(entry.nestedClassName)},
+                                            {"durationMs", toMs(entry.nestedNs)}};
+    }
+    if (entry.traceId != 0) json["traceId"] = Trace::idString(entry.traceId);
+    return json;
+}
+}  // namespace
+
+namespace EventLoopMonitor
+{
+namespace detail
+{
+std::atomic<bool> enabled{false};
+
+qint64 begin(QObject* receiver, QEvent* event, int& depth, int& type, const char*& className)
+{
+    if (!receiver || !event || QThread::currentThreadId() != guiThread) return 0;
+
+    depth = ++state.depth;
+    type = int(event->type());
+    className = receiver->metaObject()->className();
+    qint64 start = Trace::now();
+    if (depth == state.loopBase + 1)
+    {
+        state.nestedNs = 0;
+        state.nestedType = 0;
+        state.nestedClassName = nullptr;
+        Trace::resetLastId();
+        currentType.store(type, std::memory_order_relaxed);
+        currentClassName.store(className, std::memory_order_relaxed);
+        currentStart.store(start, std::memory_order_relaxed);
+        currentSeq.fetch_add(1, std::memory_order_release);
+    }
+    return start;
+}
+
+void end(qint64 startNs, int depth, int type, const char* className)
+{
+    qint64 duration = Trace::now() - startNs;
+    state.depth = depth - 1;
+    if (depth <= state.loopBase)
+    {
+        // 这次分发里运行过嵌套的事件循环并且等待过, 耗时包含空闲时间, 不计入
+        state.loopBase = depth - 1;
+        return;
+    }
+
+    if (type == QEvent::Paint)
+        paintHistogram->record(duration);
+    else if (type == QEvent::UpdateRequest)
+        frameHistogram->record(duration);
+
+    if (depth > state.loopBase + 1)
+    {
+        // 嵌套的分发包含它自己的嵌套分发, 最慢的一次通常就是外层耗时的主要来源
+        if (duration > state.nestedNs)
+        {
+            state.nestedNs = duration;
+            state.nestedType = type;
+            state.nestedClassName = className;
+        }
+        return;
+    }
+
+    currentStart.store(0, std::memory_order_relaxed);
+    eventHistogram->record(duration);
+    if (duration >= stallThresholdNs) recordStall(startNs, duration, type, className);
+}
+}  // namespace detail
+
+void start(const Options& newOptions)
+{
+    stop();
+
+    {
+        QMutexLocker locker(&logMutex);
+        options = newOptions;
+        options.logCapacity = qMax(1, options.logCapacity);
+        stallLog.clear();
+        logNext = 0;
+    }
+    stallThresholdNs = qint64(qMax(1, options.stallThresholdMs)) * NS_PER_MS;
+    guiThread = QThread::currentThreadId();
+    state = DispatchState();
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    eventHistogram = &registry.histogram("gui.event_ns");
+    paintHistogram = &registry.histogram("gui.paint_ns");
+    frameHistogram = &registry.histogram("gui.frame_ns");
+    stallCounter = &registry.counter("gui.stalls");
+
+    if (QAbstractEventDispatcher* dispatcher = QAbstractEventDispatcher::instance())
+    {
+        blockConnection = QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock,
+                                           dispatcher, onAboutToBlock, Qt::DirectConnection);
+    }
+    if (options.hangThresholdMs > 0) watchdog = new Watchdog(options.hangThresholdMs);
+
+    detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+void stop()
+{
+    detail::enabled.store(false, std::memory_order_relaxed);
+    QObject::disconnect(blockConnection);
+    if (watchdog)
+    {
+        watchdog->stop();
+        delete watchdog;
+        watchdog = nullptr;
+    }
+    currentStart.store(0, std::memory_order_relaxed);
+}
+
+qint64 stallCount()
+{
+    QMutexLocker locker(&logMutex);
+    return totalStalls;
+}
+
+void clear()
+{
+    QMutexLocker locker(&logMutex);
+    stallLog.clear();
+    logNext = 0;
+    totalStalls = 0;
+}
+
+QJsonObject toJson()
+{
+    QJsonArray stalls;
+    QJsonObject json;
+    {
+        QMutexLocker locker(&logMutex);
+        // 日志写满后 logNext 处是最旧的一条
+        int first = stallLog.size() < options.logCapacity ? 0 : logNext;
+        for (int i = 0; i < stallLog.size(); ++i)
+        {
+            stalls.append(stallToJson(stallLog[(first + i) % stallLog.size()]));
+        }
+        json["stallThresholdMs"] = options.stallThresholdMs;
+        json["hangThresholdMs"] = options.hangThresholdMs;
+        json["totalStalls"] = totalStalls;
+    }
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    json["application"] = QCoreApplication::applicationName();
+    json["qtVersion"] = QString::fromLatin1(qVersion());
+    json["platform"] = QSysInfo::prettyProductName();
+    json["exportedAt"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    json["hangs"] = registry.counter("gui.hangs").value();
+    json["histograms"] =
+        QJsonObject{{"gui.event_ns", registry.histogram("gui.event_ns").snapshot().toJson()},
+                    {"gui.paint_ns", registry.histogram("gui.paint_ns").snapshot().toJson()},
+                    {"gui.frame_ns", registry.histogram("gui.frame_ns").snapshot().toJson()}};
+    json["stalls"] = stalls;
+    return json;
+}
+
+JsonDump& dump()
+{
+    static JsonDump stallDump(
+        []() { return QJsonDocument(toJson()).toJson(QJsonDocument::Indented); });
+    return stallDump;
+}
+}  // namespace EventLoopMonitor
@@ -0,0 +1,77 @@
+// utils/EventLoopMonitor.h
+#ifndef EVENTLOOPMONITOR_H
+#define EVENTLOOPMONITOR_H
+
+#include "JsonDump.h"
+#include <QJsonObject>
+#include <QString>
+#include <atomic>
+
+class QEvent;
+class QObject;
+
+// 界面线程的事件循环监控: 每次事件分发计时, 最外层的分发记入直方图 gui.event_ns,
+// 绘制事件记入 gui.paint_ns, 整个窗口的一次重绘 (UpdateRequest) 记入 gui.frame_ns.
+// 超过阈值的分发算一次卡顿, 连同事件类型、接收者的类名、其中最慢的嵌套分发和当时在处理的
+// 追踪 id 写入固定大小的卡顿日志, 可以导出 JSON 附在问题报告里; 开启追踪时同时写一条 stall 记录.
+// 另有一个后台线程定期检查, 界面线程在一次分发里停留超过 hangThresholdMs 时立即输出警告,
+// 不必等到分发结束 (彻底卡死时分发永远不会结束)
+namespace EventLoopMonitor
+{
+struct Options
+{
+    int stallThresholdMs = 50;   // 超过即记入卡顿日志
+    int hangThresholdMs = 1000;  // 后台线程发出警告的阈值, 0 表示不启动后台线程
+    int logCapacity = 256;       // 卡顿日志只保留最近的条数
+};
+
+namespace detail
+{
+extern std::atomic<bool> enabled;
+// 是界面线程时开始计时并返回开始时间, 否则返回 0
+qint64 begin(QObject* receiver, QEvent* event, int& depth, int& type, const char*& className);
+void end(qint64 startNs, int depth, int type, const char* className);
+}  // namespace detail
+
+inline bool isEnabled()
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// 在界面线程上调用, 之后只监控这个线程
+void start(const Options& options);
+void stop();
+
+// 包住一次事件分发, 由 QApplication::notify 的重写在栈上创建. 关闭时只有一次原子读
+class Dispatch
+{
+   public:
+    Dispatch(QObject* receiver, QEvent* event)
+        : m_start(isEnabled() ? detail::begin(receiver, event, m_depth, m_type, m_className) : 0)
+    {
+    }
+    ~Dispatch()
+    {
+        if (m_start != 0) detail::end(m_start, m_depth, m_type, m_className);
+    }
+    Dispatch(const Dispatch&) = delete;
+    Dispatch& operator=(const Dispatch&) = delete;
+
+   private:
+    int m_depth = 0;
+    int m_type = 0;
+    const char* m_className = nullptr;
+    qint64 m_start;
+};
+
+// 记录过的卡顿总数, 包括已经被覆盖的
+qint64 stallCount();
+void clear();
+
+// {"stallThresholdMs", "hangThresholdMs", "stalls": [...], "histograms": {...}, ...}
+QJsonObject toJson();
+// 导出 toJson() 的内容, 默认路径由 --stall-log 设置
+JsonDump& dump();
+}  // namespace EventLoopMonitor
+
+#endif  // EVENTLOOPMONITOR_H
@@ -0,0 +1,78 @@
+// utils/GroupMembership.cpp
+#include "GroupMembership.h"
+#include <QJsonObject>
+#include <QVariant>
+#include "User.h"
+
+GroupMembership GroupMembership::fromJson(const QJsonArray& members, long creatorId)
+{
+    GroupMembership membership;
+    membership.m_creatorId = creatorId;
+    membership.m_members.reserve(members.size());
+    for (const QJsonValue& value : members)
+    {
+        if (!value.isObject()) continue;
+        QJsonObject obj = value.toObject();
+        MemberInfo info;
+        info.userId = obj["userId"].toVariant().toLongLong();
+        if (info.userId == 0) continue;  // 跳过无效的 ID
+        info.username = internString(obj["username"].toString());
+        info.nickname = internString(obj["nickname"].toString());
+        info.role = (info.userId == creatorId) ? Creator : Member;
+        membership.m_members.insert(info.userId, info);
+    }
+    return membership;
+}
+
+const GroupMembership::MemberInfo* GroupMembership::find(long userId) const
+{
+    auto it = m_members.constFind(userId);
+    return it == m_members.constEnd() ? nullptr : &it.value();
+}
+
+bool GroupMembership::add(const MemberInfo& info)
+{
+    if (info.userId == 0 || m_members.contains(info.userId)) return false;
+    m_members.insert(info.userId, info);
+    return true;
+}
+
+bool GroupMembership::add(const User* user, Role role)
+{
+    if (!user) return false;
+    MemberInfo info;
+    info.userId = user->getUserId();
+    info.username = user->getUsernameId();
+    info.nickname = user->getNicknameId();
+    info.role = (info.userId == m_creatorId) ? Creator : role;
+    return add(info);
+}
+
+bool GroupMembership::remove(long userId)
+{
+    return m_members.remove(userId) > 0;
+}
+
+void GroupMembership::setCreator(long creatorId)
+{
+    m_creatorId = creatorId;
+    for (auto it = m_members.begin(); it != m_members.end(); ++it)
+    {
+        it->role = (it->userId == creatorId) ? Creator : Member;
+    }
+}
+
+QJsonArray GroupMembership::toJson() const
+{
+    QJsonArray array;
+    for (const MemberInfo& info : m_members)
+    {
+        QJsonObject obj;
+        obj["userId"] = static_cast<qint64>(info.userId);
+        obj["username"] = internedString(info.username);
+        obj["nickname"] = internedString(info.nickname);
+        obj["role"] = info.role == Creator ? "creator" : "member";
+        array.append(obj);
+    }
+    return array;
+}
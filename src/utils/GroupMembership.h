@@ -0,0 +1,61 @@
+// utils/GroupMembership.h
+#ifndef GROUPMEMBERSHIP_H
+#define GROUPMEMBERSHIP_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QList>
+#include "StringPool.h"
+
+class User;
+
+// 群组成员集合, 以 userId 为 key 的哈希表
+// 成员判断是 O(1), 增删也是增量的, 不需要每次从 QJsonArray 重新构造集合
+class GroupMembership
+{
+   public:
+    enum Role
+    {
+        Member = 0,  // 普通成员
+        Creator = 1  // 群主
+    };
+
+    struct MemberInfo
+    {
+        long userId = 0;
+        StringId username = StringPool::InvalidId;
+        StringId nickname = StringPool::InvalidId;
+        Role role = Member;
+    };
+
+    GroupMembership() = default;
+
+    // 从后端的成员数组构造, creatorId 对应的成员标记为群主
+    static GroupMembership fromJson(const QJsonArray& members, long creatorId);
+
+    bool contains(long userId) const { return m_members.contains(userId); }
+    const MemberInfo* find(long userId) const;
+    int size() const { return m_members.size(); }
+    bool isEmpty() const { return m_members.isEmpty(); }
+
+    // 返回是否真的发生了变化
+    bool add(const MemberInfo& info);
+    bool add(const User* user, Role role = Member);
+    bool remove(long userId);
+    void clear() { m_members.clear(); }
+
+    void setCreator(long creatorId);
+    long creatorId() const { return m_creatorId; }
+
+    QList<long> ids() const { return m_members.keys(); }
+    const QHash<long, MemberInfo>& members() const { return m_members; }
+
+    // 兼容需要 JSON 的地方 (例如调试输出)
+    QJsonArray toJson() const;
+
+   private:
+    QHash<long, MemberInfo> m_members;
+    long m_creatorId = 0;
+};
+
+#endif  // GROUPMEMBERSHIP_H
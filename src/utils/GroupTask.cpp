@@ -3,9 +3,8 @@
 
 // 构造函数实现
 GroupTask::GroupTask(const QString& operationId, const QString& type, long groupId, long operatorId,
-                     const QString& groupName, long userId, QObject* parent)
-    : QObject(parent),
-      m_operationId(operationId),
+                     const QString& groupName, long userId)
+    : m_operationId(operationId),
       m_type(type),
       m_groupId(groupId),
       m_operatorId(operatorId),
@@ -15,34 +14,6 @@ GroupTask::GroupTask(const QString& operationId, const QString& type, long group
     // qDebug() << "GroupTask created: " << toString(); // 构造时打印，方便调试
 }
 
-// 拷贝构造函数实现
-GroupTask::GroupTask(const GroupTask& other)
-    : QObject(nullptr),  // 拷贝时不继承父对象
-      m_operationId(other.m_operationId),
-      m_type(other.m_type),
-      m_groupId(other.m_groupId),
-      m_operatorId(other.m_operatorId),
-      m_groupName(other.m_groupName),
-      m_userId(other.m_userId)
-{
-}
-
-// 赋值运算符实现
-GroupTask& GroupTask::operator=(const GroupTask& other)
-{
-    if (this != &other)
-    {
-        // 不需要处理QObject的父子关系，因为赋值操作不改变父子关系
-        m_operationId = other.m_operationId;
-        m_type = other.m_type;
-        m_groupId = other.m_groupId;
-        m_operatorId = other.m_operatorId;
-        m_groupName = other.m_groupName;
-        m_userId = other.m_userId;
-    }
-    return *this;
-}
-
 // Getters
 QString GroupTask::getOperationId() const
 {
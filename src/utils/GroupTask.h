@@ -1,24 +1,18 @@
 #ifndef GROUPTASK_H
 #define GROUPTASK_H
 
-#include <QObject>
+#include <QMetaType>
 #include <QString>
 #include <QDebug>  // 用于 toString() 方法的调试输出
 
-class GroupTask : public QObject
+// 群组操作任务, 值类型, 直接按值传递和保存
+// 之前是 QObject, 需要在堆上分配并且没有人负责释放
+class GroupTask
 {
-    Q_OBJECT
-
    public:
     // 构造函数：初始化所有字段
     explicit GroupTask(const QString& operationId = "", const QString& type = "", long groupId = 0,
-                       long operatorId = 0, const QString& groupName = "", long userId = 0,
-                       QObject* parent = nullptr);
-
-    // 拷贝构造函数
-    GroupTask(const GroupTask& other);
-    // 赋值运算符
-    GroupTask& operator=(const GroupTask& other);
+                       long operatorId = 0, const QString& groupName = "", long userId = 0);
 
     // Getters: 获取字段值
     QString getOperationId() const;
@@ -48,4 +42,6 @@ class GroupTask : public QObject
     long m_userId;          // 目标用户ID (如果任务与单个用户有关，例如添加/删除特定用户)
 };
 
+Q_DECLARE_METATYPE(GroupTask)
+
 #endif  // GROUPTASK_H
\ No newline at end of file
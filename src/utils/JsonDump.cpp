@@ -0,0 +1,30 @@
+// utils/JsonDump.cpp
+#include "JsonDump.h"
+#include <QFile>
+#include <QMutexLocker>
+
+JsonDump::JsonDump(Producer producer) : m_producer(std::move(producer)) {}
+
+void JsonDump::setPath(const QString& path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_path = path;
+}
+
+QString JsonDump::path() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_path;
+}
+
+bool JsonDump::write(const QString& path, QString& error) const
+{
+    QByteArray json = m_producer();
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+    {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+// utils/JsonDump.h
+#ifndef JSONDUMP_H
+#define JSONDUMP_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <functional>
+
+// 诊断数据 (运行时指标、消息追踪、卡顿日志) 导出成 JSON 文件.
+// 每种数据有一个默认路径, 由启动参数设置, 快捷键和退出时的自动导出都写到这里;
+// 诊断面板的导出按钮写到用户选择的路径
+class JsonDump
+{
+   public:
+    // 生成要写入的内容, 在调用 write 的线程上执行
+    using Producer = std::function<QByteArray()>;
+
+    explicit JsonDump(Producer producer);
+    JsonDump(const JsonDump&) = delete;
+    JsonDump& operator=(const JsonDump&) = delete;
+
+    void setPath(const QString& path);
+    // 没有设置时为空
+    QString path() const;
+
+    bool write(const QString& path, QString& error) const;
+
+   private:
+    Producer m_producer;
+    mutable QMutex m_mutex;
+    QString m_path;
+};
+
+#endif  // JSONDUMP_H
@@ -0,0 +1,366 @@
+// utils/Logging.cpp
+#include "Logging.h"
+#include "MetricsRegistry.h"
+#include <QDateTime>
+#include <QFile>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+Q_LOGGING_CATEGORY(lcApp, "chatter.app", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcConfig, "chatter.config", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcNet, "chatter.net", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcProtocol, "chatter.protocol", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcUsers, "chatter.users", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcTransfer, "chatter.transfer", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcUi, "chatter.ui", QtInfoMsg)
+
+namespace
+{
+const int MIN_QUEUE_CAPACITY = 64;
+const int IDLE_WAIT_MS = 100;         // 队列为空时后台线程最长的等待时间
+const int DROP_REPORT_INTERVAL_MS = 1000;
+
+struct Record
+{
+    QString message;
+    const char* category = nullptr;  // 分类名是字符串常量, 直接保存指针
+    qint64 timeMs = 0;
+    quint32 thread = 0;
+    QtMsgType type = QtDebugMsg;
+};
+
+// 有界的多生产者单消费者队列 (Vyukov). 每个槽位的 sequence 表示它当前可以被哪个序号写入或读出,
+// 生产者之间只竞争 enqueuePos 的一次 CAS, 队列满时 push 立即返回 false
+class LogQueue
+{
+   public:
+    // capacity 必须是 2 的幂
+    explicit LogQueue(int capacity) : m_cells(new Cell[capacity]), m_mask(quint64(capacity) - 1)
+    {
+        for (int i = 0; i < capacity; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(Record&& record)
+    {
+        quint64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            quint64 sequence = cell->sequence.load(std::memory_order_acquire);
+            qint64 diff = qint64(sequence) - qint64(pos);
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record = std::move(record);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 只能由后台线程调用
+    bool pop(Record& record)
+    {
+        Cell& cell = m_cells[m_dequeuePos & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) return false;
+        record = std::move(cell.record);
+        cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        const Cell& cell = m_cells[m_dequeuePos & m_mask];
+        return cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1;
+    }
+
+   private:
+    struct Cell
+    {
+        std::atomic<quint64> sequence{0};
+        Record record;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    const quint64 m_mask;
+    alignas(64) std::atomic<quint64> m_enqueuePos{0};
+    alignas(64) quint64 m_dequeuePos = 0;
+};
+
+char typeLetter(QtMsgType type)
+{
+    switch (type)
+    {
+        case QtDebugMsg:
+            return 'D';
+        case QtInfoMsg:
+            return 'I';
+        case QtWarningMsg:
+            return 'W';
+        case QtCriticalMsg:
+            return 'C';
+        case QtFatalMsg:
+            return 'F';
+    }
+    return '?';
+}
+
+QByteArray formatRecord(const Record& record)
+{
+    QString line =
+        QDateTime::fromMSecsSinceEpoch(record.timeMs).toString("yyyy-MM-dd HH:mm:ss.zzz");
+    line += QString(" %1 %2 [%3] ")
+                .arg(QLatin1Char(typeLetter(record.type)))
+                .arg(QLatin1String(record.category ? record.category : "default"))
+                .arg(record.thread);
+    line += record.message;
+    line += '\n';
+    return line.toUtf8();
+}
+
+int queueCapacity(int requested)
+{
+    return int(qNextPowerOfTwo(quint32(qMax(MIN_QUEUE_CAPACITY, requested) - 1)));
+}
+
+class AsyncSink
+{
+   public:
+    AsyncSink(const Logging::SinkOptions& options, QFile* file)
+        : m_queue(queueCapacity(options.queueCapacity)),
+          m_console(options.console),
+          m_maxPerSecond(options.maxPerSecond),
+          m_file(file),
+          m_written(MetricsRegistry::instance().counter("log.written")),
+          m_droppedQueueFull(MetricsRegistry::instance().counter("log.dropped.queue_full")),
+          m_droppedRateLimited(MetricsRegistry::instance().counter("log.dropped.rate_limited"))
+    {
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    // 任意线程调用
+    void post(QtMsgType type, const char* category, const QString& message)
+    {
+        Record record;
+        record.timeMs = QDateTime::currentMSecsSinceEpoch();
+        if (!allowRate(type, record.timeMs / 1000))
+        {
+            m_droppedRateLimited.add();
+            return;
+        }
+        record.message = message;
+        record.category = category;
+        record.thread = Logging::threadIndex();
+        record.type = type;
+        if (!m_queue.push(std::move(record)))
+        {
+            m_droppedQueueFull.add();
+            return;
+        }
+        if (m_sleeping.load(std::memory_order_relaxed)) m_wake.notify_one();
+    }
+
+    // 排空队列后结束后台线程
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+        if (m_file) m_file->close();
+    }
+
+   private:
+    // 固定一秒的窗口, 窗口切换时的几条消息可能计入相邻的窗口, 对限流来说足够了
+    bool allowRate(QtMsgType type, qint64 second)
+    {
+        if (m_maxPerSecond <= 0 || (type != QtDebugMsg && type != QtInfoMsg)) return true;
+        qint64 window = m_windowSecond.load(std::memory_order_relaxed);
+        if (window != second &&
+            m_windowSecond.compare_exchange_strong(window, second, std::memory_order_relaxed))
+        {
+            m_windowCount.store(0, std::memory_order_relaxed);
+        }
+        return m_windowCount.fetch_add(1, std::memory_order_relaxed) < m_maxPerSecond;
+    }
+
+    void run()
+    {
+        auto lastReport = std::chrono::steady_clock::now();
+        while (true)
+        {
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_sleeping.store(true, std::memory_order_relaxed);
+                m_wake.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS),
+                                [this]() { return m_stopping || !m_queue.isEmpty(); });
+                m_sleeping.store(false, std::memory_order_relaxed);
+                stopping = m_stopping;
+            }
+
+            drain();
+            auto now = std::chrono::steady_clock::now();
+            if (stopping || now - lastReport >= std::chrono::milliseconds(DROP_REPORT_INTERVAL_MS))
+            {
+                reportDrops();
+                lastReport = now;
+            }
+            if (stopping) break;
+        }
+    }
+
+    void drain()
+    {
+        Record record;
+        int count = 0;
+        while (m_queue.pop(record))
+        {
+            write(formatRecord(record));
+            ++count;
+        }
+        if (count == 0) return;
+        m_written.add(count);
+        if (m_console) std::fflush(stderr);
+        if (m_file) m_file->flush();
+    }
+
+    void write(const QByteArray& line)
+    {
+        if (m_console) std::fwrite(line.constData(), 1, size_t(line.size()), stderr);
+        if (m_file) m_file->write(line);
+    }
+
+    void reportDrops()
+    {
+        qint64 queueFull = m_droppedQueueFull.value();
+        qint64 rateLimited = m_droppedRateLimited.value();
+        qint64 newQueueFull = queueFull - m_reportedQueueFull;
+        qint64 newRateLimited = rateLimited - m_reportedRateLimited;
+        if (newQueueFull == 0 && newRateLimited == 0) return;
+        m_reportedQueueFull = queueFull;
+        m_reportedRateLimited = rateLimited;
+
+        Record record;
+        record.timeMs = QDateTime::currentMSecsSinceEpoch();
+        record.category = "chatter.logging";
+        record.thread = Logging::threadIndex();
+        record.type = QtWarningMsg;
+        record.message = QString("dropped %1 messages (queue full: %2, rate limited: %3)")
+                             .arg(newQueueFull + newRateLimited)
+                             .arg(newQueueFull)
+                             .arg(newRateLimited);
+        write(formatRecord(record));
+        if (m_console) std::fflush(stderr);
+        if (m_file) m_file->flush();
+    }
+
+    LogQueue m_queue;
+    const bool m_console;
+    const int m_maxPerSecond;
+    QFile* m_file;  // 打开后只由后台线程写入
+
+    MetricCounter& m_written;
+    MetricCounter& m_droppedQueueFull;
+    MetricCounter& m_droppedRateLimited;
+    qint64 m_reportedQueueFull = 0;
+    qint64 m_reportedRateLimited = 0;
+
+    std::atomic<qint64> m_windowSecond{0};
+    std::atomic<int> m_windowCount{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_sleeping{false};
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+// 安装后不释放: 其他线程可能在恢复原来的处理函数之前仍然拿着这个指针
+std::atomic<AsyncSink*> activeSink{nullptr};
+QtMessageHandler previousHandler = nullptr;
+bool installed = false;
+
+void asyncMessageHandler(QtMsgType type, const QMessageLogContext& context,
+                         const QString& message)
+{
+    AsyncSink* sink = activeSink.load(std::memory_order_acquire);
+    if (type == QtFatalMsg || !sink)
+    {
+        // 进程马上就要 abort, 或者已经关闭, 同步写出
+        Record record;
+        record.message = message;
+        record.category = context.category;
+        record.timeMs = QDateTime::currentMSecsSinceEpoch();
+        record.thread = Logging::threadIndex();
+        record.type = type;
+        QByteArray line = formatRecord(record);
+        std::fwrite(line.constData(), 1, size_t(line.size()), stderr);
+        std::fflush(stderr);
+        return;
+    }
+    sink->post(type, context.category, message);
+}
+}  // namespace
+
+namespace Logging
+{
+bool installAsyncSink(const SinkOptions& options, QString& error)
+{
+    if (installed)
+    {
+        error = "异步日志已经安装过";
+        return false;
+    }
+
+    QFile* file = nullptr;
+    if (!options.filePath.isEmpty())
+    {
+        file = new QFile(options.filePath);
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        {
+            error = file->errorString();
+            delete file;
+            return false;
+        }
+    }
+
+    installed = true;
+    activeSink.store(new AsyncSink(options, file), std::memory_order_release);
+    previousHandler = qInstallMessageHandler(asyncMessageHandler);
+    return true;
+}
+
+void shutdownAsyncSink()
+{
+    AsyncSink* sink = activeSink.exchange(nullptr, std::memory_order_acq_rel);
+    if (!sink) return;
+    qInstallMessageHandler(previousHandler);
+    sink->stop();
+}
+
+quint32 threadIndex()
+{
+    static std::atomic<quint32> nextThreadIndex{1};
+    thread_local quint32 index = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+}  // namespace Logging
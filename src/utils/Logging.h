@@ -0,0 +1,39 @@
+// utils/Logging.h
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+#include <QString>
+
+// 各子系统的日志分类, 用 qCDebug(lcNet) << ... 输出. 分类被关闭时整条语句不执行, 参数也不会格式化.
+// debug 默认关闭, 需要时用 --log-rules 或 QT_LOGGING_RULES 打开, 例如 "chatter.net.debug=true"
+Q_DECLARE_LOGGING_CATEGORY(lcApp)       // chatter.app: 启动、窗口切换
+Q_DECLARE_LOGGING_CATEGORY(lcConfig)    // chatter.config: 配置加载
+Q_DECLARE_LOGGING_CATEGORY(lcNet)       // chatter.net: 连接、心跳、重连、发送队列
+Q_DECLARE_LOGGING_CATEGORY(lcProtocol)  // chatter.protocol: 出入站消息的处理
+Q_DECLARE_LOGGING_CATEGORY(lcUsers)     // chatter.users: 在线/离线用户列表
+Q_DECLARE_LOGGING_CATEGORY(lcTransfer)  // chatter.transfer: 文件和头像的上传下载
+Q_DECLARE_LOGGING_CATEGORY(lcUi)        // chatter.ui: 界面
+
+// 异步日志输出: 调用线程只把消息和时间戳放进有界的无锁队列, 加前缀和写入都在后台线程完成.
+// 队列满或超过每秒限额的消息被丢弃并计数 (指标 log.dropped.*), 后台线程定期输出一条丢弃汇总.
+// 警告及以上的消息不受每秒限额约束; Fatal 消息直接同步写到 stderr
+namespace Logging
+{
+struct SinkOptions
+{
+    QString filePath;            // 为空则不写文件
+    bool console = true;         // 写到 stderr
+    int queueCapacity = 8192;    // 向上取整为 2 的幂
+    int maxPerSecond = 2000;     // debug/info 每秒最多输出的条数, 0 表示不限
+};
+
+bool installAsyncSink(const SinkOptions& options, QString& error);
+// 排空队列, 停止后台线程并恢复原来的输出, 在 main 返回前调用
+void shutdownAsyncSink();
+
+// 线程第一次调用时分配的小编号, 日志前缀和追踪记录共用, 同一个线程在两边的编号相同
+quint32 threadIndex();
+}  // namespace Logging
+
+#endif  // LOGGING_H
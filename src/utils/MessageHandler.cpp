@@ -1,12 +1,18 @@
 #include "MessageHandler.h"
 #include "utils/GroupTask.h"
-#include "utils/UserInfo.h"
-QJsonObject MessageHandler::createLoginMessage(const QString& username, const QString& password)
+#include "utils/Logging.h"
+#include <QDebug>
+QJsonObject MessageHandler::createLoginMessage(const QString& username, const QString& password,
+                                              const QJsonObject& capabilities)
 {
     QJsonObject message;
     message["type"] = "LOGIN";
     message["username"] = username;
     message["password"] = password;
+    if (!capabilities.isEmpty())
+    {
+        message["capabilities"] = capabilities;  // 旧版本的服务器会忽略这个字段
+    }
     return message;
 }
 
@@ -26,7 +32,7 @@ QJsonObject MessageHandler::createChatMessage(const QString& content, const QStr
     QJsonObject message;
     message["type"] = "CHAT";
     message["content"] = content;
-    message["token"] = token;
+    if (!token.isEmpty()) message["token"] = token;
     return message;
 }
 
@@ -37,8 +43,8 @@ QJsonObject MessageHandler::createPrivateChatMessage(const QString& receiver,
     message["type"] = "PRIVATE_CHAT";
     message["receiver"] = receiver;  // 此处是username而不是nickname!!
     message["content"] = content;
-    message["token"] = token;
-    qDebug() << "send private chat: " << message;  // 在这里debug好了
+    if (!token.isEmpty()) message["token"] = token;
+    qCDebug(lcProtocol) << "send private chat to" << receiver << "length:" << content.size();
     return message;
 }
 
@@ -53,23 +59,23 @@ QJsonObject MessageHandler::createGroupChatMessage(long userId, const QString& u
     message["nickname"] = nickname;
     message["groupId"] = static_cast<qint64>(groupId);  // 明确转换为 qint64
     message["content"] = content;
-    message["token"] = token;
+    if (!token.isEmpty()) message["token"] = token;
     return message;
 }
 
-QJsonObject MessageHandler::createGroupTask(const GroupTask* task)
+QJsonObject MessageHandler::createGroupTask(const GroupTask& task, const QString& token)
 {
     QJsonObject message;
-    message["type"] = task->getType();
+    message["type"] = task.getType();
     QJsonObject content;
-    content["operationId"] = task->getOperationId();
-    content["operatorId"] = static_cast<qint64>(task->getOperatorId());  // 明确转换为 qint64
-    content["groupId"] = static_cast<qint64>(task->getGroupId());        // 明确转换为 qint64
-    content["userId"] = static_cast<qint64>(task->getUserId());          // 明确转换为 qint64
-    content["groupName"] = task->getGroupName();
+    content["operationId"] = task.getOperationId();
+    content["operatorId"] = static_cast<qint64>(task.getOperatorId());  // 明确转换为 qint64
+    content["groupId"] = static_cast<qint64>(task.getGroupId());        // 明确转换为 qint64
+    content["userId"] = static_cast<qint64>(task.getUserId());          // 明确转换为 qint64
+    content["groupName"] = task.getGroupName();
 
     message["content"] = content;
-    message["token"] = UserInfo::instance().token();
+    if (!token.isEmpty()) message["token"] = token;
     return message;
 }
 
@@ -80,7 +86,7 @@ QJsonObject MessageHandler::createFileMessage(const QString& receiver,
     message["type"] = "FILE";
     message["receiver"] = receiver;
     message["content"] = QString::fromLatin1(fileContent.toBase64());
-    message["token"] = token;
+    if (!token.isEmpty()) message["token"] = token;
     return message;
 }
 
@@ -88,15 +94,34 @@ QJsonObject MessageHandler::createLogoutMessage(const QString& token)
 {
     QJsonObject message;
     message["type"] = "LOGOUT";
-    message["token"] = token;
+    if (!token.isEmpty()) message["token"] = token;
     return message;
 }
 
-QJsonObject MessageHandler::createHeartbeatMessage(const QString& token)
+QJsonObject MessageHandler::createHeartbeatMessage(quint32 seq, qint64 sentAt,
+                                                   const QString& token)
 {
     QJsonObject message;
     message["type"] = "HEARTBEAT";
+    if (!token.isEmpty()) message["token"] = token;
+    message["seq"] = static_cast<qint64>(seq);
+    message["sentAt"] = sentAt;
+    return message;
+}
+
+QJsonObject MessageHandler::createResumeMessage(const QString& token, qint64 lastMessageId,
+                                                qint64 lastEventSeq,
+                                                const QJsonObject& capabilities)
+{
+    QJsonObject message;
+    message["type"] = "RESUME";
     message["token"] = token;
+    message["lastMessageId"] = lastMessageId;
+    message["lastEventSeq"] = lastEventSeq;
+    if (!capabilities.isEmpty())
+    {
+        message["capabilities"] = capabilities;
+    }
     return message;
 }
 
@@ -9,27 +9,40 @@
 class MessageHandler
 {
    public:
-    static QJsonObject createLoginMessage(const QString& username, const QString& password);
+    // capabilities 为客户端支持的传输特性 (例如压缩), 服务器在响应中返回接受的部分
+    static QJsonObject createLoginMessage(const QString& username, const QString& password,
+                                          const QJsonObject& capabilities = QJsonObject());
     static QJsonObject createRegisterMessage(const QString& username, const QString& password,
                                              const QString& nickname);
-    static QJsonObject createChatMessage(const QString& content, const QString& token);
+    // 服务器接受了 connectionAuth 时 token 绑定在连接上, 传空字符串, 消息里不带 token;
+    // 否则 (旧版本的服务器) 每条消息都要带上 token
+    static QJsonObject createChatMessage(const QString& content,
+                                         const QString& token = QString());
     static QJsonObject createPrivateChatMessage(const QString& receiver, const QString& content,
-                                                const QString& token);
+                                                const QString& token = QString());
     // change
     static QJsonObject createGroupChatMessage(long userId, const QString& username,
                                               const QString& nickname, long groupId,
-                                              const QString& content, const QString& token);
+                                              const QString& content,
+                                              const QString& token = QString());
     static QJsonObject createFileMessage(const QString& receiver, const QByteArray& fileContent,
-                                         const QString& token);
-    static QJsonObject createLogoutMessage(const QString& token);
-    static QJsonObject createHeartbeatMessage(const QString& token);
+                                         const QString& token = QString());
+    static QJsonObject createLogoutMessage(const QString& token = QString());
+    // seq 和 sentAt 由服务器原样带回, 用于计算往返时延
+    static QJsonObject createHeartbeatMessage(quint32 seq, qint64 sentAt,
+                                              const QString& token = QString());
+    // 断线重连后恢复会话, 服务器只补发 lastMessageId / lastEventSeq 之后的内容
+    // 新的连接还没有绑定身份, 所以这里仍然需要 token
+    static QJsonObject createResumeMessage(const QString& token, qint64 lastMessageId,
+                                           qint64 lastEventSeq,
+                                           const QJsonObject& capabilities = QJsonObject());
 
     static QString getErrorMessage(const QJsonObject& response);
     static QString getSystemMessage(const QJsonObject& response);
     static QJsonArray getOnlineUsers(const QJsonObject& response);
     static int getOnlineCount(const QJsonObject& response);
     // 新增
-    static QJsonObject createGroupTask(const GroupTask* task);
+    static QJsonObject createGroupTask(const GroupTask& task, const QString& token = QString());
 };
 
 #endif  // MESSAGEHANDLER_H
\ No newline at end of file
@@ -0,0 +1,216 @@
+// utils/MetricsRegistry.cpp
+#include "MetricsRegistry.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+#include <cmath>
+
+namespace
+{
+const int LINEAR_BUCKETS = 64;  // 小于这个值的样本精确记录
+const int SUB_BUCKET_BITS = 5;  // 之后每个 2 的幂区间分成 32 个桶
+const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+void atomicMax(std::atomic<qint64>& target, qint64 value)
+{
+    qint64 current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void atomicMin(std::atomic<qint64>& target, qint64 value)
+{
+    qint64 current = target.load(std::memory_order_relaxed);
+    while (value < current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+}  // namespace
+
+void MetricGauge::set(qint64 value)
+{
+    m_value.store(value, std::memory_order_relaxed);
+    atomicMax(m_max, value);
+}
+
+void MetricGauge::add(qint64 n)
+{
+    atomicMax(m_max, m_value.fetch_add(n, std::memory_order_relaxed) + n);
+}
+
+int MetricHistogram::bucketIndex(qint64 value)
+{
+    if (value < LINEAR_BUCKETS) return int(qMax<qint64>(0, value));
+    // value >= 64 时最高位不低于第 6 位, 右移后落在 [32, 64)
+    int highestBit = 63 - qCountLeadingZeroBits(quint64(value));
+    int shift = highestBit - SUB_BUCKET_BITS;
+    int index = LINEAR_BUCKETS + (shift - 1) * SUB_BUCKETS + int((value >> shift) - SUB_BUCKETS);
+    return qMin(index, BucketCount - 1);
+}
+
+qint64 MetricHistogram::bucketUpperBound(int index)
+{
+    if (index < LINEAR_BUCKETS) return index;
+    int shift = (index - LINEAR_BUCKETS) / SUB_BUCKETS + 1;
+    qint64 sub = (index - LINEAR_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void MetricHistogram::record(qint64 value)
+{
+    value = qMax<qint64>(0, value);
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    atomicMin(m_min, value);
+    atomicMax(m_max, value);
+}
+
+MetricHistogram::Snapshot MetricHistogram::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.buckets.resize(BucketCount);
+    qint64 count = 0;
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        count += snapshot.buckets[i];
+    }
+    // 以桶的总和为准, 百分位数才能对得上
+    snapshot.count = count;
+    snapshot.sum = m_sum.load(std::memory_order_relaxed);
+    snapshot.min = count > 0 ? m_min.load(std::memory_order_relaxed) : 0;
+    snapshot.max = m_max.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void MetricHistogram::reset()
+{
+    for (std::atomic<qint64>& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+qint64 MetricHistogram::Snapshot::percentile(double percentile) const
+{
+    if (count == 0) return 0;
+    qint64 target = qMax<qint64>(
+        1, qint64(std::ceil(qBound(0.0, percentile, 100.0) / 100.0 * double(count))));
+    qint64 seen = 0;
+    for (int i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= target) return qMin(bucketUpperBound(i), max);
+    }
+    return max;
+}
+
+QJsonObject MetricHistogram::Snapshot::toJson() const
+{
+    QJsonObject json;
+    json["count"] = count;
+    json["min"] = min;
+    json["mean"] = mean();
+    json["p50"] = percentile(50.0);
+    json["p90"] = percentile(90.0);
+    json["p99"] = percentile(99.0);
+    json["p999"] = percentile(99.9);
+    json["max"] = max;
+    return json;
+}
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::MetricsRegistry()
+    : m_dump([this]() { return QJsonDocument(toJson()).toJson(); })
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    qDeleteAll(m_counters);
+    qDeleteAll(m_gauges);
+    qDeleteAll(m_histograms);
+}
+
+MetricCounter& MetricsRegistry::counter(const QString& name)
+{
+    QMutexLocker locker(&m_mutex);
+    MetricCounter*& metric = m_counters[name];
+    if (!metric) metric = new MetricCounter;
+    return *metric;
+}
+
+MetricGauge& MetricsRegistry::gauge(const QString& name)
+{
+    QMutexLocker locker(&m_mutex);
+    MetricGauge*& metric = m_gauges[name];
+    if (!metric) metric = new MetricGauge;
+    return *metric;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const QString& name)
+{
+    QMutexLocker locker(&m_mutex);
+    MetricHistogram*& metric = m_histograms[name];
+    if (!metric) metric = new MetricHistogram;
+    return *metric;
+}
+
+void MetricsRegistry::registerProbe(const QString& name, std::function<qint64()> probe)
+{
+    QMutexLocker locker(&m_mutex);
+    m_probes.insert(name, std::move(probe));
+}
+
+void MetricsRegistry::unregisterProbe(const QString& name)
+{
+    QMutexLocker locker(&m_mutex);
+    m_probes.remove(name);
+}
+
+QJsonObject MetricsRegistry::toJson() const
+{
+    QJsonObject counters;
+    QJsonObject gauges;
+    QJsonObject histograms;
+    QMap<QString, std::function<qint64()>> probes;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_counters.constBegin(); it != m_counters.constEnd(); ++it)
+            counters[it.key()] = it.value()->value();
+        for (auto it = m_gauges.constBegin(); it != m_gauges.constEnd(); ++it)
+        {
+            gauges[it.key()] =
+                QJsonObject{{"value", it.value()->value()}, {"max", it.value()->max()}};
+        }
+        for (auto it = m_histograms.constBegin(); it != m_histograms.constEnd(); ++it)
+            histograms[it.key()] = it.value()->snapshot().toJson();
+        probes = m_probes;
+    }
+
+    // 探针可能反过来更新指标, 在锁外调用
+    QJsonObject probeValues;
+    for (auto it = probes.constBegin(); it != probes.constEnd(); ++it)
+        probeValues[it.key()] = it.value()();
+
+    QJsonObject json;
+    json["application"] = QCoreApplication::applicationName();
+    json["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    json["counters"] = counters;
+    json["gauges"] = gauges;
+    json["histograms"] = histograms;
+    json["probes"] = probeValues;
+    return json;
+}
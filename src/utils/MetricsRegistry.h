@@ -0,0 +1,116 @@
+// utils/MetricsRegistry.h
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include "JsonDump.h"
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <limits>
+
+// 单调递增的计数, 例如收发字节数、重连次数
+class MetricCounter
+{
+   public:
+    void add(qint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<qint64> m_value{0};
+};
+
+// 瞬时值, 同时记录出现过的最大值, 例如排队深度
+class MetricGauge
+{
+   public:
+    void set(qint64 value);
+    void add(qint64 n);
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+    qint64 max() const { return m_max.load(std::memory_order_relaxed); }
+
+   private:
+    void updateMax(qint64 value);
+
+    std::atomic<qint64> m_value{0};
+    std::atomic<qint64> m_max{0};
+};
+
+// HDR 风格的直方图: 小于 64 的值各占一个桶, 之后每个 2 的幂区间分成 32 个桶,
+// 相对误差不超过 1/32, 桶数固定, 记录一次只是几次原子加. 单位由名字的后缀表示, 例如 parse_ns
+class MetricHistogram
+{
+   public:
+    static const int BucketCount = 1152;  // 覆盖到 2^40
+
+    struct Snapshot
+    {
+        QVector<qint64> buckets;
+        qint64 count = 0;
+        qint64 sum = 0;
+        qint64 min = 0;
+        qint64 max = 0;
+
+        double mean() const { return count > 0 ? double(sum) / count : 0.0; }
+        // percentile 取 0~100, 返回对应桶的上界 (不超过最大值)
+        qint64 percentile(double percentile) const;
+        QJsonObject toJson() const;
+    };
+
+    void record(qint64 value);
+    // 各个字段分别读取, 并发写入时快照内的数字可能相差几次记录
+    Snapshot snapshot() const;
+    // 清空所有记录, 与 record 同时调用时可能留下几次记录
+    void reset();
+
+    static int bucketIndex(qint64 value);
+    static qint64 bucketUpperBound(int index);
+
+   private:
+    std::atomic<qint64> m_buckets[BucketCount] = {};
+    std::atomic<qint64> m_count{0};
+    std::atomic<qint64> m_sum{0};
+    std::atomic<qint64> m_min{std::numeric_limits<qint64>::max()};
+    std::atomic<qint64> m_max{0};
+};
+
+// 进程内的指标注册表, 按名字取得指标, 第一次取得时创建, 之后地址不变.
+// 更新只用原子操作, 任何线程都可以调用; 按名字查找需要加锁, 热路径上把返回的引用缓存起来:
+//     static MetricCounter& bytesIn = MetricsRegistry::instance().counter("socket.bytes_in");
+class MetricsRegistry
+{
+   public:
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    static MetricsRegistry& instance();
+
+    MetricCounter& counter(const QString& name);
+    MetricGauge& gauge(const QString& name);
+    MetricHistogram& histogram(const QString& name);
+
+    // 读取时才计算的值, 例如控件数量. 在导出快照的线程上调用, 界面相关的探针只能在界面线程导出
+    void registerProbe(const QString& name, std::function<qint64()> probe);
+    void unregisterProbe(const QString& name);
+
+    // {"counters": {...}, "gauges": {name: {"value", "max"}}, "histograms": {...}, "probes": {...}}
+    QJsonObject toJson() const;
+    // 导出 toJson() 的内容, 默认路径由 --metrics 设置
+    JsonDump& dump() { return m_dump; }
+
+   private:
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    mutable QMutex m_mutex;
+    QMap<QString, MetricCounter*> m_counters;
+    QMap<QString, MetricGauge*> m_gauges;
+    QMap<QString, MetricHistogram*> m_histograms;
+    QMap<QString, std::function<qint64()>> m_probes;
+    JsonDump m_dump;
+};
+
+#endif  // METRICSREGISTRY_H
@@ -0,0 +1,55 @@
+// utils/StringPool.cpp
+#include "StringPool.h"
+
+StringPool& StringPool::instance()
+{
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::StringPool()
+{
+    // 0 号位置留给空字符串, 这样默认构造的 StringId 就表示 ""
+    m_strings.append(QString());
+    m_ids.insert(QString(), InvalidId);
+}
+
+StringId StringPool::intern(const QString& str)
+{
+    if (str.isEmpty()) return InvalidId;
+
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_ids.constFind(str);
+        if (it != m_ids.constEnd()) return it.value();
+    }
+
+    QWriteLocker locker(&m_lock);
+    // 拿到写锁之前可能已经被别的线程插入了
+    auto it = m_ids.constFind(str);
+    if (it != m_ids.constEnd()) return it.value();
+
+    StringId id = static_cast<StringId>(m_strings.size());
+    m_strings.append(str);
+    m_ids.insert(str, id);
+    return id;
+}
+
+StringId StringPool::find(const QString& str) const
+{
+    QReadLocker locker(&m_lock);
+    return m_ids.value(str, InvalidId);
+}
+
+QString StringPool::str(StringId id) const
+{
+    QReadLocker locker(&m_lock);
+    if (id >= static_cast<StringId>(m_strings.size())) return QString();
+    return m_strings.at(id);
+}
+
+int StringPool::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_strings.size();
+}
@@ -0,0 +1,54 @@
+// utils/StringPool.h
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+// 身份字符串 (username / nickname / groupName) 的全局驻留池
+// 同一个字符串只保存一份, 其余地方只持有一个 StringId, 比较时退化为整数比较
+// 身份字符串的数量受用户数和群组数限制, 所以池子只增不减
+using StringId = quint32;
+
+class StringPool
+{
+   public:
+    static constexpr StringId InvalidId = 0;  // 0 号保留给空字符串
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    static StringPool& instance();
+
+    // 返回字符串对应的 id, 不存在则插入
+    StringId intern(const QString& str);
+    // 只查找不插入, 找不到返回 InvalidId
+    StringId find(const QString& str) const;
+    // 根据 id 取回字符串, QString 是隐式共享的, 返回值拷贝只增加引用计数
+    QString str(StringId id) const;
+
+    int size() const;
+
+   private:
+    StringPool();
+    ~StringPool() = default;
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, StringId> m_ids;
+    QVector<QString> m_strings;
+};
+
+// 便捷函数
+inline StringId internString(const QString& str)
+{
+    return StringPool::instance().intern(str);
+}
+
+inline QString internedString(StringId id)
+{
+    return StringPool::instance().str(id);
+}
+
+#endif  // STRINGPOOL_H
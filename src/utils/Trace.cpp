@@ -0,0 +1,317 @@
+// utils/Trace.cpp
+#include "Trace.h"
+#include "Logging.h"
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+const int RING_BITS = 16;  // 65536 条记录, 约 3 MB, 第一次记录时才分配
+const quint64 RING_SIZE = quint64(1) << RING_BITS;
+const quint64 RING_MASK = RING_SIZE - 1;
+const quint64 LOCAL_ID_BIT = quint64(1) << 63;
+const int LOCAL_ID_PROCESS_SHIFT = 32;
+const quint64 LOCAL_ID_SEQ_MASK = (quint64(1) << LOCAL_ID_PROCESS_SHIFT) - 1;
+
+// 写入者先用 head 占一个序号, 把 seq 清零后写各个字段, 最后把 seq 设为序号 + 1.
+// 读取时前后两次读到相同且非零的 seq 才算一条完整的记录, 写入过程中的槽位被跳过
+struct Slot
+{
+    std::atomic<quint64> seq{0};
+    std::atomic<quint64> id{0};
+    std::atomic<qint64> start{0};
+    std::atomic<qint64> end{0};
+    std::atomic<quint32> info{0};  // 低 8 位是 stage, 其余是线程序号
+    std::atomic<quint64> aux{0};   // link 记录的 messageId
+};
+
+struct Ring
+{
+    std::atomic<quint64> head{0};
+    Slot slots[RING_SIZE];
+};
+
+Ring& ring()
+{
+    // 不析构, 退出阶段的其他静态对象仍然可以记录
+    static Ring* instance = new Ring;
+    return *instance;
+}
+
+std::atomic<quint64> nextLocalId{1};
+thread_local quint64 t_currentId = 0;
+thread_local quint64 t_lastId = 0;
+
+struct Entry
+{
+    quint64 id;
+    qint64 start;
+    qint64 end;
+    Trace::Stage stage;
+    quint32 thread;
+    quint64 aux;
+};
+
+const char* stageName(Trace::Stage stage)
+{
+    switch (stage)
+    {
+        case Trace::Stage::Input:
+            return "input";
+        case Trace::Stage::Send:
+            return "send";
+        case Trace::Stage::SocketWrite:
+            return "socket_write";
+        case Trace::Stage::SocketRead:
+            return "socket_read";
+        case Trace::Stage::Parse:
+            return "parse";
+        case Trace::Stage::Dispatch:
+            return "dispatch";
+        case Trace::Stage::EventBus:
+            return "event_bus";
+        case Trace::Stage::Paint:
+            return "paint";
+        case Trace::Stage::Stall:
+            return "stall";
+        case Trace::Stage::Link:
+            return "link";
+    }
+    return "unknown";
+}
+
+QVector<Entry> snapshot()
+{
+    Ring& r = ring();
+    quint64 head = r.head.load(std::memory_order_acquire);
+    quint64 oldest = head > RING_SIZE ? head - RING_SIZE : 0;
+
+    QVector<Entry> entries;
+    entries.reserve(int(qMin(head, RING_SIZE)));
+    for (quint64 i = 0; i < RING_SIZE; ++i)
+    {
+        const Slot& slot = r.slots[i];
+        quint64 seq = slot.seq.load(std::memory_order_acquire);
+        if (seq == 0 || seq - 1 < oldest) continue;
+
+        Entry entry;
+        entry.id = slot.id.load(std::memory_order_relaxed);
+        entry.start = slot.start.load(std::memory_order_relaxed);
+        entry.end = slot.end.load(std::memory_order_relaxed);
+        quint32 info = slot.info.load(std::memory_order_relaxed);
+        entry.aux = slot.aux.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq) continue;
+
+        entry.stage = static_cast<Trace::Stage>(info & 0xff);
+        entry.thread = info >> 8;
+        entries.append(entry);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.start < b.start; });
+    return entries;
+}
+
+void writeSlot(Trace::Stage stage, quint64 id, qint64 startNs, qint64 endNs, quint64 aux)
+{
+    if (id != 0) t_lastId = id;
+    Ring& r = ring();
+    quint64 index = r.head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = r.slots[index & RING_MASK];
+
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.id.store(id, std::memory_order_relaxed);
+    slot.start.store(startNs, std::memory_order_relaxed);
+    slot.end.store(endNs, std::memory_order_relaxed);
+    slot.info.store(quint32(stage) | (Logging::threadIndex() << 8), std::memory_order_relaxed);
+    slot.aux.store(aux, std::memory_order_relaxed);
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+}  // namespace
+
+namespace Trace
+{
+namespace detail
+{
+std::atomic<bool> enabled{false};
+}
+
+void setEnabled(bool enabled)
+{
+    detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+quint64 newLocalId()
+{
+    if (!isEnabled()) return 0;
+    static const quint64 process =
+        quint64(QCoreApplication::applicationPid() & 0x7fffffff) << LOCAL_ID_PROCESS_SHIFT;
+    return LOCAL_ID_BIT | process |
+           (nextLocalId.fetch_add(1, std::memory_order_relaxed) & LOCAL_ID_SEQ_MASK);
+}
+
+bool isLocalId(quint64 id)
+{
+    return (id & LOCAL_ID_BIT) != 0;
+}
+
+quint64 currentId()
+{
+    return t_currentId;
+}
+
+quint64 lastId()
+{
+    return t_lastId;
+}
+
+void resetLastId()
+{
+    t_lastId = 0;
+}
+
+void record(Stage stage, quint64 id, qint64 startNs, qint64 endNs)
+{
+    writeSlot(stage, id, startNs, endNs, 0);
+}
+
+void link(quint64 id, quint64 messageId)
+{
+    if (!isEnabled()) return;
+    qint64 t = now();
+    writeSlot(Stage::Link, id, t, t, messageId);
+}
+
+Scope::Scope(quint64 id) : m_previous(0), m_active(isEnabled())
+{
+    if (m_active)
+    {
+        m_previous = t_currentId;
+        t_currentId = id;
+        if (id != 0) t_lastId = id;
+    }
+}
+
+Scope::~Scope()
+{
+    if (m_active) t_currentId = m_previous;
+}
+
+QString idString(quint64 id)
+{
+    if (id & LOCAL_ID_BIT)
+    {
+        return QString("local:%1.%2")
+            .arg((id & ~LOCAL_ID_BIT) >> LOCAL_ID_PROCESS_SHIFT)
+            .arg(id & LOCAL_ID_SEQ_MASK);
+    }
+    return QString::number(id);
+}
+
+int capacity()
+{
+    return int(RING_SIZE);
+}
+
+void clear()
+{
+    Ring& r = ring();
+    for (Slot& slot : r.slots) slot.seq.store(0, std::memory_order_relaxed);
+}
+
+QByteArray exportChromeTrace()
+{
+    const QVector<Entry> entries = snapshot();
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+
+    QJsonObject processName;
+    processName["name"] = "process_name";
+    processName["ph"] = "M";
+    processName["pid"] = pid;
+    processName["args"] = QJsonObject{{"name", QCoreApplication::applicationName()}};
+    events.append(processName);
+
+    // 同一个 id 的记录按时间先后用 flow 箭头连起来: 第一条 s, 中间 t, 最后一条 f
+    QHash<quint64, int> remaining;
+    for (const Entry& entry : entries)
+    {
+        if (entry.id != 0) remaining[entry.id]++;
+    }
+    QHash<quint64, bool> started;
+
+    for (const Entry& entry : entries)
+    {
+        QJsonObject event;
+        event["name"] = stageName(entry.stage);
+        event["cat"] = "message";
+        event["ts"] = entry.start / 1000.0;  // 微秒
+        event["pid"] = pid;
+        event["tid"] = qint64(entry.thread);
+        QJsonObject args{{"id", idString(entry.id)}};
+        if (entry.stage == Stage::Link) args["messageId"] = QString::number(entry.aux);
+        event["args"] = args;
+        if (entry.end > entry.start)
+        {
+            event["ph"] = "X";
+            event["dur"] = (entry.end - entry.start) / 1000.0;
+        }
+        else
+        {
+            event["ph"] = "i";
+            event["s"] = "t";
+        }
+        events.append(event);
+
+        if (entry.id == 0 || remaining.value(entry.id) + started.contains(entry.id) < 2) continue;
+        int left = --remaining[entry.id];
+        QJsonObject flow;
+        flow["name"] = "message";
+        flow["cat"] = "flow";
+        flow["id"] = idString(entry.id);
+        flow["ts"] = entry.start / 1000.0;
+        flow["pid"] = pid;
+        flow["tid"] = qint64(entry.thread);
+        if (!started.contains(entry.id))
+        {
+            flow["ph"] = "s";
+            started.insert(entry.id, true);
+        }
+        else if (left > 0)
+        {
+            flow["ph"] = "t";
+        }
+        else
+        {
+            flow["ph"] = "f";
+            flow["bp"] = "e";
+        }
+        events.append(flow);
+    }
+
+    QJsonObject json;
+    json["traceEvents"] = events;
+    json["displayTimeUnit"] = "ns";
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+JsonDump& dump()
+{
+    static JsonDump traceDump(exportChromeTrace);
+    return traceDump;
+}
+}  // namespace Trace
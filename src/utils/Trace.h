@@ -0,0 +1,119 @@
+// utils/Trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "JsonDump.h"
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+
+// 消息链路追踪: 从输入框按下回车到另一端的气泡绘制出来, 每一段记录单调时钟的起止时间.
+// 入站的记录按服务器的 messageId 关联; 出站的消息还没有 messageId, 按本地分配的 id 关联.
+// 出站消息带上本地 id (traceId 字段), 服务器原样转发, 接收方改用这个 id 记录并写一条 link
+// 把它和 messageId 对应起来, 两个客户端的追踪文件放在一起时同一条消息的记录会连起来.
+// 关闭时每个埋点只有一次原子读和一个分支; 开启后写入固定大小的无锁环形缓冲区, 旧记录被覆盖,
+// 需要时导出为 Chrome trace JSON, 用 chrome://tracing 或 Perfetto 打开.
+// 时间戳取系统的单调时钟, 同一台机器上两个客户端导出的文件可以放在一起看
+namespace Trace
+{
+enum class Stage : quint8
+{
+    Input,        // 按下回车到输入框处理完
+    Send,         // 构造并编码出站帧
+    SocketWrite,  // 交给 socket
+    SocketRead,   // 从 socket 读出一批数据
+    Parse,        // 从缓冲区解出一帧
+    Dispatch,     // MessageProcessor 处理
+    EventBus,     // 经 GlobalEventBus 转发给界面
+    Paint,        // 气泡第一次绘制
+    Stall,        // 界面线程上超过阈值的一次事件分发, 见 EventLoopMonitor
+    Link,         // 入站消息带有发送方的 id, 记录它对应的 messageId
+};
+
+namespace detail
+{
+extern std::atomic<bool> enabled;
+}
+
+inline bool isEnabled()
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+void setEnabled(bool enabled);
+
+// 单调时钟, 纳秒
+qint64 now();
+// 出站消息的本地 id, 最高位置 1 以免与服务器的 messageId 冲突; 关闭时返回 0
+// 其余的位是进程号和序号, 不同客户端分配的 id 不会相同
+quint64 newLocalId();
+bool isLocalId(quint64 id);
+
+// 当前线程正在处理的消息 id, 由 Scope 设置, 同步调用链中的埋点用它关联
+quint64 currentId();
+
+// 当前线程最近一次进入 Scope 或写入记录时用到的非零 id, 事件分发结束后用它找出当时在处理哪条消息
+quint64 lastId();
+void resetLastId();
+
+// 写入一条记录, 调用方已经检查过 isEnabled()
+void record(Stage stage, quint64 id, qint64 startNs, qint64 endNs);
+
+// 接收方用发送方的 id 记录一条入站消息时, 同时记下服务器分配的 messageId
+void link(quint64 id, quint64 messageId);
+
+// 没有持续时间的时刻
+inline void mark(Stage stage, quint64 id)
+{
+    if (isEnabled())
+    {
+        qint64 t = now();
+        record(stage, id, t, t);
+    }
+}
+
+// 作用域内的一段耗时
+class Span
+{
+   public:
+    Span(Stage stage, quint64 id) : m_stage(stage), m_id(id), m_start(isEnabled() ? now() : 0) {}
+    ~Span()
+    {
+        if (m_start != 0) record(m_stage, m_id, m_start, now());
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+   private:
+    Stage m_stage;
+    quint64 m_id;
+    qint64 m_start;
+};
+
+// 设置作用域内的 currentId(), 离开时恢复
+class Scope
+{
+   public:
+    explicit Scope(quint64 id);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    quint64 m_previous;
+    bool m_active;
+};
+
+// 本地 id 写成 local:进程号.序号, 服务器的 messageId 原样输出
+QString idString(quint64 id);
+
+// 环形缓冲区能保存的记录数
+int capacity();
+void clear();
+
+// 导出缓冲区中现有的记录, 同一个 id 的记录之间用 flow 箭头连起来
+QByteArray exportChromeTrace();
+// 导出 exportChromeTrace() 的内容, 默认路径由 --trace 设置
+JsonDump& dump();
+}  // namespace Trace
+
+#endif  // TRACE_H
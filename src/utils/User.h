@@ -5,6 +5,7 @@
 #include <QObject>
 #include <QString>
 #include <QDebug>  // 用于调试输出
+#include "StringPool.h"
 
 class User : public QObject
 {
@@ -23,8 +24,8 @@ class User : public QObject
                   QObject* parent = nullptr)
         : QObject(parent),
           m_userId(id),
-          m_username(username),
-          m_nickname(nickname),
+          m_username(internString(username)),
+          m_nickname(internString(nickname)),
           m_avatarUrl(avatarUrl),
           m_status(status)
     {
@@ -33,16 +34,19 @@ class User : public QObject
 
     // Getters
     long getUserId() const { return m_userId; }
-    QString getUsername() const { return m_username; }
-    QString getNickname() const { return m_nickname; }
+    QString getUsername() const { return internedString(m_username); }
+    QString getNickname() const { return internedString(m_nickname); }
+    // 驻留 id, 用于整数比较和作为 key
+    StringId getUsernameId() const { return m_username; }
+    StringId getNicknameId() const { return m_nickname; }
     QString getAvatarUrl() const { return m_avatarUrl; }
     UserStatus getStatus() const { return m_status; }
     bool isOnline() const { return m_status == Online; }  // 提供一个方便的isOnline方法
 
     // Setters (如果数据可能变化)
     void setUserId(long id) { m_userId = id; }
-    void setUsername(const QString& name) { m_username = name; }
-    void setNickname(const QString& name) { m_nickname = name; }
+    void setUsername(const QString& name) { m_username = internString(name); }
+    void setNickname(const QString& name) { m_nickname = internString(name); }
     void setAvatarUrl(const QString& url) { m_avatarUrl = url; }
     void setStatus(UserStatus status)
     {
@@ -54,8 +58,8 @@ class User : public QObject
 
    private:
     long m_userId;
-    QString m_username;
-    QString m_nickname;
+    StringId m_username;  // 驻留池中的 id, 不再持有字符串拷贝
+    StringId m_nickname;
     QString m_avatarUrl;
     UserStatus m_status;
 };
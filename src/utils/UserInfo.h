@@ -3,28 +3,35 @@
 #define USERINFO_H
 
 #include <QString>
+#include "StringPool.h"
 
+// 当前登录用户的信息. 界面使用 instance() 这个全局实例;
+// 压测工具在一个进程里模拟多个用户, 每个 ChatClient 使用自己创建的实例
 class UserInfo
 {
    public:
-    // 删除拷贝构造函数和赋值操作符，确保单例
+    UserInfo() = default;
+    ~UserInfo() = default;
+    // 不可拷贝, 各处通过引用共享同一份登录状态
     UserInfo(const UserInfo&) = delete;
     UserInfo& operator=(const UserInfo&) = delete;
 
-    // 获取单例实例
+    // 获取界面使用的全局实例
     static UserInfo& instance();
 
     // 用户信息设置
     void setUserId(long id) { m_userId = id; }
-    void setUsername(const QString& username) { m_username = username; }
-    void setNickname(const QString& nickname) { m_nickname = nickname; }
+    void setUsername(const QString& username) { m_username = internString(username); }
+    void setNickname(const QString& nickname) { m_nickname = internString(nickname); }
     void setToken(const QString& token) { m_token = token; }
     void setOnline(bool flag){isOnline = flag;}
 
     // 用户信息获取
     long userId() const { return m_userId; }
-    QString username() const { return m_username; }
-    QString nickname() const { return m_nickname; }
+    QString username() const { return internedString(m_username); }
+    QString nickname() const { return internedString(m_nickname); }
+    StringId usernameId() const { return m_username; }
+    StringId nicknameId() const { return m_nickname; }
     QString token() const { return m_token; }
     bool online() const {return isOnline;}
     // 检查是否已登录
@@ -34,21 +41,18 @@ class UserInfo
     void clear()
     {
         m_userId = -1;
-        m_username.clear();
-        m_nickname.clear();
+        m_username = StringPool::InvalidId;
+        m_nickname = StringPool::InvalidId;
         m_token.clear();
         isOnline = false;
     }
 
    private:
-    UserInfo() = default;   // 私有构造函数
-    ~UserInfo() = default;  // 私有析构函数
-
     long m_userId = -1;
-    QString m_username;
-    QString m_nickname;
+    StringId m_username = StringPool::InvalidId;
+    StringId m_nickname = StringPool::InvalidId;
     QString m_token;
-    bool isOnline;
+    bool isOnline = false;
 };
 
 #endif  // USERINFO_H
\ No newline at end of file
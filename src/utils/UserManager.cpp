@@ -1,5 +1,6 @@
 // utils/UserManager.cpp
 #include "UserManager.h"
+#include "Logging.h"
 #include <QDebug>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -11,13 +12,13 @@ UserManager::UserManager(QObject* parent)
       m_busyNumbers(0),
       m_isInitialDataLoaded(false)  // 初始化标志
 {
-    qDebug() << "UserManager created.";
+    qCDebug(lcUsers) << "UserManager created.";
 }
 
 UserManager::~UserManager()
 {
     clearUsers();
-    qDebug() << "UserManager destroyed, all User objects cleared.";
+    qCDebug(lcUsers) << "UserManager destroyed, all User objects cleared.";
 }
 
 void UserManager::clearUsers()
@@ -37,7 +38,7 @@ void UserManager::clearUsers()
 // **重新引入：初始化在线用户列表**
 void UserManager::initOnlineUsers(const QJsonArray& users)
 {
-    qDebug() << "UserManager: Initializing online users...";
+    qCDebug(lcUsers) << "UserManager: Initializing online users...";
     // 不在此处 clearUsers()，因为是增量更新
     for (const QJsonValue& userValue : users)
     {
@@ -54,13 +55,14 @@ void UserManager::initOnlineUsers(const QJsonArray& users)
             addOrUpdateUser(id, username, nickname, avatarUrl, status);
         }
     }
-    qDebug() << "UserManager: Online users initialized. Current Online: " << m_onlineNumbers;
+    qCDebug(lcUsers) << "UserManager: Online users initialized. Current Online: "
+                     << m_onlineNumbers;
 }
 
 // **重新引入：初始化离线用户列表**
 void UserManager::initOfflineUsers(const QJsonArray& users)
 {
-    qDebug() << "UserManager: Initializing offline users...";
+    qCDebug(lcUsers) << "UserManager: Initializing offline users...";
     // 不在此处 clearUsers()，因为是增量更新
     for (const QJsonValue& userValue : users)
     {
@@ -76,7 +78,8 @@ void UserManager::initOfflineUsers(const QJsonArray& users)
             addOrUpdateUser(id, username, nickname, avatarUrl, status);
         }
     }
-    qDebug() << "UserManager: Offline users initialized. Current Offline: " << m_offlineNumbers;
+    qCDebug(lcUsers) << "UserManager: Offline users initialized. Current Offline: "
+                     << m_offlineNumbers;
 }
 
 // **新增：标记初始数据加载完成**
@@ -86,7 +89,7 @@ void UserManager::markInitialDataLoaded()
     {
         m_isInitialDataLoaded = true;
         emit usersInitialized();  // 只有当所有初始数据加载完成后才发出此信号
-        qDebug() << "UserManager: Initial data load marked as complete. Emitting usersInitialized.";
+        qCDebug(lcUsers) << "UserManager: Initial data load marked as complete. Emitting usersInitialized.";
     }
 }
 
@@ -102,7 +105,7 @@ void UserManager::addOrUpdateUser(long userId, const QString& username, const QS
         user = new User(userId, username, nickname, avatarUrl, newStatus,
                         this);  // UserManager作为父对象
         m_allUsers.insert(userId, user);
-        m_usernameToIdMap.insert(username, userId);
+        m_usernameToIdMap.insert(user->getUsernameId(), userId);
 
         // 更新计数
         if (newStatus == User::Online)
@@ -157,25 +160,25 @@ void UserManager::addOrUpdateUser(long userId, const QString& username, const QS
             // 信号搞太多了反而会出错, 这里就是
             emit userStatusChanged(user);
 
-            qDebug() << "UserManager: User " << username << " (ID:" << userId
-                     << ") status changed from " << oldStatus << " to " << newStatus;
-        }
-        else
-        {
-            qDebug() << "UserManager: User " << username << " (ID:" << userId << ") status already "
-                     << newStatus << ". No change in status.";
+            qCDebug(lcUsers) << "UserManager: User " << username << " (ID:" << userId
+                             << ") status changed from " << oldStatus << " to " << newStatus;
         }
     }
 }
 
 User* UserManager::getUserByUsername(const QString& username) const
 {
-    if (m_usernameToIdMap.contains(username))
-    {
-        long userId = m_usernameToIdMap.value(username);
-        return m_allUsers.value(userId, nullptr);
-    }
-    return nullptr;
+    // 只查找不插入, 未知的 username 不应该进入驻留池
+    StringId usernameId = StringPool::instance().find(username);
+    if (usernameId == StringPool::InvalidId) return nullptr;
+    return getUserByUsernameId(usernameId);
+}
+
+User* UserManager::getUserByUsernameId(StringId usernameId) const
+{
+    auto it = m_usernameToIdMap.constFind(usernameId);
+    if (it == m_usernameToIdMap.constEnd()) return nullptr;
+    return m_allUsers.value(it.value(), nullptr);
 }
 
 User* UserManager::getUserById(long userId) const
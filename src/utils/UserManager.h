@@ -5,6 +5,7 @@
 #include <QObject>
 #include <QString>
 #include <QMap>
+#include <QHash>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
@@ -28,6 +29,7 @@ class UserManager : public QObject
     // 获取用户数据的方法 (外部只能通过这些接口访问)
     QMap<long, User*> getAllUsers() const { return m_allUsers; }  // 返回ID到User*的映射
     User* getUserByUsername(const QString& username) const;       // 根据username查找
+    User* getUserByUsernameId(StringId usernameId) const;         // 根据驻留的username id查找
     User* getUserById(long userId) const;                         // 根据ID查找
 
     int getOnlineNumber() const { return m_onlineNumbers; }
@@ -47,7 +49,7 @@ class UserManager : public QObject
 
    private:
     QMap<long, User*> m_allUsers;
-    QMap<QString, long> m_usernameToIdMap;
+    QHash<StringId, long> m_usernameToIdMap;  // key 是驻留池中的 username id
 
     int m_onlineNumbers;
     int m_offlineNumbers;
@@ -0,0 +1,116 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// 常量初始化, 早于任何静态构造函数中的分配
+static std::atomic<quint64> s_allocations{0};
+
+quint64 allocationCount()
+{
+    return s_allocations.load(std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+
+#include <malloc.h>
+
+// 覆盖 malloc 系列, 转发到 glibc 的实现; operator new 最终也会走到这里, 不重复统计
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+
+    void* malloc(size_t size)
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    // QByteArray / QList 扩容走 realloc, 也算一次分配
+    void* realloc(void* pointer, size_t size)
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(pointer, size);
+    }
+}
+
+const char* allocationCountSource()
+{
+    return "malloc";
+}
+
+// 包括各个 arena 中已分配的块和直接 mmap 的大块
+qint64 heapBytesInUse()
+{
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+#else
+    struct mallinfo info = mallinfo();
+#endif
+    return qint64(info.uordblks) + qint64(info.hblkhd);
+}
+
+#else
+
+void* operator new(std::size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+const char* allocationCountSource()
+{
+    return "operator new";
+}
+
+qint64 heapBytesInUse()
+{
+    return -1;
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// 进程内的堆分配计数, 链接了 chatter_bench_support 的工具才有效
+// glibc 上统计 malloc / calloc / realloc (Qt 的容器直接使用 malloc), 其他平台只能统计 operator new
+quint64 allocationCount();
+// 当前平台统计的是哪一层分配, 写进结果里便于比较不同平台的数据
+const char* allocationCountSource();
+// 堆上仍在使用的字节数, 前后相减得到一段代码留下的内存; 只有 glibc 支持, 其他平台返回 -1
+qint64 heapBytesInUse();
+
+#endif  // ALLOCATIONCOUNTER_H
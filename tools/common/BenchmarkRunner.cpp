@@ -0,0 +1,90 @@
+#include "BenchmarkRunner.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QSysInfo>
+#include <QTextStream>
+#include <algorithm>
+
+QJsonObject BenchmarkRunner::Result::toJson() const
+{
+    QJsonObject json;
+    json["name"] = name;
+    json["iterations"] = iterations;
+    json["itemsPerOp"] = itemsPerOp;
+    json["nsPerOp"] = nsPerOp;
+    json["nsPerOpMin"] = nsPerOpMin;
+    json["nsPerItem"] = nsPerItem();
+    json["allocationsPerOp"] = allocationsPerOp;
+    json["allocationsPerItem"] = allocationsPerItem();
+    json["bytesPerOp"] = bytesPerOp;
+    json["bytesPerSecond"] = bytesPerSecond();
+    return json;
+}
+
+bool BenchmarkRunner::accepts(const QString& name) const
+{
+    return m_filter.pattern().isEmpty() || m_filter.match(name).hasMatch();
+}
+
+void BenchmarkRunner::record(Result result, QList<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    result.nsPerOp = samples[samples.size() / 2];
+    result.nsPerOpMin = samples.first();
+    m_results.append(result);
+}
+
+void BenchmarkRunner::printTable() const
+{
+    QTextStream out(stdout);
+    out << Qt::endl
+        << qSetFieldWidth(48) << Qt::left << "benchmark" << qSetFieldWidth(0) << Qt::right
+        << QString("ns/msg").rightJustified(14) << QString("allocs/msg").rightJustified(14)
+        << QString("bytes/op").rightJustified(12) << QString("MB/s").rightJustified(10)
+        << Qt::endl;
+    for (const Result& result : m_results)
+    {
+        out << qSetFieldWidth(48) << Qt::left << result.name << qSetFieldWidth(0) << Qt::right
+            << QString::number(result.nsPerItem(), 'f', 1).rightJustified(14)
+            << QString::number(result.allocationsPerItem(), 'f', 1).rightJustified(14)
+            << QString::number(result.bytesPerOp).rightJustified(12)
+            << (result.bytesPerOp > 0
+                    ? QString::number(result.bytesPerSecond() / 1048576.0, 'f', 1)
+                    : QString("-"))
+                   .rightJustified(10)
+            << Qt::endl;
+    }
+}
+
+QJsonObject BenchmarkRunner::environment()
+{
+    QJsonObject context;
+    context["qtVersion"] = QString::fromLatin1(qVersion());
+    context["buildAbi"] = QSysInfo::buildAbi();
+    context["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    context["os"] = QSysInfo::prettyProductName();
+    context["allocationSource"] = QString::fromLatin1(allocationCountSource());
+#ifdef QT_NO_DEBUG
+    context["buildType"] = "release";
+#else
+    context["buildType"] = "debug";
+#endif
+    return context;
+}
+
+QJsonObject BenchmarkRunner::toJson(const QString& suite) const
+{
+    QJsonArray results;
+    for (const Result& result : m_results) results.append(result.toJson());
+
+    QJsonObject context = environment();
+    context["minTimeMs"] = m_minTimeMs;
+    context["repetitions"] = m_repetitions;
+
+    QJsonObject json;
+    json["suite"] = suite;
+    json["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    json["context"] = context;
+    json["results"] = results;
+    return json;
+}
@@ -0,0 +1,123 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include "AllocationCounter.h"
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+
+// 微基准测试的计时器
+// 每个用例先预热, 再把迭代次数倍增到单次测量超过 minTimeMs, 然后重复测量几次取中位数.
+// 同时记录每次操作的堆分配次数和处理的字节数, 结果可以输出为表格或 JSON, 便于长期跟踪
+class BenchmarkRunner
+{
+   public:
+    struct Result
+    {
+        QString name;
+        qint64 iterations = 0;    // 每次测量的迭代次数
+        int itemsPerOp = 1;       // 一次操作处理的消息条数, 按条计算耗时
+        double nsPerOp = 0.0;     // 各次测量的中位数
+        double nsPerOpMin = 0.0;
+        double allocationsPerOp = 0.0;
+        qint64 bytesPerOp = 0;
+
+        double nsPerItem() const { return nsPerOp / itemsPerOp; }
+        double allocationsPerItem() const { return allocationsPerOp / itemsPerOp; }
+        double bytesPerSecond() const { return nsPerOp > 0 ? bytesPerOp * 1e9 / nsPerOp : 0.0; }
+        QJsonObject toJson() const;
+    };
+
+    void setMinTimeMs(int ms) { m_minTimeMs = ms; }
+    void setRepetitions(int repetitions) { m_repetitions = qMax(1, repetitions); }
+    void setFilter(const QRegularExpression& filter) { m_filter = filter; }
+    bool accepts(const QString& name) const;
+
+    // bytesPerOp 为 0 表示不计算吞吐量
+    template <typename Operation>
+    void run(const QString& name, qint64 bytesPerOp, int itemsPerOp, Operation&& operation);
+
+    const QList<Result>& results() const { return m_results; }
+    // 人读的表格, 写到标准输出
+    void printTable() const;
+    // 机器可读的结果, 带上 Qt 版本、编译器和分配统计方式等上下文
+    QJsonObject toJson(const QString& suite) const;
+    // Qt 版本、编译器、构建类型等与用例无关的上下文, 不用这个计时器的工具也可以写进结果
+    static QJsonObject environment();
+
+    // 防止编译器把没有用到的结果优化掉
+    template <typename T>
+    static void doNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static const void* volatile sink;
+        sink = &value;
+#endif
+    }
+
+   private:
+    static constexpr int WARMUP_ITERATIONS = 3;
+    static constexpr qint64 MAX_ITERATIONS = qint64(1) << 30;
+
+    template <typename Operation>
+    static qint64 measure(Operation& operation, qint64 iterations);
+    void record(Result result, QList<double> samples);
+
+    int m_minTimeMs = 200;
+    int m_repetitions = 5;
+    QRegularExpression m_filter;
+    QList<Result> m_results;
+};
+
+template <typename Operation>
+qint64 BenchmarkRunner::measure(Operation& operation, qint64 iterations)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 0; i < iterations; ++i) operation();
+    return timer.nsecsElapsed();
+}
+
+template <typename Operation>
+void BenchmarkRunner::run(const QString& name, qint64 bytesPerOp, int itemsPerOp,
+                          Operation&& operation)
+{
+    if (!accepts(name)) return;
+
+    for (int i = 0; i < WARMUP_ITERATIONS; ++i) operation();
+
+    // 每次按实际耗时估计需要的迭代次数, 最多放大 10 倍, 避免第一次测量受冷缓存影响估计过大
+    const qint64 targetNs = qint64(m_minTimeMs) * 1000000;
+    qint64 iterations = 1;
+    while (iterations < MAX_ITERATIONS)
+    {
+        qint64 elapsed = measure(operation, iterations);
+        if (elapsed >= targetNs) break;
+        double scale = elapsed > 0 ? 1.2 * targetNs / elapsed : 10.0;
+        iterations = qMin(MAX_ITERATIONS, qint64(iterations * qBound(2.0, scale, 10.0)));
+    }
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.itemsPerOp = qMax(1, itemsPerOp);
+    result.bytesPerOp = bytesPerOp;
+
+    QList<double> samples;
+    quint64 allocations = 0;
+    for (int r = 0; r < m_repetitions; ++r)
+    {
+        quint64 before = allocationCount();
+        qint64 elapsed = measure(operation, iterations);
+        allocations += allocationCount() - before;
+        samples.append(double(elapsed) / iterations);
+    }
+    result.allocationsPerOp = double(allocations) / (double(iterations) * m_repetitions);
+    record(result, samples);
+}
+
+#endif  // BENCHMARKRUNNER_H
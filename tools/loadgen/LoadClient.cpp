@@ -0,0 +1,164 @@
+#include "LoadClient.h"
+#include <QDebug>
+
+namespace
+{
+const QString PROBE_PREFIX = "lg ";    // 压测消息: "lg <发送时刻 us> <用户名>#<序号> <填充>"
+const int MAX_SENDS_PER_TICK = 100;    // 定时器被长时间阻塞后不一次补发太多
+const int MAX_SEND_INTERVAL = 1000;
+}  // namespace
+
+LoadClient::LoadClient(const QString& username, const QString& password,
+                       const QElapsedTimer& clock, QObject* parent)
+    : QObject(parent),
+      m_username(username),
+      m_password(password),
+      m_clock(clock),
+      m_client(new ChatClient(m_userInfo, this)),
+      m_sendTimer(new QTimer(this)),
+      m_probeTimer(new QTimer(this)),
+      m_random(QRandomGenerator::global()->generate())
+{
+    connect(m_sendTimer, &QTimer::timeout, this, &LoadClient::sendDue);
+    connect(m_probeTimer, &QTimer::timeout, this,
+            [this]()
+            {
+                if (m_loggedIn && m_client->isConnected()) m_client->probeNow();
+            });
+
+    // TCP 连上时 ChatClient 还没有登录; 能恢复会话时由 ChatClient 自己发 RESUME
+    connect(m_client, &ChatClient::connected, this,
+            [this]()
+            {
+                if (!m_loggedIn && !m_client->canResumeSession())
+                    m_client->login(m_username, m_password);
+            });
+    connect(m_client, &ChatClient::loginSuccess, this, [this]() { markUp(false); });
+    connect(m_client, &ChatClient::sessionResumed, this, [this]() { markUp(true); });
+    connect(m_client, &ChatClient::sessionResumeFailed, this,
+            [this]() { m_client->login(m_username, m_password); });
+    connect(m_client, &ChatClient::connectionStateChanged, this,
+            [this](ChatClient::ConnectionState state)
+            {
+                if (state != ChatClient::ConnectionState::Connected) markDown();
+            });
+    connect(m_client, &ChatClient::errorOccurred, this, [this]() { m_counters.errors++; });
+
+    connect(m_client, &ChatClient::messageReceived, this,
+            [this](const QString&, const QString& content, qint64) { handleContent(content); });
+    connect(m_client, &ChatClient::privateMessageReceived, this,
+            [this](const QString&, const QString& receiver, const QString& content, qint64)
+            {
+                // 服务器回显给发送者的私聊不算一次投递
+                if (receiver == m_username) handleContent(content);
+            });
+}
+
+void LoadClient::start(const QString& host, quint16 port)
+{
+    m_client->connectToServer(host, port);
+}
+
+void LoadClient::stop()
+{
+    m_sendTimer->stop();
+    m_probeTimer->stop();
+    m_loggedIn = false;  // 主动断开不计入断线次数
+    m_client->disconnectFromServer(true);
+}
+
+void LoadClient::markDown()
+{
+    if (!m_loggedIn) return;
+    m_loggedIn = false;
+    m_downSinceMs = m_clock.elapsed();
+    m_counters.disconnects++;
+}
+
+void LoadClient::markUp(bool resumed)
+{
+    if (m_loggedIn) return;
+    m_loggedIn = true;
+
+    if (m_downSinceMs >= 0)
+    {
+        if (resumed)
+            m_counters.resumes++;
+        else
+            m_counters.relogins++;
+        emit recovered(m_clock.elapsed() - m_downSinceMs, resumed);
+        m_downSinceMs = -1;
+    }
+
+    if (!m_everLoggedIn)
+    {
+        m_everLoggedIn = true;
+        if (m_rate > 0)
+        {
+            // 各个用户的发送时刻错开, 不在同一个定时器周期里一起发出
+            int interval = qBound(1, int(1000.0 / m_rate), MAX_SEND_INTERVAL);
+            m_sendStartMs = m_clock.elapsed() + m_random.bounded(interval);
+            m_sendTimer->setTimerType(interval < 20 ? Qt::PreciseTimer : Qt::CoarseTimer);
+            m_sendTimer->start(interval);
+        }
+        if (m_probeIntervalMs > 0) m_probeTimer->start(m_probeIntervalMs);
+        emit firstLogin();
+    }
+}
+
+void LoadClient::sendDue()
+{
+    qint64 elapsed = m_clock.elapsed() - m_sendStartMs;
+    if (elapsed < 0) return;
+
+    qint64 due = qint64(double(elapsed) * m_rate / 1000.0);
+    qint64 count = due - m_scheduled;
+    m_scheduled = due;
+    if (count <= 0) return;
+
+    // 断线期间到期的消息不补发, 否则恢复后的突发会淹没真实的延迟
+    if (!m_loggedIn || !m_client->isConnected())
+    {
+        m_counters.skipped += count;
+        return;
+    }
+    if (count > MAX_SENDS_PER_TICK)
+    {
+        m_counters.skipped += count - MAX_SENDS_PER_TICK;
+        count = MAX_SENDS_PER_TICK;
+    }
+
+    for (qint64 i = 0; i < count; ++i)
+    {
+        QString content = QString("%1%2 %3#%4 %5")
+                              .arg(PROBE_PREFIX)
+                              .arg(m_clock.nsecsElapsed() / 1000)
+                              .arg(m_username)
+                              .arg(++m_seq)
+                              .arg(m_padding);
+        if (m_mode == Mode::PrivateChat)
+        {
+            if (m_peers.isEmpty()) return;
+            QString peer = m_peers[m_random.bounded(int(m_peers.size()))];
+            if (peer == m_username) peer = m_peers[(m_peers.indexOf(peer) + 1) % m_peers.size()];
+            m_client->sendPrivateMessage(peer, content);
+        }
+        else
+        {
+            m_client->sendMessage(content);
+        }
+        m_counters.sent++;
+    }
+}
+
+void LoadClient::handleContent(const QString& content)
+{
+    if (!content.startsWith(PROBE_PREFIX)) return;
+
+    bool ok = false;
+    qint64 sentMicros = content.section(' ', 1, 1).toLongLong(&ok);
+    if (!ok) return;
+
+    m_counters.received++;
+    emit delivered(m_clock.nsecsElapsed() / 1000 - sentMicros);
+}
@@ -0,0 +1,103 @@
+#ifndef LOADCLIENT_H
+#define LOADCLIENT_H
+
+#include "network/ChatClient.h"
+#include "utils/UserInfo.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTimer>
+
+// 压测中的一个模拟用户: 自己的 UserInfo 和 ChatClient, 登录后按固定速率发送消息.
+// 消息内容带上发送时刻, 收到其他模拟用户的消息时算出端到端延迟.
+// 断线后由 ChatClient 自己重连和恢复会话, 这里只记录断开了多久以及是恢复还是重新登录的
+class LoadClient : public QObject
+{
+    Q_OBJECT
+
+   public:
+    enum class Mode
+    {
+        Chat,         // 公共聊天, 每条消息发给所有在线用户
+        PrivateChat,  // 私聊, 每条消息随机发给一个其他模拟用户
+    };
+
+    struct Counters
+    {
+        qint64 sent = 0;
+        qint64 skipped = 0;   // 未登录期间到期而没有发出的消息
+        qint64 received = 0;  // 收到的压测消息
+        qint64 errors = 0;
+        qint64 disconnects = 0;
+        qint64 resumes = 0;   // 重连后恢复了会话
+        qint64 relogins = 0;  // 重连后只能重新登录
+    };
+
+    // clock 由所有模拟用户共享, 发送和接收时刻在同一个时间轴上
+    LoadClient(const QString& username, const QString& password, const QElapsedTimer& clock,
+               QObject* parent = nullptr);
+
+    void setMode(Mode mode) { m_mode = mode; }
+    // 私聊的对象
+    void setPeers(const QStringList& peers) { m_peers = peers; }
+    // 每秒发送的消息数, 0 表示只接收
+    void setSendRate(double messagesPerSecond) { m_rate = messagesPerSecond; }
+    // 填充到消息内容中的字节数
+    void setPayloadSize(int bytes) { m_padding = QString(qMax(0, bytes), QChar('x')); }
+    // 登录后每隔 ms 发一次心跳探测 (控制帧), 0 表示不额外探测
+    void setProbeInterval(int ms) { m_probeIntervalMs = ms; }
+
+    void start(const QString& host, quint16 port);
+    void stop();
+
+    const QString& username() const { return m_username; }
+    bool isLoggedIn() const { return m_loggedIn; }
+    // ChatClient 的重连次数用完了
+    bool hasGivenUp() const
+    {
+        return m_client->connectionState() == ChatClient::ConnectionState::Error;
+    }
+    const Counters& counters() const { return m_counters; }
+    ChatClient* client() const { return m_client; }
+
+   signals:
+    void firstLogin();
+    // 一条压测消息到达, 延迟单位微秒
+    void delivered(qint64 latencyMicros);
+    // 断开后重新可用, resumed 为 true 表示恢复了原来的会话
+    void recovered(qint64 downtimeMs, bool resumed);
+
+   private slots:
+    void sendDue();
+
+   private:
+    void handleContent(const QString& content);
+    void markDown();
+    void markUp(bool resumed);
+
+    QString m_username;
+    QString m_password;
+    const QElapsedTimer& m_clock;
+    UserInfo m_userInfo;   // 必须先于 m_client 构造
+    ChatClient* m_client;
+    QTimer* m_sendTimer;
+    QTimer* m_probeTimer;
+    int m_probeIntervalMs = 0;
+    QRandomGenerator m_random;
+
+    Mode m_mode = Mode::Chat;
+    QStringList m_peers;
+    double m_rate = 0.0;
+    QString m_padding;
+
+    bool m_loggedIn = false;
+    bool m_everLoggedIn = false;
+    qint64 m_downSinceMs = -1;
+    qint64 m_sendStartMs = 0;   // 按 (now - m_sendStartMs) * rate 计算应发送的条数
+    qint64 m_scheduled = 0;     // 已经处理过的发送时刻数 (发出或跳过)
+    quint64 m_seq = 0;
+    Counters m_counters;
+};
+
+#endif  // LOADCLIENT_H
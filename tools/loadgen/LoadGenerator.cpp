@@ -0,0 +1,300 @@
+#include "LoadGenerator.h"
+#include "utils/MetricsRegistry.h"
+#include <QDateTime>
+#include <QSysInfo>
+#include <QTextStream>
+
+namespace
+{
+LoadClient::Counters operator-(const LoadClient::Counters& a, const LoadClient::Counters& b)
+{
+    LoadClient::Counters c;
+    c.sent = a.sent - b.sent;
+    c.skipped = a.skipped - b.skipped;
+    c.received = a.received - b.received;
+    c.errors = a.errors - b.errors;
+    c.disconnects = a.disconnects - b.disconnects;
+    c.resumes = a.resumes - b.resumes;
+    c.relogins = a.relogins - b.relogins;
+    return c;
+}
+
+// 一行摘要, 单位毫秒, 例如 "p50 1.20 p99 4.81 p999 9.73 max 12.02 ms (n=10000)"
+QString latencySummary(const MetricHistogram& histogram)
+{
+    MetricHistogram::Snapshot snapshot = histogram.snapshot();
+    return QString("p50 %1 p99 %2 p999 %3 max %4 ms (n=%5)")
+        .arg(snapshot.percentile(50.0) / 1000.0, 0, 'f', 2)
+        .arg(snapshot.percentile(99.0) / 1000.0, 0, 'f', 2)
+        .arg(snapshot.percentile(99.9) / 1000.0, 0, 'f', 2)
+        .arg(snapshot.max / 1000.0, 0, 'f', 2)
+        .arg(snapshot.count);
+}
+
+double perSecond(qint64 count, qint64 ms)
+{
+    return ms > 0 ? count * 1000.0 / ms : 0.0;
+}
+
+// 不限速时令牌桶总是满的, 聊天消息直接进入 OutboundQueue
+const double UNPACED_RATE = 1e6;
+const int UNPACED_BURST = 1000000;
+}  // namespace
+
+QJsonObject LoadOptions::toJson() const
+{
+    QJsonObject json;
+    json["host"] = host;
+    json["port"] = port;
+    json["clients"] = clients;
+    json["mode"] = mode == LoadClient::Mode::Chat ? "chat" : "private";
+    json["rate"] = rate;
+    json["payloadBytes"] = payloadBytes;
+    json["rampMs"] = rampMs;
+    json["warmupMs"] = warmupMs;
+    json["durationMs"] = durationMs;
+    json["saturate"] = saturate;
+    if (saturate) json["probeIntervalMs"] = probeIntervalMs;
+    return json;
+}
+
+LoadGenerator::LoadGenerator(const LoadOptions& options, QObject* parent)
+    : QObject(parent), m_options(options), m_progressTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    QStringList usernames;
+    for (int i = 0; i < m_options.clients; ++i)
+    {
+        usernames.append(QString("%1%2").arg(m_options.userPrefix).arg(i, 5, 10, QChar('0')));
+    }
+
+    for (const QString& username : usernames)
+    {
+        LoadClient* client = new LoadClient(username, m_options.password, m_clock, this);
+        client->setMode(m_options.mode);
+        client->setPeers(usernames);
+        client->setSendRate(m_options.rate);
+        client->setPayloadSize(m_options.payloadBytes);
+        if (m_options.saturate)
+        {
+            client->client()->sendPacer()->setRate(UNPACED_RATE, UNPACED_BURST);
+            client->setProbeInterval(m_options.probeIntervalMs);
+        }
+
+        connect(client, &LoadClient::firstLogin, this, [this]() { m_everLoggedIn++; });
+        connect(client, &LoadClient::delivered, this,
+                [this](qint64 latencyMicros)
+                {
+                    if (!m_measuring) return;
+                    m_latency.record(latencyMicros);
+                    m_intervalLatency.record(latencyMicros);
+                });
+        connect(client, &LoadClient::recovered, this,
+                [this](qint64 downtimeMs, bool)
+                {
+                    if (m_measuring) m_recovery.record(downtimeMs * 1000);
+                });
+        m_clients.append(client);
+    }
+
+    connect(m_progressTimer, &QTimer::timeout, this, &LoadGenerator::printProgress);
+}
+
+void LoadGenerator::start()
+{
+    for (int i = 0; i < m_clients.size(); ++i)
+    {
+        LoadClient* client = m_clients[i];
+        int delay = m_clients.size() > 1 ? int(qint64(m_options.rampMs) * i / m_clients.size()) : 0;
+        QTimer::singleShot(delay, client, [this, client]()
+                           { client->start(m_options.host, m_options.port); });
+    }
+    QTimer::singleShot(m_options.rampMs + m_options.warmupMs, this,
+                       &LoadGenerator::beginMeasurement);
+    if (m_options.reportIntervalMs > 0) m_progressTimer->start(m_options.reportIntervalMs);
+}
+
+void LoadGenerator::beginMeasurement()
+{
+    m_baseline = totalCounters();
+    for (int i = 0; i < OutboundQueue::PriorityCount; ++i)
+    {
+        m_laneBaseline[i] = laneTotals(static_cast<OutboundQueue::Priority>(i));
+    }
+    m_latency.reset();
+    m_intervalLatency.reset();
+    m_recovery.reset();
+    m_measureStartMs = m_clock.elapsed();
+    m_measuring = true;
+    QTimer::singleShot(m_options.durationMs, this, &LoadGenerator::finish);
+}
+
+void LoadGenerator::finish()
+{
+    m_measuring = false;
+    m_measureEndMs = m_clock.elapsed();
+    m_final = totalCounters() - m_baseline;
+    for (int i = 0; i < OutboundQueue::PriorityCount; ++i)
+    {
+        m_laneFinal[i] = laneTotals(static_cast<OutboundQueue::Priority>(i));
+    }
+    m_progressTimer->stop();
+    for (LoadClient* client : m_clients) client->stop();
+    emit finished();
+}
+
+LoadClient::Counters LoadGenerator::totalCounters() const
+{
+    LoadClient::Counters total;
+    for (const LoadClient* client : m_clients)
+    {
+        const LoadClient::Counters& c = client->counters();
+        total.sent += c.sent;
+        total.skipped += c.skipped;
+        total.received += c.received;
+        total.errors += c.errors;
+        total.disconnects += c.disconnects;
+        total.resumes += c.resumes;
+        total.relogins += c.relogins;
+    }
+    return total;
+}
+
+LoadGenerator::LaneTotals LoadGenerator::laneTotals(OutboundQueue::Priority priority) const
+{
+    LaneTotals total;
+    for (const LoadClient* client : m_clients)
+    {
+        OutboundQueue::ClassStats stats = client->client()->outboundQueue()->stats(priority);
+        total.frames += stats.frames;
+        total.queued += stats.queued;
+        total.totalQueueMs += stats.totalQueueMs;
+        total.maxQueueMs = qMax(total.maxQueueMs, stats.maxQueueMs);
+    }
+    return total;
+}
+
+QJsonObject LoadGenerator::laneJson(OutboundQueue::Priority priority) const
+{
+    const LaneTotals& end = m_laneFinal[static_cast<int>(priority)];
+    const LaneTotals& begin = m_laneBaseline[static_cast<int>(priority)];
+    quint64 frames = end.frames - begin.frames;
+    QJsonObject json;
+    json["frames"] = qint64(frames);
+    json["queued"] = qint64(end.queued - begin.queued);
+    json["averageQueueMs"] = frames ? double(end.totalQueueMs - begin.totalQueueMs) / frames : 0.0;
+    json["maxQueueMs"] = end.maxQueueMs;
+    return json;
+}
+
+int LoadGenerator::loggedInCount() const
+{
+    int count = 0;
+    for (const LoadClient* client : m_clients)
+    {
+        if (client->isLoggedIn()) count++;
+    }
+    return count;
+}
+
+void LoadGenerator::printProgress()
+{
+    LoadClient::Counters total = totalCounters();
+    QTextStream(stdout) << QString("[%1s] online %2/%3 sent %4 delivered %5 disconnects %6 | %7")
+                               .arg(m_clock.elapsed() / 1000.0, 0, 'f', 1)
+                               .arg(loggedInCount())
+                               .arg(m_clients.size())
+                               .arg(total.sent)
+                               .arg(total.received)
+                               .arg(total.disconnects)
+                               .arg(m_measuring ? latencySummary(m_intervalLatency) : QString("warmup"))
+                        << Qt::endl;
+    m_intervalLatency.reset();
+}
+
+bool LoadGenerator::passed() const
+{
+    int gaveUp = 0;
+    for (const LoadClient* client : m_clients)
+    {
+        if (client->hasGivenUp()) gaveUp++;
+    }
+    bool delivered = m_options.rate <= 0 || m_final.received > 0;
+    return m_everLoggedIn == m_clients.size() && gaveUp == 0 && delivered;
+}
+
+QJsonObject LoadGenerator::toJson() const
+{
+    qint64 elapsedMs = m_measureEndMs - m_measureStartMs;
+    int gaveUp = 0;
+    for (const LoadClient* client : m_clients)
+    {
+        if (client->hasGivenUp()) gaveUp++;
+    }
+
+    QJsonObject reconnects;
+    reconnects["disconnects"] = m_final.disconnects;
+    reconnects["resumes"] = m_final.resumes;
+    reconnects["relogins"] = m_final.relogins;
+    reconnects["gaveUp"] = gaveUp;
+    reconnects["recoveryUs"] = m_recovery.snapshot().toJson();
+
+    QJsonObject results;
+    results["elapsedMs"] = elapsedMs;
+    results["everLoggedIn"] = m_everLoggedIn;
+    results["sent"] = m_final.sent;
+    results["skipped"] = m_final.skipped;
+    results["delivered"] = m_final.received;
+    results["errors"] = m_final.errors;
+    results["sentPerSecond"] = perSecond(m_final.sent, elapsedMs);
+    results["deliveredPerSecond"] = perSecond(m_final.received, elapsedMs);
+    results["latencyUs"] = m_latency.snapshot().toJson();
+    results["reconnects"] = reconnects;
+    QJsonObject sendQueue;
+    sendQueue["control"] = laneJson(OutboundQueue::Priority::Control);
+    sendQueue["interactive"] = laneJson(OutboundQueue::Priority::Interactive);
+    sendQueue["bulk"] = laneJson(OutboundQueue::Priority::Bulk);
+    results["sendQueue"] = sendQueue;
+    results["passed"] = passed();
+    // 进程内所有模拟客户端共用同一个指标注册表, 这里是合计值
+    results["clientMetrics"] = MetricsRegistry::instance().toJson();
+
+    QJsonObject context;
+    context["qtVersion"] = QString::fromLatin1(qVersion());
+    context["buildAbi"] = QSysInfo::buildAbi();
+    context["os"] = QSysInfo::prettyProductName();
+
+    QJsonObject json;
+    json["suite"] = "loadgen";
+    json["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    json["context"] = context;
+    json["options"] = m_options.toJson();
+    json["results"] = results;
+    return json;
+}
+
+void LoadGenerator::printSummary() const
+{
+    qint64 elapsedMs = m_measureEndMs - m_measureStartMs;
+    QJsonObject control = laneJson(OutboundQueue::Priority::Control);
+    QTextStream out(stdout);
+    out << Qt::endl
+        << "clients     " << m_clients.size() << " (logged in " << m_everLoggedIn << ")"
+        << Qt::endl
+        << "sent        " << m_final.sent << " ("
+        << QString::number(perSecond(m_final.sent, elapsedMs), 'f', 1) << "/s), skipped "
+        << m_final.skipped << Qt::endl
+        << "delivered   " << m_final.received << " ("
+        << QString::number(perSecond(m_final.received, elapsedMs), 'f', 1) << "/s)" << Qt::endl
+        << "latency     " << latencySummary(m_latency) << Qt::endl
+        << "reconnects  " << m_final.disconnects << " disconnects, " << m_final.resumes
+        << " resumed, " << m_final.relogins << " re-login" << Qt::endl
+        << "recovery    " << latencySummary(m_recovery) << Qt::endl
+        << "control q   " << control["frames"].toInteger() << " frames ("
+        << control["queued"].toInteger() << " queued), avg "
+        << QString::number(control["averageQueueMs"].toDouble(), 'f', 2) << " ms, max "
+        << control["maxQueueMs"].toInteger() << " ms" << Qt::endl
+        << "errors      " << m_final.errors << Qt::endl
+        << (passed() ? "PASS" : "FAIL") << Qt::endl;
+}
@@ -0,0 +1,93 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include "LoadClient.h"
+#include "utils/MetricsRegistry.h"
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+struct LoadOptions
+{
+    QString host = "127.0.0.1";
+    quint16 port = 0;
+    int clients = 10;
+    QString userPrefix = "loadgen";
+    QString password = "loadgen";
+    LoadClient::Mode mode = LoadClient::Mode::Chat;
+    double rate = 1.0;          // 每个用户每秒发送的消息数
+    int payloadBytes = 0;
+    int rampMs = 1000;          // 在这段时间内陆续发起连接, 避免所有用户同时登录
+    int warmupMs = 2000;        // 连接完成后先运行一段时间再开始统计
+    int durationMs = 30000;     // 统计的时长
+    int reportIntervalMs = 5000;
+    // 发送队列饱和的场景: 不限制聊天消息的发送速率, 让 socket 写缓冲区一直处于水位线以上,
+    // 同时按 probeIntervalMs 发送心跳探测, 统计控制帧在队列中的排队时间
+    bool saturate = false;
+    int probeIntervalMs = 200;
+
+    QJsonObject toJson() const;
+};
+
+// 驱动多个 LoadClient: 分批连接、预热、统计一段时间后断开, 汇总延迟、吞吐量和重连情况
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+
+   public:
+    explicit LoadGenerator(const LoadOptions& options, QObject* parent = nullptr);
+
+    void start();
+
+    // 所有用户都登录过、没有用户放弃重连, 发送时至少有一条消息送达
+    bool passed() const;
+    QJsonObject toJson() const;
+    void printSummary() const;
+
+   signals:
+    void finished();
+
+   private slots:
+    void beginMeasurement();
+    void finish();
+    void printProgress();
+
+   private:
+    // 所有模拟用户的 OutboundQueue 在一个优先级上的合计
+    struct LaneTotals
+    {
+        quint64 frames = 0;
+        quint64 queued = 0;
+        qint64 totalQueueMs = 0;
+        qint64 maxQueueMs = 0;
+    };
+
+    LoadClient::Counters totalCounters() const;
+    LaneTotals laneTotals(OutboundQueue::Priority priority) const;
+    // 统计期间的排队情况; maxQueueMs 无法扣除预热阶段, 是整个运行期间的最大值
+    QJsonObject laneJson(OutboundQueue::Priority priority) const;
+    int loggedInCount() const;
+
+    LoadOptions m_options;
+    QElapsedTimer m_clock;
+    QList<LoadClient*> m_clients;
+    QTimer* m_progressTimer;
+
+    bool m_measuring = false;
+    qint64 m_measureStartMs = 0;
+    qint64 m_measureEndMs = 0;
+    LoadClient::Counters m_baseline;  // 统计开始时的计数, 预热期间的不算
+    LoadClient::Counters m_final;
+    LaneTotals m_laneBaseline[OutboundQueue::PriorityCount];
+    LaneTotals m_laneFinal[OutboundQueue::PriorityCount];
+    int m_everLoggedIn = 0;
+
+    // 单位微秒, 不放进注册表, 预热结束时清零
+    MetricHistogram m_latency;          // 统计期间的端到端延迟
+    MetricHistogram m_intervalLatency;  // 上一次进度输出之后的延迟
+    MetricHistogram m_recovery;         // 断线到重新可用的时间
+};
+
+#endif  // LOADGENERATOR_H
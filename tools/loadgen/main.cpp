@@ -0,0 +1,161 @@
+#include "LoadGenerator.h"
+#include "utils/ConfigManager.h"
+#include "utils/Logging.h"
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QTextStream>
+
+// 无界面的压测工具: 同时登录 N 个用户, 按固定速率收发消息, 统计端到端延迟、吞吐量和重连
+// 例: chatter_mock_server --tcp-port 9100 --disconnect-every 20000 &
+//     chatter_loadgen --port 9100 --clients 200 --rate 2 --duration 60 --json loadgen.json
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chatter_loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless load generator driving N simulated chat clients");
+    parser.addHelpOption();
+
+    QCommandLineOption configOption("config", "Client config providing tcp.host and tcp.port",
+                                    "file", "resources/config.json");
+    QCommandLineOption hostOption("host", "Override tcp.host", "host");
+    QCommandLineOption portOption("port", "Override tcp.port", "port");
+    QCommandLineOption clientsOption("clients", "Number of simulated clients", "count", "10");
+    QCommandLineOption modeOption("mode", "chat (broadcast) or private", "mode", "chat");
+    QCommandLineOption rateOption("rate", "Messages per second per client (0 = receive only)",
+                                  "rate", "1");
+    QCommandLineOption payloadOption("payload", "Extra bytes of content per message", "bytes",
+                                     "0");
+    QCommandLineOption rampOption("ramp", "Spread connection attempts over this time", "ms",
+                                  "1000");
+    QCommandLineOption warmupOption("warmup", "Run before measuring", "ms", "2000");
+    QCommandLineOption durationOption("duration", "Measurement time", "seconds", "30");
+    QCommandLineOption reportOption("report-interval", "Print progress periodically (0 = off)",
+                                    "ms", "5000");
+    QCommandLineOption userPrefixOption("user-prefix", "Username prefix of simulated users",
+                                        "prefix", "loadgen");
+    QCommandLineOption passwordOption("password", "Password of simulated users", "password",
+                                      "loadgen");
+    QCommandLineOption jsonOption("json", "Write machine-readable results to file ('-' = stdout)",
+                                  "file");
+    QCommandLineOption saturateOption("saturate",
+                                      "Unpaced sends that keep the send queue full, with "
+                                      "heartbeat probes measuring the control lane");
+    QCommandLineOption probeIntervalOption("probe-interval",
+                                           "Heartbeat probe interval with --saturate", "ms", "200");
+    QCommandLineOption verboseOption("verbose", "Keep client logging, including chatter.* debug output");
+
+    parser.addOptions({configOption, hostOption, portOption, clientsOption, modeOption, rateOption,
+                       payloadOption, rampOption, warmupOption, durationOption, reportOption,
+                       userPrefixOption, passwordOption, jsonOption, saturateOption,
+                       probeIntervalOption, verboseOption});
+    parser.process(app);
+
+    // N 个客户端的调试输出会淹没结果, 也会拖慢事件循环; --verbose 时交给后台线程输出
+    if (parser.isSet(verboseOption))
+    {
+        QLoggingCategory::setFilterRules("chatter.*.debug=true");
+        QString logError;
+        Logging::installAsyncSink(Logging::SinkOptions(), logError);
+    }
+    else
+    {
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false\n*.warning=false");
+    }
+
+    ConfigManager& config = ConfigManager::instance();
+    if (!config.loadConfig(parser.value(configOption)))
+    {
+        qCritical() << "无法加载配置文件, 需要通过 --host / --port 指定服务器:"
+                    << parser.value(configOption);
+    }
+
+    LoadOptions options;
+    options.host = parser.isSet(hostOption) ? parser.value(hostOption) : config.tcpHost();
+    options.port = parser.isSet(portOption) ? parser.value(portOption).toUShort()
+                                            : config.tcpPort();
+    options.clients = qMax(1, parser.value(clientsOption).toInt());
+    options.rate = qMax(0.0, parser.value(rateOption).toDouble());
+    options.payloadBytes = parser.value(payloadOption).toInt();
+    options.rampMs = qMax(0, parser.value(rampOption).toInt());
+    options.warmupMs = qMax(0, parser.value(warmupOption).toInt());
+    options.durationMs = qMax(1, int(parser.value(durationOption).toDouble() * 1000));
+    options.reportIntervalMs = parser.value(reportOption).toInt();
+    options.userPrefix = parser.value(userPrefixOption);
+    options.password = parser.value(passwordOption);
+    options.saturate = parser.isSet(saturateOption);
+    options.probeIntervalMs = qMax(1, parser.value(probeIntervalOption).toInt());
+    if (options.saturate)
+    {
+        // 没有指定时用足以让写缓冲区持续积压的速率和消息大小
+        if (!parser.isSet(rateOption)) options.rate = 200;
+        if (!parser.isSet(payloadOption)) options.payloadBytes = 8192;
+    }
+
+    QString mode = parser.value(modeOption);
+    if (mode == "chat")
+    {
+        options.mode = LoadClient::Mode::Chat;
+    }
+    else if (mode == "private")
+    {
+        options.mode = LoadClient::Mode::PrivateChat;
+    }
+    else
+    {
+        qCritical() << "Unknown mode:" << mode;
+        return 1;
+    }
+    if (options.host.isEmpty() || options.port == 0)
+    {
+        qCritical() << "No server address, use --host and --port";
+        return 1;
+    }
+    // ChatClient 会同时尝试配置中的地址, 覆盖后只连接指定的服务器
+    config.setTcpHost(options.host);
+    config.setTcpPort(options.port);
+
+    QString jsonPath = parser.value(jsonOption);
+    // 结果写到标准输出时不打印进度和表格, 保持输出是合法的 JSON
+    if (jsonPath == "-") options.reportIntervalMs = 0;
+
+    LoadGenerator generator(options);
+    int exitCode = 0;
+    QObject::connect(&generator, &LoadGenerator::finished, &app,
+                     [&]()
+                     {
+                         if (jsonPath != "-") generator.printSummary();
+                         if (!jsonPath.isEmpty())
+                         {
+                             QByteArray json = QJsonDocument(generator.toJson()).toJson();
+                             if (jsonPath == "-")
+                             {
+                                 QTextStream(stdout) << json;
+                             }
+                             else
+                             {
+                                 QFile file(jsonPath);
+                                 if (!file.open(QIODevice::WriteOnly) ||
+                                     file.write(json) != json.size())
+                                 {
+                                     qCritical() << "Cannot write results:" << jsonPath
+                                                 << file.errorString();
+                                     exitCode = 1;
+                                 }
+                             }
+                         }
+                         if (!generator.passed()) exitCode = 1;
+                         app.exit(exitCode);
+                     });
+    generator.start();
+    int result = app.exec();
+    Logging::shutdownAsyncSink();
+    return result;
+}
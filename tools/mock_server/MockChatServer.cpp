@@ -0,0 +1,981 @@
+#include "MockChatServer.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QPair>
+#include <QUuid>
+#include <algorithm>
+
+Q_LOGGING_CATEGORY(lcMock, "chatter.mock", QtInfoMsg)
+
+// 负载生成的节拍: 速率按经过的时间累积, 高速率时一个节拍内发出多条
+const int LOAD_TICK_INTERVAL = 10;
+// 保留的最近消息和事件数量, 决定 RESUME 最多能补发多少
+const int HISTORY_CAPACITY = 10000;
+const int EVENT_CAPACITY = 2000;
+const char BOT_PASSWORD[] = "bot";
+
+// 机器人消息的内容从这段文字中截取, 长度随机, 接近真实聊天的长度分布
+const QString FILLER_TEXT = QStringLiteral(
+    "今天的构建又挂了, 谁动了 CMakeLists? 我看一下日志, 好像是链接顺序的问题. "
+    "The quick brown fox jumps over the lazy dog while the build server reboots again. "
+    "下午三点开会, 记得带上上周的压测数据和延迟分布图, 尤其是 p99 的那一部分.");
+
+LoadProfile LoadProfile::fromJson(const QJsonObject& json, const LoadProfile& defaults)
+{
+    LoadProfile profile = defaults;
+    profile.onlineUsers = json["onlineUsers"].toInt(profile.onlineUsers);
+    profile.offlineUsers = json["offlineUsers"].toInt(profile.offlineUsers);
+    profile.historySize = json["historySize"].toInt(profile.historySize);
+    profile.groups = json["groups"].toInt(profile.groups);
+    profile.groupMembers = json["groupMembers"].toInt(profile.groupMembers);
+    profile.chatRate = json["chatRate"].toDouble(profile.chatRate);
+    profile.groupChatRate = json["groupChatRate"].toDouble(profile.groupChatRate);
+    profile.presenceRate = json["presenceRate"].toDouble(profile.presenceRate);
+    profile.latencyMs = json["latencyMs"].toInt(profile.latencyMs);
+    profile.jitterMs = json["jitterMs"].toInt(profile.jitterMs);
+    profile.disconnectEveryMs = json["disconnectEveryMs"].toInt(profile.disconnectEveryMs);
+    profile.echoToSender = json["echoToSender"].toBool(profile.echoToSender);
+    profile.acceptDeflate = json["acceptDeflate"].toBool(profile.acceptDeflate);
+    profile.acceptCbor = json["acceptCbor"].toBool(profile.acceptCbor);
+    profile.acceptConnectionAuth =
+        json["acceptConnectionAuth"].toBool(profile.acceptConnectionAuth);
+    profile.rateLimit = json["rateLimit"].toDouble(profile.rateLimit);
+    profile.rateBurst = json["rateBurst"].toInt(profile.rateBurst);
+    profile.seed = static_cast<quint32>(json["seed"].toInteger(profile.seed));
+    return profile;
+}
+
+MockChatServer::MockChatServer(const LoadProfile& profile, QObject* parent)
+    : QObject(parent),
+      m_profile(profile),
+      m_server(new QTcpServer(this)),
+      m_loadTimer(new QTimer(this)),
+      m_disconnectTimer(new QTimer(this)),
+      m_random(profile.seed)
+{
+    m_clock.start();
+    connect(m_server, &QTcpServer::newConnection, this, &MockChatServer::onNewConnection);
+
+    m_loadTimer->setInterval(LOAD_TICK_INTERVAL);
+    m_loadTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_loadTimer, &QTimer::timeout, this, &MockChatServer::generateLoad);
+    if (m_profile.chatRate > 0 || m_profile.groupChatRate > 0 || m_profile.presenceRate > 0)
+    {
+        m_loadTimer->start();
+    }
+
+    connect(m_disconnectTimer, &QTimer::timeout, this, &MockChatServer::injectDisconnect);
+    if (m_profile.disconnectEveryMs > 0)
+    {
+        m_disconnectTimer->start(m_profile.disconnectEveryMs);
+    }
+
+    seedData();
+}
+
+bool MockChatServer::listen(const QHostAddress& address, quint16 port)
+{
+    return m_server->listen(address, port);
+}
+
+void MockChatServer::seedData()
+{
+    int botCount = m_profile.onlineUsers + m_profile.offlineUsers;
+    for (int i = 0; i < botCount; ++i)
+    {
+        QString username = QString("bot%1").arg(i + 1, 4, 10, QChar('0'));
+        MockUser& bot = addUser(username, QString("机器人%1").arg(i + 1), BOT_PASSWORD, true);
+        bot.online = i < m_profile.onlineUsers;
+        (bot.online ? m_onlineBots : m_offlineBots).append(username);
+    }
+
+    if (botCount > 0)
+    {
+        for (int i = 0; i < m_profile.groups; ++i)
+        {
+            MockGroup group;
+            group.groupId = m_nextGroupId++;
+            group.groupName = QString("压测群%1").arg(i + 1);
+            group.creatorId = m_users[m_onlineBots.value(0, m_offlineBots.value(0))].userId;
+            group.memberIds.append(group.creatorId);
+            for (int j = 0; j < m_profile.groupMembers && group.memberIds.size() < botCount; ++j)
+            {
+                long memberId = 1 + m_random.bounded(botCount);
+                if (!group.memberIds.contains(memberId)) group.memberIds.append(memberId);
+            }
+            m_presetGroupIds.append(group.groupId);
+            m_groups.insert(group.groupId, group);
+        }
+    }
+
+    for (int i = 0; i < m_profile.historySize && !m_onlineBots.isEmpty(); ++i)
+    {
+        generateBotChat();
+    }
+}
+
+MockChatServer::MockUser& MockChatServer::addUser(const QString& username, const QString& nickname,
+                                                  const QString& password, bool bot)
+{
+    MockUser user;
+    user.userId = m_nextUserId++;
+    user.username = username;
+    user.nickname = nickname;
+    user.password = password;
+    user.bot = bot;
+    m_usernameById.insert(user.userId, username);
+    return *m_users.insert(username, user);
+}
+
+QJsonObject MockChatServer::userJson(const MockUser& user) const
+{
+    QJsonObject json;
+    json["userId"] = static_cast<qint64>(user.userId);
+    json["username"] = user.username;
+    json["nickname"] = user.nickname;
+    json["avatarUrl"] = "";
+    return json;
+}
+
+QJsonObject MockChatServer::groupJson(const MockGroup& group) const
+{
+    QJsonArray members;
+    for (long memberId : group.memberIds)
+    {
+        members.append(userJson(m_users.value(m_usernameById.value(memberId))));
+    }
+    QJsonObject json;
+    json["groupId"] = static_cast<qint64>(group.groupId);
+    json["groupName"] = group.groupName;
+    json["creatorId"] = static_cast<qint64>(group.creatorId);
+    json["createdAt"] = QJsonValue::Null;
+    json["members"] = members;
+    return json;
+}
+
+QJsonArray MockChatServer::groupHistory(long groupId) const
+{
+    QJsonArray history;
+    for (const QJsonObject& message : m_history)
+    {
+        if (message["type"].toString() != "GROUP_CHAT" ||
+            message["groupId"].toVariant().toLongLong() != groupId)
+            continue;
+        QJsonObject dto;
+        dto["messageId"] = message["messageId"];
+        dto["userId"] = message["userId"];
+        dto["content"] = message["content"];
+        dto["timestamp"] = message["timestamp"];
+        history.append(dto);
+    }
+    return history;
+}
+
+QString MockChatServer::usernameForToken(const QString& token) const
+{
+    return m_tokens.value(token);
+}
+
+QJsonObject MockChatServer::storeFile(const QString& fileName, const QByteArray& data)
+{
+    QString fileId = QString::number(m_nextFileId++);
+    m_files.insert(fileId, {fileName, data});
+
+    QJsonObject fileInfo;
+    fileInfo["fileUrl"] = m_fileBaseUrl + '/' + fileId;
+    fileInfo["fileName"] = fileName;
+    fileInfo["fileSize"] = static_cast<qint64>(data.size());
+    return fileInfo;
+}
+
+QByteArray MockChatServer::fileData(const QString& fileId, QString* fileName, bool* found) const
+{
+    auto it = m_files.constFind(fileId);
+    *found = it != m_files.constEnd();
+    if (!*found) return QByteArray();
+    if (fileName) *fileName = it->fileName;
+    return it->data;
+}
+
+void MockChatServer::deliverFile(const QString& sender, const QString& receiver,
+                                 const QJsonObject& fileInfo)
+{
+    QJsonObject message;
+    message["type"] = "FILE";
+    message["username"] = sender;
+    message["nickname"] = m_users.value(sender).nickname;
+    message["receiver"] = receiver;
+    message["content"] = fileInfo;
+    sendToUser(receiver, recordMessage(message));
+}
+
+void MockChatServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection())
+    {
+        Session* session = new Session;
+        session->socket = socket;
+        session->delayTimer = new QTimer(socket);
+        session->delayTimer->setSingleShot(true);
+        session->delayTimer->setTimerType(Qt::PreciseTimer);
+        connect(session->delayTimer, &QTimer::timeout, this,
+                [this, socket]()
+                {
+                    Session* current = m_sessions.value(socket);
+                    if (current) flushDelayed(current);
+                });
+
+        m_sessions.insert(socket, session);
+        m_stats.connections++;
+        connect(socket, &QTcpSocket::readyRead, this, &MockChatServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &MockChatServer::onDisconnected);
+        qCDebug(lcMock) << "Client connected:" << socket->peerAddress().toString()
+                        << socket->peerPort();
+    }
+}
+
+void MockChatServer::onReadyRead()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    Session* session = m_sessions.value(socket);
+    if (!session) return;
+
+    QByteArray data = socket->readAll();
+    m_stats.bytesIn += data.size();
+    session->codec.append(data);
+
+    QJsonObject message;
+    QString error;
+    while (true)
+    {
+        FrameCodec::DecodeResult result = session->codec.decodeNext(message, error);
+        if (result == FrameCodec::DecodeResult::NeedMore) return;
+        if (result == FrameCodec::DecodeResult::Error)
+        {
+            qCWarning(lcMock) << "Invalid frame from client:" << error;
+            sendError(session, error);
+            continue;
+        }
+        if (result == FrameCodec::DecodeResult::Corrupt)
+        {
+            qCWarning(lcMock) << "Corrupt stream from client, closing:" << error;
+            socket->abort();
+            return;
+        }
+
+        m_stats.framesIn++;
+        handleMessage(session, message);
+        // LOGOUT 等处理会关闭连接, 之后 session 已经被删除
+        if (!m_sessions.contains(socket)) return;
+    }
+}
+
+void MockChatServer::onDisconnected()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    Session* session = m_sessions.take(socket);
+    if (!session) return;
+
+    QString username = session->username;
+    if (!username.isEmpty()) m_sessionsByUser.remove(username, session);
+    delete session;
+    socket->deleteLater();
+
+    // 同一用户的最后一个连接断开时才算下线, token 保留, 之后可以 RESUME
+    if (!username.isEmpty() && !m_sessionsByUser.contains(username))
+    {
+        auto it = m_users.find(username);
+        if (it != m_users.end())
+        {
+            it->online = false;
+            QJsonObject event;
+            event["type"] = "USER_LOGOUT";
+            event["content"] = userJson(*it);
+            broadcast(recordEvent(event));
+        }
+    }
+}
+
+void MockChatServer::handleMessage(Session* session, const QJsonObject& message)
+{
+    QString type = message["type"].toString();
+    if (type == "LOGIN")
+    {
+        handleLogin(session, message);
+    }
+    else if (type == "REGISTER")
+    {
+        handleRegister(session, message);
+    }
+    else if (type == "RESUME")
+    {
+        handleResume(session, message);
+    }
+    else if (type == "HEARTBEAT")
+    {
+        // 原样带回 seq 和 sentAt, 客户端据此计算 RTT
+        QJsonObject response;
+        response["type"] = "HEARTBEAT";
+        if (message.contains("seq")) response["seq"] = message["seq"];
+        if (message.contains("sentAt")) response["sentAt"] = message["sentAt"];
+        send(session, response);
+    }
+    else if (session->username.isEmpty())
+    {
+        // 身份绑定在连接上, 登录之前的业务消息一律拒绝
+        m_stats.rejectedFrames++;
+        sendError(session, "未登录或会话已失效");
+    }
+    else if (!session->codec.connectionAuth() &&
+             m_tokens.value(message["token"].toString()) != session->username)
+    {
+        // 没有协商 connectionAuth 的连接按旧协议处理, 每条业务消息都要带上有效的 token
+        m_stats.rejectedFrames++;
+        sendError(session, "token 无效");
+    }
+    else if (type == "CHAT")
+    {
+        handleChat(session, message);
+    }
+    else if (type == "PRIVATE_CHAT")
+    {
+        handlePrivateChat(session, message);
+    }
+    else if (type == "GROUP_CHAT")
+    {
+        handleGroupChat(session, message);
+    }
+    else if (type.startsWith("GROUP_"))
+    {
+        handleGroupTask(session, message);
+    }
+    else if (type == "FILE")
+    {
+        handleFile(session, message);
+    }
+    else if (type == "LOGOUT")
+    {
+        handleLogout(session);
+    }
+    else
+    {
+        sendError(session, QString("未知消息类型: %1").arg(type));
+    }
+}
+
+void MockChatServer::handleLogin(Session* session, const QJsonObject& message)
+{
+    QString username = message["username"].toString();
+    QString password = message["password"].toString();
+
+    QJsonObject response;
+    response["type"] = "LOGIN";
+    if (username.isEmpty())
+    {
+        response["status"] = "error";
+        response["errorMessage"] = "用户名不能为空";
+        send(session, response);
+        return;
+    }
+
+    // 不要求先注册: 第一次登录时自动创建用户, 压测工具可以直接使用任意用户名
+    auto it = m_users.find(username);
+    MockUser& user = it != m_users.end() ? *it : addUser(username, username, password, false);
+    if (user.password != password)
+    {
+        response["status"] = "error";
+        response["errorMessage"] = "用户名或密码错误";
+        send(session, response);
+        return;
+    }
+
+    bool wasOnline = user.online;
+    QJsonObject accepted = bindSession(session, user, message["capabilities"].toObject());
+    response["status"] = "success";
+    response["token"] = session->token;
+    response["userId"] = static_cast<qint64>(user.userId);
+    response["username"] = user.username;
+    response["nickname"] = user.nickname;
+    // 登录快照对应的事件序号, 客户端断线恢复时只需要补发之后的事件
+    response["eventSeq"] = m_nextEventSeq - 1;
+    if (message.contains("capabilities")) response["capabilities"] = accepted;
+    send(session, response);
+    // 响应本身还是 JSON 文本, 从下一帧开始使用协商好的格式
+    session->codec.applyCapabilities(accepted);
+
+    sendInitialState(session);
+    if (!wasOnline)
+    {
+        QJsonObject event;
+        event["type"] = "USER_LOGIN";
+        event["content"] = userJson(user);
+        broadcast(recordEvent(event), session);
+    }
+}
+
+void MockChatServer::handleRegister(Session* session, const QJsonObject& message)
+{
+    QString username = message["username"].toString();
+    QJsonObject response;
+    response["type"] = "REGISTER";
+    if (username.isEmpty() || m_users.contains(username))
+    {
+        response["status"] = "error";
+        response["errorMessage"] = username.isEmpty() ? "用户名不能为空" : "用户名已存在";
+    }
+    else
+    {
+        QString nickname = message["nickname"].toString();
+        addUser(username, nickname.isEmpty() ? username : nickname, message["password"].toString(),
+                false);
+        response["status"] = "success";
+    }
+    send(session, response);
+}
+
+void MockChatServer::handleResume(Session* session, const QJsonObject& message)
+{
+    QString token = message["token"].toString();
+    QString username = m_tokens.value(token);
+
+    QJsonObject response;
+    response["type"] = "RESUME";
+    auto it = m_users.find(username);
+    if (username.isEmpty() || it == m_users.end())
+    {
+        response["status"] = "error";
+        response["errorMessage"] = "会话已失效";
+        send(session, response);
+        return;
+    }
+
+    MockUser& user = *it;
+    bool wasOnline = user.online;
+    session->token = token;
+    QJsonObject accepted = bindSession(session, user, message["capabilities"].toObject());
+
+    // 补发断线期间错过的上下线事件和消息, 超出保留范围的部分只能丢失
+    qint64 lastMessageId = message["lastMessageId"].toVariant().toLongLong();
+    qint64 lastEventSeq = message["lastEventSeq"].toVariant().toLongLong();
+    QList<QJsonObject> replay;
+    for (const QJsonObject& event : m_events)
+    {
+        if (event["eventSeq"].toVariant().toLongLong() > lastEventSeq) replay.append(event);
+    }
+    for (const QJsonObject& record : m_history)
+    {
+        if (record["messageId"].toVariant().toLongLong() > lastMessageId &&
+            isVisibleTo(record, username))
+        {
+            replay.append(record);
+        }
+    }
+
+    response["status"] = "success";
+    response["content"] = QJsonObject{{"replayed", static_cast<int>(replay.size())}};
+    if (message.contains("capabilities")) response["capabilities"] = accepted;
+    send(session, response);
+    session->codec.applyCapabilities(accepted);
+
+    for (const QJsonObject& record : replay) send(session, record);
+    if (!wasOnline)
+    {
+        QJsonObject event;
+        event["type"] = "USER_LOGIN";
+        event["content"] = userJson(user);
+        broadcast(recordEvent(event), session);
+    }
+}
+
+void MockChatServer::handleLogout(Session* session)
+{
+    // 主动退出的 token 立即失效, 不能再用来 RESUME
+    m_tokens.remove(session->token);
+    session->socket->disconnectFromHost();
+}
+
+QJsonObject MockChatServer::bindSession(Session* session, MockUser& user, const QJsonObject& offer)
+{
+    if (session->token.isEmpty())
+    {
+        session->token = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    }
+    if (!session->username.isEmpty()) m_sessionsByUser.remove(session->username, session);
+    session->username = user.username;
+    m_sessionsByUser.insert(user.username, session);
+    m_tokens.insert(session->token, user.username);
+    user.online = true;
+
+    QJsonObject accepted;
+    if (m_profile.acceptDeflate && offer["compression"].toArray().contains(QJsonValue("deflate")))
+    {
+        accepted["compression"] = "deflate";
+        if (offer.contains("compressionThreshold"))
+        {
+            session->codec.setCompressionThreshold(offer["compressionThreshold"].toInt());
+        }
+    }
+    if (m_profile.acceptCbor && offer["encodings"].toArray().contains(QJsonValue("cbor")))
+    {
+        accepted["encoding"] = "cbor";
+    }
+    if (m_profile.acceptConnectionAuth && offer["connectionAuth"].toBool())
+    {
+        accepted["connectionAuth"] = true;
+    }
+    if (m_profile.rateLimit > 0)
+    {
+        QJsonObject rateLimit;
+        rateLimit["messagesPerSecond"] = m_profile.rateLimit;
+        rateLimit["burst"] = qMax(1, m_profile.rateBurst);
+        accepted["rateLimit"] = rateLimit;
+    }
+    return accepted;
+}
+
+void MockChatServer::sendInitialState(Session* session)
+{
+    const MockUser& user = m_users[session->username];
+
+    QJsonArray online;
+    QJsonArray offline;
+    for (const MockUser& other : std::as_const(m_users))
+    {
+        (other.online ? online : offline).append(userJson(other));
+    }
+
+    // 登录的用户自动加入预置群组, 机器人的群聊消息才有人接收
+    QJsonArray groups;
+    for (MockGroup& group : m_groups)
+    {
+        if (m_presetGroupIds.contains(group.groupId) && !group.memberIds.contains(user.userId))
+        {
+            group.memberIds.append(user.userId);
+        }
+        if (group.memberIds.contains(user.userId)) groups.append(groupJson(group));
+    }
+
+    send(session, QJsonObject{{"type", "ONLINE_USERS"}, {"content", online}});
+    send(session, QJsonObject{{"type", "OFFLINE_USERS"}, {"content", offline}});
+    send(session, QJsonObject{{"type", "GROUP_INFO"}, {"content", groups}});
+    send(session, QJsonObject{{"type", "HISTORY_MESSAGES"},
+                              {"content", historyFor(session->username, m_profile.historySize)}});
+}
+
+void MockChatServer::handleChat(Session* session, const QJsonObject& message)
+{
+    const MockUser& user = m_users[session->username];
+    QJsonObject chat;
+    chat["type"] = "CHAT";
+    chat["userId"] = static_cast<qint64>(user.userId);
+    chat["username"] = user.username;
+    chat["nickname"] = user.nickname;
+    chat["content"] = message["content"].toString();
+    if (message.contains("traceId")) chat["traceId"] = message["traceId"];  // 原样转发
+    broadcast(recordMessage(chat), m_profile.echoToSender ? nullptr : session);
+}
+
+void MockChatServer::handlePrivateChat(Session* session, const QJsonObject& message)
+{
+    QString receiver = message["receiver"].toString();
+    if (!m_users.contains(receiver))
+    {
+        sendError(session, QString("用户不存在: %1").arg(receiver));
+        return;
+    }
+
+    const MockUser& user = m_users[session->username];
+    QJsonObject chat;
+    chat["type"] = "PRIVATE_CHAT";
+    chat["username"] = user.username;
+    chat["nickname"] = user.nickname;
+    chat["receiver"] = receiver;
+    chat["content"] = message["content"].toString();
+    if (message.contains("traceId")) chat["traceId"] = message["traceId"];  // 原样转发
+    chat = recordMessage(chat);
+    sendToUser(receiver, chat, session);
+    if (m_profile.echoToSender) send(session, chat);
+}
+
+void MockChatServer::handleGroupChat(Session* session, const QJsonObject& message)
+{
+    long groupId = message["groupId"].toVariant().toLongLong();
+    const MockUser& user = m_users[session->username];
+    auto it = m_groups.constFind(groupId);
+    if (it == m_groups.constEnd() || !it->memberIds.contains(user.userId))
+    {
+        sendError(session, "群组不存在或不是群组成员");
+        return;
+    }
+
+    // 发送者以连接绑定的用户为准, 不信任消息里的 userId / username
+    QJsonObject chat;
+    chat["type"] = "GROUP_CHAT";
+    chat["userId"] = static_cast<qint64>(user.userId);
+    chat["username"] = user.username;
+    chat["nickname"] = user.nickname;
+    chat["groupId"] = static_cast<qint64>(groupId);
+    chat["content"] = message["content"].toString();
+    if (message.contains("traceId")) chat["traceId"] = message["traceId"];  // 原样转发
+    chat = recordMessage(chat);
+    for (long memberId : it->memberIds)
+    {
+        sendToUser(m_usernameById.value(memberId), chat,
+                   m_profile.echoToSender ? nullptr : session);
+    }
+}
+
+/*
+{
+    "type": "GROUP_CREATE" | "GROUP_DELETE" | "GROUP_ADD" | "GROUP_REMOVE",
+    "content": { "operationId", "operatorId", "groupId", "userId", "groupName" }
+}
+响应 GROUP_RESPONSE 总是带回 operationId, 受影响的其他用户收到 GROUP_BROADCAST
+*/
+void MockChatServer::handleGroupTask(Session* session, const QJsonObject& message)
+{
+    QString type = message["type"].toString();
+    QJsonObject task = message["content"].toObject();
+    long operatorId = m_users[session->username].userId;
+    long groupId = task["groupId"].toVariant().toLongLong();
+    long userId = task["userId"].toVariant().toLongLong();
+
+    QJsonObject content;
+    content["operationId"] = task["operationId"].toString();
+    QString error;
+    // 先回复操作者, 再通知其他用户, 与真实服务器的顺序一致
+    QList<QPair<QString, QJsonObject>> notifications;
+
+    auto it = m_groups.find(groupId);
+    if (type == "GROUP_CREATE")
+    {
+        MockGroup group;
+        group.groupId = m_nextGroupId++;
+        group.groupName = task["groupName"].toString();
+        group.creatorId = operatorId;
+        group.memberIds.append(operatorId);
+        m_groups.insert(group.groupId, group);
+        content["groupId"] = static_cast<qint64>(group.groupId);
+        content["groupName"] = group.groupName;
+        content["creatorId"] = static_cast<qint64>(operatorId);
+    }
+    else if (type != "GROUP_DELETE" && type != "GROUP_ADD" && type != "GROUP_REMOVE")
+    {
+        error = QString("未知的群组操作: %1").arg(type);
+    }
+    else if (it == m_groups.end())
+    {
+        error = "群组不存在";
+    }
+    else if (type == "GROUP_DELETE")
+    {
+        if (it->creatorId != operatorId)
+        {
+            error = "只有群主可以解散群组";
+        }
+        else
+        {
+            QJsonObject broadcast{{"type", "remove"},
+                                  {"groupId", static_cast<qint64>(groupId)},
+                                  {"groupName", it->groupName}};
+            for (long memberId : it->memberIds)
+            {
+                if (memberId == operatorId) continue;
+                notifications.append({m_usernameById.value(memberId), broadcast});
+            }
+            m_groups.erase(it);
+            m_presetGroupIds.removeAll(groupId);
+            content["groupId"] = static_cast<qint64>(groupId);
+        }
+    }
+    else if (type == "GROUP_ADD")
+    {
+        if (!m_usernameById.contains(userId))
+        {
+            error = "用户不存在";
+        }
+        else if (it->memberIds.contains(userId))
+        {
+            error = "用户已经在群组中";
+        }
+        else
+        {
+            it->memberIds.append(userId);
+            QJsonObject broadcast = groupJson(*it);
+            broadcast["type"] = "add";
+            broadcast["history"] = groupHistory(groupId);
+            notifications.append({m_usernameById.value(userId), broadcast});
+            content["groupId"] = static_cast<qint64>(groupId);
+            content["userId"] = static_cast<qint64>(userId);
+        }
+    }
+    else  // GROUP_REMOVE
+    {
+        if (!it->memberIds.contains(userId))
+        {
+            error = "用户不在群组中";
+        }
+        else if (operatorId != it->creatorId && operatorId != userId)
+        {
+            error = "只有群主可以移除其他成员";
+        }
+        else
+        {
+            it->memberIds.removeAll(userId);
+            notifications.append({m_usernameById.value(userId),
+                                  QJsonObject{{"type", "remove"},
+                                              {"groupId", static_cast<qint64>(groupId)},
+                                              {"groupName", it->groupName}}});
+            content["groupId"] = static_cast<qint64>(groupId);
+            content["userId"] = static_cast<qint64>(userId);
+        }
+    }
+
+    QJsonObject response;
+    response["type"] = "GROUP_RESPONSE";
+    response["status"] = error.isEmpty() ? "success" : "error";
+    if (!error.isEmpty()) response["errorMessage"] = error;
+    response["content"] = content;
+    send(session, response);
+
+    for (const auto& notification : notifications)
+    {
+        QJsonObject broadcast;
+        broadcast["type"] = "GROUP_BROADCAST";
+        broadcast["content"] = notification.second;
+        sendToUser(notification.first, broadcast, session);
+    }
+}
+
+void MockChatServer::handleFile(Session* session, const QJsonObject& message)
+{
+    QString receiver = message["receiver"].toString();
+    if (!m_users.contains(receiver))
+    {
+        sendError(session, QString("用户不存在: %1").arg(receiver));
+        return;
+    }
+    // TCP 通道上的文件没有文件名, 保存后与 HTTP 上传的文件一样可以下载
+    QByteArray data = QByteArray::fromBase64(message["content"].toString().toLatin1());
+    QJsonObject fileInfo = storeFile(QString("file-%1").arg(m_nextFileId), data);
+    deliverFile(session->username, receiver, fileInfo);
+}
+
+void MockChatServer::send(Session* session, const QJsonObject& message)
+{
+    QByteArray frame = session->codec.encode(message);
+    m_stats.framesOut++;
+    m_stats.bytesOut += frame.size();
+
+    if (m_profile.latencyMs <= 0 && m_profile.jitterMs <= 0)
+    {
+        session->socket->write(frame);
+        return;
+    }
+
+    // 抖动只拉开帧之间的间隔, 不改变顺序, 与真实的 TCP 连接一致
+    qint64 now = m_clock.elapsed();
+    qint64 jitter = m_profile.jitterMs > 0 ? m_random.bounded(m_profile.jitterMs + 1) : 0;
+    qint64 due = qMax(now + m_profile.latencyMs + jitter, session->lastDueMs);
+    session->lastDueMs = due;
+    session->delayed.enqueue({due, frame});
+    if (!session->delayTimer->isActive())
+    {
+        session->delayTimer->start(static_cast<int>(due - now));
+    }
+}
+
+void MockChatServer::flushDelayed(Session* session)
+{
+    qint64 now = m_clock.elapsed();
+    while (!session->delayed.isEmpty() && session->delayed.head().dueMs <= now)
+    {
+        session->socket->write(session->delayed.dequeue().frame);
+    }
+    if (!session->delayed.isEmpty())
+    {
+        session->delayTimer->start(static_cast<int>(session->delayed.head().dueMs - now));
+    }
+}
+
+void MockChatServer::broadcast(const QJsonObject& message, Session* except)
+{
+    for (Session* session : std::as_const(m_sessionsByUser))
+    {
+        if (session != except) send(session, message);
+    }
+}
+
+void MockChatServer::sendToUser(const QString& username, const QJsonObject& message,
+                                Session* except)
+{
+    auto range = m_sessionsByUser.equal_range(username);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it.value() != except) send(it.value(), message);
+    }
+}
+
+void MockChatServer::sendError(Session* session, const QString& error)
+{
+    QJsonObject response;
+    response["type"] = "ERROR";
+    response["errorMessage"] = error;
+    send(session, response);
+}
+
+QJsonObject MockChatServer::recordMessage(QJsonObject message)
+{
+    message["messageId"] = m_nextMessageId++;
+    message["timestamp"] = nowTimestamp();
+    m_history.append(message);
+    if (m_history.size() > HISTORY_CAPACITY) m_history.removeFirst();
+    return message;
+}
+
+QJsonObject MockChatServer::recordEvent(QJsonObject event)
+{
+    event["eventSeq"] = m_nextEventSeq++;
+    m_events.append(event);
+    if (m_events.size() > EVENT_CAPACITY) m_events.removeFirst();
+    return event;
+}
+
+bool MockChatServer::isVisibleTo(const QJsonObject& message, const QString& username) const
+{
+    QString type = message["type"].toString();
+    if (type == "CHAT") return true;
+    if (type == "PRIVATE_CHAT" || type == "FILE")
+    {
+        return message["username"].toString() == username ||
+               message["receiver"].toString() == username;
+    }
+    if (type == "GROUP_CHAT")
+    {
+        auto it = m_groups.constFind(message["groupId"].toVariant().toLongLong());
+        return it != m_groups.constEnd() && it->memberIds.contains(m_users.value(username).userId);
+    }
+    return false;
+}
+
+QJsonArray MockChatServer::historyFor(const QString& username, int limit) const
+{
+    QList<QJsonObject> visible;
+    for (auto it = m_history.crbegin(); it != m_history.crend() && visible.size() < limit; ++it)
+    {
+        if (isVisibleTo(*it, username)) visible.append(*it);
+    }
+    std::reverse(visible.begin(), visible.end());
+
+    QJsonArray history;
+    for (QJsonObject message : visible)
+    {
+        // 历史记录中的文件信息是 JSON 字符串, 与实时推送的 FILE 消息不同
+        if (message["type"].toString() == "FILE")
+        {
+            message["content"] = QString::fromUtf8(
+                QJsonDocument(message["content"].toObject()).toJson(QJsonDocument::Compact));
+        }
+        history.append(message);
+    }
+    return history;
+}
+
+void MockChatServer::generateLoad()
+{
+    qint64 now = m_clock.elapsed();
+    double seconds = (now - m_lastLoadTickMs) / 1000.0;
+    m_lastLoadTickMs = now;
+
+    // 没有客户端时不积累, 避免第一个连接进来时收到一大批消息
+    if (m_sessionsByUser.isEmpty())
+    {
+        m_chatCredit = m_groupChatCredit = m_presenceCredit = 0.0;
+        return;
+    }
+
+    m_chatCredit += seconds * m_profile.chatRate;
+    m_groupChatCredit += seconds * m_profile.groupChatRate;
+    m_presenceCredit += seconds * m_profile.presenceRate;
+    for (; m_chatCredit >= 1.0; m_chatCredit -= 1.0) generateBotChat();
+    for (; m_groupChatCredit >= 1.0; m_groupChatCredit -= 1.0) generateBotGroupChat();
+    for (; m_presenceCredit >= 1.0; m_presenceCredit -= 1.0) generatePresenceChange();
+}
+
+void MockChatServer::generateBotChat()
+{
+    if (m_onlineBots.isEmpty()) return;
+    const MockUser& bot = m_users[m_onlineBots[m_random.bounded(int(m_onlineBots.size()))]];
+
+    QJsonObject chat;
+    chat["type"] = "CHAT";
+    chat["userId"] = static_cast<qint64>(bot.userId);
+    chat["username"] = bot.username;
+    chat["nickname"] = bot.nickname;
+    chat["content"] = FILLER_TEXT.left(1 + m_random.bounded(int(FILLER_TEXT.size())));
+    broadcast(recordMessage(chat));
+}
+
+void MockChatServer::generateBotGroupChat()
+{
+    if (m_presetGroupIds.isEmpty()) return;
+    long groupId = m_presetGroupIds[m_random.bounded(int(m_presetGroupIds.size()))];
+    const MockGroup& group = m_groups[groupId];
+
+    // 随机选一个机器人成员发言, 抽到真实用户时改由群主发言
+    long senderId = group.memberIds[m_random.bounded(int(group.memberIds.size()))];
+    const MockUser* sender = &m_users[m_usernameById.value(senderId)];
+    if (!sender->bot) sender = &m_users[m_usernameById.value(group.creatorId)];
+
+    QJsonObject chat;
+    chat["type"] = "GROUP_CHAT";
+    chat["userId"] = static_cast<qint64>(sender->userId);
+    chat["username"] = sender->username;
+    chat["nickname"] = sender->nickname;
+    chat["groupId"] = static_cast<qint64>(groupId);
+    chat["content"] = FILLER_TEXT.left(1 + m_random.bounded(int(FILLER_TEXT.size())));
+    chat = recordMessage(chat);
+    for (long memberId : group.memberIds) sendToUser(m_usernameById.value(memberId), chat);
+}
+
+void MockChatServer::generatePresenceChange()
+{
+    bool goOnline = m_onlineBots.isEmpty() || (!m_offlineBots.isEmpty() && m_random.bounded(2) == 0);
+    QList<QString>& from = goOnline ? m_offlineBots : m_onlineBots;
+    QList<QString>& to = goOnline ? m_onlineBots : m_offlineBots;
+    if (from.isEmpty()) return;
+
+    int index = m_random.bounded(int(from.size()));
+    QString username = from[index];
+    from[index] = from.last();
+    from.removeLast();
+    to.append(username);
+
+    MockUser& bot = m_users[username];
+    bot.online = goOnline;
+    QJsonObject event;
+    event["type"] = goOnline ? "USER_LOGIN" : "USER_LOGOUT";
+    event["content"] = userJson(bot);
+    broadcast(recordEvent(event));
+}
+
+void MockChatServer::injectDisconnect()
+{
+    // abort 会同步触发 disconnected, 先复制一份列表再逐个断开
+    const QList<QTcpSocket*> sockets = m_sessions.keys();
+    for (QTcpSocket* socket : sockets)
+    {
+        m_stats.injectedDisconnects++;
+        socket->abort();
+    }
+    if (!sockets.isEmpty())
+    {
+        qCDebug(lcMock) << "Injected disconnect, clients dropped:" << sockets.size();
+    }
+}
+
+QString MockChatServer::nowTimestamp() const
+{
+    return QDateTime::currentDateTime().toString(Qt::ISODate);
+}
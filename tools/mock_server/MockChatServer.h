@@ -0,0 +1,214 @@
+#ifndef MOCKCHATSERVER_H
+#define MOCKCHATSERVER_H
+
+#include "network/FrameCodec.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QMultiHash>
+#include <QObject>
+#include <QQueue>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+// chatter.mock: 模拟服务器的连接、帧错误和负载注入, debug 用 QT_LOGGING_RULES 打开
+Q_DECLARE_LOGGING_CATEGORY(lcMock)
+
+// 模拟服务器的负载配置, 可以来自命令行, 也可以来自 --scenario 指定的 JSON 文件 (字段名相同)
+struct LoadProfile
+{
+    int onlineUsers = 20;      // 预置的在线机器人用户
+    int offlineUsers = 20;     // 预置的离线用户
+    int historySize = 50;      // 登录时下发的历史消息条数
+    int groups = 3;            // 预置的群组, 登录的用户自动加入
+    int groupMembers = 10;     // 每个预置群组中的机器人成员数
+    double chatRate = 0.0;     // 机器人在公共大厅发言, 条/秒
+    double groupChatRate = 0.0;  // 机器人在预置群组中发言, 条/秒
+    double presenceRate = 0.0;   // 机器人上下线, 次/秒
+    int latencyMs = 0;         // 服务器到客户端方向注入的固定延迟
+    int jitterMs = 0;          // 在固定延迟上叠加 [0, jitterMs] 的随机延迟, 不会打乱帧的顺序
+    int disconnectEveryMs = 0;   // 周期性地断开所有客户端连接, 0 表示不断开
+    bool echoToSender = false;   // 聊天消息也发回发送者, 压测时用来测量端到端延迟
+    bool acceptDeflate = true;   // 是否接受客户端提出的压缩和 CBOR 编码
+    bool acceptCbor = true;
+    bool acceptConnectionAuth = true;  // 不接受时按旧版本的服务器, 要求每条消息都带 token
+    double rateLimit = 0.0;    // 在 capabilities 中公布的发送速率限制, 0 表示不公布
+    int rateBurst = 0;
+    quint32 seed = 1;          // 随机数种子, 相同的配置和种子产生相同的负载
+
+    static LoadProfile fromJson(const QJsonObject& json, const LoadProfile& defaults);
+};
+
+// 离线使用的聊天服务器, 实现客户端用到的 TCP 协议:
+// LOGIN / REGISTER / RESUME / LOGOUT / HEARTBEAT / CHAT / PRIVATE_CHAT / GROUP_CHAT / GROUP_* / FILE,
+// 包括 capabilities 协商 (deflate 压缩、CBOR 编码、速率限制、按连接绑定的身份认证).
+// 用户、群组和消息都只保存在内存中, 重启后恢复为预置数据.
+class MockChatServer : public QObject
+{
+    Q_OBJECT
+
+   public:
+    struct Stats
+    {
+        quint64 connections = 0;
+        quint64 framesIn = 0;
+        quint64 framesOut = 0;
+        quint64 bytesIn = 0;
+        quint64 bytesOut = 0;
+        quint64 rejectedFrames = 0;  // 未登录的连接或 token 不匹配的业务消息
+        quint64 injectedDisconnects = 0;
+    };
+
+    explicit MockChatServer(const LoadProfile& profile, QObject* parent = nullptr);
+
+    bool listen(const QHostAddress& address, quint16 port);
+    QString errorString() const { return m_server->errorString(); }
+    quint16 serverPort() const { return m_server->serverPort(); }
+
+    // 以下供 HTTP 文件服务使用
+    // 根据登录 token 查找用户名, 找不到时返回空字符串
+    QString usernameForToken(const QString& token) const;
+    // 下载地址的前缀, 例如 http://127.0.0.1:8080/api/files/download
+    void setFileBaseUrl(const QString& baseUrl) { m_fileBaseUrl = baseUrl; }
+    // 保存文件, 返回客户端需要的文件信息 {fileUrl, fileName, fileSize}
+    QJsonObject storeFile(const QString& fileName, const QByteArray& data);
+    // 按 storeFile 分配的 id 取回文件, 不存在时 found 为 false
+    QByteArray fileData(const QString& fileId, QString* fileName, bool* found) const;
+    // 文件上传完成后向接收方推送 FILE 消息, 并记入双方的历史记录
+    void deliverFile(const QString& sender, const QString& receiver, const QJsonObject& fileInfo);
+
+    int sessionCount() const { return m_sessions.size(); }
+    const Stats& stats() const { return m_stats; }
+    const LoadProfile& profile() const { return m_profile; }
+
+   private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void generateLoad();
+    void injectDisconnect();
+
+   private:
+    struct MockUser
+    {
+        long userId = 0;
+        QString username;
+        QString nickname;
+        QString password;
+        bool bot = false;
+        bool online = false;
+    };
+
+    struct MockGroup
+    {
+        long groupId = 0;
+        QString groupName;
+        long creatorId = 0;
+        QList<long> memberIds;
+    };
+
+    struct StoredFile
+    {
+        QString fileName;
+        QByteArray data;
+    };
+
+    struct DelayedFrame
+    {
+        qint64 dueMs;
+        QByteArray frame;
+    };
+
+    // 一个 TCP 连接, 登录或恢复会话之后才绑定到用户
+    struct Session
+    {
+        QTcpSocket* socket = nullptr;
+        FrameCodec codec;
+        QString username;  // 空表示尚未认证
+        QString token;
+        QQueue<DelayedFrame> delayed;
+        qint64 lastDueMs = 0;
+        QTimer* delayTimer = nullptr;
+    };
+
+    void seedData();
+    MockUser& addUser(const QString& username, const QString& nickname, const QString& password,
+                      bool bot);
+    QJsonObject userJson(const MockUser& user) const;
+    QJsonObject groupJson(const MockGroup& group) const;
+    QJsonArray groupHistory(long groupId) const;
+
+    void handleMessage(Session* session, const QJsonObject& message);
+    void handleLogin(Session* session, const QJsonObject& message);
+    void handleRegister(Session* session, const QJsonObject& message);
+    void handleResume(Session* session, const QJsonObject& message);
+    void handleLogout(Session* session);
+    void handleChat(Session* session, const QJsonObject& message);
+    void handlePrivateChat(Session* session, const QJsonObject& message);
+    void handleGroupChat(Session* session, const QJsonObject& message);
+    void handleGroupTask(Session* session, const QJsonObject& message);
+    void handleFile(Session* session, const QJsonObject& message);
+
+    // 登录或恢复成功后把连接绑定到用户, 并按客户端的提议选择编码
+    QJsonObject bindSession(Session* session, MockUser& user, const QJsonObject& offer);
+    void sendInitialState(Session* session);
+
+    void send(Session* session, const QJsonObject& message);
+    void flushDelayed(Session* session);
+    void broadcast(const QJsonObject& message, Session* except = nullptr);
+    void sendToUser(const QString& username, const QJsonObject& message, Session* except = nullptr);
+    void sendError(Session* session, const QString& error);
+
+    // 消息编号和事件序号, 记录下来以便 RESUME 补发
+    QJsonObject recordMessage(QJsonObject message);
+    QJsonObject recordEvent(QJsonObject event);
+    bool isVisibleTo(const QJsonObject& message, const QString& username) const;
+    QJsonArray historyFor(const QString& username, int limit) const;
+
+    void generateBotChat();
+    void generateBotGroupChat();
+    void generatePresenceChange();
+    QString nowTimestamp() const;
+
+    LoadProfile m_profile;
+    QTcpServer* m_server;
+    QHash<QTcpSocket*, Session*> m_sessions;
+    QMultiHash<QString, Session*> m_sessionsByUser;  // 已认证的连接, 同一用户可以有多个
+
+    QHash<QString, MockUser> m_users;  // username -> 用户
+    QHash<long, QString> m_usernameById;
+    QHash<QString, QString> m_tokens;  // token -> username, 断开后保留, 用于 RESUME
+    QList<QString> m_onlineBots;
+    QList<QString> m_offlineBots;
+    QMap<long, MockGroup> m_groups;
+    QList<long> m_presetGroupIds;
+    long m_nextUserId = 1;
+    long m_nextGroupId = 1;
+
+    QList<QJsonObject> m_history;  // 最近的聊天消息, 带 messageId
+    QList<QJsonObject> m_events;   // 最近的上下线事件, 带 eventSeq
+    qint64 m_nextMessageId = 1;
+    qint64 m_nextEventSeq = 1;
+
+    QHash<QString, StoredFile> m_files;
+    qint64 m_nextFileId = 1;
+    QString m_fileBaseUrl;
+
+    QTimer* m_loadTimer;
+    QTimer* m_disconnectTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastLoadTickMs = 0;
+    double m_chatCredit = 0.0;  // 按速率累积的待发送条数, 整数部分在本次 tick 中发出
+    double m_groupChatCredit = 0.0;
+    double m_presenceCredit = 0.0;
+    QRandomGenerator m_random;
+    Stats m_stats;
+};
+
+#endif  // MOCKCHATSERVER_H
@@ -0,0 +1,284 @@
+#include "MockHttpServer.h"
+#include "MockChatServer.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTimer>
+
+const int MAX_HEADER_SIZE = 64 * 1024;
+const qint64 MAX_BODY_SIZE = 256 * 1024 * 1024;
+const char REQUEST_TOO_LARGE[] = "请求过大";
+
+static QByteArray statusText(int status)
+{
+    switch (status)
+    {
+        case 200:
+            return "OK";
+        case 400:
+            return "Bad Request";
+        case 401:
+            return "Unauthorized";
+        case 404:
+            return "Not Found";
+        case 413:
+            return "Payload Too Large";
+        default:
+            return "Error";
+    }
+}
+
+// Content-Disposition 中的参数, 例如 name="file"; filename="a.txt"
+static QString dispositionParameter(const QString& headers, const QString& parameter)
+{
+    QRegularExpression pattern(QString("(?:^|[;\\s])%1=\"([^\"]*)\"").arg(parameter),
+                               QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = pattern.match(headers);
+    return match.hasMatch() ? match.captured(1) : QString();
+}
+
+MockHttpServer::MockHttpServer(MockChatServer* chatServer, const QString& apiPrefix, int latencyMs,
+                               QObject* parent)
+    : QObject(parent),
+      m_chatServer(chatServer),
+      m_apiPrefix(apiPrefix),
+      m_latencyMs(latencyMs),
+      m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MockHttpServer::onNewConnection);
+}
+
+bool MockHttpServer::listen(const QHostAddress& address, quint16 port)
+{
+    return m_server->listen(address, port);
+}
+
+void MockHttpServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection())
+    {
+        m_buffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, &MockHttpServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this,
+                [this, socket]()
+                {
+                    m_buffers.remove(socket);
+                    socket->deleteLater();
+                });
+    }
+}
+
+void MockHttpServer::onReadyRead()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    auto it = m_buffers.find(socket);
+    if (it == m_buffers.end()) return;
+    it->append(socket->readAll());
+
+    Request request;
+    QString error;
+    if (takeRequest(*it, request, error))
+    {
+        // 一个连接只处理一个请求, 之后到达的数据不再读取
+        disconnect(socket, &QTcpSocket::readyRead, this, &MockHttpServer::onReadyRead);
+        if (m_latencyMs > 0)
+        {
+            QTimer::singleShot(m_latencyMs, socket,
+                               [this, socket, request]() { handleRequest(socket, request); });
+        }
+        else
+        {
+            handleRequest(socket, request);
+        }
+    }
+    else if (!error.isEmpty())
+    {
+        disconnect(socket, &QTcpSocket::readyRead, this, &MockHttpServer::onReadyRead);
+        respondError(socket, error == REQUEST_TOO_LARGE ? 413 : 400, error);
+    }
+}
+
+bool MockHttpServer::takeRequest(QByteArray& buffer, Request& request, QString& error)
+{
+    qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+    {
+        if (buffer.size() > MAX_HEADER_SIZE) error = REQUEST_TOO_LARGE;
+        return false;
+    }
+
+    QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() < 3)
+    {
+        error = "请求行格式错误";
+        return false;
+    }
+    request.method = requestLine[0];
+    request.path = requestLine[1];
+    for (qsizetype i = 1; i < lines.size(); ++i)
+    {
+        qsizetype colon = lines[i].indexOf(':');
+        if (colon <= 0) continue;
+        request.headers.insert(lines[i].left(colon).trimmed().toLower(),
+                               lines[i].mid(colon + 1).trimmed());
+    }
+
+    bool ok = true;
+    qint64 length = request.headers.value("content-length", "0").toLongLong(&ok);
+    if (!ok || length < 0)
+    {
+        error = "Content-Length 无效";
+        return false;
+    }
+    if (length > MAX_BODY_SIZE)
+    {
+        error = REQUEST_TOO_LARGE;
+        return false;
+    }
+    qint64 total = headerEnd + 4 + length;
+    if (buffer.size() < total) return false;
+
+    request.body = buffer.mid(headerEnd + 4, length);
+    buffer.remove(0, total);
+    return true;
+}
+
+void MockHttpServer::handleRequest(QTcpSocket* socket, const Request& request)
+{
+    QByteArray authorization = request.headers.value("authorization");
+    QString username = authorization.startsWith("Bearer ")
+                           ? m_chatServer->usernameForToken(QString::fromUtf8(authorization.mid(7)))
+                           : QString();
+    if (username.isEmpty())
+    {
+        respondError(socket, 401, "未登录或 token 已失效");
+        return;
+    }
+
+    QString path = QString::fromUtf8(request.path);
+    QString uploadPath = m_apiPrefix + "/files/upload";
+    QString downloadPrefix = m_apiPrefix + "/files/download/";
+    if (request.method == "POST" && path == uploadPath)
+    {
+        handleUpload(socket, request, username);
+    }
+    else if (request.method == "GET" && path.startsWith(downloadPrefix))
+    {
+        handleDownload(socket, path.mid(downloadPrefix.size()));
+    }
+    else
+    {
+        respondError(socket, 404, QString("未知接口: %1 %2")
+                                      .arg(QString::fromLatin1(request.method), path));
+    }
+}
+
+void MockHttpServer::handleUpload(QTcpSocket* socket, const Request& request,
+                                  const QString& username)
+{
+    QByteArray contentType = request.headers.value("content-type");
+    qsizetype boundaryPos = contentType.indexOf("boundary=");
+    if (!contentType.startsWith("multipart/form-data") || boundaryPos < 0)
+    {
+        respondError(socket, 400, "需要 multipart/form-data");
+        return;
+    }
+    QByteArray boundary = contentType.mid(boundaryPos + 9).trimmed();
+    if (boundary.size() >= 2 && boundary.startsWith('"') && boundary.endsWith('"'))
+    {
+        boundary = boundary.mid(1, boundary.size() - 2);  // QHttpMultiPart 会给 boundary 加引号
+    }
+
+    // 按分隔线切出每个部分, 每部分是 头部 + 空行 + 数据
+    const QByteArray delimiter = "--" + boundary;
+    const QByteArray& body = request.body;
+    QString fileName;
+    QByteArray fileContent;
+    bool hasFile = false;
+    QString receiver;
+
+    qsizetype pos = body.indexOf(delimiter);
+    while (pos >= 0)
+    {
+        qsizetype partStart = pos + delimiter.size();
+        if (body.mid(partStart, 2) == "--") break;  // 结束分隔线
+        partStart += 2;                             // 分隔线后的 \r\n
+        qsizetype next = body.indexOf("\r\n" + delimiter, partStart);
+        if (next < 0) break;
+
+        qsizetype headerEnd = body.indexOf("\r\n\r\n", partStart);
+        if (headerEnd >= 0 && headerEnd < next)
+        {
+            QString headers = QString::fromUtf8(body.mid(partStart, headerEnd - partStart));
+            QString name = dispositionParameter(headers, "name");
+            if (name == "file")
+            {
+                fileName = dispositionParameter(headers, "filename");
+                fileContent = body.mid(headerEnd + 4, next - headerEnd - 4);
+                hasFile = true;
+            }
+            else if (name == "receiverUsername")
+            {
+                receiver = QString::fromUtf8(body.mid(headerEnd + 4, next - headerEnd - 4));
+            }
+        }
+        pos = next + 2;
+    }
+
+    if (!hasFile || receiver.isEmpty())
+    {
+        respondError(socket, 400, "缺少 file 或 receiverUsername 字段");
+        return;
+    }
+
+    QJsonObject fileInfo = m_chatServer->storeFile(fileName.isEmpty() ? "file" : fileName,
+                                                   fileContent);
+    QJsonObject response;
+    response["status"] = "success";
+    response["content"] = fileInfo;
+    respond(socket, 200, "application/json",
+            QJsonDocument(response).toJson(QJsonDocument::Compact));
+    qCDebug(lcMock) << "File uploaded:" << fileInfo["fileName"].toString() << fileContent.size()
+                    << "bytes," << username << "->" << receiver;
+
+    m_chatServer->deliverFile(username, receiver, fileInfo);
+}
+
+void MockHttpServer::handleDownload(QTcpSocket* socket, const QString& fileId)
+{
+    QString fileName;
+    bool found = false;
+    QByteArray data = m_chatServer->fileData(fileId, &fileName, &found);
+    if (!found)
+    {
+        respondError(socket, 404, QString("文件不存在: %1").arg(fileId));
+        return;
+    }
+    QByteArray disposition = "Content-Disposition: attachment; filename=\"" +
+                             fileName.toUtf8() + "\"\r\n";
+    respond(socket, 200, "application/octet-stream", data, disposition);
+}
+
+void MockHttpServer::respond(QTcpSocket* socket, int status, const QByteArray& contentType,
+                             const QByteArray& body, const QByteArray& extraHeaders)
+{
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    head += "Content-Type: " + contentType + "\r\n";
+    head += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    head += extraHeaders;
+    head += "Connection: close\r\n\r\n";
+    socket->write(head);
+    socket->write(body);
+    socket->disconnectFromHost();
+}
+
+void MockHttpServer::respondError(QTcpSocket* socket, int status, const QString& error)
+{
+    QJsonObject response;
+    response["status"] = "error";
+    response["errorMessage"] = error;
+    respond(socket, status, "application/json",
+            QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,59 @@
+#ifndef MOCKHTTPSERVER_H
+#define MOCKHTTPSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+class MockChatServer;
+
+// 文件上传 / 下载的最小 HTTP/1.1 实现, 只支持客户端实际用到的两个接口:
+//   POST {apiPrefix}/files/upload          multipart/form-data, 字段 file 和 receiverUsername
+//   GET  {apiPrefix}/files/download/<id>
+// 两者都要求 Authorization: Bearer <token>, token 来自 MockChatServer 的登录.
+// 每个连接只处理一个请求, 响应后关闭连接.
+class MockHttpServer : public QObject
+{
+    Q_OBJECT
+
+   public:
+    MockHttpServer(MockChatServer* chatServer, const QString& apiPrefix, int latencyMs,
+                   QObject* parent = nullptr);
+
+    bool listen(const QHostAddress& address, quint16 port);
+    QString errorString() const { return m_server->errorString(); }
+    quint16 serverPort() const { return m_server->serverPort(); }
+
+   private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+   private:
+    struct Request
+    {
+        QByteArray method;
+        QByteArray path;
+        QHash<QByteArray, QByteArray> headers;  // 名称统一为小写
+        QByteArray body;
+    };
+
+    // 缓冲区中有完整的请求时取出并返回 true; 请求格式错误时 error 非空
+    bool takeRequest(QByteArray& buffer, Request& request, QString& error);
+    void handleRequest(QTcpSocket* socket, const Request& request);
+    void handleUpload(QTcpSocket* socket, const Request& request, const QString& username);
+    void handleDownload(QTcpSocket* socket, const QString& fileId);
+    void respond(QTcpSocket* socket, int status, const QByteArray& contentType,
+                 const QByteArray& body, const QByteArray& extraHeaders = QByteArray());
+    void respondError(QTcpSocket* socket, int status, const QString& error);
+
+    MockChatServer* m_chatServer;
+    QString m_apiPrefix;
+    int m_latencyMs;
+    QTcpServer* m_server;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+};
+
+#endif  // MOCKHTTPSERVER_H
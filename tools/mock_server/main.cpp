@@ -0,0 +1,171 @@
+#include "MockChatServer.h"
+#include "MockHttpServer.h"
+#include "utils/ConfigManager.h"
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QTimer>
+
+// 本地模拟服务器, 基准测试和压测可以完全离线地运行
+// 例: chatter_mock_server --config resources/config.json --online-users 10000 --chat-rate 200
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chatter_mock_server");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Chatter mock server for offline benchmarks and load tests");
+    parser.addHelpOption();
+
+    QCommandLineOption configOption("config", "Client config providing tcp.port, http.port, apiPrefix",
+                                    "file", "resources/config.json");
+    QCommandLineOption scenarioOption("scenario", "Load profile JSON (LoadProfile field names)",
+                                      "file");
+    QCommandLineOption listenOption("listen", "Address to listen on", "address", "127.0.0.1");
+    QCommandLineOption tcpPortOption("tcp-port", "Override tcp.port", "port");
+    QCommandLineOption httpPortOption("http-port", "Override http.port", "port");
+    QCommandLineOption onlineUsersOption("online-users", "Preset online bot users", "count");
+    QCommandLineOption offlineUsersOption("offline-users", "Preset offline users", "count");
+    QCommandLineOption historyOption("history", "History messages sent on login", "count");
+    QCommandLineOption groupsOption("groups", "Preset groups joined by every client", "count");
+    QCommandLineOption groupMembersOption("group-members", "Bot members per preset group", "count");
+    QCommandLineOption chatRateOption("chat-rate", "Bot public chat messages per second", "rate");
+    QCommandLineOption groupChatRateOption("group-chat-rate", "Bot group messages per second",
+                                           "rate");
+    QCommandLineOption presenceRateOption("presence-rate", "Bot login/logout events per second",
+                                          "rate");
+    QCommandLineOption latencyOption("latency", "Injected server-to-client latency", "ms");
+    QCommandLineOption jitterOption("jitter", "Extra random latency in [0, ms]", "ms");
+    QCommandLineOption disconnectOption("disconnect-every", "Drop every client periodically", "ms");
+    QCommandLineOption rateLimitOption("rate-limit", "Advertise a send rate limit", "per-second");
+    QCommandLineOption burstOption("burst", "Burst size advertised with --rate-limit", "count");
+    QCommandLineOption seedOption("seed", "Random seed", "seed");
+    QCommandLineOption echoOption("echo", "Echo chat messages back to the sender");
+    QCommandLineOption noDeflateOption("no-deflate", "Refuse deflate compression");
+    QCommandLineOption noCborOption("no-cbor", "Refuse CBOR encoding");
+    QCommandLineOption noConnectionAuthOption(
+        "no-connection-auth", "Refuse connection-scoped auth, require a token in every frame");
+    QCommandLineOption statsOption("stats-interval", "Print traffic statistics periodically", "ms",
+                                   "0");
+
+    parser.addOptions({configOption, scenarioOption, listenOption, tcpPortOption, httpPortOption,
+                       onlineUsersOption, offlineUsersOption, historyOption, groupsOption,
+                       groupMembersOption, chatRateOption, groupChatRateOption, presenceRateOption,
+                       latencyOption, jitterOption, disconnectOption, rateLimitOption, burstOption,
+                       seedOption, echoOption, noDeflateOption, noCborOption,
+                       noConnectionAuthOption, statsOption});
+    parser.process(app);
+
+    // 与客户端读取同一份配置, 端口自然一致
+    ConfigManager& config = ConfigManager::instance();
+    if (!config.loadConfig(parser.value(configOption)))
+    {
+        qCWarning(lcMock) << "无法加载配置文件, 使用默认端口:"
+                          << parser.value(configOption);
+    }
+    quint16 tcpPort = parser.isSet(tcpPortOption) ? parser.value(tcpPortOption).toUShort()
+                                                  : config.tcpPort();
+    quint16 httpPort = parser.isSet(httpPortOption) ? parser.value(httpPortOption).toUShort()
+                                                    : config.httpPort();
+
+    LoadProfile profile;
+    if (parser.isSet(scenarioOption))
+    {
+        QFile file(parser.value(scenarioOption));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            qCritical() << "无法打开负载配置:" << file.fileName();
+            return 1;
+        }
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject())
+        {
+            qCritical() << "负载配置格式错误:" << error.errorString();
+            return 1;
+        }
+        profile = LoadProfile::fromJson(doc.object(), profile);
+    }
+
+    // 命令行参数覆盖负载配置文件
+    auto intOption = [&parser](const QCommandLineOption& option, int& target)
+    {
+        if (parser.isSet(option)) target = parser.value(option).toInt();
+    };
+    auto doubleOption = [&parser](const QCommandLineOption& option, double& target)
+    {
+        if (parser.isSet(option)) target = parser.value(option).toDouble();
+    };
+    intOption(onlineUsersOption, profile.onlineUsers);
+    intOption(offlineUsersOption, profile.offlineUsers);
+    intOption(historyOption, profile.historySize);
+    intOption(groupsOption, profile.groups);
+    intOption(groupMembersOption, profile.groupMembers);
+    doubleOption(chatRateOption, profile.chatRate);
+    doubleOption(groupChatRateOption, profile.groupChatRate);
+    doubleOption(presenceRateOption, profile.presenceRate);
+    intOption(latencyOption, profile.latencyMs);
+    intOption(jitterOption, profile.jitterMs);
+    intOption(disconnectOption, profile.disconnectEveryMs);
+    doubleOption(rateLimitOption, profile.rateLimit);
+    intOption(burstOption, profile.rateBurst);
+    if (parser.isSet(seedOption)) profile.seed = parser.value(seedOption).toUInt();
+    if (parser.isSet(echoOption)) profile.echoToSender = true;
+    if (parser.isSet(noDeflateOption)) profile.acceptDeflate = false;
+    if (parser.isSet(noCborOption)) profile.acceptCbor = false;
+    if (parser.isSet(noConnectionAuthOption)) profile.acceptConnectionAuth = false;
+
+    QHostAddress address(parser.value(listenOption));
+    MockChatServer chatServer(profile);
+    MockHttpServer httpServer(&chatServer, config.apiPrefix(), profile.latencyMs);
+
+    if (!chatServer.listen(address, tcpPort))
+    {
+        qCritical() << "TCP 端口监听失败:" << tcpPort << chatServer.errorString();
+        return 1;
+    }
+    if (!httpServer.listen(address, httpPort))
+    {
+        qCritical() << "HTTP 端口监听失败:" << httpPort << httpServer.errorString();
+        return 1;
+    }
+    // 客户端直接使用 fileUrl 下载, 所以这里是完整的地址; 监听所有地址时使用配置中的 http.host
+    QString host = address.toString();
+    if (address == QHostAddress::Any || address == QHostAddress::AnyIPv4 ||
+        address == QHostAddress::AnyIPv6)
+        host = config.httpHost();
+    else if (address.protocol() == QAbstractSocket::IPv6Protocol)
+        host = QString("[%1]").arg(host);
+    chatServer.setFileBaseUrl(QString("http://%1:%2%3/files/download")
+                                  .arg(host)
+                                  .arg(httpServer.serverPort())
+                                  .arg(config.apiPrefix()));
+
+    qCInfo(lcMock) << "Mock server listening, tcp:" << chatServer.serverPort()
+                   << "http:" << httpServer.serverPort() << "online users:" << profile.onlineUsers
+                   << "chat rate:" << profile.chatRate << "seed:" << profile.seed;
+
+    QTimer statsTimer;
+    int statsInterval = parser.value(statsOption).toInt();
+    if (statsInterval > 0)
+    {
+        QObject::connect(&statsTimer, &QTimer::timeout,
+                         [&chatServer]()
+                         {
+                             const MockChatServer::Stats& stats = chatServer.stats();
+                             qCInfo(lcMock) << "sessions:" << chatServer.sessionCount()
+                                            << "frames in/out:" << stats.framesIn << stats.framesOut
+                                            << "bytes in/out:" << stats.bytesIn << stats.bytesOut
+                                            << "rejected:" << stats.rejectedFrames
+                                            << "dropped:" << stats.injectedDisconnects;
+                         });
+        statsTimer.start(statsInterval);
+    }
+
+    return app.exec();
+}
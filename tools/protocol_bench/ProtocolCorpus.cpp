@@ -0,0 +1,195 @@
+#include "ProtocolCorpus.h"
+#include "network/FrameCodec.h"
+#include "network/TrafficCapture.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <iterator>
+
+namespace
+{
+const quint32 CORPUS_SEED = 20240601;
+const QDateTime BASE_TIME = QDateTime(QDate(2024, 6, 1), QTime(9, 0), Qt::UTC);
+
+// 聊天内容的长度分布: 大部分是短句, 少量长段落
+QString sampleContent(QRandomGenerator& random)
+{
+    static const QString words[] = {"好的", "收到", "明天", "会议", "build", "failed", "没问题",
+                                    "哈哈", "review", "这个", "接口", "延迟", "😀", "p99",
+                                    "deploy", "\"quoted\"", "路径 C:\\temp"};
+    int count = random.bounded(100) < 90 ? 2 + random.bounded(12) : 40 + random.bounded(80);
+    QString content;
+    for (int i = 0; i < count; ++i)
+    {
+        if (i > 0) content.append(' ');
+        content.append(words[random.bounded(int(std::size(words)))]);
+    }
+    return content;
+}
+
+QString timestamp(int index)
+{
+    return BASE_TIME.addSecs(index * 7).toString(Qt::ISODate);
+}
+
+QJsonObject userJson(int index)
+{
+    QJsonObject user;
+    user["userId"] = 1000 + index;
+    user["username"] = QString("user%1").arg(index, 5, 10, QChar('0'));
+    user["nickname"] = QString("用户%1").arg(index);
+    user["avatarUrl"] = QString("http://127.0.0.1:8080/api/avatars/%1.png").arg(1000 + index);
+    return user;
+}
+
+ProtocolCorpus::Frame makeFrame(const QString& name, const QJsonObject& message)
+{
+    return {name, message, QJsonDocument(message).toJson(QJsonDocument::Compact)};
+}
+}  // namespace
+
+namespace ProtocolCorpus
+{
+QJsonObject chatMessage(int index)
+{
+    QRandomGenerator random(CORPUS_SEED + index);
+    QJsonObject message;
+    message["type"] = "CHAT";
+    message["messageId"] = 500000 + index;
+    message["userId"] = 1000 + index % 200;
+    message["username"] = QString("user%1").arg(index % 200, 5, 10, QChar('0'));
+    message["nickname"] = QString("用户%1").arg(index % 200);
+    message["content"] = sampleContent(random);
+    message["timestamp"] = timestamp(index);
+    return message;
+}
+
+QJsonObject privateChatMessage(int index)
+{
+    QJsonObject message = chatMessage(index);
+    message["type"] = "PRIVATE_CHAT";
+    message["receiver"] = QString("user%1").arg((index + 1) % 200, 5, 10, QChar('0'));
+    return message;
+}
+
+QJsonObject groupChatMessage(int index)
+{
+    QJsonObject message = chatMessage(index);
+    message["type"] = "GROUP_CHAT";
+    message["groupId"] = 1 + index % 20;
+    return message;
+}
+
+// 与服务器一致, 历史记录中混合了三种消息
+QJsonObject historyMessages(int count)
+{
+    QJsonArray content;
+    for (int i = 0; i < count; ++i)
+    {
+        int kind = i % 10;
+        content.append(kind < 7 ? chatMessage(i) : kind < 9 ? privateChatMessage(i)
+                                                            : groupChatMessage(i));
+    }
+    return QJsonObject{{"type", "HISTORY_MESSAGES"}, {"content", content}};
+}
+
+QJsonObject onlineUsers(int count)
+{
+    QJsonArray content;
+    for (int i = 0; i < count; ++i) content.append(userJson(i));
+    return QJsonObject{{"type", "ONLINE_USERS"}, {"content", content}};
+}
+
+QJsonObject groupInfo(int groups, int membersPerGroup)
+{
+    QRandomGenerator random(CORPUS_SEED);
+    QJsonArray content;
+    for (int g = 0; g < groups; ++g)
+    {
+        QJsonArray members;
+        for (int m = 0; m < membersPerGroup; ++m) members.append(userJson(random.bounded(10000)));
+        QJsonObject group;
+        group["groupId"] = 1 + g;
+        group["groupName"] = QString("项目组%1").arg(g + 1);
+        group["creatorId"] = members.first().toObject()["userId"];
+        group["createdAt"] = timestamp(g);
+        group["members"] = members;
+        content.append(group);
+    }
+    return QJsonObject{{"type", "GROUP_INFO"}, {"content", content}};
+}
+
+QList<Frame> standardFrames()
+{
+    QList<Frame> frames;
+    frames.append(makeFrame("CHAT", chatMessage(1)));
+    frames.append(makeFrame("PRIVATE_CHAT", privateChatMessage(2)));
+    frames.append(makeFrame("GROUP_CHAT", groupChatMessage(3)));
+    frames.append(makeFrame("HEARTBEAT", QJsonObject{{"type", "HEARTBEAT"},
+                                                     {"seq", 42},
+                                                     {"sentAt", qint64(1717203600000)}}));
+    frames.append(makeFrame("USER_LOGIN", QJsonObject{{"type", "USER_LOGIN"},
+                                                      {"eventSeq", 981},
+                                                      {"content", userJson(7)}}));
+    for (int size : {10, 100, 1000})
+    {
+        frames.append(makeFrame(QString("HISTORY_MESSAGES_%1").arg(size), historyMessages(size)));
+    }
+    frames.append(makeFrame("ONLINE_USERS_10000", onlineUsers(10000)));
+    frames.append(makeFrame("GROUP_INFO_20x50", groupInfo(20, 50)));
+    return frames;
+}
+
+bool loadCapturedFrames(const QString& path, QMap<QString, QList<Frame>>& framesByType,
+                        QString& error)
+{
+    // 交给 FrameCodec 解析, 压缩帧和普通帧都能读入
+    FrameCodec codec;
+    if (TrafficCapture::isCaptureFile(path))
+    {
+        // 客户端 --capture 录下的抓包, 只取入站帧
+        QList<TrafficCapture::Frame> captured;
+        qint64 startedAtMs = 0;
+        if (!TrafficCapture::load(path, captured, startedAtMs, error)) return false;
+        for (const TrafficCapture::Frame& frame : captured)
+        {
+            if (frame.direction == TrafficCapture::Direction::Inbound) codec.append(frame.bytes);
+        }
+    }
+    else
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            error = file.errorString();
+            return false;
+        }
+        codec.append(file.readAll());
+    }
+    QJsonObject message;
+    QString frameError;
+    while (true)
+    {
+        FrameCodec::DecodeResult result = codec.decodeNext(message, frameError);
+        if (result == FrameCodec::DecodeResult::NeedMore) break;
+        if (result == FrameCodec::DecodeResult::Corrupt)
+        {
+            error = frameError;
+            return false;
+        }
+        if (result == FrameCodec::DecodeResult::Frame)
+        {
+            QString type = message["type"].toString();
+            framesByType[type].append(makeFrame(type, message));
+        }
+    }
+    if (framesByType.isEmpty())
+    {
+        error = "文件中没有可用的帧";
+        return false;
+    }
+    return true;
+}
+}  // namespace ProtocolCorpus
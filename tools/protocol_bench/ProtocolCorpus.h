@@ -0,0 +1,35 @@
+#ifndef PROTOCOLCORPUS_H
+#define PROTOCOLCORPUS_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+// 基准测试使用的协议帧, 字段和大小与服务器实际发送的消息一致, 内容由固定种子生成
+// 也可以从文件读入抓取的真实帧 (一行一帧, 与 TCP 文本格式相同)
+namespace ProtocolCorpus
+{
+struct Frame
+{
+    QString name;     // 用例名, 例如 HISTORY_MESSAGES_1000
+    QJsonObject message;
+    QByteArray json;  // compact JSON, 不含换行
+};
+
+QJsonObject chatMessage(int index);
+QJsonObject privateChatMessage(int index);
+QJsonObject groupChatMessage(int index);
+QJsonObject historyMessages(int count);
+QJsonObject onlineUsers(int count);
+QJsonObject groupInfo(int groups, int membersPerGroup);
+
+// 各种类型和大小的标准帧
+QList<Frame> standardFrames();
+// 读取抓取的帧文件 (文本格式, 可以包含压缩帧) 或客户端的抓包文件, 按消息类型分组
+bool loadCapturedFrames(const QString& path, QMap<QString, QList<Frame>>& framesByType,
+                        QString& error);
+}  // namespace ProtocolCorpus
+
+#endif  // PROTOCOLCORPUS_H
@@ -0,0 +1,335 @@
+#include "BenchmarkRunner.h"
+#include "ProtocolCorpus.h"
+#include "network/FrameCodec.h"
+#include "network/FrameTemplates.h"
+#include "network/MessageProcessor.h"
+#include "utils/MessageHandler.h"
+#include "utils/StringPool.h"
+#include "utils/Trace.h"
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QTextStream>
+
+// 大于这个大小的帧才测量压缩, 与 FrameCodec 的默认压缩阈值一致
+const int COMPRESSION_BENCH_THRESHOLD = 1024;
+
+static void benchmarkInbound(BenchmarkRunner& runner, MessageProcessor& processor,
+                             const ProtocolCorpus::Frame& frame)
+{
+    const QByteArray& json = frame.json;
+    const QJsonObject& message = frame.message;
+
+    runner.run("parse/" + frame.name, json.size(), 1,
+               [&]()
+               {
+                   QJsonDocument doc = QJsonDocument::fromJson(json);
+                   BenchmarkRunner::doNotOptimize(doc);
+               });
+    runner.run("dispatch/" + frame.name, 0, 1, [&]() { processor.processMessage(message); });
+    runner.run("parse_dispatch/" + frame.name, json.size(), 1,
+               [&]() { processor.processMessage(QJsonDocument::fromJson(json).object()); });
+    runner.run("serialize/" + frame.name, json.size(), 1,
+               [&]()
+               {
+                   QByteArray out = QJsonDocument(message).toJson(QJsonDocument::Compact);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+
+    const QByteArray cbor = FrameCodec::toCbor(message);
+    runner.run("cbor.encode/" + frame.name, cbor.size(), 1,
+               [&]()
+               {
+                   QByteArray out = FrameCodec::toCbor(message);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+    runner.run("cbor.decode/" + frame.name, cbor.size(), 1,
+               [&]()
+               {
+                   QJsonObject decoded;
+                   QString error;
+                   FrameCodec::fromCbor(cbor, decoded, error);
+                   BenchmarkRunner::doNotOptimize(decoded);
+               });
+
+    if (json.size() >= COMPRESSION_BENCH_THRESHOLD)
+    {
+        const QByteArray compressed = qCompress(json, 1);
+        runner.run("deflate.compress/" + frame.name, json.size(), 1,
+                   [&]()
+                   {
+                       QByteArray out = qCompress(json, 1);
+                       BenchmarkRunner::doNotOptimize(out);
+                   });
+        runner.run("deflate.uncompress/" + frame.name, json.size(), 1,
+                   [&]()
+                   {
+                       QByteArray out = qUncompress(compressed);
+                       BenchmarkRunner::doNotOptimize(out);
+                   });
+    }
+}
+
+// 客户端发出的消息: MessageHandler 构造 QJsonObject 再序列化, 与 FrameTemplates 直接拼接对比
+static void benchmarkOutbound(BenchmarkRunner& runner)
+{
+    const QString content = ProtocolCorpus::chatMessage(1)["content"].toString();
+    const QString receiver = "user00002";
+    const QString username = "user00001";
+    const QString nickname = "用户1";
+    const StringId usernameId = internString(username);
+    const StringId nicknameId = internString(nickname);
+    FrameTemplates templates;
+
+    runner.run("build.object/CHAT", 0, 1,
+               [&]()
+               {
+                   QByteArray out = QJsonDocument(MessageHandler::createChatMessage(content))
+                                        .toJson(QJsonDocument::Compact);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+    runner.run("build.object/PRIVATE_CHAT", 0, 1,
+               [&]()
+               {
+                   QByteArray out =
+                       QJsonDocument(MessageHandler::createPrivateChatMessage(receiver, content))
+                           .toJson(QJsonDocument::Compact);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+    runner.run("build.template/PRIVATE_CHAT", 0, 1,
+               [&]()
+               {
+                   QByteArray out;
+                   FrameTemplates::appendPrivateChat(out, receiver, content);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+    runner.run("build.object/GROUP_CHAT", 0, 1,
+               [&]()
+               {
+                   QByteArray out = QJsonDocument(MessageHandler::createGroupChatMessage(
+                                                      1001, username, nickname, 7, content))
+                                        .toJson(QJsonDocument::Compact);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+    runner.run("build.template/GROUP_CHAT", 0, 1,
+               [&]()
+               {
+                   QByteArray out;
+                   templates.appendGroupChat(out, 1001, usernameId, nicknameId, 7, content);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+    runner.run("build.object/HEARTBEAT", 0, 1,
+               [&]()
+               {
+                   QByteArray out =
+                       QJsonDocument(MessageHandler::createHeartbeatMessage(42, 1717203600000))
+                           .toJson(QJsonDocument::Compact);
+                   BenchmarkRunner::doNotOptimize(out);
+               });
+}
+
+// 追踪埋点本身的开销, 关闭时每个 span 应当低于 50ns
+static void benchmarkTrace(BenchmarkRunner& runner)
+{
+    Trace::setEnabled(false);
+    runner.run("trace.span/disabled", 0, 1,
+               [&]() { Trace::Span span(Trace::Stage::Dispatch, Trace::currentId()); });
+    Trace::setEnabled(true);
+    runner.run("trace.span/enabled", 0, 1,
+               [&]() { Trace::Span span(Trace::Stage::Dispatch, Trace::currentId()); });
+    Trace::setEnabled(false);
+}
+
+// 抓取的帧按类型成批测量, 结果按条折算
+static void benchmarkCaptured(BenchmarkRunner& runner, MessageProcessor& processor,
+                              const QString& type, const QList<ProtocolCorpus::Frame>& frames)
+{
+    qint64 bytes = 0;
+    for (const ProtocolCorpus::Frame& frame : frames) bytes += frame.json.size();
+    int count = static_cast<int>(frames.size());
+
+    runner.run("captured.parse/" + type, bytes, count,
+               [&]()
+               {
+                   for (const ProtocolCorpus::Frame& frame : frames)
+                   {
+                       QJsonDocument doc = QJsonDocument::fromJson(frame.json);
+                       BenchmarkRunner::doNotOptimize(doc);
+                   }
+               });
+    runner.run("captured.dispatch/" + type, 0, count,
+               [&]()
+               {
+                   for (const ProtocolCorpus::Frame& frame : frames)
+                       processor.processMessage(frame.message);
+               });
+    runner.run("captured.serialize/" + type, bytes, count,
+               [&]()
+               {
+                   for (const ProtocolCorpus::Frame& frame : frames)
+                   {
+                       QByteArray out = QJsonDocument(frame.message).toJson(QJsonDocument::Compact);
+                       BenchmarkRunner::doNotOptimize(out);
+                   }
+               });
+}
+
+// 每个标准帧在四种编码组合下编码再解码, 结果必须与原消息相同;
+// FrameTemplates 的输出解析后必须与 MessageHandler 构造的消息相同
+static int verifyRoundTrip(const QList<ProtocolCorpus::Frame>& frames)
+{
+    QTextStream out(stdout);
+    int failures = 0;
+    const FrameCodec::Encoding encodings[] = {FrameCodec::Encoding::Json,
+                                              FrameCodec::Encoding::Cbor};
+    const FrameCodec::Compression compressions[] = {FrameCodec::Compression::None,
+                                                    FrameCodec::Compression::Deflate};
+
+    for (const ProtocolCorpus::Frame& frame : frames)
+    {
+        for (FrameCodec::Encoding encoding : encodings)
+        {
+            for (FrameCodec::Compression compression : compressions)
+            {
+                FrameCodec sender;
+                sender.setEncoding(encoding);
+                sender.setCompression(compression);
+                FrameCodec receiver;
+                receiver.append(sender.encode(frame.message));
+
+                QJsonObject decoded;
+                QString error;
+                FrameCodec::DecodeResult result = receiver.decodeNext(decoded, error);
+                bool ok = result == FrameCodec::DecodeResult::Frame && decoded == frame.message;
+                QString variant = QString("%1%2")
+                                      .arg(encoding == FrameCodec::Encoding::Json ? "json" : "cbor")
+                                      .arg(compression == FrameCodec::Compression::Deflate
+                                               ? "+deflate"
+                                               : "");
+                if (!ok)
+                {
+                    failures++;
+                    out << "FAIL " << frame.name << " " << variant << " " << error << Qt::endl;
+                }
+            }
+        }
+    }
+
+    const QString content = ProtocolCorpus::chatMessage(1)["content"].toString();
+    FrameTemplates templates;
+    QByteArray groupChat;
+    templates.appendGroupChat(groupChat, 1001, internString("user00001"), internString("用户1"), 7,
+                              content);
+    if (QJsonDocument::fromJson(groupChat).object() !=
+        MessageHandler::createGroupChatMessage(1001, "user00001", "用户1", 7, content))
+    {
+        failures++;
+        out << "FAIL template GROUP_CHAT " << groupChat << Qt::endl;
+    }
+    QByteArray privateChat;
+    FrameTemplates::appendPrivateChat(privateChat, "user00002", content);
+    if (QJsonDocument::fromJson(privateChat).object() !=
+        MessageHandler::createPrivateChatMessage("user00002", content))
+    {
+        failures++;
+        out << "FAIL template PRIVATE_CHAT " << privateChat << Qt::endl;
+    }
+
+    if (failures == 0)
+        out << "verify: all round trips OK" << Qt::endl;
+    else
+        out << "verify: " << failures << " failures" << Qt::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+// 协议层的微基准测试: 解析、分发、序列化、CBOR 和压缩, 按消息类型和大小分别测量
+// 例: chatter_protocol_bench --filter "HISTORY|ONLINE" --json results.json
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chatter_protocol_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Protocol micro-benchmarks: parse, dispatch, serialize");
+    parser.addHelpOption();
+    QCommandLineOption filterOption("filter", "Only run benchmarks matching the regex", "regex");
+    QCommandLineOption minTimeOption("min-time", "Minimum time per measurement", "ms", "200");
+    QCommandLineOption repetitionsOption("repetitions", "Measurements per benchmark (median)",
+                                         "count", "5");
+    QCommandLineOption jsonOption("json", "Write machine-readable results to file ('-' = stdout)",
+                                  "file");
+    QCommandLineOption framesOption("frames", "Also benchmark captured frames from file", "file");
+    QCommandLineOption verifyOption("verify", "Check codec round trips instead of benchmarking");
+    parser.addOptions(
+        {filterOption, minTimeOption, repetitionsOption, jsonOption, framesOption, verifyOption});
+    parser.process(app);
+
+    // 处理函数里的日志会刷屏, 全部关闭. 分类关闭时整条语句不执行, 参数也不格式化,
+    // 所以测得的耗时不含日志开销; 客户端默认也关闭 debug, 只有 info 和警告会多出格式化的开销
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false\n*.warning=false");
+
+    const QList<ProtocolCorpus::Frame> frames = ProtocolCorpus::standardFrames();
+    if (parser.isSet(verifyOption)) return verifyRoundTrip(frames);
+
+    BenchmarkRunner runner;
+    runner.setMinTimeMs(parser.value(minTimeOption).toInt());
+    runner.setRepetitions(parser.value(repetitionsOption).toInt());
+    if (parser.isSet(filterOption))
+    {
+        QRegularExpression filter(parser.value(filterOption));
+        if (!filter.isValid())
+        {
+            qCritical() << "Invalid filter:" << filter.errorString();
+            return 1;
+        }
+        runner.setFilter(filter);
+    }
+
+    MessageProcessor processor;
+    for (const ProtocolCorpus::Frame& frame : frames) benchmarkInbound(runner, processor, frame);
+    benchmarkOutbound(runner);
+    benchmarkTrace(runner);
+
+    if (parser.isSet(framesOption))
+    {
+        QMap<QString, QList<ProtocolCorpus::Frame>> captured;
+        QString error;
+        if (!ProtocolCorpus::loadCapturedFrames(parser.value(framesOption), captured, error))
+        {
+            qCritical() << "Cannot load captured frames:" << error;
+            return 1;
+        }
+        for (auto it = captured.constBegin(); it != captured.constEnd(); ++it)
+        {
+            benchmarkCaptured(runner, processor, it.key(), it.value());
+        }
+    }
+
+    QString jsonPath = parser.value(jsonOption);
+    if (jsonPath != "-") runner.printTable();
+
+    if (!jsonPath.isEmpty())
+    {
+        QByteArray json = QJsonDocument(runner.toJson("protocol")).toJson();
+        QString path = jsonPath;
+        if (path == "-")
+        {
+            QTextStream(stdout) << json;
+        }
+        else
+        {
+            QFile file(path);
+            if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+            {
+                qCritical() << "Cannot write results:" << path << file.errorString();
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "network/ChatClient.h"
+#include "network/TrafficReplayer.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/UserInfo.h"
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QSysInfo>
+#include <QTextStream>
+
+// 无界面的抓包回放: 把 chatter_client --capture 录下的入站帧交给 ChatClient 解码和分发,
+// 只测协议层和数据模型, 不包括界面. 同一个抓包在两个版本上各跑一次即可比较
+// 例: chatter_replay capture.bin --json replay.json
+//     chatter_replay capture.bin --speed 1     按原始节奏回放
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chatter_replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay a traffic capture through the client without UI");
+    parser.addHelpOption();
+    parser.addPositionalArgument("capture", "Capture file written by chatter_client --capture");
+
+    QCommandLineOption speedOption("speed", "1 = original timing, 0 = as fast as possible",
+                                   "factor", "0");
+    QCommandLineOption jsonOption("json", "Write machine-readable results to file ('-' = stdout)",
+                                  "file");
+    QCommandLineOption verboseOption("verbose", "Keep client logging");
+    parser.addOptions({speedOption, jsonOption, verboseOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(1);
+    }
+    if (!parser.isSet(verboseOption))
+    {
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false\n*.warning=false");
+    }
+
+    const QString capturePath = parser.positionalArguments().first();
+    TrafficReplayer replayer;
+    QString error;
+    if (!replayer.load(capturePath, error))
+    {
+        qCritical() << "Cannot load capture:" << capturePath << error;
+        return 1;
+    }
+    replayer.setSpeed(parser.value(speedOption).toDouble());
+
+    UserInfo userInfo;
+    ChatClient client(userInfo);
+    client.beginReplay();
+    QObject::connect(&replayer, &TrafficReplayer::frameReady, &client, &ChatClient::replayFrame);
+
+    const QString jsonPath = parser.value(jsonOption);
+    QObject::connect(
+        &replayer, &TrafficReplayer::finished, &app,
+        [&](qint64 elapsedMs)
+        {
+            MetricHistogram::Snapshot parse =
+                MetricsRegistry::instance().histogram("frame.parse_ns").snapshot();
+            double seconds = qMax<qint64>(1, elapsedMs) / 1000.0;
+
+            if (jsonPath != "-")
+            {
+                QTextStream out(stdout);
+                out << "capture:      " << capturePath << Qt::endl
+                    << "frames:       " << replayer.frameCount() << " ("
+                    << replayer.byteCount() << " bytes, captured over "
+                    << replayer.capturedDurationMs() << " ms)" << Qt::endl
+                    << "elapsed:      " << elapsedMs << " ms" << Qt::endl
+                    << "throughput:   " << QString::number(replayer.frameCount() / seconds, 'f', 0)
+                    << " frames/s, "
+                    << QString::number(replayer.byteCount() / seconds / 1048576.0, 'f', 2)
+                    << " MB/s" << Qt::endl
+                    << "parse ns:     p50 " << parse.percentile(50) << ", p99 "
+                    << parse.percentile(99) << ", max " << parse.max << Qt::endl;
+            }
+
+            int exitCode = 0;
+            if (!jsonPath.isEmpty())
+            {
+                QJsonObject context;
+                context["qtVersion"] = QString::fromLatin1(qVersion());
+                context["buildAbi"] = QSysInfo::buildAbi();
+                context["os"] = QSysInfo::prettyProductName();
+
+                QJsonObject results;
+                results["capture"] = capturePath;
+                results["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+                results["speed"] = replayer.speed();
+                results["frames"] = replayer.frameCount();
+                results["bytes"] = replayer.byteCount();
+                results["capturedDurationMs"] = replayer.capturedDurationMs();
+                results["elapsedMs"] = elapsedMs;
+                results["framesPerSecond"] = replayer.frameCount() / seconds;
+                results["context"] = context;
+                results["metrics"] = MetricsRegistry::instance().toJson();
+
+                QByteArray json = QJsonDocument(results).toJson();
+                if (jsonPath == "-")
+                {
+                    QTextStream(stdout) << json;
+                }
+                else
+                {
+                    QFile file(jsonPath);
+                    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+                    {
+                        qCritical() << "Cannot write results:" << jsonPath << file.errorString();
+                        exitCode = 1;
+                    }
+                }
+            }
+            app.exit(exitCode);
+        });
+
+    replayer.start();
+    return app.exec();
+}
@@ -0,0 +1,97 @@
+#include "SyntheticConversation.h"
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTime>
+#include <iterator>
+
+namespace
+{
+const quint32 CONVERSATION_SEED = 20240601;
+const int FILE_SIZE_LIMIT = 64 * 1024 * 1024;
+
+QString sampleContent(QRandomGenerator& random)
+{
+    static const QString words[] = {"好的", "收到", "明天", "会议", "build", "failed", "没问题",
+                                    "哈哈", "review", "这个", "接口", "延迟", "😀", "p99",
+                                    "deploy", "\"quoted\"", "路径 C:\\temp"};
+    int count = random.bounded(100) < 90 ? 2 + random.bounded(12) : 40 + random.bounded(80);
+    QString content;
+    for (int i = 0; i < count; ++i)
+    {
+        if (i > 0) content.append(' ');
+        content.append(words[random.bounded(int(std::size(words)))]);
+    }
+    return content;
+}
+
+QJsonObject fileContent(QRandomGenerator& random, int index, bool isOwn)
+{
+    static const QString extensions[] = {"pdf", "png", "zip", "docx", "log"};
+    QString fileName = QString("附件_%1.%2")
+                           .arg(index)
+                           .arg(extensions[random.bounded(int(std::size(extensions)))]);
+    QJsonObject content;
+    content["type"] = "file";
+    content["fileName"] = fileName;
+    content["fileSize"] = random.bounded(FILE_SIZE_LIMIT);
+    content["fileUrl"] = QString("http://127.0.0.1:8080/api/files/%1").arg(index);
+    content["isSender"] = isOwn;
+    content["haveTransmitted"] = random.bounded(3) == 0;
+    content["taskId"] = QString("bench_%1").arg(index);
+    return content;
+}
+}  // namespace
+
+namespace SyntheticConversation
+{
+QString username(int sender)
+{
+    return QString("user%1").arg(sender, 5, 10, QChar('0'));
+}
+
+QString nickname(int sender)
+{
+    return QString("用户%1").arg(sender);
+}
+
+Message message(int index, bool withFiles)
+{
+    QRandomGenerator random(CONVERSATION_SEED + index);
+    int sender = random.bounded(SenderCount);
+
+    Message message;
+    message.senderUsername = username(sender);
+    message.senderNickname = nickname(sender);
+    message.isOwn = sender == 0;
+    message.timestamp = QTime(9, 0).addSecs(index % 50000).toString("hh:mm:ss");
+    message.isFile = withFiles && index % FileEvery == FileEvery - 1;
+    if (message.isFile)
+        message.content = fileContent(random, index, message.isOwn);
+    else
+        message.content = sampleContent(random);
+    return message;
+}
+
+QJsonArray groupInfo(int groups)
+{
+    QJsonArray members;
+    for (int sender = 0; sender < SenderCount; ++sender)
+    {
+        members.append(QJsonObject{{"userId", 1000 + sender},
+                                   {"username", username(sender)},
+                                   {"nickname", nickname(sender)}});
+    }
+
+    QJsonArray content;
+    for (int g = 0; g < groups; ++g)
+    {
+        QJsonObject group;
+        group["groupId"] = 1 + g;
+        group["groupName"] = QString("项目组%1").arg(g + 1);
+        group["creatorId"] = 1000;
+        group["members"] = members;
+        content.append(group);
+    }
+    return content;
+}
+}  // namespace SyntheticConversation
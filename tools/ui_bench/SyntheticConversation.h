@@ -0,0 +1,34 @@
+#ifndef SYNTHETICCONVERSATION_H
+#define SYNTHETICCONVERSATION_H
+
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QString>
+
+// 界面基准测试使用的合成会话, 内容由固定种子生成, 同一个下标每次得到相同的消息.
+// 文本长度的分布与 ProtocolCorpus 一致: 大部分是短句, 少量长段落;
+// 带文件的会话中每 FileEvery 条有一条文件消息, 已传输和未传输的各占一部分
+namespace SyntheticConversation
+{
+const int SenderCount = 12;  // 下标 0 是自己
+const int FileEvery = 8;
+
+struct Message
+{
+    QString senderUsername;
+    QString senderNickname;
+    QJsonValue content;  // 文本消息是字符串, 文件消息是 MessageBubble 使用的文件对象
+    QString timestamp;
+    bool isFile = false;
+    bool isOwn = false;
+};
+
+QString username(int sender);
+QString nickname(int sender);
+
+Message message(int index, bool withFiles);
+// GroupChatTab::receiveGroupInfo 的参数, 群组 id 从 1 开始
+QJsonArray groupInfo(int groups);
+}  // namespace SyntheticConversation
+
+#endif  // SYNTHETICCONVERSATION_H
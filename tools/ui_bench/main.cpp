@@ -0,0 +1,412 @@
+#include "AllocationCounter.h"
+#include "BenchmarkRunner.h"
+#include "SyntheticConversation.h"
+#include "network/ChatClient.h"
+#include "ui/GroupChatSession.h"
+#include "ui/GroupChatTab.h"
+#include "ui/PrivateChatSession.h"
+#include "ui/PublicChatTab.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/UserInfo.h"
+#include "utils/UserManager.h"
+
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QListWidget>
+#include <QLoggingCategory>
+#include <QScrollArea>
+#include <QScrollBar>
+#include <QTextStream>
+#include <QVBoxLayout>
+#include <functional>
+
+namespace
+{
+const int FILL_BATCH = 256;  // 填充时每批处理一次事件, 接近一次收到一批历史消息的情况
+const int SCROLL_FRAMES = 240;
+const int GROUP_COUNT = 4;
+const int WINDOW_WIDTH = 960;
+const int WINDOW_HEIGHT = 720;
+const int SETTLE_PASSES = 3;
+
+// 一种会话控件: 怎样构造, 怎样追加第 index 条消息
+struct Scenario
+{
+    QString name;
+    bool withFiles;
+    std::function<QWidget*()> create;
+    std::function<void(QWidget*, const SyntheticConversation::Message&)> append;
+};
+
+struct Row
+{
+    QString name;
+    int messages = 0;
+    QJsonObject values;
+};
+
+// 处理已经排队的事件: 布局请求、追加后延迟执行的滚动到底部, 以及随后的重绘.
+// 每一轮都可能排入新的事件, 固定处理几轮
+void settle()
+{
+    for (int i = 0; i < SETTLE_PASSES; ++i) QCoreApplication::processEvents();
+}
+
+double toMs(qint64 ns)
+{
+    return ns / 1e6;
+}
+
+// 放进一个固定大小的顶层窗口并显示, offscreen 平台上同样会布局和绘制
+QWidget* showInWindow(QWidget* content)
+{
+    QWidget* window = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout(window);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(content);
+    window->resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+    window->show();
+    settle();
+    return window;
+}
+
+// 从底部开始每帧向上滚动三分之一页, 到顶后回到底部, 每帧等绘制完成
+QJsonObject measureScroll(QScrollArea* area)
+{
+    QScrollBar* bar = area->verticalScrollBar();
+    const int step = qMax(1, bar->pageStep() / 3);
+    MetricHistogram frames;
+    int value = bar->maximum();
+    QElapsedTimer total;
+    total.start();
+    for (int i = 0; i < SCROLL_FRAMES; ++i)
+    {
+        value -= step;
+        if (value < bar->minimum()) value = bar->maximum();
+        QElapsedTimer frame;
+        frame.start();
+        bar->setValue(value);
+        settle();
+        frames.record(frame.nsecsElapsed());
+    }
+    qint64 elapsed = qMax<qint64>(1, total.nsecsElapsed());
+
+    QJsonObject json;
+    json["fps"] = SCROLL_FRAMES * 1e9 / elapsed;
+    json["frame_ns"] = frames.snapshot().toJson();
+    return json;
+}
+
+// 填满 messages 条, 再逐条追加 samples 条测单条延迟 (追加 + 布局 + 滚动到底部 + 重绘), 最后测滚动
+Row runScenario(const Scenario& scenario, int messages, int samples)
+{
+    QWidget* content = scenario.create();
+    QWidget* window = showInWindow(content);
+
+    const qint64 heapBefore = heapBytesInUse();
+    const quint64 allocationsBefore = allocationCount();
+    const int widgetsBefore = QApplication::allWidgets().size();
+    QElapsedTimer fill;
+    fill.start();
+    for (int i = 0; i < messages; ++i)
+    {
+        scenario.append(content, SyntheticConversation::message(i, scenario.withFiles));
+        if ((i + 1) % FILL_BATCH == 0) settle();
+    }
+    settle();
+    const qint64 fillNs = fill.nsecsElapsed();
+    const qint64 heapAfter = heapBytesInUse();
+
+    Row row;
+    row.name = scenario.name;
+    row.messages = messages;
+    row.values["fillMs"] = toMs(fillNs);
+    row.values["fillNsPerMessage"] = double(fillNs) / messages;
+    row.values["allocationsPerMessage"] =
+        double(allocationCount() - allocationsBefore) / messages;
+    row.values["widgetsPerMessage"] =
+        double(QApplication::allWidgets().size() - widgetsBefore) / messages;
+    // 包括控件和会话数据 (ChatMessageRecord) 两部分
+    if (heapBefore >= 0)
+        row.values["heapBytesPerMessage"] = double(heapAfter - heapBefore) / messages;
+
+    MetricHistogram append;
+    for (int i = 0; i < samples; ++i)
+    {
+        SyntheticConversation::Message message =
+            SyntheticConversation::message(messages + i, scenario.withFiles);
+        QElapsedTimer timer;
+        timer.start();
+        scenario.append(content, message);
+        settle();
+        append.record(timer.nsecsElapsed());
+    }
+    row.values["append_ns"] = append.snapshot().toJson();
+
+    if (QScrollArea* area = content->findChild<QScrollArea*>())
+    {
+        row.values["scroll"] = measureScroll(area);
+    }
+
+    delete window;
+    settle();
+    return row;
+}
+
+// GroupChatTab 的会话切换: 第一次打开一个群组时从 GroupChatData 构造控件 (cold),
+// 之后在已经构造好的会话之间切换只是 QStackedWidget 换页加滚动到底部 (warm)
+Row runGroupSwitch(ChatClient* client, UserManager* userManager, int messages, int rounds)
+{
+    GroupChatTab* tab = new GroupChatTab(client, SyntheticConversation::nickname(0), userManager);
+    QWidget* window = showInWindow(tab);
+
+    tab->receiveGroupInfo(SyntheticConversation::groupInfo(GROUP_COUNT));
+    for (int i = 0; i < messages; ++i)
+    {
+        SyntheticConversation::Message message = SyntheticConversation::message(i, false);
+        tab->appendMessage(message.senderUsername, message.senderNickname, 1 + i % GROUP_COUNT,
+                           message.content.toString(), message.timestamp);
+    }
+    settle();
+
+    // 与用户点击列表项走同一个槽
+    QListWidget* list = tab->findChild<QListWidget*>("groupList");
+    auto open = [list](int row)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        emit list->itemClicked(list->item(row));
+        settle();
+        return timer.nsecsElapsed();
+    };
+
+    MetricHistogram cold;
+    for (int row = 0; row < list->count(); ++row) cold.record(open(row));
+    MetricHistogram warm;
+    for (int i = 0; i < rounds; ++i) warm.record(open(i % list->count()));
+
+    Row row;
+    row.name = "group_tab.switch";
+    row.messages = messages;
+    row.values["groups"] = list->count();
+    row.values["messagesPerGroup"] = messages / GROUP_COUNT;
+    row.values["cold_ns"] = cold.snapshot().toJson();
+    row.values["warm_ns"] = warm.snapshot().toJson();
+
+    delete window;
+    settle();
+    return row;
+}
+
+QString formatMs(const QJsonValue& histogram, const char* key)
+{
+    if (!histogram.isObject()) return "-";
+    qint64 ns = histogram.toObject().value(QLatin1String(key)).toInteger();
+    return QString::number(toMs(ns), 'f', 2);
+}
+
+void printTable(const QList<Row>& rows)
+{
+    QTextStream out(stdout);
+    out << Qt::endl
+        << qSetFieldWidth(20) << Qt::left << "benchmark" << qSetFieldWidth(0) << Qt::right
+        << QString("messages").rightJustified(10) << QString("fill ns/msg").rightJustified(13)
+        << QString("heap B/msg").rightJustified(12) << QString("p50 ms").rightJustified(10)
+        << QString("p99 ms").rightJustified(10) << QString("scroll fps").rightJustified(12)
+        << Qt::endl;
+    for (const Row& row : rows)
+    {
+        const QJsonObject& v = row.values;
+        // 会话切换一行的延迟列是 warm, 填充列显示 cold 的 p50
+        bool isSwitch = v.contains("warm_ns");
+        QJsonValue latency = isSwitch ? v["warm_ns"] : v["append_ns"];
+        out << qSetFieldWidth(20) << Qt::left << row.name << qSetFieldWidth(0) << Qt::right
+            << QString::number(row.messages).rightJustified(10)
+            << (isSwitch ? "cold " + formatMs(v["cold_ns"], "p50") + "ms"
+                         : QString::number(v["fillNsPerMessage"].toDouble(), 'f', 0))
+                   .rightJustified(13)
+            << (v.contains("heapBytesPerMessage")
+                    ? QString::number(v["heapBytesPerMessage"].toDouble(), 'f', 0)
+                    : QString("-"))
+                   .rightJustified(12)
+            << formatMs(latency, "p50").rightJustified(10)
+            << formatMs(latency, "p99").rightJustified(10)
+            << (v.contains("scroll")
+                    ? QString::number(v["scroll"].toObject()["fps"].toDouble(), 'f', 1)
+                    : QString("-"))
+                   .rightJustified(12)
+            << Qt::endl;
+    }
+}
+}  // namespace
+
+// 界面可扩展性基准测试: 在 offscreen 平台上构造真实的会话控件, 填入合成消息,
+// 测填充耗时、每条消息的内存和控件数、单条追加延迟、滚动帧率和群组会话切换耗时
+// 例: QT_QPA_PLATFORM=offscreen chatter_ui_bench --sizes 1000,10000 --json ui.json
+int main(int argc, char* argv[])
+{
+    // CI 上没有显示器, 默认使用 offscreen 平台
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chatter_ui_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("UI scalability benchmark on synthetic conversations");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma separated conversation sizes", "list",
+                                   "1000,10000,100000");
+    QCommandLineOption samplesOption("samples", "Single appends measured after filling", "count",
+                                     "100");
+    QCommandLineOption roundsOption("switch-rounds", "Warm group switches to measure", "count",
+                                    "50");
+    QCommandLineOption filterOption("filter", "Only run benchmarks matching the regex", "regex");
+    QCommandLineOption noStyleOption("no-style", "Do not load the client style sheet");
+    QCommandLineOption jsonOption("json", "Write machine-readable results to file ('-' = stdout)",
+                                  "file");
+    parser.addOptions({sizesOption, samplesOption, roundsOption, filterOption, noStyleOption,
+                       jsonOption});
+    parser.process(app);
+
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false\n*.warning=false");
+
+    QList<int> sizes;
+    for (const QString& part : parser.value(sizesOption).split(',', Qt::SkipEmptyParts))
+    {
+        bool ok = false;
+        int size = part.trimmed().toInt(&ok);
+        if (!ok || size <= 0)
+        {
+            qCritical() << "Invalid size:" << part;
+            return 1;
+        }
+        sizes.append(size);
+    }
+    const int samples = qMax(1, parser.value(samplesOption).toInt());
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+    QRegularExpression filter(parser.value(filterOption));
+    if (!filter.isValid())
+    {
+        qCritical() << "Invalid filter:" << filter.errorString();
+        return 1;
+    }
+
+    // 控件的样式表对布局和绘制的开销影响很大, 默认与客户端一致
+    if (!parser.isSet(noStyleOption))
+    {
+        QFile styleFile(":/styles/styles.qss");
+        if (styleFile.open(QFile::ReadOnly)) app.setStyleSheet(styleFile.readAll());
+    }
+
+    // 下标 0 的发送者是自己, 气泡按自己的消息靠右显示
+    UserInfo::instance().setUserId(1000);
+    UserInfo::instance().setUsername(SyntheticConversation::username(0));
+    UserInfo::instance().setNickname(SyntheticConversation::nickname(0));
+    const QString selfUsername = SyntheticConversation::username(0);
+    const QString selfNickname = SyntheticConversation::nickname(0);
+    ChatClient client(&app);
+    UserManager userManager;
+
+    const QList<Scenario> scenarios = {
+        {"public", false,
+         [&]() { return new PublicChatTab(&client, selfNickname); },
+         [](QWidget* widget, const SyntheticConversation::Message& message)
+         {
+             static_cast<PublicChatTab*>(widget)->appendMessage(
+                 message.senderNickname, message.content.toString(), message.timestamp);
+         }},
+        {"private", true,
+         [&]()
+         {
+             auto data = QSharedPointer<PrivateChatData>::create(
+                 internString(SyntheticConversation::username(1)),
+                 internString(SyntheticConversation::nickname(1)));
+             return new PrivateChatSession(&client, data, selfUsername, selfNickname);
+         },
+         [](QWidget* widget, const SyntheticConversation::Message& message)
+         {
+             static_cast<PrivateChatSession*>(widget)->appendMessage(
+                 internString(message.senderUsername), message.content, message.timestamp,
+                 message.isFile);
+         }},
+        {"group", false,
+         []()
+         {
+             QJsonObject info = SyntheticConversation::groupInfo(1).first().toObject();
+             auto data = QSharedPointer<GroupChatData>::create(
+                 1, info["groupName"].toString(), 1000, info["members"].toArray());
+             return new GroupChatSession(data);
+         },
+         [](QWidget* widget, const SyntheticConversation::Message& message)
+         {
+             static_cast<GroupChatSession*>(widget)->appendMessage(
+                 internString(message.senderUsername), internString(message.senderNickname),
+                 message.content, message.timestamp);
+         }},
+    };
+
+    auto accepts = [&filter](const QString& name)
+    {
+        return filter.pattern().isEmpty() || filter.match(name).hasMatch();
+    };
+
+    QList<Row> rows;
+    for (int size : sizes)
+    {
+        for (const Scenario& scenario : scenarios)
+        {
+            if (accepts(scenario.name)) rows.append(runScenario(scenario, size, samples));
+        }
+        if (accepts("group_tab.switch"))
+        {
+            rows.append(runGroupSwitch(&client, &userManager, size, rounds));
+        }
+    }
+
+    QString jsonPath = parser.value(jsonOption);
+    if (jsonPath != "-") printTable(rows);
+
+    if (!jsonPath.isEmpty())
+    {
+        QJsonArray results;
+        for (const Row& row : rows)
+        {
+            QJsonObject result = row.values;
+            result["name"] = row.name;
+            result["messages"] = row.messages;
+            results.append(result);
+        }
+        QJsonObject context = BenchmarkRunner::environment();
+        context["platform"] = QGuiApplication::platformName();
+        context["styleSheet"] = !parser.isSet(noStyleOption);
+        context["samples"] = samples;
+        context["scrollFrames"] = SCROLL_FRAMES;
+
+        QJsonObject json;
+        json["suite"] = "ui";
+        json["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        json["context"] = context;
+        json["results"] = results;
+        QByteArray bytes = QJsonDocument(json).toJson();
+        if (jsonPath == "-")
+        {
+            QTextStream(stdout) << bytes;
+        }
+        else
+        {
+            QFile file(jsonPath);
+            if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size())
+            {
+                qCritical() << "Cannot write results:" << jsonPath << file.errorString();
+                return 1;
+            }
+        }
+    }
+    return 0;
+}